@@ -10,11 +10,13 @@ uniform vec3 diffuseColor;
 uniform sampler2D diffuseMap;
 uniform vec3 specularColor;
 uniform sampler2D specularMap;
+uniform sampler2D normalMap;
 uniform float shininess;
 	
 uniform int hasDiffuseMap;
 uniform int hasSpecularMap;
 uniform int hasShininessInSpecularAlpha;
+uniform int hasNormalMap;
 
 struct AmbientLight {
 	vec3 color;
@@ -60,8 +62,29 @@ struct Light {
 uniform Light light;
 uniform vec3 viewPos;
 
+// Normal maps only store X and Y, Z is reconstructed. The tangent frame is built from the screen space derivatives.
+vec3 GetNormal(vec3 normal) {
+	if (hasNormalMap == 0) return normal;
+
+	vec2 mapUV = vec2(uv.x, 1 - uv.y);
+	vec2 xy = texture(normalMap, mapUV).rg * 2.0 - 1.0;
+	vec3 tangentNormal = vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0)));
+
+	vec3 dPdx = dFdx(fragPos);
+	vec3 dPdy = dFdy(fragPos);
+	vec2 dUVdx = dFdx(mapUV);
+	vec2 dUVdy = dFdy(mapUV);
+	vec3 dPdyPerp = cross(dPdy, normal);
+	vec3 dPdxPerp = cross(normal, dPdx);
+	vec3 tangent = dPdyPerp * dUVdx.x + dPdxPerp * dUVdy.x;
+	vec3 bitangent = dPdyPerp * dUVdx.y + dPdxPerp * dUVdy.y;
+	float scale = inversesqrt(max(max(dot(tangent, tangent), dot(bitangent, bitangent)), 1e-20));
+
+	return normalize(mat3(tangent * scale, bitangent * scale, normal) * tangentNormal);
+}
+
 void main() {    
-	vec3 fragN = normalize(fragNormal);
+	vec3 fragN = GetNormal(normalize(fragNormal));
 	vec3 viewN = normalize(viewPos - fragPos);
 	
 	// diffuse 
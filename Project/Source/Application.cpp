@@ -2,6 +2,9 @@
 
 #include "Globals.h"
 #include "Utils/Logging.h"
+#include "Utils/FrameArena.h"
+#include "Utils/AllocationCounter.h"
+#include "Utils/Profiling.h"
 #include "Modules/ModuleHardwareInfo.h"
 #include "Modules/ModuleFiles.h"
 #include "Modules/ModuleInput.h"
@@ -16,73 +19,190 @@
 #include "Modules/ModuleTime.h"
 
 #include "SDL_timer.h"
+#include "Math/myassert.h"
 #include <windows.h>
-#include "Brofiler.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <stdio.h>
 
 #include "Utils/Leaks.h"
 
-Application::Application() {
-	// Order matters: they will Init/start/update in this order
-	modules.push_back(hardware = new ModuleHardwareInfo());
-	modules.push_back(window = new ModuleWindow());
-	modules.push_back(files = new ModuleFiles());
-	modules.push_back(resources = new ModuleResources());
-	modules.push_back(programs = new ModulePrograms());
+struct StartupTask {
+	Module* module = nullptr;
+	bool onWorker = false;
+	unsigned numPendingDependencies = 0;
+	std::vector<unsigned> dependencies;
+	std::vector<unsigned> dependents;
+	unsigned long long startNs = 0;
+	unsigned long long endNs = 0;
+};
 
-	modules.push_back(time = new ModuleTime());
-	modules.push_back(input = new ModuleInput());
-	modules.push_back(camera = new ModuleCamera());
+struct StartupScheduler {
+	std::mutex mutex;
+	std::condition_variable condition;
+	std::vector<StartupTask> tasks;
+	std::vector<unsigned> readyMainTasks; // Run in module order
+	std::deque<unsigned> readyWorkerTasks;
+	std::vector<std::function<void()>> mainThreadFunctions;
+	unsigned numRunning = 0;
+	unsigned numFinished = 0;
+	bool failed = false;
 
-	modules.push_back(scene = new ModuleScene());
-	modules.push_back(editor = new ModuleEditor());
-	modules.push_back(debugDraw = new ModuleDebugDraw());
+	// After a failure, the running tasks finish but no new ones start
+	bool IsDone() const {
+		return numFinished == tasks.size() || (failed && numRunning == 0);
+	}
+};
+
+static bool RunStartupTask(StartupScheduler& scheduler, unsigned index, bool (Module::*step)(), std::unique_lock<std::mutex>& lock) {
+	StartupTask& task = scheduler.tasks[index];
+	scheduler.numRunning += 1;
+	lock.unlock();
 
-	modules.push_back(renderer = new ModuleRender());
+	task.startNs = ProfilerNowNs();
+	bool ret;
+	{
+		// Not PROFILE_ZONE: the Brofiler category would keep the first module name
+		ProfileScope scope(task.module->name, ProfilerColor::SkyBlue);
+		ret = (task.module->*step)();
+	}
+	task.endNs = ProfilerNowNs();
+
+	lock.lock();
+	scheduler.numRunning -= 1;
+	scheduler.numFinished += 1;
+	if (!ret) {
+		LOG_WARNING(LogCategory::GENERAL, "Module \"%s\" failed.", task.module->name);
+		scheduler.failed = true;
+	}
+	for (unsigned dependent : task.dependents) {
+		StartupTask& dependentTask = scheduler.tasks[dependent];
+		dependentTask.numPendingDependencies -= 1;
+		if (dependentTask.numPendingDependencies > 0) continue;
+
+		if (dependentTask.onWorker) {
+			scheduler.readyWorkerTasks.push_back(dependent);
+		} else {
+			scheduler.readyMainTasks.push_back(dependent);
+		}
+	}
+	scheduler.condition.notify_all();
+	return ret;
 }
 
-Application::~Application() {
-	for (Module* module : modules) {
-		delete module;
+static void RunStartupWorker(StartupScheduler* scheduler, bool (Module::*step)()) {
+	SetProfilerThreadName("Startup Worker");
+
+	std::unique_lock<std::mutex> lock(scheduler->mutex);
+	while (!scheduler->IsDone()) {
+		if (!scheduler->failed && !scheduler->readyWorkerTasks.empty()) {
+			unsigned index = scheduler->readyWorkerTasks.front();
+			scheduler->readyWorkerTasks.pop_front();
+			RunStartupTask(*scheduler, index, step, lock);
+			continue;
+		}
+		scheduler->condition.wait(lock);
 	}
 }
 
-bool Application::Init() {
-	bool ret = true;
+// Logs the chain of dependencies that decided how long the step took
+static void LogStartupCriticalPath(const StartupScheduler& scheduler, const char* stepName, unsigned long long startNs, unsigned long long endNs) {
+	int index = -1;
+	for (unsigned i = 0; i < scheduler.tasks.size(); ++i) {
+		if (scheduler.tasks[i].endNs == 0) continue;
+		if (index == -1 || scheduler.tasks[i].endNs > scheduler.tasks[index].endNs) index = i;
+	}
 
-	for (std::vector<Module*>::iterator it = modules.begin(); it != modules.end() && ret; ++it) {
-		ret = (*it)->Init();
+	std::string criticalPath;
+	while (index != -1) {
+		const StartupTask& task = scheduler.tasks[index];
+		char entry[128];
+		sprintf_s(entry, "%s%s (%.2fms)", criticalPath.empty() ? "" : " <- ", task.module->name, (task.endNs - task.startNs) / 1000000.0);
+		criticalPath += entry;
+
+		int dependencyIndex = -1;
+		for (unsigned dependency : task.dependencies) {
+			if (dependencyIndex == -1 || scheduler.tasks[dependency].endNs > scheduler.tasks[dependencyIndex].endNs) dependencyIndex = dependency;
+		}
+		index = dependencyIndex;
 	}
 
-	return ret;
+	LOG_INFO(LogCategory::GENERAL, "%s finished in %.2fms. Critical path: %s.", stepName, (endNs - startNs) / 1000000.0, criticalPath.c_str());
 }
 
-bool Application::Start() {
-	bool ret = true;
+Application::Application(bool headless_)
+	: headless(headless_)
+	, mainThreadId(std::this_thread::get_id()) {
+	// Order matters: they will update in this order.
+	// Modules that Init/Start on the main thread keep this order between them. The ones on workers only wait for their dependencies.
+	AddModule(hardware = new ModuleHardwareInfo(), "ModuleHardwareInfo");
+	if (!headless) AddModule(window = new ModuleWindow(), "ModuleWindow");
+	AddModule(files = new ModuleFiles(), "ModuleFiles");
+	AddModule(resources = new ModuleResources(), "ModuleResources", {files});
+	if (!headless) AddModule(programs = new ModulePrograms(), "ModulePrograms", {files});
+
+	AddModule(time = new ModuleTime(), "ModuleTime");
+	if (!headless) AddModule(input = new ModuleInput(), "ModuleInput", {window});
+	AddModule(camera = new ModuleCamera(), "ModuleCamera");
+
+	AddModule(scene = new ModuleScene(), "ModuleScene", {files, resources, camera});
+	if (!headless) AddModule(editor = new ModuleEditor(), "ModuleEditor", {window});
+	if (!headless) AddModule(debugDraw = new ModuleDebugDraw(), "ModuleDebugDraw");
 
-	for (std::vector<Module*>::iterator it = modules.begin(); it != modules.end() && ret; ++it) {
-		ret = (*it)->Start();
+	AddModule(renderer = new ModuleRender(), "ModuleRender", {window});
+}
+
+Application::~Application() {
+	for (Module* module : modules) {
+		delete module;
 	}
+}
 
-	return ret;
+bool Application::Init() {
+	frameStats.Init(modules);
+
+	return RunStartupStep(&Module::Init, &Module::InitOnWorker, "Init");
+}
+
+bool Application::Start() {
+	return RunStartupStep(&Module::Start, &Module::StartOnWorker, "Start");
 }
 
 UpdateStatus Application::Update() {
-	BROFILER_CATEGORY("App - Update", Profiler::Color::Red)
+	PROFILE_FRAME("App - Update")
+
+	frameStats.BeginFrame(ProfilerNowNs());
 
 	UpdateStatus ret = UpdateStatus::CONTINUE;
 
-	for (std::vector<Module*>::iterator it = modules.begin(); it != modules.end() && ret == UpdateStatus::CONTINUE; ++it) {
-		ret = (*it)->PreUpdate();
+	for (unsigned i = 0; i < modules.size() && ret == UpdateStatus::CONTINUE; ++i) {
+		unsigned long long startNs = ProfilerNowNs();
+		ret = modules[i]->PreUpdate();
+		frameStats.RecordModule(i, ModulePhase::PRE_UPDATE, ProfilerNowNs() - startNs);
 	}
 
-	for (std::vector<Module*>::iterator it = modules.begin(); it != modules.end() && ret == UpdateStatus::CONTINUE; ++it) {
-		ret = (*it)->Update();
+	for (unsigned i = 0; i < modules.size() && ret == UpdateStatus::CONTINUE; ++i) {
+		unsigned long long startNs = ProfilerNowNs();
+		ret = modules[i]->Update();
+		frameStats.RecordModule(i, ModulePhase::UPDATE, ProfilerNowNs() - startNs);
 	}
 
-	for (std::vector<Module*>::iterator it = modules.begin(); it != modules.end() && ret == UpdateStatus::CONTINUE; ++it) {
-		ret = (*it)->PostUpdate();
+	for (unsigned i = 0; i < modules.size() && ret == UpdateStatus::CONTINUE; ++i) {
+		unsigned long long startNs = ProfilerNowNs();
+		ret = modules[i]->PostUpdate();
+		frameStats.RecordModule(i, ModulePhase::POST_UPDATE, ProfilerNowNs() - startNs);
 	}
 
+	// Transient frame data is freed here
+	FrameArena::EndFrame();
+	unsigned long long allocationCount = GetAllocationCount();
+	frameHeapAllocations = allocationCount - lastAllocationCount;
+	lastAllocationCount = allocationCount;
+
+	frameStats.EndFrameWork(ProfilerNowNs());
 	time->WaitForEndOfFrame();
 
 	return ret;
@@ -98,6 +218,129 @@ bool Application::CleanUp() {
 	return ret;
 }
 
+void Application::AddModule(Module* module, const char* name, std::initializer_list<Module*> dependencies) {
+	module->name = name;
+	for (Module* dependency : dependencies) {
+		// Headless applications don't have some of the modules
+		if (dependency == nullptr) continue;
+
+		// Dependencies are added first, so there can't be cycles
+		assert(std::find(modules.begin(), modules.end(), dependency) != modules.end());
+		module->dependencies.push_back(dependency);
+	}
+	modules.push_back(module);
+}
+
+bool Application::RunStartupStep(bool (Module::*step)(), bool (Module::*onWorker)() const, const char* stepName) {
+	ProfileScope scope(stepName, ProfilerColor::SkyBlue);
+
+	unsigned long long startNs = ProfilerNowNs();
+
+	StartupScheduler scheduler;
+	scheduler.tasks.resize(modules.size());
+	unsigned numWorkerTasks = 0;
+	int previousMainTask = -1;
+	for (unsigned i = 0; i < modules.size(); ++i) {
+		StartupTask& task = scheduler.tasks[i];
+		task.module = modules[i];
+		task.onWorker = (modules[i]->*onWorker)();
+		for (Module* dependency : modules[i]->dependencies) {
+			task.dependencies.push_back((unsigned) (std::find(modules.begin(), modules.end(), dependency) - modules.begin()));
+		}
+		if (task.onWorker) {
+			numWorkerTasks += 1;
+		} else {
+			if (previousMainTask != -1) task.dependencies.push_back(previousMainTask);
+			previousMainTask = i;
+		}
+
+		for (unsigned dependency : task.dependencies) {
+			scheduler.tasks[dependency].dependents.push_back(i);
+		}
+		task.numPendingDependencies = (unsigned) task.dependencies.size();
+		if (task.numPendingDependencies > 0) continue;
+
+		if (task.onWorker) {
+			scheduler.readyWorkerTasks.push_back(i);
+		} else {
+			scheduler.readyMainTasks.push_back(i);
+		}
+	}
+
+	// Without workers, the main thread runs every task
+	unsigned numWorkers = std::min(std::max(std::thread::hardware_concurrency(), 1u) - 1, numWorkerTasks);
+	std::vector<std::thread> workers;
+	startupScheduler = &scheduler;
+	for (unsigned i = 0; i < numWorkers; ++i) {
+		workers.emplace_back(RunStartupWorker, &scheduler, step);
+	}
+
+	std::unique_lock<std::mutex> lock(scheduler.mutex);
+	while (true) {
+		// Work requested by the workers goes first, as they may be waiting for it
+		if (!scheduler.mainThreadFunctions.empty()) {
+			std::vector<std::function<void()>> functions;
+			functions.swap(scheduler.mainThreadFunctions);
+			lock.unlock();
+			for (std::function<void()>& function : functions) {
+				function();
+			}
+			lock.lock();
+			continue;
+		}
+
+		if (scheduler.IsDone()) break;
+
+		if (!scheduler.failed && !scheduler.readyMainTasks.empty()) {
+			std::vector<unsigned>::iterator first = std::min_element(scheduler.readyMainTasks.begin(), scheduler.readyMainTasks.end());
+			unsigned index = *first;
+			scheduler.readyMainTasks.erase(first);
+			RunStartupTask(scheduler, index, step, lock);
+			continue;
+		}
+
+		if (numWorkers == 0 && !scheduler.failed && !scheduler.readyWorkerTasks.empty()) {
+			unsigned index = scheduler.readyWorkerTasks.front();
+			scheduler.readyWorkerTasks.pop_front();
+			RunStartupTask(scheduler, index, step, lock);
+			continue;
+		}
+
+		scheduler.condition.wait(lock);
+	}
+	lock.unlock();
+
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+	startupScheduler = nullptr;
+
+	// The last tasks may have requested work right before finishing
+	for (std::function<void()>& function : scheduler.mainThreadFunctions) {
+		function();
+	}
+
+	LogStartupCriticalPath(scheduler, stepName, startNs, ProfilerNowNs());
+
+	return !scheduler.failed;
+}
+
+void Application::RunOnMainThread(const std::function<void()>& task) {
+	if (IsMainThread()) {
+		task();
+		return;
+	}
+
+	assert(startupScheduler != nullptr);
+	std::lock_guard<std::mutex> lock(startupScheduler->mutex);
+	startupScheduler->mainThreadFunctions.push_back(task);
+	startupScheduler->condition.notify_all();
+}
+
+bool Application::IsMainThread() const {
+	return std::this_thread::get_id() == mainThreadId;
+}
+
 void Application::RequestBrowser(char* url) {
 	ShellExecuteA(NULL, "open", url, NULL, NULL, SW_SHOWNORMAL);
 }
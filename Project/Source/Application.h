@@ -1,8 +1,12 @@
 #pragma once
 
 #include "Utils/MSTimer.h"
+#include "Utils/FrameStats.h"
 
 #include <vector>
+#include <functional>
+#include <thread>
+#include <initializer_list>
 
 enum class UpdateStatus;
 
@@ -23,7 +27,7 @@ class ModuleTime;
 
 class Application {
 public:
-	Application();
+	Application(bool headless = false);
 	~Application();
 
 	bool Init();
@@ -33,6 +37,11 @@ public:
 
 	void RequestBrowser(char* url);
 
+	// Runs the task right away on the main thread. From a startup worker, the main thread runs it as soon as it's free.
+	// Used for the GL and SDL video work of the modules that Init or Start on workers.
+	void RunOnMainThread(const std::function<void()>& task);
+	bool IsMainThread() const;
+
 public:
 	ModuleHardwareInfo* hardware = nullptr;
 	ModuleResources* resources = nullptr;
@@ -47,13 +56,33 @@ public:
 	ModuleScene* scene = nullptr;
 	ModuleTime* time = nullptr;
 
+	// Headless applications have no window, input, editor, debug draw or shader programs, and render with the null backend.
+	// Those modules are nullptr.
+	const bool headless = false;
+
 	// Application Configuration
 
 	char appName[20] = "Tesseract";
 	char organization[20] = "";
 
+	// Heap allocations made during the last frame. Only counted in debug builds.
+	unsigned long long frameHeapAllocations = 0;
+
+	// Frame and per-module timing
+	FrameStats frameStats;
+
+private:
+	void AddModule(Module* module, const char* name, std::initializer_list<Module*> dependencies = {});
+
+	// Runs a startup step of every module, respecting their dependencies. Returns false if any module fails.
+	bool RunStartupStep(bool (Module::*step)(), bool (Module::*onWorker)() const, const char* stepName);
+
 private:
 	std::vector<Module*> modules;
+	unsigned long long lastAllocationCount = 0;
+
+	std::thread::id mainThreadId;
+	struct StartupScheduler* startupScheduler = nullptr; // Only set while a startup step runs
 };
 
 extern Application* App;
@@ -0,0 +1,143 @@
+#include "Benchmarks.h"
+
+#include "Globals.h"
+#include "Application.h"
+#include "Utils/Logging.h"
+#include "FileSystem/JsonWriter.h"
+
+#include "rapidjson/document.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "Utils/Leaks.h"
+
+#define BENCHMARK_RESULTS_FILE_PATH "Benchmarks.json"
+#define BENCHMARK_REGRESSION_THRESHOLD 0.15 // 15% slower
+
+#define JSON_TAG_RESULTS "Results"
+#define JSON_TAG_NAME "Name"
+#define JSON_TAG_NS_PER_OP "NsPerOp"
+#define JSON_TAG_TIME_US "TimeUs"
+#define JSON_TAG_OPERATIONS "Operations"
+
+struct BenchmarkResult {
+	std::string name;
+	unsigned long long timeUs = 0;
+	unsigned operations = 0;
+	double nsPerOp = 0.0;
+};
+
+volatile size_t Benchmarks::sink = 0;
+
+static std::vector<BenchmarkResult> results;
+
+static bool SaveResults(const char* filePath) {
+	JsonWriter writer(filePath, true);
+	if (!writer.IsOpen()) return false;
+
+	writer.StartObject();
+	writer.Key(JSON_TAG_RESULTS);
+	writer.StartArray();
+	for (const BenchmarkResult& result : results) {
+		writer.StartObject();
+		writer.Member(JSON_TAG_NAME, result.name.c_str());
+		writer.Member(JSON_TAG_NS_PER_OP, result.nsPerOp);
+		writer.Member(JSON_TAG_TIME_US, result.timeUs);
+		writer.Member(JSON_TAG_OPERATIONS, result.operations);
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.EndObject();
+
+	return writer.Close();
+}
+
+// Returns false if the baseline is invalid or any result is slower than it by more than BENCHMARK_REGRESSION_THRESHOLD
+static bool CompareWithBaseline(const char* filePath) {
+	FILE* file = fopen(filePath, "rb");
+	if (!file) {
+		LOG_CRITICAL(LogCategory::GENERAL, "Can't open benchmark baseline \"%s\".", filePath);
+		return false;
+	}
+	std::string json;
+	char chunk[4096];
+	size_t read = 0;
+	while ((read = fread(chunk, sizeof(char), sizeof(chunk), file)) > 0) {
+		json.append(chunk, read);
+	}
+	fclose(file);
+
+	rapidjson::Document document;
+	document.Parse(json.c_str());
+	if (document.HasParseError() || !document.IsObject() || !document.HasMember(JSON_TAG_RESULTS) || !document[JSON_TAG_RESULTS].IsArray()) {
+		LOG_CRITICAL(LogCategory::GENERAL, "Invalid benchmark baseline \"%s\".", filePath);
+		return false;
+	}
+
+	LOG("Comparing with \"%s\" --------------", filePath);
+	unsigned numRegressions = 0;
+	const rapidjson::Value& jResults = document[JSON_TAG_RESULTS];
+	for (rapidjson::SizeType i = 0; i < jResults.Size(); ++i) {
+		const rapidjson::Value& jBaseline = jResults[i];
+		if (!jBaseline.IsObject() || !jBaseline.HasMember(JSON_TAG_NAME) || !jBaseline[JSON_TAG_NAME].IsString() || !jBaseline.HasMember(JSON_TAG_NS_PER_OP) || !jBaseline[JSON_TAG_NS_PER_OP].IsNumber()) {
+			LOG_CRITICAL(LogCategory::GENERAL, "Invalid entry %u in benchmark baseline \"%s\".", i, filePath);
+			return false;
+		}
+
+		const char* name = jBaseline[JSON_TAG_NAME].GetString();
+		double baselineNsPerOp = jBaseline[JSON_TAG_NS_PER_OP].GetDouble();
+		for (const BenchmarkResult& result : results) {
+			if (result.name != name || baselineNsPerOp <= 0.0) continue;
+
+			double change = result.nsPerOp / baselineNsPerOp - 1.0;
+			if (change > BENCHMARK_REGRESSION_THRESHOLD) {
+				LOG_WARNING(LogCategory::GENERAL, "%-48s %+7.1f%% (regression)", name, change * 100.0);
+				numRegressions += 1;
+			} else {
+				LOG("%-48s %+7.1f%%", name, change * 100.0);
+			}
+			break;
+		}
+	}
+	LOG("%u regressions.", numRegressions);
+
+	return numRegressions == 0;
+}
+
+bool Benchmarks::Run(const char* baselineFilePath) {
+	results.clear();
+
+	LOG("Running benchmarks --------------");
+	PoolBenchmark();
+	HashMapBenchmark();
+	QuadtreeBenchmark();
+
+	// Scene benchmarks run on the engine modules, without a window or GPU
+	App = new Application(true);
+	bool appStarted = App->Init() && App->Start();
+	if (appStarted) {
+		SceneBenchmark();
+		App->CleanUp();
+	} else {
+		LOG_CRITICAL(LogCategory::GENERAL, "Scene benchmarks skipped: the headless application failed to start.");
+	}
+	RELEASE(App);
+	LOG("Benchmarks finished --------------");
+
+	if (!SaveResults(BENCHMARK_RESULTS_FILE_PATH)) return false;
+	if (!appStarted) return false;
+
+	return baselineFilePath != nullptr ? CompareWithBaseline(baselineFilePath) : true;
+}
+
+void Benchmarks::LogResult(const char* name, unsigned long long timeUs, unsigned operations) {
+	BenchmarkResult result;
+	result.name = name;
+	result.timeUs = timeUs;
+	result.operations = operations;
+	result.nsPerOp = timeUs * 1000.0 / operations;
+	results.push_back(result);
+
+	LOG("%-48s %10.2f ns/op", name, result.nsPerOp);
+}
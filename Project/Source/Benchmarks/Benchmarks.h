@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Utils/PerformanceTimer.h"
+
+/* Micro and scene benchmarks for engine internals. Run them with the '--benchmark [baseline]' command line argument.
+*  Results are logged and written to BENCHMARK_RESULTS_FILE_PATH as JSON. If a baseline results file from another build is given,
+*  every result is compared with it and Run fails when something got slower than BENCHMARK_REGRESSION_THRESHOLD.
+*/
+
+namespace Benchmarks {
+	bool Run(const char* baselineFilePath = nullptr);
+
+	// Runs 'function' several times and returns the fastest run in microseconds
+	template<typename F> unsigned long long MeasureBestUs(unsigned runs, const F& function);
+	void LogResult(const char* name, unsigned long long timeUs, unsigned operations);
+
+	// Written by benchmarks so that the measured work isn't optimized away
+	extern volatile size_t sink;
+
+	void PoolBenchmark();
+	void HashMapBenchmark();
+	void QuadtreeBenchmark();
+	void SceneBenchmark(); // Needs a (headless) Application
+} // namespace Benchmarks
+
+template<typename F>
+inline unsigned long long Benchmarks::MeasureBestUs(unsigned runs, const F& function) {
+	unsigned long long bestUs = (unsigned long long) -1;
+	for (unsigned i = 0; i < runs; ++i) {
+		PerformanceTimer timer;
+		timer.Start();
+		function();
+		unsigned long long timeUs = timer.Stop();
+		if (timeUs < bestUs) bestUs = timeUs;
+	}
+	return bestUs;
+}
@@ -0,0 +1,96 @@
+#include "Benchmarks.h"
+
+#include "Utils/FlatHashMap.h"
+#include "Utils/UID.h"
+
+#include <unordered_map>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <stdio.h>
+
+#include "Utils/Leaks.h"
+
+#define HASH_MAP_BENCHMARK_RUNS 10
+
+static void RunHashMapBenchmark(unsigned numKeys) {
+	// Random 64-bit keys, like UIDs. Misses use a different set of keys.
+	std::mt19937_64 random(numKeys);
+	std::vector<UID> keys(numKeys);
+	std::vector<UID> missingKeys(numKeys);
+	for (unsigned i = 0; i < numKeys; ++i) {
+		keys[i] = random();
+		missingKeys[i] = random();
+	}
+
+	char name[64];
+
+	// Insert
+	sprintf_s(name, "FlatHashMap: Insert %u", numKeys);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(HASH_MAP_BENCHMARK_RUNS, [&]() {
+		FlatHashMap<size_t> map;
+		for (unsigned i = 0; i < numKeys; ++i) {
+			map[keys[i]] = i;
+		}
+		Benchmarks::sink = map.Size();
+	}), numKeys);
+
+	sprintf_s(name, "std::unordered_map: Insert %u", numKeys);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(HASH_MAP_BENCHMARK_RUNS, [&]() {
+		std::unordered_map<UID, size_t> map;
+		for (unsigned i = 0; i < numKeys; ++i) {
+			map[keys[i]] = i;
+		}
+		Benchmarks::sink = map.size();
+	}), numKeys);
+
+	// Find. Keys are looked up in a different order than inserted, so that nodes allocated in sequence don't favor std::unordered_map.
+	FlatHashMap<size_t> flatMap;
+	std::unordered_map<UID, size_t> stdMap;
+	for (unsigned i = 0; i < numKeys; ++i) {
+		flatMap[keys[i]] = i;
+		stdMap[keys[i]] = i;
+	}
+	std::shuffle(keys.begin(), keys.end(), random);
+
+	sprintf_s(name, "FlatHashMap: Find hit %u", numKeys);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(HASH_MAP_BENCHMARK_RUNS, [&]() {
+		size_t total = 0;
+		for (unsigned i = 0; i < numKeys; ++i) {
+			total += *flatMap.Find(keys[i]);
+		}
+		Benchmarks::sink = total;
+	}), numKeys);
+
+	sprintf_s(name, "std::unordered_map: Find hit %u", numKeys);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(HASH_MAP_BENCHMARK_RUNS, [&]() {
+		size_t total = 0;
+		for (unsigned i = 0; i < numKeys; ++i) {
+			total += stdMap.find(keys[i])->second;
+		}
+		Benchmarks::sink = total;
+	}), numKeys);
+
+	sprintf_s(name, "FlatHashMap: Find miss %u", numKeys);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(HASH_MAP_BENCHMARK_RUNS, [&]() {
+		size_t total = 0;
+		for (unsigned i = 0; i < numKeys; ++i) {
+			total += flatMap.Find(missingKeys[i]) == nullptr;
+		}
+		Benchmarks::sink = total;
+	}), numKeys);
+
+	sprintf_s(name, "std::unordered_map: Find miss %u", numKeys);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(HASH_MAP_BENCHMARK_RUNS, [&]() {
+		size_t total = 0;
+		for (unsigned i = 0; i < numKeys; ++i) {
+			total += stdMap.find(missingKeys[i]) == stdMap.end();
+		}
+		Benchmarks::sink = total;
+	}), numKeys);
+}
+
+void Benchmarks::HashMapBenchmark() {
+	RunHashMapBenchmark(10000);
+	RunHashMapBenchmark(100000);
+}
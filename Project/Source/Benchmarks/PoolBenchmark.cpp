@@ -0,0 +1,115 @@
+#include "Benchmarks.h"
+
+#include "Globals.h"
+#include "Utils/Pool.h"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "Utils/Leaks.h"
+
+#define POOL_BENCHMARK_OBJECTS 10000
+#define POOL_BENCHMARK_LIVE_OBJECTS 50
+#define POOL_BENCHMARK_RUNS 20
+#define POOL_BENCHMARK_ITERATION_REPEATS 1000
+#define POOL_BENCHMARK_FULL_RUNS 3
+#define POOL_BENCHMARK_FULL_SEED 1234
+
+// Roughly the size of a GameObject
+struct PoolBenchmarkObject {
+	size_t value = 0;
+	char payload[120];
+};
+
+template<typename T>
+static unsigned long long MeasureObtainRelease(Pool<T>& pool, std::vector<T*>& objects) {
+	return Benchmarks::MeasureBestUs(POOL_BENCHMARK_RUNS, [&]() {
+		for (unsigned i = 0; i < POOL_BENCHMARK_OBJECTS; ++i) {
+			objects[i] = pool.Obtain();
+		}
+		// Release in a different order than obtained, like destroying parts of a scene
+		for (unsigned i = 0; i < POOL_BENCHMARK_OBJECTS; i += 2) {
+			pool.Release(objects[i]);
+		}
+		for (unsigned i = 1; i < POOL_BENCHMARK_OBJECTS; i += 2) {
+			pool.Release(objects[i]);
+		}
+	});
+}
+
+// Fills the pool up to its max capacity and releases everything in random order, which hits a different page on every release
+template<typename T>
+static unsigned long long MeasureFullObtainRandomRelease(Pool<T>& pool, unsigned numObjects) {
+	std::vector<T*> objects(numObjects);
+	std::vector<unsigned> releaseOrder(numObjects);
+	for (unsigned i = 0; i < numObjects; ++i) {
+		releaseOrder[i] = i;
+	}
+	std::shuffle(releaseOrder.begin(), releaseOrder.end(), std::mt19937(POOL_BENCHMARK_FULL_SEED));
+
+	return Benchmarks::MeasureBestUs(POOL_BENCHMARK_FULL_RUNS, [&]() {
+		for (unsigned i = 0; i < numObjects; ++i) {
+			objects[i] = pool.Obtain();
+		}
+		for (unsigned i = 0; i < numObjects; ++i) {
+			pool.Release(objects[releaseOrder[i]]);
+		}
+	});
+}
+
+template<typename T>
+static unsigned long long MeasureIteration(Pool<T>& pool) {
+	return Benchmarks::MeasureBestUs(POOL_BENCHMARK_RUNS, [&]() {
+		// Repeated so that a run is long enough to be measured in microseconds
+		size_t total = 0;
+		for (unsigned i = 0; i < POOL_BENCHMARK_ITERATION_REPEATS; ++i) {
+			for (T& object : pool) {
+				total += object.value;
+			}
+		}
+		Benchmarks::sink = total;
+	});
+}
+
+void Benchmarks::PoolBenchmark() {
+	std::vector<PoolBenchmarkObject*> objects(POOL_BENCHMARK_OBJECTS);
+
+	// Obtain/Release
+	Pool<PoolBenchmarkObject> fixedPool;
+	fixedPool.Allocate(POOL_BENCHMARK_OBJECTS);
+	LogResult("Pool fixed: Obtain + Release", MeasureObtainRelease(fixedPool, objects), POOL_BENCHMARK_OBJECTS);
+
+	Pool<PoolBenchmarkObject> pagedPool;
+	pagedPool.AllocatePaged(1024);
+	LogResult("Pool paged (1024): Obtain + Release", MeasureObtainRelease(pagedPool, objects), POOL_BENCHMARK_OBJECTS);
+
+	Pool<PoolBenchmarkObject> decommitPool;
+	decommitPool.AllocatePaged(1024, POOL_BENCHMARK_OBJECTS, true);
+	LogResult("Pool paged (1024, decommit): Obtain + Release", MeasureObtainRelease(decommitPool, objects), POOL_BENCHMARK_OBJECTS);
+
+	unsigned long long newDeleteUs = MeasureBestUs(POOL_BENCHMARK_RUNS, [&]() {
+		for (unsigned i = 0; i < POOL_BENCHMARK_OBJECTS; ++i) {
+			objects[i] = new PoolBenchmarkObject();
+		}
+		for (unsigned i = 0; i < POOL_BENCHMARK_OBJECTS; ++i) {
+			delete objects[i];
+		}
+	});
+	LogResult("new + delete (reference)", newDeleteUs, POOL_BENCHMARK_OBJECTS);
+
+	// Same page size and capacity as the GameObjects, about a thousand pages
+	{
+		Pool<PoolBenchmarkObject> fullPool;
+		fullPool.AllocatePaged(GAMEOBJECTS_PAGE_SIZE, GAMEOBJECTS_MAX_CAPACITY, true);
+		LogResult("Pool paged (max capacity): Obtain + Release random", MeasureFullObtainRandomRelease(fullPool, GAMEOBJECTS_MAX_CAPACITY), GAMEOBJECTS_MAX_CAPACITY);
+	}
+
+	// Iteration over a mostly empty pool
+	for (unsigned i = 0; i < POOL_BENCHMARK_LIVE_OBJECTS; ++i) {
+		fixedPool.Obtain()->value = i;
+		pagedPool.Obtain()->value = i;
+	}
+	LogResult("Pool fixed: Iterate 50 live of 10000", MeasureIteration(fixedPool), POOL_BENCHMARK_LIVE_OBJECTS * POOL_BENCHMARK_ITERATION_REPEATS);
+	LogResult("Pool paged: Iterate 50 live of 10240", MeasureIteration(pagedPool), POOL_BENCHMARK_LIVE_OBJECTS * POOL_BENCHMARK_ITERATION_REPEATS);
+}
@@ -0,0 +1,111 @@
+#include "Benchmarks.h"
+
+#include "Utils/Quadtree.h"
+
+#include <vector>
+#include <random>
+#include <stdio.h>
+
+#include "Utils/Leaks.h"
+
+#define QUADTREE_BENCHMARK_RUNS 10
+#define QUADTREE_BENCHMARK_QUERIES 1000
+#define QUADTREE_BENCHMARK_EXTENT 1000.0f
+#define QUADTREE_BENCHMARK_MAX_DEPTH 6
+#define QUADTREE_BENCHMARK_ELEMENTS_PER_NODE 16
+
+struct QuadtreeBenchmarkObject {
+	AABB2D aabb = {{0, 0}, {0, 0}};
+};
+
+static void BuildQuadtree(Quadtree<QuadtreeBenchmarkObject*>& quadtree, std::vector<QuadtreeBenchmarkObject>& objects) {
+	AABB2D bounds = {{-QUADTREE_BENCHMARK_EXTENT, -QUADTREE_BENCHMARK_EXTENT}, {QUADTREE_BENCHMARK_EXTENT, QUADTREE_BENCHMARK_EXTENT}};
+	quadtree.Initialize(bounds, QUADTREE_BENCHMARK_MAX_DEPTH, QUADTREE_BENCHMARK_ELEMENTS_PER_NODE);
+	for (QuadtreeBenchmarkObject& object : objects) {
+		quadtree.Add(&object, object.aabb);
+	}
+	quadtree.Optimize();
+}
+
+// Same traversal as frustum culling and picking. Objects in several leaves are counted once per leaf.
+static size_t CountIntersecting(const Quadtree<QuadtreeBenchmarkObject*>::Node& node, const AABB2D& nodeAABB, const AABB2D& query) {
+	if (!nodeAABB.Intersects(query)) return 0;
+
+	if (node.IsBranch()) {
+		vec2d center = nodeAABB.minPoint + (nodeAABB.maxPoint - nodeAABB.minPoint) * 0.5f;
+		size_t count = 0;
+		count += CountIntersecting(node.childNodes->nodes[0], {{nodeAABB.minPoint.x, center.y}, {center.x, nodeAABB.maxPoint.y}}, query);
+		count += CountIntersecting(node.childNodes->nodes[1], {{center.x, center.y}, {nodeAABB.maxPoint.x, nodeAABB.maxPoint.y}}, query);
+		count += CountIntersecting(node.childNodes->nodes[2], {{nodeAABB.minPoint.x, nodeAABB.minPoint.y}, {center.x, center.y}}, query);
+		count += CountIntersecting(node.childNodes->nodes[3], {{center.x, nodeAABB.minPoint.y}, {nodeAABB.maxPoint.x, center.y}}, query);
+		return count;
+	}
+
+	size_t count = 0;
+	for (const Quadtree<QuadtreeBenchmarkObject*>::Element* element = node.firstElement; element != nullptr; element = element->next) {
+		if (element->aabb.Intersects(query)) count += 1;
+	}
+	return count;
+}
+
+static void RunQuadtreeBenchmark(unsigned numObjects) {
+	// Small random boxes inside the bounds
+	std::mt19937 random(numObjects);
+	std::uniform_real_distribution<float> position(-QUADTREE_BENCHMARK_EXTENT * 0.95f, QUADTREE_BENCHMARK_EXTENT * 0.95f);
+	std::uniform_real_distribution<float> size(1.0f, 20.0f);
+	std::vector<QuadtreeBenchmarkObject> objects(numObjects);
+	for (QuadtreeBenchmarkObject& object : objects) {
+		vec2d minPoint = {position(random), position(random)};
+		object.aabb = {minPoint, {minPoint.x + size(random), minPoint.y + size(random)}};
+	}
+
+	// Queries the size of a view of a tenth of the world
+	std::vector<AABB2D> queries(QUADTREE_BENCHMARK_QUERIES);
+	for (AABB2D& query : queries) {
+		vec2d minPoint = {position(random), position(random)};
+		query = {minPoint, {minPoint.x + QUADTREE_BENCHMARK_EXTENT * 0.2f, minPoint.y + QUADTREE_BENCHMARK_EXTENT * 0.2f}};
+	}
+
+	char name[64];
+	Quadtree<QuadtreeBenchmarkObject*> quadtree;
+
+	// Build
+	sprintf_s(name, "Quadtree: Build %u", numObjects);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(QUADTREE_BENCHMARK_RUNS, [&]() {
+		BuildQuadtree(quadtree, objects);
+	}), numObjects);
+
+	// Query
+	sprintf_s(name, "Quadtree: Query (%u objects)", numObjects);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(QUADTREE_BENCHMARK_RUNS, [&]() {
+		size_t total = 0;
+		for (const AABB2D& query : queries) {
+			total += CountIntersecting(quadtree.root, quadtree.bounds, query);
+		}
+		Benchmarks::sink = total;
+	}), QUADTREE_BENCHMARK_QUERIES);
+
+	// Remove. The tree has to be rebuilt before every run, so runs are timed one by one.
+	unsigned long long bestRemoveUs = (unsigned long long) -1;
+	for (unsigned run = 0; run < QUADTREE_BENCHMARK_RUNS; ++run) {
+		BuildQuadtree(quadtree, objects);
+
+		PerformanceTimer timer;
+		timer.Start();
+		for (QuadtreeBenchmarkObject& object : objects) {
+			quadtree.Remove(&object);
+		}
+		unsigned long long timeUs = timer.Stop();
+		if (timeUs < bestRemoveUs) bestRemoveUs = timeUs;
+	}
+	Benchmarks::sink = quadtree.elements.Count();
+	sprintf_s(name, "Quadtree: Remove %u", numObjects);
+	Benchmarks::LogResult(name, bestRemoveUs, numObjects);
+
+	quadtree.Clear();
+}
+
+void Benchmarks::QuadtreeBenchmark() {
+	RunQuadtreeBenchmark(1000);
+	RunQuadtreeBenchmark(10000);
+}
@@ -0,0 +1,167 @@
+#include "Benchmarks.h"
+
+#include "Globals.h"
+#include "Application.h"
+#include "Utils/Logging.h"
+#include "Benchmarks/SceneGenerator.h"
+#include "Resources/GameObject.h"
+#include "Components/ComponentTransform.h"
+#include "Components/ComponentMesh.h"
+#include "Components/ComponentLight.h"
+#include "FileSystem/SceneImporter.h"
+#include "Modules/ModuleScene.h"
+#include "Modules/ModuleCamera.h"
+#include "Modules/ModuleRender.h"
+
+#include "Math/float2.h"
+#include <vector>
+#include <random>
+#include <stdio.h>
+
+#include "Utils/Leaks.h"
+
+#define SCENE_BENCHMARK_RUNS 10
+#define SCENE_BENCHMARK_FILE_RUNS 3
+#define SCENE_BENCHMARK_PICKS 100
+#define SCENE_BENCHMARK_FILE_NAME "Benchmark"
+
+static SceneGeneratorParams MakeSceneParams(const char* name, unsigned numGameObjects, unsigned maxDepth, SpatialDistribution distribution, float meshReuseRatio) {
+	SceneGeneratorParams params;
+	params.name = name;
+	params.numGameObjects = numGameObjects;
+	params.maxDepth = maxDepth;
+	params.distribution = distribution;
+	params.meshReuseRatio = meshReuseRatio;
+	return params;
+}
+
+static void RunSceneBenchmark(const SceneGeneratorParams& params) {
+	char name[96];
+	unsigned numGameObjects = params.numGameObjects;
+
+	// Generate
+	PerformanceTimer generateTimer;
+	generateTimer.Start();
+	SceneGenerator::GenerateScene(params);
+	sprintf_s(name, "%s: Generate", params.name);
+	Benchmarks::LogResult(name, generateTimer.Stop(), numGameObjects);
+
+	std::vector<ComponentTransform*> transforms;
+	std::vector<ComponentMesh*> meshes;
+	for (GameObject& gameObject : App->scene->gameObjects) {
+		transforms.push_back(gameObject.GetComponent<ComponentTransform>());
+		ComponentMesh* mesh = gameObject.GetComponent<ComponentMesh>();
+		if (mesh != nullptr) meshes.push_back(mesh);
+	}
+
+	// Transform propagation: everything dirty, then every global matrix recalculated
+	sprintf_s(name, "%s: Transform propagation", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_RUNS, [&]() {
+		for (ComponentTransform* transform : transforms) {
+			transform->Invalidate();
+		}
+		for (ComponentTransform* transform : transforms) {
+			transform->CalculateGlobalMatrix();
+		}
+	}), (unsigned) transforms.size());
+
+	// Quadtree build, with the world bounding boxes already calculated
+	sprintf_s(name, "%s: Quadtree build", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_RUNS, [&]() {
+		App->scene->RebuildQuadtree();
+	}), numGameObjects);
+
+	// Frustum culling and render queue building, from a camera looking at the scene from one side
+	App->camera->SetPosition(vec(0.0f, params.extent * 0.2f, -params.extent));
+	App->camera->LookAt(0.0f, 0.0f, 0.0f);
+	sprintf_s(name, "%s: Culling + render queue", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_RUNS, [&]() {
+		App->renderer->drawPackets.clear();
+		App->renderer->Update();
+	}), numGameObjects);
+	Benchmarks::sink = App->renderer->drawPackets.size();
+
+	// Occlusion culling, from street level looking down the street between the two central columns of blocks
+	if (params.distribution == SpatialDistribution::CITY) {
+		bool occlusionCulling = App->renderer->occlusionCulling;
+		App->camera->SetPosition(vec(0.0f, 2.0f, -params.extent));
+		App->camera->LookAt(0.0f, 2.0f, params.extent);
+
+		size_t numDrawPackets[2] = {0, 0};
+		for (unsigned i = 0; i < 2; ++i) {
+			App->renderer->occlusionCulling = i == 1;
+			sprintf_s(name, "%s: Culling + render queue, street level%s", params.name, i == 1 ? ", occlusion" : "");
+			Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_RUNS, [&]() {
+				App->renderer->drawPackets.clear();
+				App->renderer->Update();
+			}), numGameObjects);
+			numDrawPackets[i] = App->renderer->drawPackets.size();
+		}
+		LOG("%s: %u draw packets without occlusion culling, %u with %u occluders.", params.name, (unsigned) numDrawPackets[0], (unsigned) numDrawPackets[1], App->renderer->numOccluders);
+
+		App->renderer->occlusionCulling = occlusionCulling;
+		App->camera->SetPosition(vec(0.0f, params.extent * 0.2f, -params.extent));
+		App->camera->LookAt(0.0f, 0.0f, 0.0f);
+	}
+
+	// Light selection for every mesh
+	sprintf_s(name, "%s: Light selection", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_RUNS, [&]() {
+		size_t total = 0;
+		for (ComponentMesh* mesh : meshes) {
+			ArenaScope arenaScope;
+			ComponentLight* directionalLight = nullptr;
+			FrameVector<ComponentLight*> pointLights;
+			FrameVector<ComponentLight*> spotLights;
+			mesh->GatherLights(directionalLight, pointLights, spotLights);
+			total += pointLights.size() + spotLights.size();
+		}
+		Benchmarks::sink = total;
+	}), (unsigned) meshes.size());
+
+	// Picking at random points of the screen
+	std::mt19937 random(params.seed);
+	std::uniform_real_distribution<float> screen(-1.0f, 1.0f);
+	std::vector<float2> pickPositions(SCENE_BENCHMARK_PICKS);
+	for (float2& pickPosition : pickPositions) {
+		pickPosition = float2(screen(random), screen(random));
+	}
+	sprintf_s(name, "%s: Picking", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_FILE_RUNS, [&]() {
+		size_t total = 0;
+		for (const float2& pickPosition : pickPositions) {
+			total += App->camera->PickGameObject(pickPosition) != nullptr ? 1 : 0;
+		}
+		Benchmarks::sink = total;
+	}), SCENE_BENCHMARK_PICKS);
+
+	// Save and load. Loading replaces the scene, so it goes last.
+	sprintf_s(name, "%s: Save JSON", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_FILE_RUNS, [&]() {
+		SceneImporter::SaveScene(SCENE_BENCHMARK_FILE_NAME, SceneFormat::JSON);
+	}), numGameObjects);
+
+	sprintf_s(name, "%s: Load JSON", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_FILE_RUNS, [&]() {
+		SceneImporter::LoadScene(SCENE_BENCHMARK_FILE_NAME);
+	}), numGameObjects);
+
+	sprintf_s(name, "%s: Save binary", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_FILE_RUNS, [&]() {
+		SceneImporter::SaveScene(SCENE_BENCHMARK_FILE_NAME, SceneFormat::BINARY);
+	}), numGameObjects);
+
+	sprintf_s(name, "%s: Load binary", params.name);
+	Benchmarks::LogResult(name, Benchmarks::MeasureBestUs(SCENE_BENCHMARK_FILE_RUNS, [&]() {
+		SceneImporter::LoadScene(SCENE_BENCHMARK_FILE_NAME);
+	}), numGameObjects);
+}
+
+void Benchmarks::SceneBenchmark() {
+	RunSceneBenchmark(MakeSceneParams("Scene uniform 1k", 1000, 4, SpatialDistribution::UNIFORM, 0.9f));
+	RunSceneBenchmark(MakeSceneParams("Scene clustered 10k", 10000, 8, SpatialDistribution::CLUSTERED, 0.99f));
+	RunSceneBenchmark(MakeSceneParams("Scene grid 10k flat", 10000, 1, SpatialDistribution::GRID, 0.999f));
+	RunSceneBenchmark(MakeSceneParams("Scene city 10k", 10000, 1, SpatialDistribution::CITY, 0.99f));
+
+	App->scene->CreateEmptyScene();
+}
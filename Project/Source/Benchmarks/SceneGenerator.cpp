@@ -0,0 +1,222 @@
+#include "SceneGenerator.h"
+
+#include "Globals.h"
+#include "Application.h"
+#include "Utils/Buffer.h"
+#include "Utils/Hash.h"
+#include "Resources/GameObject.h"
+#include "Resources/Mesh.h"
+#include "Components/ComponentTransform.h"
+#include "Components/ComponentMesh.h"
+#include "Components/ComponentMaterial.h"
+#include "Components/ComponentBoundingBox.h"
+#include "Components/ComponentLight.h"
+#include "FileSystem/MeshImporter.h"
+#include "Modules/ModuleScene.h"
+#include "Modules/ModuleResources.h"
+#include "Modules/ModuleFiles.h"
+
+#include "Math/float3.h"
+#include "Math/float4x4.h"
+#include "Math/Quat.h"
+#include "Geometry/AABB.h"
+#include <random>
+#include <vector>
+#include <string>
+
+#include "Utils/Leaks.h"
+
+#define SCENE_GENERATOR_NUM_CLUSTERS 16
+#define SCENE_GENERATOR_MESH_SEED 0x5C3 // Keeps generated mesh names apart from imported ones
+
+// Box with 4 vertices per face, so that every face has its own normal. Same file format as imported meshes.
+static Mesh* GenerateBoxMesh(const float3& halfSize) {
+	const unsigned numVertices = 24;
+	const unsigned numIndices = 36;
+	const unsigned vertexSize = sizeof(float) * 8;
+
+	Buffer<char> buffer = Buffer<char>(sizeof(unsigned) * 2 + vertexSize * numVertices + sizeof(unsigned) * numIndices);
+	unsigned* header = (unsigned*) buffer.Data();
+	header[0] = numVertices;
+	header[1] = numIndices;
+	float* vertices = (float*) (header + 2);
+	unsigned* indices = (unsigned*) (vertices + numVertices * 8);
+
+	const float corners[4][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+	unsigned face = 0;
+	for (unsigned axis = 0; axis < 3; ++axis) {
+		unsigned uAxis = (axis + 1) % 3;
+		unsigned vAxis = (axis + 2) % 3;
+		for (float sign = -1; sign <= 1; sign += 2) {
+			for (unsigned corner = 0; corner < 4; ++corner) {
+				float* vertex = vertices + (face * 4 + corner) * 8;
+				vertex[axis] = sign * halfSize[axis];
+				vertex[uAxis] = corners[corner][0] * halfSize[uAxis];
+				vertex[vAxis] = corners[corner][1] * halfSize[vAxis];
+				vertex[3 + axis] = sign;
+				vertex[3 + uAxis] = 0;
+				vertex[3 + vAxis] = 0;
+				vertex[6] = corners[corner][0] * 0.5f + 0.5f;
+				vertex[7] = corners[corner][1] * 0.5f + 0.5f;
+			}
+
+			// Counter-clockwise when seen from outside
+			unsigned base = face * 4;
+			unsigned* faceIndices = indices + face * 6;
+			if (sign > 0) {
+				faceIndices[0] = base;
+				faceIndices[1] = base + 1;
+				faceIndices[2] = base + 2;
+				faceIndices[3] = base;
+				faceIndices[4] = base + 2;
+				faceIndices[5] = base + 3;
+			} else {
+				faceIndices[0] = base;
+				faceIndices[1] = base + 2;
+				faceIndices[2] = base + 1;
+				faceIndices[3] = base;
+				faceIndices[4] = base + 3;
+				faceIndices[5] = base + 2;
+			}
+			face += 1;
+		}
+	}
+
+	// Named after the contents, like imported meshes
+	std::string fileName = HashToString(HashBuffer(buffer.Data(), buffer.Size(), SCENE_GENERATOR_MESH_SEED));
+	std::string filePath = std::string(MESHES_PATH) + "/" + fileName + MESH_EXTENSION;
+	if (!App->files->Exists(filePath.c_str())) {
+		App->files->Save(filePath.c_str(), buffer);
+	}
+
+	Mesh* mesh = App->resources->ObtainMeshWithFileName(fileName);
+	mesh->numVertices = numVertices;
+	mesh->numIndices = numIndices;
+	MeshImporter::LoadMesh(mesh);
+
+	return mesh;
+}
+
+static GameObject* CreateLight(GameObject* parent, LightType lightType, const float3& position, const Quat& rotation) {
+	GameObject* gameObject = App->scene->CreateGameObject(parent);
+	gameObject->name = lightType == LightType::POINT ? "Point Light" : "Spot Light";
+	ComponentTransform* transform = gameObject->CreateComponent<ComponentTransform>();
+	transform->SetPosition(position);
+	transform->SetRotation(rotation);
+	transform->SetScale(float3::one);
+	ComponentLight* light = gameObject->CreateComponent<ComponentLight>();
+	light->lightType = lightType;
+	gameObject->InitComponents();
+	return gameObject;
+}
+
+void SceneGenerator::GenerateScene(const SceneGeneratorParams& params) {
+	ModuleScene* scene = App->scene;
+	scene->CreateEmptyScene();
+
+	std::mt19937 random(params.seed);
+	std::uniform_real_distribution<float> position(-params.extent, params.extent);
+	std::uniform_real_distribution<float> height(0.0f, 10.0f);
+	std::uniform_real_distribution<float> angle(0.0f, 2.0f * pi);
+	std::uniform_real_distribution<float> boxHalfSize(0.5f, 5.0f);
+	std::normal_distribution<float> clusterOffset(0.0f, params.extent * 0.05f);
+
+	// Grid cells, also used for the city blocks
+	unsigned gridSide = 1;
+	while (gridSide * gridSide < params.numGameObjects) gridSide += 1;
+	float gridSpacing = 2.0f * params.extent / gridSide;
+	std::uniform_real_distribution<float> buildingFootprint(gridSpacing * 0.25f, gridSpacing * 0.4f);
+	std::uniform_real_distribution<float> buildingHeight(gridSpacing * 0.5f, gridSpacing * 2.0f);
+
+	// Meshes
+	unsigned numMeshes = (unsigned) (params.numGameObjects * (1.0f - params.meshReuseRatio) + 0.5f);
+	if (numMeshes == 0) numMeshes = 1;
+	std::vector<Mesh*> meshes;
+	std::vector<float3> meshHalfSizes;
+	meshes.reserve(numMeshes);
+	meshHalfSizes.reserve(numMeshes);
+	for (unsigned i = 0; i < numMeshes; ++i) {
+		float3 halfSize(boxHalfSize(random), boxHalfSize(random), boxHalfSize(random));
+		if (params.distribution == SpatialDistribution::CITY) halfSize = float3(buildingFootprint(random), buildingHeight(random), buildingFootprint(random));
+		meshes.push_back(GenerateBoxMesh(halfSize));
+		meshHalfSizes.push_back(halfSize);
+	}
+
+	// Placement
+	std::vector<float3> clusters;
+	for (unsigned i = 0; i < SCENE_GENERATOR_NUM_CLUSTERS; ++i) {
+		clusters.push_back(float3(position(random), 0.0f, position(random)));
+	}
+	// GameObjects. Parents are picked at random among the previous GameObjects that aren't at the max depth yet.
+	std::vector<GameObject*> gameObjects;
+	std::vector<unsigned> depths;
+	gameObjects.reserve(params.numGameObjects);
+	depths.reserve(params.numGameObjects);
+	for (unsigned i = 0; i < params.numGameObjects; ++i) {
+		GameObject* parent = scene->root;
+		unsigned depth = 1;
+		// Buildings are children of the root, so that they stay aligned with the streets
+		if (!gameObjects.empty() && params.distribution != SpatialDistribution::CITY) {
+			unsigned candidate = random() % gameObjects.size();
+			if (depths[candidate] < params.maxDepth) {
+				parent = gameObjects[candidate];
+				depth = depths[candidate] + 1;
+			}
+		}
+
+		float3 worldPosition;
+		switch (params.distribution) {
+		case SpatialDistribution::UNIFORM:
+			worldPosition = float3(position(random), height(random), position(random));
+			break;
+		case SpatialDistribution::CLUSTERED: {
+			const float3& cluster = clusters[random() % clusters.size()];
+			worldPosition = float3(Clamp(cluster.x + clusterOffset(random), -params.extent, params.extent), height(random), Clamp(cluster.z + clusterOffset(random), -params.extent, params.extent));
+			break;
+		}
+		case SpatialDistribution::GRID:
+		case SpatialDistribution::CITY:
+			worldPosition = float3(-params.extent + (i % gridSide + 0.5f) * gridSpacing, 0.0f, -params.extent + (i / gridSide + 0.5f) * gridSpacing);
+			break;
+		}
+
+		GameObject* gameObject = scene->CreateGameObject(parent);
+		gameObject->name = "Generated";
+
+		// Positions are chosen in world space and converted to the space of the parent
+		const float4x4& parentMatrix = parent->GetComponent<ComponentTransform>()->GetGlobalMatrix();
+		ComponentTransform* transform = gameObject->CreateComponent<ComponentTransform>();
+		transform->SetPosition(parentMatrix.Inverted().TransformPos(worldPosition));
+		transform->SetRotation(Quat::RotateY(angle(random)));
+		transform->SetScale(float3::one);
+
+		unsigned meshIndex = i < numMeshes ? i : random() % numMeshes;
+		if (params.distribution == SpatialDistribution::CITY) {
+			// Standing on the ground
+			transform->SetPosition(worldPosition + float3(0.0f, meshHalfSizes[meshIndex].y, 0.0f));
+			transform->SetRotation(Quat::identity);
+		}
+		ComponentMesh* mesh = gameObject->CreateComponent<ComponentMesh>();
+		mesh->mesh = App->resources->meshes.GetHandle(meshes[meshIndex]);
+		gameObject->CreateComponent<ComponentMaterial>();
+		ComponentBoundingBox* boundingBox = gameObject->CreateComponent<ComponentBoundingBox>();
+		boundingBox->SetLocalBoundingBox(AABB(-meshHalfSizes[meshIndex], meshHalfSizes[meshIndex]));
+		gameObject->InitComponents();
+
+		gameObjects.push_back(gameObject);
+		depths.push_back(depth);
+	}
+
+	// Lights
+	for (unsigned i = 0; i < params.numPointLights; ++i) {
+		CreateLight(scene->root, LightType::POINT, float3(position(random), 5.0f + height(random), position(random)), Quat::identity);
+	}
+	for (unsigned i = 0; i < params.numSpotLights; ++i) {
+		CreateLight(scene->root, LightType::SPOT, float3(position(random), 20.0f + height(random), position(random)), Quat::RotateX(pi / 2));
+	}
+
+	// Quadtree that fits the generated objects
+	float quadtreeExtent = params.extent + 10.0f;
+	scene->quadtreeBounds = {{-quadtreeExtent, -quadtreeExtent}, {quadtreeExtent, quadtreeExtent}};
+	scene->RebuildQuadtree();
+}
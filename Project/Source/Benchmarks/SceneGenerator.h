@@ -0,0 +1,28 @@
+#pragma once
+
+enum class SpatialDistribution {
+	UNIFORM, // Spread over the whole extent
+	CLUSTERED, // Grouped around a few random points, like props in rooms
+	GRID, // Regular grid, like tiles or instanced vegetation
+	CITY // Blocks of tall buildings separated by streets, for occlusion culling
+};
+
+struct SceneGeneratorParams {
+	const char* name = "Generated"; // Used in benchmark names
+	unsigned numGameObjects = 1000;
+	unsigned maxDepth = 4; // Max hierarchy depth under the scene root
+	SpatialDistribution distribution = SpatialDistribution::UNIFORM;
+	float extent = 500.0f; // Objects are placed in [-extent, extent] in X and Z
+	unsigned numPointLights = 8;
+	unsigned numSpotLights = 4;
+	float meshReuseRatio = 0.9f; // Fraction of the GameObjects that share a mesh with another one
+	unsigned seed = 1;
+};
+
+/* Generates scenes of box meshes with repeatable parameters, for benchmarks.
+*  The generated meshes are saved to the meshes library like imported ones, so picking and scene loading work with them.
+*/
+
+namespace SceneGenerator {
+	void GenerateScene(const SceneGeneratorParams& params); // Replaces the current scene
+} // namespace SceneGenerator
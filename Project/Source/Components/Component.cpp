@@ -1,6 +1,7 @@
 #include "Component.h"
 
-#include "FileSystem/JsonValue.h"
+#include "FileSystem/JsonWriter.h"
+#include "FileSystem/ConstJsonValue.h"
 
 #include "Utils/Leaks.h"
 
@@ -13,15 +14,21 @@ void Component::Init() {}
 
 void Component::Update() {}
 
+void Component::FixedUpdate() {}
+
 void Component::DrawGizmos() {}
 
 void Component::OnTransformUpdate() {}
 
 void Component::OnEditorUpdate() {}
 
-void Component::Save(JsonValue jComponent) const {}
+void Component::Save(JsonWriter& writer) const {}
+
+void Component::Load(ConstJsonValue jComponent) {}
+
+void Component::Save(BinaryWriter& writer) const {}
 
-void Component::Load(JsonValue jComponent) {}
+void Component::Load(BinaryReader& reader) {}
 
 void Component::Enable() {
 	active = true;
@@ -2,7 +2,10 @@
 
 #include "ComponentType.h"
 
-class JsonValue;
+class JsonWriter;
+class ConstJsonValue;
+class BinaryWriter;
+class BinaryReader;
 class GameObject;
 
 class Component {
@@ -11,11 +14,14 @@ public:
 
 	virtual void Init();
 	virtual void Update();
+	virtual void FixedUpdate(); // Called every fixed step of game time. Use ModuleTime::GetFixedDeltaTime().
 	virtual void DrawGizmos();
 	virtual void OnTransformUpdate();
 	virtual void OnEditorUpdate();
-	virtual void Save(JsonValue jComponent) const;
-	virtual void Load(JsonValue jComponent);
+	virtual void Save(JsonWriter& writer) const;
+	virtual void Load(ConstJsonValue jComponent);
+	virtual void Save(BinaryWriter& writer) const;
+	virtual void Load(BinaryReader& reader);
 
 	void Enable();
 	void Disable();
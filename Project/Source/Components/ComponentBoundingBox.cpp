@@ -1,6 +1,8 @@
 #include "ComponentBoundingBox.h"
 
 #include "Utils/Logging.h"
+#include "FileSystem/BinaryWriter.h"
+#include "FileSystem/BinaryReader.h"
 #include "Resources/GameObject.h"
 #include "Components/ComponentTransform.h"
 
@@ -15,24 +17,38 @@ void ComponentBoundingBox::OnTransformUpdate() {
 	CalculateWorldBoundingBox(true);
 }
 
-void ComponentBoundingBox::Save(JsonValue jComponent) const {
-	JsonValue jLocalBoundingBox = jComponent[JSON_TAG_LOCAL_BOUNDING_BOX];
-	jLocalBoundingBox[0] = localAABB.minPoint.x;
-	jLocalBoundingBox[1] = localAABB.minPoint.y;
-	jLocalBoundingBox[2] = localAABB.minPoint.z;
-	jLocalBoundingBox[3] = localAABB.maxPoint.x;
-	jLocalBoundingBox[4] = localAABB.maxPoint.y;
-	jLocalBoundingBox[5] = localAABB.maxPoint.z;
+void ComponentBoundingBox::Save(JsonWriter& writer) const {
+	writer.Key(JSON_TAG_LOCAL_BOUNDING_BOX);
+	writer.StartArray();
+	writer.Write(localAABB.minPoint.x);
+	writer.Write(localAABB.minPoint.y);
+	writer.Write(localAABB.minPoint.z);
+	writer.Write(localAABB.maxPoint.x);
+	writer.Write(localAABB.maxPoint.y);
+	writer.Write(localAABB.maxPoint.z);
+	writer.EndArray();
 }
 
-void ComponentBoundingBox::Load(JsonValue jComponent) {
-	JsonValue jLocalBoundingBox = jComponent[JSON_TAG_LOCAL_BOUNDING_BOX];
+void ComponentBoundingBox::Load(ConstJsonValue jComponent) {
+	ConstJsonValue jLocalBoundingBox = jComponent[JSON_TAG_LOCAL_BOUNDING_BOX];
 	localAABB.minPoint.Set(jLocalBoundingBox[0], jLocalBoundingBox[1], jLocalBoundingBox[2]);
 	localAABB.maxPoint.Set(jLocalBoundingBox[3], jLocalBoundingBox[4], jLocalBoundingBox[5]);
 
 	dirty = true;
 }
 
+void ComponentBoundingBox::Save(BinaryWriter& writer) const {
+	writer.Write(localAABB.minPoint);
+	writer.Write(localAABB.maxPoint);
+}
+
+void ComponentBoundingBox::Load(BinaryReader& reader) {
+	localAABB.minPoint = reader.Read<vec>();
+	localAABB.maxPoint = reader.Read<vec>();
+
+	dirty = true;
+}
+
 void ComponentBoundingBox::SetLocalBoundingBox(const AABB& boundingBox) {
 	localAABB = boundingBox;
 	dirty = true;
@@ -10,8 +10,10 @@ public:
 	REGISTER_COMPONENT(ComponentBoundingBox, ComponentType::BOUNDING_BOX);
 
 	void OnTransformUpdate() override;
-	void Save(JsonValue jComponent) const override;
-	void Load(JsonValue jComponent) override;
+	void Save(JsonWriter& writer) const override;
+	void Load(ConstJsonValue jComponent) override;
+	void Save(BinaryWriter& writer) const override;
+	void Load(BinaryReader& reader) override;
 
 	void SetLocalBoundingBox(const AABB& boundingBox);
 	void CalculateWorldBoundingBox(bool force = false);
@@ -2,6 +2,8 @@
 
 #include "Globals.h"
 #include "Application.h"
+#include "FileSystem/BinaryWriter.h"
+#include "FileSystem/BinaryReader.h"
 #include "Resources/GameObject.h"
 #include "Components/ComponentTransform.h"
 #include "Modules/ModuleEditor.h"
@@ -70,33 +72,41 @@ void ComponentCamera::OnEditorUpdate() {
 	}
 }
 
-void ComponentCamera::Save(JsonValue jComponent) const {
-	JsonValue jFrustum = jComponent[JSON_TAG_FRUSTRUM];
-	JsonValue jPos = jFrustum[JSON_TAG_POS];
-	jPos[0] = frustum.Pos().x;
-	jPos[1] = frustum.Pos().y;
-	jPos[2] = frustum.Pos().z;
-	JsonValue jUp = jFrustum[JSON_TAG_UP];
-	jUp[0] = frustum.Up().x;
-	jUp[1] = frustum.Up().y;
-	jUp[2] = frustum.Up().z;
-	JsonValue jFront = jFrustum[JSON_TAG_FRONT];
-	jFront[0] = frustum.Front().x;
-	jFront[1] = frustum.Front().y;
-	jFront[2] = frustum.Front().z;
-	jFrustum[JSON_TAG_NEAR_PLANE_DISTANCE] = frustum.NearPlaneDistance();
-	jFrustum[JSON_TAG_FAR_PLANE_DISTANCE] = frustum.FarPlaneDistance();
-	jFrustum[JSON_TAG_HORIZONTAL_FOV] = frustum.HorizontalFov();
-	jFrustum[JSON_TAG_VERTICAL_FOV] = frustum.VerticalFov();
-
-	jComponent[JSON_TAG_CAMERA_SELECTED] = activeCamera;
+void ComponentCamera::Save(JsonWriter& writer) const {
+	writer.Key(JSON_TAG_FRUSTRUM);
+	writer.StartObject();
+	writer.Key(JSON_TAG_POS);
+	writer.StartArray();
+	writer.Write(frustum.Pos().x);
+	writer.Write(frustum.Pos().y);
+	writer.Write(frustum.Pos().z);
+	writer.EndArray();
+	writer.Key(JSON_TAG_UP);
+	writer.StartArray();
+	writer.Write(frustum.Up().x);
+	writer.Write(frustum.Up().y);
+	writer.Write(frustum.Up().z);
+	writer.EndArray();
+	writer.Key(JSON_TAG_FRONT);
+	writer.StartArray();
+	writer.Write(frustum.Front().x);
+	writer.Write(frustum.Front().y);
+	writer.Write(frustum.Front().z);
+	writer.EndArray();
+	writer.Member(JSON_TAG_NEAR_PLANE_DISTANCE, frustum.NearPlaneDistance());
+	writer.Member(JSON_TAG_FAR_PLANE_DISTANCE, frustum.FarPlaneDistance());
+	writer.Member(JSON_TAG_HORIZONTAL_FOV, frustum.HorizontalFov());
+	writer.Member(JSON_TAG_VERTICAL_FOV, frustum.VerticalFov());
+	writer.EndObject();
+
+	writer.Member(JSON_TAG_CAMERA_SELECTED, activeCamera);
 }
 
-void ComponentCamera::Load(JsonValue jComponent) {
-	JsonValue jFrustum = jComponent[JSON_TAG_FRUSTRUM];
-	JsonValue jPos = jFrustum[JSON_TAG_POS];
-	JsonValue jUp = jFrustum[JSON_TAG_UP];
-	JsonValue jFront = jFrustum[JSON_TAG_FRONT];
+void ComponentCamera::Load(ConstJsonValue jComponent) {
+	ConstJsonValue jFrustum = jComponent[JSON_TAG_FRUSTRUM];
+	ConstJsonValue jPos = jFrustum[JSON_TAG_POS];
+	ConstJsonValue jUp = jFrustum[JSON_TAG_UP];
+	ConstJsonValue jFront = jFrustum[JSON_TAG_FRONT];
 	frustum.SetFrame(vec(jPos[0], jPos[1], jPos[2]), vec(jFront[0], jFront[1], jFront[2]), vec(jUp[0], jUp[1], jUp[2]));
 	frustum.SetViewPlaneDistances(jFrustum[JSON_TAG_NEAR_PLANE_DISTANCE], jFrustum[JSON_TAG_FAR_PLANE_DISTANCE]);
 	frustum.SetPerspective(jFrustum[JSON_TAG_HORIZONTAL_FOV], jFrustum[JSON_TAG_VERTICAL_FOV]);
@@ -104,6 +114,33 @@ void ComponentCamera::Load(JsonValue jComponent) {
 	activeCamera = jComponent[JSON_TAG_CAMERA_SELECTED];
 }
 
+void ComponentCamera::Save(BinaryWriter& writer) const {
+	writer.Write(frustum.Pos());
+	writer.Write(frustum.Up());
+	writer.Write(frustum.Front());
+	writer.Write(frustum.NearPlaneDistance());
+	writer.Write(frustum.FarPlaneDistance());
+	writer.Write(frustum.HorizontalFov());
+	writer.Write(frustum.VerticalFov());
+
+	writer.Write(activeCamera);
+}
+
+void ComponentCamera::Load(BinaryReader& reader) {
+	vec pos = reader.Read<vec>();
+	vec up = reader.Read<vec>();
+	vec front = reader.Read<vec>();
+	frustum.SetFrame(pos, front, up);
+	float nearPlaneDistance = reader.Read<float>();
+	float farPlaneDistance = reader.Read<float>();
+	frustum.SetViewPlaneDistances(nearPlaneDistance, farPlaneDistance);
+	float horizontalFov = reader.Read<float>();
+	float verticalFov = reader.Read<float>();
+	frustum.SetPerspective(horizontalFov, verticalFov);
+
+	activeCamera = reader.Read<bool>();
+}
+
 Frustum ComponentCamera::BuildDefaultFrustum() const {
 	Frustum newFrustum;
 	newFrustum.SetKind(FrustumSpaceGL, FrustumRightHanded);
@@ -11,8 +11,10 @@ public:
 	void DrawGizmos() override;
 	void OnTransformUpdate() override;
 	void OnEditorUpdate() override;
-	void Save(JsonValue jComponent) const override;
-	void Load(JsonValue jComponent) override;
+	void Save(JsonWriter& writer) const override;
+	void Load(ConstJsonValue jComponent) override;
+	void Save(BinaryWriter& writer) const override;
+	void Load(BinaryReader& reader) override;
 
 	Frustum BuildDefaultFrustum() const;
 
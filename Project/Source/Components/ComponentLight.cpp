@@ -3,6 +3,8 @@
 #include "Globals.h"
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "FileSystem/BinaryWriter.h"
+#include "FileSystem/BinaryReader.h"
 #include "Resources/GameObject.h"
 #include "Components/ComponentTransform.h"
 #include "Modules/ModuleResources.h"
@@ -105,50 +107,62 @@ void ComponentLight::OnEditorUpdate() {
 	}
 }
 
-void ComponentLight::Save(JsonValue jComponent) const {
-	JsonValue jLightType = jComponent[JSON_TAG_TYPE];
-	jLightType = (int) lightType;
-
-	JsonValue jColor = jComponent[JSON_TAG_COLOR];
-	jColor[0] = color.x;
-	jColor[1] = color.y;
-	jColor[2] = color.z;
-
-	JsonValue jIntensity = jComponent[JSON_TAG_INTENSITY];
-	jIntensity = intensity;
-
-	JsonValue jKl = jComponent[JSON_TAG_KL];
-	jKl = kl;
-
-	JsonValue jKq = jComponent[JSON_TAG_KQ];
-	jKq = kq;
-
-	JsonValue jInnerAngle = jComponent[JSON_TAG_INNER_ANGLE];
-	jInnerAngle = innerAngle;
-
-	JsonValue jOuterAngle = jComponent[JSON_TAG_OUTER_ANGLE];
-	jOuterAngle = outerAngle;
+void ComponentLight::Save(JsonWriter& writer) const {
+	writer.Member(JSON_TAG_TYPE, (int) lightType);
+
+	writer.Key(JSON_TAG_COLOR);
+	writer.StartArray();
+	writer.Write(color.x);
+	writer.Write(color.y);
+	writer.Write(color.z);
+	writer.EndArray();
+
+	writer.Member(JSON_TAG_INTENSITY, intensity);
+	writer.Member(JSON_TAG_KL, kl);
+	writer.Member(JSON_TAG_KQ, kq);
+	writer.Member(JSON_TAG_INNER_ANGLE, innerAngle);
+	writer.Member(JSON_TAG_OUTER_ANGLE, outerAngle);
 }
 
-void ComponentLight::Load(JsonValue jComponent) {
-	JsonValue jLightType = jComponent[JSON_TAG_TYPE];
+void ComponentLight::Load(ConstJsonValue jComponent) {
+	ConstJsonValue jLightType = jComponent[JSON_TAG_TYPE];
 	lightType = (LightType)(int) jLightType;
 
-	JsonValue jColor = jComponent[JSON_TAG_COLOR];
+	ConstJsonValue jColor = jComponent[JSON_TAG_COLOR];
 	color.Set(jColor[0], jColor[1], jColor[2]);
 
-	JsonValue jIntensity = jComponent[JSON_TAG_INTENSITY];
+	ConstJsonValue jIntensity = jComponent[JSON_TAG_INTENSITY];
 	intensity = jIntensity;
 
-	JsonValue jKl = jComponent[JSON_TAG_KL];
+	ConstJsonValue jKl = jComponent[JSON_TAG_KL];
 	kl = jKl;
 
-	JsonValue jKq = jComponent[JSON_TAG_KQ];
+	ConstJsonValue jKq = jComponent[JSON_TAG_KQ];
 	kq = jKq;
 
-	JsonValue jInnerAngle = jComponent[JSON_TAG_INNER_ANGLE];
+	ConstJsonValue jInnerAngle = jComponent[JSON_TAG_INNER_ANGLE];
 	innerAngle = jInnerAngle;
 
-	JsonValue jOuterAngle = jComponent[JSON_TAG_OUTER_ANGLE];
+	ConstJsonValue jOuterAngle = jComponent[JSON_TAG_OUTER_ANGLE];
 	outerAngle = jOuterAngle;
 }
+
+void ComponentLight::Save(BinaryWriter& writer) const {
+	writer.Write((int) lightType);
+	writer.Write(color);
+	writer.Write(intensity);
+	writer.Write(kl);
+	writer.Write(kq);
+	writer.Write(innerAngle);
+	writer.Write(outerAngle);
+}
+
+void ComponentLight::Load(BinaryReader& reader) {
+	lightType = (LightType) reader.Read<int>();
+	color = reader.Read<float3>();
+	intensity = reader.Read<float>();
+	kl = reader.Read<float>();
+	kq = reader.Read<float>();
+	innerAngle = reader.Read<float>();
+	outerAngle = reader.Read<float>();
+}
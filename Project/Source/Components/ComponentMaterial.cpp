@@ -2,6 +2,8 @@
 
 #include "Application.h"
 #include "FileSystem/TextureImporter.h"
+#include "FileSystem/BinaryWriter.h"
+#include "FileSystem/BinaryReader.h"
 #include "Resources/GameObject.h"
 #include "Modules/ModuleResources.h"
 #include "Modules/ModuleEditor.h"
@@ -18,10 +20,18 @@
 #define JSON_TAG_HAS_SPECULAR_MAP "HasSpecularMap"
 #define JSON_TAG_SPECULAR_COLOR "SpecularColor"
 #define JSON_TAG_HAS_SPECULAR_MAP_FILE_NAME "SpecularMapFileName"
+#define JSON_TAG_HAS_NORMAL_MAP "HasNormalMap"
+#define JSON_TAG_NORMAL_MAP_FILE_NAME "NormalMapFileName"
 #define JSON_TAG_SHININESS "Shininess"
 #define JSON_TAG_HAS_SHININESS_IN_ALPHA_CHANNEL "HasShininessInAlphaChannel"
 #define JSON_TAG_AMBIENT "Ambient"
 
+// Empty if the Texture has been released
+static InternedString GetTextureFileName(PoolHandle<Texture> handle) {
+	Texture* texture = App->resources->textures.Get(handle);
+	return texture != nullptr ? texture->fileName : InternedString();
+}
+
 void ComponentMaterial::OnEditorUpdate() {
 	if (ImGui::CollapsingHeader("Material")) {
 		bool active = IsActive();
@@ -78,12 +88,13 @@ void ComponentMaterial::OnEditorUpdate() {
 			if (diffuseItemCurrent == diffuseItems[0]) {
 				ImGui::ColorEdit3("Color##diffuse", material.diffuseColor.ptr());
 			} else {
-				std::string& currentDiffuseTexture = material.diffuseMap ? material.diffuseMap->fileName : "";
+				Texture* diffuseMap = App->resources->textures.Get(material.diffuseMap);
+				InternedString currentDiffuseTexture = diffuseMap ? diffuseMap->fileName : InternedString();
 				if (ImGui::BeginCombo("Texture##diffuse", currentDiffuseTexture.c_str())) {
 					for (unsigned i = 0; i < textures.size(); ++i) {
 						bool isSelected = (currentDiffuseTexture == textures[i]->fileName);
 						if (ImGui::Selectable(textures[i]->fileName.c_str(), isSelected)) {
-							material.diffuseMap = textures[i];
+							material.diffuseMap = App->resources->textures.GetHandle(textures[i]);
 						};
 						if (isSelected) {
 							ImGui::SetItemDefaultFocus();
@@ -113,12 +124,13 @@ void ComponentMaterial::OnEditorUpdate() {
 			if (specularItemCurrent == specularItems[0]) {
 				ImGui::ColorEdit3("Color##specular", material.specularColor.ptr());
 			} else {
-				std::string& currentSpecularTexture = material.specularMap ? material.specularMap->fileName : "";
+				Texture* specularMap = App->resources->textures.Get(material.specularMap);
+				InternedString currentSpecularTexture = specularMap ? specularMap->fileName : InternedString();
 				if (ImGui::BeginCombo("Texture##specular", currentSpecularTexture.c_str())) {
 					for (unsigned i = 0; i < textures.size(); ++i) {
 						bool isSelected = (currentSpecularTexture == textures[i]->fileName);
 						if (ImGui::Selectable(textures[i]->fileName.c_str(), isSelected)) {
-							material.specularMap = textures[i];
+							material.specularMap = App->resources->textures.GetHandle(textures[i]);
 						};
 						if (isSelected) {
 							ImGui::SetItemDefaultFocus();
@@ -146,6 +158,27 @@ void ComponentMaterial::OnEditorUpdate() {
 			if (shininessItemCurrent == shininessItems[0]) {
 				ImGui::DragFloat("Shininess##shininess", &material.shininess, App->editor->dragSpeed3f, 0.0f, 1000.0f);
 			}
+			ImGui::Text("");
+
+			// Normal Map
+			ImGui::TextColored(App->editor->textColor, "Normal Settings:");
+			ImGui::Checkbox("Normal Map", &material.hasNormalMap);
+			if (material.hasNormalMap) {
+				Texture* normalMap = App->resources->textures.Get(material.normalMap);
+				InternedString currentNormalTexture = normalMap ? normalMap->fileName : InternedString();
+				if (ImGui::BeginCombo("Texture##normal", currentNormalTexture.c_str())) {
+					for (unsigned i = 0; i < textures.size(); ++i) {
+						bool isSelected = (currentNormalTexture == textures[i]->fileName);
+						if (ImGui::Selectable(textures[i]->fileName.c_str(), isSelected)) {
+							material.normalMap = App->resources->textures.GetHandle(textures[i]);
+						};
+						if (isSelected) {
+							ImGui::SetItemDefaultFocus();
+						}
+					}
+					ImGui::EndCombo();
+				}
+			}
 		}
 		ImGui::Separator();
 		ImGui::TextColored(App->editor->titleColor, "Filters");
@@ -198,105 +231,181 @@ void ComponentMaterial::OnEditorUpdate() {
 			ImGui::EndCombo();
 		}
 		ImGui::Separator();
-		if (material.diffuseMap != nullptr) {
+		Texture* diffuseMap = App->resources->textures.Get(material.diffuseMap);
+		if (diffuseMap != nullptr) {
 			ImGui::TextColored(App->editor->titleColor, "Diffuse Texture");
 			ImGui::TextWrapped("Size:##diffuse");
 			ImGui::SameLine();
 			int width;
 			int height;
-			glGetTextureLevelParameteriv(material.diffuseMap->glTexture, 0, GL_TEXTURE_WIDTH, &width);
-			glGetTextureLevelParameteriv(material.diffuseMap->glTexture, 0, GL_TEXTURE_HEIGHT, &height);
+			glGetTextureLevelParameteriv(diffuseMap->glTexture, 0, GL_TEXTURE_WIDTH, &width);
+			glGetTextureLevelParameteriv(diffuseMap->glTexture, 0, GL_TEXTURE_HEIGHT, &height);
 			ImGui::TextWrapped("%d x %d##diffuse", width, height);
-			ImGui::Image((void*) material.diffuseMap->glTexture, ImVec2(200, 200));
+			ImGui::Image((void*) diffuseMap->glTexture, ImVec2(200, 200));
 			ImGui::Separator();
 		}
-		if (material.specularMap != nullptr) {
+		Texture* specularMap = App->resources->textures.Get(material.specularMap);
+		if (specularMap != nullptr) {
 			ImGui::TextColored(App->editor->titleColor, "Specular Texture");
 			ImGui::TextWrapped("Size:##specular");
 			ImGui::SameLine();
 			int width;
 			int height;
-			glGetTextureLevelParameteriv(material.specularMap->glTexture, 0, GL_TEXTURE_WIDTH, &width);
-			glGetTextureLevelParameteriv(material.specularMap->glTexture, 0, GL_TEXTURE_HEIGHT, &height);
+			glGetTextureLevelParameteriv(specularMap->glTexture, 0, GL_TEXTURE_WIDTH, &width);
+			glGetTextureLevelParameteriv(specularMap->glTexture, 0, GL_TEXTURE_HEIGHT, &height);
 			ImGui::TextWrapped("%d x %d##specular", width, height);
-			ImGui::Image((void*) material.specularMap->glTexture, ImVec2(200, 200));
+			ImGui::Image((void*) specularMap->glTexture, ImVec2(200, 200));
+			ImGui::Separator();
+		}
+		Texture* normalMap = App->resources->textures.Get(material.normalMap);
+		if (normalMap != nullptr) {
+			ImGui::TextColored(App->editor->titleColor, "Normal Map");
+			ImGui::TextWrapped("Size:##normal");
+			ImGui::SameLine();
+			int width;
+			int height;
+			glGetTextureLevelParameteriv(normalMap->glTexture, 0, GL_TEXTURE_WIDTH, &width);
+			glGetTextureLevelParameteriv(normalMap->glTexture, 0, GL_TEXTURE_HEIGHT, &height);
+			ImGui::TextWrapped("%d x %d##normal", width, height);
+			ImGui::Image((void*) normalMap->glTexture, ImVec2(200, 200));
 			ImGui::Separator();
 		}
 	}
 }
 
-void ComponentMaterial::Save(JsonValue jComponent) const {
-	jComponent[JSON_TAG_HAS_DIFFUSE_MAP] = material.hasDiffuseMap;
-	JsonValue jDiffuseColor = jComponent[JSON_TAG_DIFFUSE_COLOR];
-	jDiffuseColor[0] = material.diffuseColor.x;
-	jDiffuseColor[1] = material.diffuseColor.y;
-	jDiffuseColor[2] = material.diffuseColor.z;
-	if (material.hasDiffuseMap) jComponent[JSON_TAG_DIFFUSE_MAP_FILE_NAME] = material.diffuseMap->fileName.c_str();
-
-	jComponent[JSON_TAG_HAS_SPECULAR_MAP] = material.hasSpecularMap;
-	JsonValue jSpecularColor = jComponent[JSON_TAG_SPECULAR_COLOR];
-	jSpecularColor[0] = material.specularColor.x;
-	jSpecularColor[1] = material.specularColor.y;
-	jSpecularColor[2] = material.specularColor.z;
-	if (material.hasSpecularMap) jComponent[JSON_TAG_HAS_SPECULAR_MAP_FILE_NAME] = material.specularMap->fileName.c_str();
-
-	jComponent[JSON_TAG_SHININESS] = material.shininess;
-	jComponent[JSON_TAG_HAS_SHININESS_IN_ALPHA_CHANNEL] = material.hasShininessInAlphaChannel;
-
-	JsonValue jAmbient = jComponent[JSON_TAG_AMBIENT];
-	jAmbient[0] = material.ambient.x;
-	jAmbient[1] = material.ambient.y;
-	jAmbient[2] = material.ambient.z;
+void ComponentMaterial::Save(JsonWriter& writer) const {
+	writer.Member(JSON_TAG_HAS_DIFFUSE_MAP, material.hasDiffuseMap);
+	writer.Key(JSON_TAG_DIFFUSE_COLOR);
+	writer.StartArray();
+	writer.Write(material.diffuseColor.x);
+	writer.Write(material.diffuseColor.y);
+	writer.Write(material.diffuseColor.z);
+	writer.EndArray();
+	if (material.hasDiffuseMap) writer.Member(JSON_TAG_DIFFUSE_MAP_FILE_NAME, GetTextureFileName(material.diffuseMap).c_str());
+
+	writer.Member(JSON_TAG_HAS_SPECULAR_MAP, material.hasSpecularMap);
+	writer.Key(JSON_TAG_SPECULAR_COLOR);
+	writer.StartArray();
+	writer.Write(material.specularColor.x);
+	writer.Write(material.specularColor.y);
+	writer.Write(material.specularColor.z);
+	writer.EndArray();
+	if (material.hasSpecularMap) writer.Member(JSON_TAG_HAS_SPECULAR_MAP_FILE_NAME, GetTextureFileName(material.specularMap).c_str());
+
+	writer.Member(JSON_TAG_HAS_NORMAL_MAP, material.hasNormalMap);
+	if (material.hasNormalMap) writer.Member(JSON_TAG_NORMAL_MAP_FILE_NAME, GetTextureFileName(material.normalMap).c_str());
+
+	writer.Member(JSON_TAG_SHININESS, material.shininess);
+	writer.Member(JSON_TAG_HAS_SHININESS_IN_ALPHA_CHANNEL, material.hasShininessInAlphaChannel);
+
+	writer.Key(JSON_TAG_AMBIENT);
+	writer.StartArray();
+	writer.Write(material.ambient.x);
+	writer.Write(material.ambient.y);
+	writer.Write(material.ambient.z);
+	writer.EndArray();
 }
 
-void ComponentMaterial::Load(JsonValue jComponent) {
+void ComponentMaterial::Load(ConstJsonValue jComponent) {
+	// Textures that are already in the GPU or queued for upload are kept. They can be shared by other materials.
 	material.hasDiffuseMap = jComponent[JSON_TAG_HAS_DIFFUSE_MAP];
-	JsonValue jDiffuseColor = jComponent[JSON_TAG_DIFFUSE_COLOR];
+	ConstJsonValue jDiffuseColor = jComponent[JSON_TAG_DIFFUSE_COLOR];
 	material.diffuseColor.Set(jDiffuseColor[0], jDiffuseColor[1], jDiffuseColor[2]);
 	if (material.hasDiffuseMap) {
-		std::string diffuseFileName = jComponent[JSON_TAG_DIFFUSE_MAP_FILE_NAME];
-		for (Texture& texture : App->resources->textures) {
-			if (texture.fileName == diffuseFileName) {
-				material.diffuseMap = &texture;
-			}
-		}
-		if (material.diffuseMap == nullptr) {
-			material.diffuseMap = App->resources->ObtainTexture();
-			material.diffuseMap->fileName = diffuseFileName;
-		}
+		InternedString diffuseFileName = jComponent[JSON_TAG_DIFFUSE_MAP_FILE_NAME];
+		Texture* diffuseMap = App->resources->ObtainTextureWithFileName(diffuseFileName);
+		material.diffuseMap = App->resources->textures.GetHandle(diffuseMap);
 
-		TextureImporter::UnloadTexture(material.diffuseMap);
-		TextureImporter::LoadTexture(material.diffuseMap);
-	} else if (material.diffuseMap != nullptr) {
-		App->resources->ReleaseTexture(material.diffuseMap);
-		material.diffuseMap = nullptr;
+		TextureImporter::LoadTexture(diffuseMap);
+	} else {
+		material.diffuseMap = PoolHandle<Texture>();
 	}
 
 	material.hasSpecularMap = jComponent[JSON_TAG_HAS_SPECULAR_MAP];
-	JsonValue jSpecularColor = jComponent[JSON_TAG_SPECULAR_COLOR];
+	ConstJsonValue jSpecularColor = jComponent[JSON_TAG_SPECULAR_COLOR];
 	material.specularColor.Set(jSpecularColor[0], jSpecularColor[1], jSpecularColor[2]);
 	if (material.hasSpecularMap) {
-		std::string specularFileName = jComponent[JSON_TAG_HAS_SPECULAR_MAP_FILE_NAME];
-		for (Texture& texture : App->resources->textures) {
-			if (texture.fileName == specularFileName) {
-				material.specularMap = &texture;
-			}
-		}
-		if (material.specularMap == nullptr) {
-			material.specularMap = App->resources->ObtainTexture();
-			material.specularMap->fileName = specularFileName;
-		}
+		InternedString specularFileName = jComponent[JSON_TAG_HAS_SPECULAR_MAP_FILE_NAME];
+		Texture* specularMap = App->resources->ObtainTextureWithFileName(specularFileName);
+		material.specularMap = App->resources->textures.GetHandle(specularMap);
+
+		TextureImporter::LoadTexture(specularMap);
+	} else {
+		material.specularMap = PoolHandle<Texture>();
+	}
 
-		TextureImporter::UnloadTexture(material.specularMap);
-		TextureImporter::LoadTexture(material.specularMap);
-	} else if (material.specularMap != nullptr) {
-		App->resources->ReleaseTexture(material.specularMap);
-		material.specularMap = nullptr;
+	// Missing in scenes saved before normal maps, which reads as false
+	material.hasNormalMap = jComponent[JSON_TAG_HAS_NORMAL_MAP];
+	if (material.hasNormalMap) {
+		InternedString normalFileName = jComponent[JSON_TAG_NORMAL_MAP_FILE_NAME];
+		Texture* normalMap = App->resources->ObtainTextureWithFileName(normalFileName);
+		material.normalMap = App->resources->textures.GetHandle(normalMap);
+
+		TextureImporter::LoadTexture(normalMap);
+	} else {
+		material.normalMap = PoolHandle<Texture>();
 	}
 
 	material.shininess = jComponent[JSON_TAG_SHININESS];
 	material.hasShininessInAlphaChannel = jComponent[JSON_TAG_HAS_SHININESS_IN_ALPHA_CHANNEL];
 
-	JsonValue jAmbient = jComponent[JSON_TAG_AMBIENT];
+	ConstJsonValue jAmbient = jComponent[JSON_TAG_AMBIENT];
 	material.ambient.Set(jAmbient[0], jAmbient[1], jAmbient[2]);
 }
+
+void ComponentMaterial::Save(BinaryWriter& writer) const {
+	writer.Write((int) material.materialType);
+
+	writer.Write(material.hasDiffuseMap);
+	writer.Write(material.diffuseColor);
+	if (material.hasDiffuseMap) writer.WriteString(GetTextureFileName(material.diffuseMap));
+
+	writer.Write(material.hasSpecularMap);
+	writer.Write(material.specularColor);
+	if (material.hasSpecularMap) writer.WriteString(GetTextureFileName(material.specularMap));
+
+	writer.Write(material.hasNormalMap);
+	if (material.hasNormalMap) writer.WriteString(GetTextureFileName(material.normalMap));
+
+	writer.Write(material.shininess);
+	writer.Write(material.hasShininessInAlphaChannel);
+	writer.Write(material.ambient);
+}
+
+void ComponentMaterial::Load(BinaryReader& reader) {
+	material.materialType = (ShaderType) reader.Read<int>();
+
+	// Textures that are already in the GPU are kept
+	material.hasDiffuseMap = reader.Read<bool>();
+	material.diffuseColor = reader.Read<float3>();
+	if (material.hasDiffuseMap) {
+		Texture* diffuseMap = App->resources->ObtainTextureWithFileName(reader.ReadString());
+		material.diffuseMap = App->resources->textures.GetHandle(diffuseMap);
+		TextureImporter::LoadTexture(diffuseMap);
+	} else {
+		material.diffuseMap = PoolHandle<Texture>();
+	}
+
+	material.hasSpecularMap = reader.Read<bool>();
+	material.specularColor = reader.Read<float3>();
+	if (material.hasSpecularMap) {
+		Texture* specularMap = App->resources->ObtainTextureWithFileName(reader.ReadString());
+		material.specularMap = App->resources->textures.GetHandle(specularMap);
+		TextureImporter::LoadTexture(specularMap);
+	} else {
+		material.specularMap = PoolHandle<Texture>();
+	}
+
+	material.hasNormalMap = reader.Read<bool>();
+	if (material.hasNormalMap) {
+		Texture* normalMap = App->resources->ObtainTextureWithFileName(reader.ReadString());
+		material.normalMap = App->resources->textures.GetHandle(normalMap);
+		TextureImporter::LoadTexture(normalMap);
+	} else {
+		material.normalMap = PoolHandle<Texture>();
+	}
+
+	material.shininess = reader.Read<float>();
+	material.hasShininessInAlphaChannel = reader.Read<bool>();
+	material.ambient = reader.Read<float3>();
+}
@@ -8,8 +8,10 @@ public:
 	REGISTER_COMPONENT(ComponentMaterial, ComponentType::MATERIAL);
 
 	void OnEditorUpdate() override;
-	void Save(JsonValue jComponent) const override;
-	void Load(JsonValue jComponent) override;
+	void Save(JsonWriter& writer) const override;
+	void Load(ConstJsonValue jComponent) override;
+	void Save(BinaryWriter& writer) const override;
+	void Load(BinaryReader& reader) override;
 
 public:
 	GameObject* light = nullptr;
@@ -4,6 +4,8 @@
 #include "Application.h"
 #include "Utils/Logging.h"
 #include "FileSystem/MeshImporter.h"
+#include "FileSystem/BinaryWriter.h"
+#include "FileSystem/BinaryReader.h"
 #include "Resources/GameObject.h"
 #include "Resources/Texture.h"
 #include "Resources/Mesh.h"
@@ -18,14 +20,27 @@
 #include "Modules/ModuleEditor.h"
 
 #include "assimp/mesh.h"
+#include "Math/MathFunc.h"
 #include "GL/glew.h"
 #include "imgui.h"
+#include <math.h>
 
 #include "Utils/Leaks.h"
 
 #define JSON_TAG_FILENAME "FileName"
 #define JSON_TAG_MATERIAL_INDEX "MaterialIndex"
 
+// Coarser levels are only picked when their error is below this fraction of the threshold, so meshes near it don't keep switching
+#define LOD_HYSTERESIS 0.75f
+
+// Coarsest level whose error on screen is below the threshold
+static unsigned CoarsestLod(const Mesh* mesh, float projectedRadius, float maxErrorPixels) {
+	for (unsigned lod = mesh->numLods - 1; lod > 0; --lod) {
+		if (mesh->lodErrors[lod] * projectedRadius <= maxErrorPixels) return lod;
+	}
+	return 0;
+}
+
 void ComponentMesh::OnEditorUpdate() {
 	if (ImGui::CollapsingHeader("Mesh")) {
 		bool active = IsActive();
@@ -40,13 +55,19 @@ void ComponentMesh::OnEditorUpdate() {
 		}
 		ImGui::Separator();
 
+		Mesh* meshResource = GetMesh();
 		ImGui::TextColored(App->editor->titleColor, "Geometry");
-		ImGui::TextWrapped("Num Vertices: ");
-		ImGui::SameLine();
-		ImGui::TextColored(App->editor->textColor, "%d", mesh->numVertices);
-		ImGui::TextWrapped("Num Triangles: ");
-		ImGui::SameLine();
-		ImGui::TextColored(App->editor->textColor, "%d", mesh->numIndices / 3);
+		if (meshResource != nullptr) {
+			ImGui::TextWrapped("Num Vertices: ");
+			ImGui::SameLine();
+			ImGui::TextColored(App->editor->textColor, "%d", meshResource->numVertices);
+			ImGui::TextWrapped("Num Triangles: ");
+			ImGui::SameLine();
+			ImGui::TextColored(App->editor->textColor, "%d", meshResource->numIndices / 3);
+			ImGui::TextWrapped("Level of Detail: ");
+			ImGui::SameLine();
+			ImGui::TextColored(App->editor->textColor, "%u of %u (%u triangles)", lod, meshResource->numLods, meshResource->lodNumIndices[Min(lod, meshResource->numLods - 1)] / 3);
+		}
 		ImGui::Separator();
 		ImGui::TextColored(App->editor->titleColor, "Bounding Box");
 
@@ -59,167 +80,221 @@ void ComponentMesh::OnEditorUpdate() {
 	}
 }
 
-void ComponentMesh::Save(JsonValue jComponent) const {
-	jComponent[JSON_TAG_FILENAME] = mesh->fileName.c_str();
-	jComponent[JSON_TAG_MATERIAL_INDEX] = mesh->materialIndex;
+void ComponentMesh::Save(JsonWriter& writer) const {
+	writer.Member(JSON_TAG_FILENAME, GetMesh()->fileName.c_str());
+	writer.Member(JSON_TAG_MATERIAL_INDEX, materialIndex);
 }
 
-void ComponentMesh::Load(JsonValue jComponent) {
-	std::string fileName = jComponent[JSON_TAG_FILENAME];
-	for (Mesh& otherMesh : App->resources->meshes) {
-		if (otherMesh.fileName == fileName) {
-			mesh = &otherMesh;
-		}
-	}
-	if (mesh == nullptr) {
-		mesh = App->resources->ObtainMesh();
-		mesh->fileName = fileName;
-	}
-	mesh->materialIndex = jComponent[JSON_TAG_MATERIAL_INDEX];
+void ComponentMesh::Load(ConstJsonValue jComponent) {
+	InternedString fileName = jComponent[JSON_TAG_FILENAME];
+	Mesh* meshResource = App->resources->ObtainMeshWithFileName(fileName);
+	mesh = App->resources->meshes.GetHandle(meshResource);
+	materialIndex = jComponent[JSON_TAG_MATERIAL_INDEX];
 
-	MeshImporter::UnloadMesh(mesh);
-	MeshImporter::LoadMesh(mesh);
+	// Meshes that are already in the GPU are kept
+	MeshImporter::LoadMesh(meshResource);
 }
 
-void ComponentMesh::Draw(const std::vector<ComponentMaterial*>& materials, const float4x4& modelMatrix) const {
-	if (!IsActive()) return;
+void ComponentMesh::Save(BinaryWriter& writer) const {
+	writer.WriteString(GetMesh()->fileName);
+	writer.Write(materialIndex);
+}
 
-	unsigned program = App->programs->defaultProgram;
+void ComponentMesh::Load(BinaryReader& reader) {
+	InternedString fileName = reader.ReadString();
+	Mesh* meshResource = GetMesh();
+	if (meshResource == nullptr || meshResource->fileName != fileName) {
+		meshResource = App->resources->ObtainMeshWithFileName(fileName);
+		mesh = App->resources->meshes.GetHandle(meshResource);
+	}
+	materialIndex = reader.Read<unsigned>();
 
-	float4x4 viewMatrix = App->camera->GetViewMatrix();
-	float4x4 projMatrix = App->camera->GetProjectionMatrix();
-	unsigned glTextureDiffuse = 0;
-	unsigned glTextureSpecular = 0;
+	// Meshes that are already in the GPU are kept
+	MeshImporter::LoadMesh(meshResource);
+}
 
-	if (materials.size() > mesh->materialIndex) {
-		if (materials[mesh->materialIndex]->IsActive()) {
-			Texture* diffuse = materials[mesh->materialIndex]->material.diffuseMap;
-			glTextureDiffuse = diffuse ? diffuse->glTexture : 0;
-			Texture* specular = materials[mesh->materialIndex]->material.specularMap;
-			glTextureSpecular = specular ? specular->glTexture : 0;
-		}
-	}
+Mesh* ComponentMesh::GetMesh() const {
+	return App->resources->meshes.Get(mesh);
+}
 
-	ComponentLight* directionalLight = nullptr;
-	std::vector<ComponentLight*> pointLightsVector;
-	std::vector<float> pointDistancesVector;
-	std::vector<ComponentLight*> spotLightsVector;
-	std::vector<float> spotDistancesVector;
-
-	if (materials[mesh->materialIndex]->material.materialType == ShaderType::PHONG) {
-		float farPointDistance = 0;
-		ComponentLight* farPointLight = nullptr;
-		float farSpotDistance = 0;
-		ComponentLight* farSpotLight = nullptr;
-
-		for (GameObject& object : App->scene->gameObjects) {
-			ComponentLight* light = object.GetComponent<ComponentLight>();
-			if (light == nullptr) continue;
-
-			if (light->lightType == LightType::DIRECTIONAL) {
-				// It takes the first actived Directional Light inside the Pool
-				if (light->IsActive() && directionalLight == nullptr) {
-					directionalLight = light;
-					continue;
-				}
-			} else if (light->lightType == LightType::POINT) {
-				if (light->IsActive()) {
-					float3 meshPosition = GetOwner().GetComponent<ComponentTransform>()->GetPosition();
-					float3 lightPosition = object.GetComponent<ComponentTransform>()->GetPosition();
-					float distance = Distance(meshPosition, lightPosition);
-					if (pointLightsVector.size() < 8) {
-						pointDistancesVector.push_back(distance);
-						pointLightsVector.push_back(light);
-
-						if (distance > farPointDistance) {
-							farPointLight = light;
-							farPointDistance = distance;
+void ComponentMesh::GatherLights(ComponentLight*& directionalLight, FrameVector<ComponentLight*>& pointLightsVector, FrameVector<ComponentLight*>& spotLightsVector) const {
+	FrameVector<float> pointDistancesVector;
+	FrameVector<float> spotDistancesVector;
+	pointLightsVector.reserve(8);
+	pointDistancesVector.reserve(8);
+	spotLightsVector.reserve(8);
+	spotDistancesVector.reserve(8);
+
+	float farPointDistance = 0;
+	ComponentLight* farPointLight = nullptr;
+	float farSpotDistance = 0;
+	ComponentLight* farSpotLight = nullptr;
+
+	for (GameObject& object : App->scene->gameObjects) {
+		ComponentLight* light = object.GetComponent<ComponentLight>();
+		if (light == nullptr) continue;
+
+		if (light->lightType == LightType::DIRECTIONAL) {
+			// It takes the first actived Directional Light inside the Pool
+			if (light->IsActive() && directionalLight == nullptr) {
+				directionalLight = light;
+				continue;
+			}
+		} else if (light->lightType == LightType::POINT) {
+			if (light->IsActive()) {
+				float3 meshPosition = GetOwner().GetComponent<ComponentTransform>()->GetPosition();
+				float3 lightPosition = object.GetComponent<ComponentTransform>()->GetPosition();
+				float distance = Distance(meshPosition, lightPosition);
+				if (pointLightsVector.size() < 8) {
+					pointDistancesVector.push_back(distance);
+					pointLightsVector.push_back(light);
+
+					if (distance > farPointDistance) {
+						farPointLight = light;
+						farPointDistance = distance;
+					}
+				} else {
+					if (distance < farPointDistance) {
+						int count = 0;
+						int selected = -1;
+						for (float pointDistance : pointDistancesVector) {
+							if (pointDistance == farPointDistance) selected = count;
+							count += 1;
 						}
-					} else {
-						if (distance < farPointDistance) {
-							int count = 0;
-							int selected = -1;
-							for (float pointDistance : pointDistancesVector) {
-								if (pointDistance == farPointDistance) selected = count;
-								count += 1;
-							}
 
-							pointLightsVector[selected] = light;
-							pointDistancesVector[selected] = distance;
-
-							count = 0;
-							selected = -1;
-							float maxDistance = 0;
-							for (float pointDistance : pointDistancesVector) {
-								if (pointDistance > maxDistance) {
-									maxDistance = pointDistance;
-									selected = count;
-								}
-								count += 1;
-							}
+						pointLightsVector[selected] = light;
+						pointDistancesVector[selected] = distance;
 
-							farPointDistance = maxDistance;
-							farPointLight = pointLightsVector[selected];
+						count = 0;
+						selected = -1;
+						float maxDistance = 0;
+						for (float pointDistance : pointDistancesVector) {
+							if (pointDistance > maxDistance) {
+								maxDistance = pointDistance;
+								selected = count;
+							}
+							count += 1;
 						}
+
+						farPointDistance = maxDistance;
+						farPointLight = pointLightsVector[selected];
 					}
 				}
-			} else if (light->lightType == LightType::SPOT) {
-				if (light->IsActive()) {
-					float3 meshPosition = GetOwner().GetComponent<ComponentTransform>()->GetPosition();
-					float3 lightPosition = object.GetComponent<ComponentTransform>()->GetPosition();
-					float distance = Distance(meshPosition, lightPosition);
-					if (spotLightsVector.size() < 8) {
-						spotDistancesVector.push_back(distance);
-						spotLightsVector.push_back(light);
-
-						if (distance > farSpotDistance) {
-							farSpotLight = light;
-							farSpotDistance = distance;
+			}
+		} else if (light->lightType == LightType::SPOT) {
+			if (light->IsActive()) {
+				float3 meshPosition = GetOwner().GetComponent<ComponentTransform>()->GetPosition();
+				float3 lightPosition = object.GetComponent<ComponentTransform>()->GetPosition();
+				float distance = Distance(meshPosition, lightPosition);
+				if (spotLightsVector.size() < 8) {
+					spotDistancesVector.push_back(distance);
+					spotLightsVector.push_back(light);
+
+					if (distance > farSpotDistance) {
+						farSpotLight = light;
+						farSpotDistance = distance;
+					}
+				} else {
+					if (distance < farSpotDistance) {
+						int count = 0;
+						int selected = -1;
+						for (float spotDistance : spotDistancesVector) {
+							if (spotDistance == farSpotDistance) selected = count;
+							count += 1;
 						}
-					} else {
-						if (distance < farSpotDistance) {
-							int count = 0;
-							int selected = -1;
-							for (float spotDistance : spotDistancesVector) {
-								if (spotDistance == farSpotDistance) selected = count;
-								count += 1;
-							}
 
-							spotLightsVector[selected] = light;
-							spotDistancesVector[selected] = distance;
-
-							count = 0;
-							selected = -1;
-							float maxDistance = 0;
-							for (float spotDistance : spotDistancesVector) {
-								if (spotDistance > maxDistance) {
-									maxDistance = spotDistance;
-									selected = count;
-								}
-								count += 1;
-							}
+						spotLightsVector[selected] = light;
+						spotDistancesVector[selected] = distance;
 
-							farSpotDistance = maxDistance;
-							farSpotLight = spotLightsVector[selected];
+						count = 0;
+						selected = -1;
+						float maxDistance = 0;
+						for (float spotDistance : spotDistancesVector) {
+							if (spotDistance > maxDistance) {
+								maxDistance = spotDistance;
+								selected = count;
+							}
+							count += 1;
 						}
+
+						farSpotDistance = maxDistance;
+						farSpotLight = spotLightsVector[selected];
 					}
 				}
 			}
 		}
+	}
+}
+
+void ComponentMesh::SelectLod(const AABB& worldAABB) {
+	const Mesh* meshResource = GetMesh();
+	if (!App->renderer->lodEnabled || meshResource == nullptr || meshResource->numLods <= 1) {
+		lod = 0;
+		return;
+	}
+
+	// Inside the sphere, the mesh covers the screen
+	float radius = worldAABB.HalfDiagonal().Length();
+	float distance = worldAABB.CenterPoint().Distance(App->camera->GetPosition());
+	if (distance <= radius) {
+		lod = 0;
+		return;
+	}
+
+	float projectedRadius = radius / (distance * tanf(App->camera->GetFOV() * 0.5f)) * App->renderer->viewportHeight * 0.5f;
+	unsigned maxLod = CoarsestLod(meshResource, projectedRadius, App->renderer->lodMaxErrorPixels);
+	unsigned minLod = CoarsestLod(meshResource, projectedRadius, App->renderer->lodMaxErrorPixels * LOD_HYSTERESIS);
+	lod = Clamp(lod, minLod, maxLod);
+}
+
+void ComponentMesh::Draw(const FrameVector<ComponentMaterial*>& materials, const float4x4& modelMatrix) const {
+	if (!IsActive()) return;
+
+	const Mesh* meshResource = GetMesh();
+	if (meshResource == nullptr) return;
+
+	ArenaScope arenaScope;
+
+	unsigned program = App->programs->defaultProgram;
+
+	float4x4 viewMatrix = App->camera->GetViewMatrix();
+	float4x4 projMatrix = App->camera->GetProjectionMatrix();
+	unsigned glTextureDiffuse = 0;
+	unsigned glTextureSpecular = 0;
+	unsigned glTextureNormal = 0;
+
+	if (materials.size() > materialIndex) {
+		if (materials[materialIndex]->IsActive()) {
+			Texture* diffuse = App->resources->textures.Get(materials[materialIndex]->material.diffuseMap);
+			glTextureDiffuse = diffuse ? diffuse->glTexture : 0;
+			Texture* specular = App->resources->textures.Get(materials[materialIndex]->material.specularMap);
+			glTextureSpecular = specular ? specular->glTexture : 0;
+			Texture* normal = App->resources->textures.Get(materials[materialIndex]->material.normalMap);
+			glTextureNormal = normal ? normal->glTexture : 0;
+		}
+	}
+
+	if (materials[materialIndex]->material.materialType == ShaderType::PHONG) {
+		ComponentLight* directionalLight = nullptr;
+		FrameVector<ComponentLight*> pointLightsVector;
+		FrameVector<ComponentLight*> spotLightsVector;
+		GatherLights(directionalLight, pointLightsVector, spotLightsVector);
 
 		program = App->programs->phongPbrProgram;
 		glUseProgram(program);
 
-		glUniform3fv(glGetUniformLocation(program, "diffuseColor"), 1, materials[mesh->materialIndex]->material.diffuseColor.ptr());
-		glUniform3fv(glGetUniformLocation(program, "specularColor"), 1, materials[mesh->materialIndex]->material.specularColor.ptr());
-		glUniform1f(glGetUniformLocation(program, "shininess"), materials[mesh->materialIndex]->material.shininess);
+		glUniform3fv(glGetUniformLocation(program, "diffuseColor"), 1, materials[materialIndex]->material.diffuseColor.ptr());
+		glUniform3fv(glGetUniformLocation(program, "specularColor"), 1, materials[materialIndex]->material.specularColor.ptr());
+		glUniform1f(glGetUniformLocation(program, "shininess"), materials[materialIndex]->material.shininess);
 
-		int hasDiffuseMap = (materials[mesh->materialIndex]->material.hasDiffuseMap) ? 1 : 0;
-		int hasSpecularMap = (materials[mesh->materialIndex]->material.hasSpecularMap) ? 1 : 0;
-		int hasShininessInAlphaChannel = (materials[mesh->materialIndex]->material.hasShininessInAlphaChannel) ? 1 : 0;
+		int hasDiffuseMap = (materials[materialIndex]->material.hasDiffuseMap) ? 1 : 0;
+		int hasSpecularMap = (materials[materialIndex]->material.hasSpecularMap) ? 1 : 0;
+		int hasShininessInAlphaChannel = (materials[materialIndex]->material.hasShininessInAlphaChannel) ? 1 : 0;
+		int hasNormalMap = (materials[materialIndex]->material.hasNormalMap && glTextureNormal) ? 1 : 0;
 		glUniform1i(glGetUniformLocation(program, "hasDiffuseMap"), hasDiffuseMap);
 		glUniform1i(glGetUniformLocation(program, "hasSpecularMap"), hasSpecularMap);
 		glUniform1i(glGetUniformLocation(program, "hasShininessInSpecularAlpha"), hasShininessInAlphaChannel);
+		glUniform1i(glGetUniformLocation(program, "hasNormalMap"), hasNormalMap);
 
 		glUniform3fv(glGetUniformLocation(program, "light.ambient.color"), 1, App->renderer->ambientColor.ptr());
 
@@ -396,13 +471,17 @@ void ComponentMesh::Draw(const std::vector<ComponentMaterial*>& materials, const
 	glUniformMatrix4fv(glGetUniformLocation(program, "proj"), 1, GL_TRUE, projMatrix.ptr());
 	glUniform1i(glGetUniformLocation(program, "diffuseMap"), 0);
 	glUniform1i(glGetUniformLocation(program, "specularMap"), 1);
+	glUniform1i(glGetUniformLocation(program, "normalMap"), 2);
 
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, glTextureDiffuse);
 	glActiveTexture(GL_TEXTURE1);
 	glBindTexture(GL_TEXTURE_2D, glTextureSpecular);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, glTextureNormal);
 
-	glBindVertexArray(mesh->vao);
-	glDrawElements(GL_TRIANGLES, mesh->numIndices, GL_UNSIGNED_INT, nullptr);
+	glBindVertexArray(meshResource->vao);
+	unsigned drawLod = Min(lod, meshResource->numLods - 1);
+	glDrawElements(GL_TRIANGLES, meshResource->lodNumIndices[drawLod], GL_UNSIGNED_INT, (void*) (sizeof(unsigned) * meshResource->lodIndexOffsets[drawLod]));
 	glBindVertexArray(0);
 }
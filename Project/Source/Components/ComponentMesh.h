@@ -2,12 +2,15 @@
 
 #include "Component.h"
 #include "Resources/Mesh.h"
+#include "Utils/FrameArena.h"
+#include "Utils/PoolHandle.h"
 
 #include "Math/float4x4.h"
 #include "Geometry/Sphere.h"
-#include <vector>
+#include "Geometry/AABB.h"
 
 class ComponentMaterial;
+class ComponentLight;
 struct aiMesh;
 
 class ComponentMesh : public Component {
@@ -15,13 +18,22 @@ public:
 	REGISTER_COMPONENT(ComponentMesh, ComponentType::MESH);
 
 	void OnEditorUpdate() override;
-	void Save(JsonValue jComponent) const override;
-	void Load(JsonValue jComponent) override;
+	void Save(JsonWriter& writer) const override;
+	void Load(ConstJsonValue jComponent) override;
+	void Save(BinaryWriter& writer) const override;
+	void Load(BinaryReader& reader) override;
 
-	void Draw(const std::vector<ComponentMaterial*>& materials, const float4x4& modelMatrix) const;
+	// Picks the level of detail of the next draws from the size of the bounding sphere on screen
+	void SelectLod(const AABB& worldAABB);
+	void Draw(const FrameVector<ComponentMaterial*>& materials, const float4x4& modelMatrix) const;
+	void GatherLights(ComponentLight*& directionalLight, FrameVector<ComponentLight*>& pointLights, FrameVector<ComponentLight*>& spotLights) const; // Lights that affect this mesh. Allocated in the frame arena.
+
+	Mesh* GetMesh() const; // nullptr if the Mesh has been released
 
 public:
-	Mesh* mesh = nullptr;
+	PoolHandle<Mesh> mesh; // Handle, so that a released Mesh whose slot is reused is never drawn
+	unsigned materialIndex = 0; // Kept here and not in the Mesh, which is shared by every mesh with the same geometry
+	unsigned lod = 0;
 
 private:
 	bool bbActive = false;
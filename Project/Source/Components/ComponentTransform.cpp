@@ -4,9 +4,13 @@
 #include "Resources/GameObject.h"
 #include "Components/ComponentCamera.h"
 #include "Components/ComponentBoundingBox.h"
+#include "FileSystem/BinaryWriter.h"
+#include "FileSystem/BinaryReader.h"
 #include "Modules/ModuleEditor.h"
 #include "Modules/ModuleInput.h"
 #include "Modules/ModuleCamera.h"
+#include "Modules/ModuleScene.h"
+#include "Modules/ModuleTime.h"
 
 #include "Math/float3x3.h"
 #include "SDL.h"
@@ -19,6 +23,7 @@
 #define JSON_TAG_LOCAL_EULER_ANGLES "LocalEulerAngles"
 
 void ComponentTransform::Init() {
+	SaveFixedStepState();
 	CalculateGlobalMatrix();
 	for (Component* component : GetOwner().components) {
 		component->OnTransformUpdate();
@@ -27,6 +32,7 @@ void ComponentTransform::Init() {
 
 void ComponentTransform::Update() {
 	CalculateGlobalMatrix();
+	CalculateRenderMatrix();
 }
 
 void ComponentTransform::OnEditorUpdate() {
@@ -50,43 +56,69 @@ void ComponentTransform::OnEditorUpdate() {
 	}
 }
 
-void ComponentTransform::Save(JsonValue jComponent) const {
-	JsonValue jPosition = jComponent[JSON_TAG_POSITION];
-	jPosition[0] = position.x;
-	jPosition[1] = position.y;
-	jPosition[2] = position.z;
-
-	JsonValue jRotation = jComponent[JSON_TAG_ROTATION];
-	jRotation[0] = rotation.x;
-	jRotation[1] = rotation.y;
-	jRotation[2] = rotation.z;
-	jRotation[3] = rotation.w;
-
-	JsonValue jScale = jComponent[JSON_TAG_SCALE];
-	jScale[0] = scale.x;
-	jScale[1] = scale.y;
-	jScale[2] = scale.z;
-
-	JsonValue jLocalEulerAngles = jComponent[JSON_TAG_LOCAL_EULER_ANGLES];
-	jLocalEulerAngles[0] = localEulerAngles.x;
-	jLocalEulerAngles[1] = localEulerAngles.y;
-	jLocalEulerAngles[2] = localEulerAngles.z;
-}
-
-void ComponentTransform::Load(JsonValue jComponent) {
-	JsonValue jPosition = jComponent[JSON_TAG_POSITION];
+void ComponentTransform::Save(JsonWriter& writer) const {
+	writer.Key(JSON_TAG_POSITION);
+	writer.StartArray();
+	writer.Write(position.x);
+	writer.Write(position.y);
+	writer.Write(position.z);
+	writer.EndArray();
+
+	writer.Key(JSON_TAG_ROTATION);
+	writer.StartArray();
+	writer.Write(rotation.x);
+	writer.Write(rotation.y);
+	writer.Write(rotation.z);
+	writer.Write(rotation.w);
+	writer.EndArray();
+
+	writer.Key(JSON_TAG_SCALE);
+	writer.StartArray();
+	writer.Write(scale.x);
+	writer.Write(scale.y);
+	writer.Write(scale.z);
+	writer.EndArray();
+
+	writer.Key(JSON_TAG_LOCAL_EULER_ANGLES);
+	writer.StartArray();
+	writer.Write(localEulerAngles.x);
+	writer.Write(localEulerAngles.y);
+	writer.Write(localEulerAngles.z);
+	writer.EndArray();
+}
+
+void ComponentTransform::Load(ConstJsonValue jComponent) {
+	ConstJsonValue jPosition = jComponent[JSON_TAG_POSITION];
 	position.Set(jPosition[0], jPosition[1], jPosition[2]);
 
-	JsonValue jRotation = jComponent[JSON_TAG_ROTATION];
+	ConstJsonValue jRotation = jComponent[JSON_TAG_ROTATION];
 	rotation.Set(jRotation[0], jRotation[1], jRotation[2], jRotation[3]);
 
-	JsonValue jScale = jComponent[JSON_TAG_SCALE];
+	ConstJsonValue jScale = jComponent[JSON_TAG_SCALE];
 	scale.Set(jScale[0], jScale[1], jScale[2]);
 
-	JsonValue jLocalEulerAngles = jComponent[JSON_TAG_LOCAL_EULER_ANGLES];
+	ConstJsonValue jLocalEulerAngles = jComponent[JSON_TAG_LOCAL_EULER_ANGLES];
 	localEulerAngles.Set(jLocalEulerAngles[0], jLocalEulerAngles[1], jLocalEulerAngles[2]);
 
 	dirty = true;
+	SaveFixedStepState();
+}
+
+void ComponentTransform::Save(BinaryWriter& writer) const {
+	writer.Write(position);
+	writer.Write(rotation);
+	writer.Write(scale);
+	writer.Write(localEulerAngles);
+}
+
+void ComponentTransform::Load(BinaryReader& reader) {
+	position = reader.Read<float3>();
+	rotation = reader.Read<Quat>();
+	scale = reader.Read<float3>();
+	localEulerAngles = reader.Read<float3>();
+
+	dirty = true;
+	SaveFixedStepState();
 }
 
 void ComponentTransform::InvalidateHierarchy() {
@@ -108,6 +140,7 @@ void ComponentTransform::Invalidate() {
 
 void ComponentTransform::SetPosition(float3 position_) {
 	position = position_;
+	if (!App->scene->simulatingFixedStep) SaveFixedStepState(); // Changes outside fixed steps are not interpolated
 	InvalidateHierarchy();
 	for (Component* component : GetOwner().components) {
 		component->OnTransformUpdate();
@@ -117,6 +150,7 @@ void ComponentTransform::SetPosition(float3 position_) {
 void ComponentTransform::SetRotation(Quat rotation_) {
 	rotation = rotation_;
 	localEulerAngles = rotation_.ToEulerXYZ().Mul(RADTODEG);
+	if (!App->scene->simulatingFixedStep) SaveFixedStepState(); // Changes outside fixed steps are not interpolated
 	InvalidateHierarchy();
 	for (Component* component : GetOwner().components) {
 		component->OnTransformUpdate();
@@ -126,6 +160,7 @@ void ComponentTransform::SetRotation(Quat rotation_) {
 void ComponentTransform::SetRotation(float3 rotation_) {
 	rotation = Quat::FromEulerXYZ(rotation_.x * DEGTORAD, rotation_.y * DEGTORAD, rotation_.z * DEGTORAD);
 	localEulerAngles = rotation_;
+	if (!App->scene->simulatingFixedStep) SaveFixedStepState(); // Changes outside fixed steps are not interpolated
 	InvalidateHierarchy();
 	for (Component* component : GetOwner().components) {
 		component->OnTransformUpdate();
@@ -134,6 +169,7 @@ void ComponentTransform::SetRotation(float3 rotation_) {
 
 void ComponentTransform::SetScale(float3 scale_) {
 	scale = scale_;
+	if (!App->scene->simulatingFixedStep) SaveFixedStepState(); // Changes outside fixed steps are not interpolated
 	InvalidateHierarchy();
 	for (Component* component : GetOwner().components) {
 		component->OnTransformUpdate();
@@ -158,6 +194,36 @@ void ComponentTransform::CalculateGlobalMatrix(bool force) {
 	}
 }
 
+void ComponentTransform::SaveFixedStepState() {
+	previousPosition = position;
+	previousRotation = rotation;
+	previousScale = scale;
+}
+
+void ComponentTransform::CalculateRenderMatrix() {
+	unsigned frame = App->time->GetFrameCount();
+	if (renderMatrixFrame == frame) return;
+	renderMatrixFrame = frame;
+
+	CalculateGlobalMatrix();
+
+	float4x4 renderLocalMatrix = localMatrix;
+	if (!previousPosition.BitEquals(position) || !previousRotation.BitEquals(rotation) || !previousScale.BitEquals(scale)) {
+		float alpha = App->time->GetFixedStepAlpha();
+		renderLocalMatrix = float4x4::FromTRS(previousPosition.Lerp(position, alpha), previousRotation.Slerp(rotation, alpha), previousScale.Lerp(scale, alpha));
+	}
+
+	GameObject* parent = GetOwner().GetParent();
+	if (parent != nullptr) {
+		ComponentTransform* parentTransform = parent->GetComponent<ComponentTransform>();
+
+		parentTransform->CalculateRenderMatrix();
+		renderMatrix = parentTransform->renderMatrix * renderLocalMatrix;
+	} else {
+		renderMatrix = renderLocalMatrix;
+	}
+}
+
 float3 ComponentTransform::GetPosition() const {
 	return position;
 }
@@ -178,6 +244,10 @@ const float4x4& ComponentTransform::GetGlobalMatrix() const {
 	return globalMatrix;
 }
 
+const float4x4& ComponentTransform::GetRenderMatrix() const {
+	return renderMatrix;
+}
+
 bool ComponentTransform::GetDirty() const {
 	return dirty;
 }
\ No newline at end of file
@@ -14,8 +14,10 @@ public:
 	void Init() override;
 	void Update() override;
 	void OnEditorUpdate() override;
-	void Save(JsonValue jComponent) const override;
-	void Load(JsonValue jComponent) override;
+	void Save(JsonWriter& writer) const override;
+	void Load(ConstJsonValue jComponent) override;
+	void Save(BinaryWriter& writer) const override;
+	void Load(BinaryReader& reader) override;
 
 	void InvalidateHierarchy();
 	void Invalidate();
@@ -25,12 +27,15 @@ public:
 	void SetRotation(float3 rotation);
 	void SetScale(float3 scale);
 	void CalculateGlobalMatrix(bool force = false);
+	void SaveFixedStepState(); // Called before each fixed step. The render matrix is interpolated from this state.
+	void CalculateRenderMatrix();
 
 	float3 GetPosition() const;
 	Quat GetRotation() const;
 	float3 GetScale() const;
 	const float4x4& GetLocalMatrix() const;
 	const float4x4& GetGlobalMatrix() const;
+	const float4x4& GetRenderMatrix() const; // Global matrix interpolated between the last two fixed steps
 
 	bool GetDirty() const;
 
@@ -44,4 +49,11 @@ private:
 	bool dirty = true;
 	float4x4 localMatrix = float4x4::identity;
 	float4x4 globalMatrix = float4x4::identity;
+
+	// Render interpolation
+	float3 previousPosition = float3::zero;
+	Quat previousRotation = Quat::identity;
+	float3 previousScale = float3::one;
+	float4x4 renderMatrix = float4x4::identity;
+	unsigned renderMatrixFrame = 0;
 };
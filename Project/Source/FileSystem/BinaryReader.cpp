@@ -0,0 +1,74 @@
+#include "BinaryReader.h"
+
+#include "Utils/Leaks.h"
+
+BinaryReader::BinaryReader(const char* data_, size_t size_)
+	: data(data_)
+	, size(size_) {}
+
+void BinaryReader::ReadBytes(void* bytes, size_t numBytes) {
+	if (failed || numBytes > size - cursor) {
+		failed = true;
+		memset(bytes, 0, numBytes);
+		return;
+	}
+
+	memcpy(bytes, data + cursor, numBytes);
+	cursor += numBytes;
+}
+
+void BinaryReader::Skip(size_t numBytes) {
+	if (failed || numBytes > size - cursor) {
+		failed = true;
+		return;
+	}
+
+	cursor += numBytes;
+}
+
+bool BinaryReader::ReadStringTable() {
+	unsigned numStrings = Read<unsigned>();
+	strings.clear();
+	if (numStrings > size - cursor) { // Every string takes at least 5 bytes
+		failed = true;
+		return false;
+	}
+	strings.reserve(numStrings);
+	for (unsigned i = 0; i < numStrings && !failed; ++i) {
+		unsigned length = Read<unsigned>();
+		const char* string = data + cursor;
+		Skip(length + 1);
+		if (failed || string[length] != '\0') {
+			failed = true;
+			break;
+		}
+		strings.push_back(InternedString(string, length));
+	}
+
+	return !failed;
+}
+
+InternedString BinaryReader::ReadString() {
+	return GetString(Read<unsigned>());
+}
+
+InternedString BinaryReader::GetString(unsigned index) const {
+	return index < strings.size() ? strings[index] : InternedString();
+}
+
+size_t BinaryReader::Tell() const {
+	return cursor;
+}
+
+void BinaryReader::Seek(size_t offset) {
+	if (offset > size) {
+		failed = true;
+		return;
+	}
+
+	cursor = offset;
+}
+
+bool BinaryReader::HasFailed() const {
+	return failed;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Utils/InternedString.h"
+
+#include <vector>
+#include <string.h>
+
+/* Reads plain values from a byte buffer written with BinaryWriter.
+*  Reading past the end doesn't crash: it returns zeroed values and marks the reader as failed.
+*  The strings of the string table are interned once when the table is read.
+*/
+
+class BinaryReader {
+public:
+	BinaryReader(const char* data, size_t size);
+
+	// Only for trivially copyable types
+	template<typename T> T Read();
+	void ReadBytes(void* bytes, size_t size);
+	void Skip(size_t size);
+
+	bool ReadStringTable();
+	InternedString ReadString();
+	InternedString GetString(unsigned index) const;
+
+	size_t Tell() const;
+	void Seek(size_t offset);
+	bool HasFailed() const;
+
+private:
+	const char* data = nullptr;
+	size_t size = 0;
+	size_t cursor = 0;
+	bool failed = false;
+
+	std::vector<InternedString> strings;
+};
+
+template<typename T>
+inline T BinaryReader::Read() {
+	T value;
+	ReadBytes(&value, sizeof(T));
+	return value;
+}
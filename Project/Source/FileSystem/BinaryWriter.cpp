@@ -0,0 +1,48 @@
+#include "BinaryWriter.h"
+
+#include "Utils/Leaks.h"
+
+void BinaryWriter::Reserve(size_t size) {
+	data.reserve(size);
+}
+
+void BinaryWriter::Clear() {
+	data.clear();
+	strings.clear();
+	stringIndices.Clear();
+}
+
+void BinaryWriter::WriteBytes(const void* bytes, size_t size) {
+	const char* begin = (const char*) bytes;
+	data.insert(data.end(), begin, begin + size);
+}
+
+void BinaryWriter::WriteString(InternedString string) {
+	Write(AddString(string));
+}
+
+unsigned BinaryWriter::AddString(InternedString string) {
+	unsigned* existingIndex = stringIndices.Find(string.Id());
+	if (existingIndex != nullptr) return *existingIndex;
+
+	unsigned index = (unsigned) strings.size();
+	stringIndices[string.Id()] = index;
+	strings.push_back(string);
+	return index;
+}
+
+void BinaryWriter::WriteStringTable(BinaryWriter& output) const {
+	output.Write((unsigned) strings.size());
+	for (InternedString string : strings) {
+		output.Write(string.size());
+		output.WriteBytes(string.c_str(), string.size() + 1);
+	}
+}
+
+const char* BinaryWriter::Data() const {
+	return data.data();
+}
+
+size_t BinaryWriter::Size() const {
+	return data.size();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Utils/InternedString.h"
+#include "Utils/FlatHashMap.h"
+
+#include <vector>
+#include <string.h>
+
+/* Appends plain values to a growable byte buffer.
+*  Strings are not written inline: they are added to a string table and only their index is written,
+*  so repeated strings (mesh and texture file names) are stored once. Strings are deduplicated by their interned id.
+*/
+
+class BinaryWriter {
+public:
+	void Reserve(size_t size);
+	void Clear();
+
+	// Only for trivially copyable types
+	template<typename T> void Write(const T& value);
+	template<typename T> void Overwrite(size_t offset, const T& value);
+	void WriteBytes(const void* bytes, size_t size);
+
+	void WriteString(InternedString string);
+	unsigned AddString(InternedString string);
+	void WriteStringTable(BinaryWriter& output) const;
+
+	const char* Data() const;
+	size_t Size() const;
+
+private:
+	std::vector<char> data;
+	std::vector<InternedString> strings;
+	FlatHashMap<unsigned> stringIndices; // Indexed by the id of the interned string
+};
+
+template<typename T>
+inline void BinaryWriter::Write(const T& value) {
+	WriteBytes(&value, sizeof(T));
+}
+
+template<typename T>
+inline void BinaryWriter::Overwrite(size_t offset, const T& value) {
+	memcpy(&data[offset], &value, sizeof(T));
+}
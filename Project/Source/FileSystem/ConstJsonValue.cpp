@@ -0,0 +1,82 @@
+#include "ConstJsonValue.h"
+
+#include "Utils/Leaks.h"
+
+static const rapidjson::Value nullValue;
+
+ConstJsonValue::ConstJsonValue(const rapidjson::Value& value_)
+	: value(value_) {
+	if (value.IsObject()) {
+		nextMember = value.MemberBegin();
+	}
+}
+
+size_t ConstJsonValue::Size() const {
+	return value.IsArray() ? value.Size() : 0;
+}
+
+ConstJsonValue ConstJsonValue::operator[](unsigned index) const {
+	if (!value.IsArray() || index >= value.Size()) {
+		return ConstJsonValue(nullValue);
+	}
+
+	return ConstJsonValue(value[index]);
+}
+
+const rapidjson::Value& ConstJsonValue::FindMember(const char* key) const {
+	if (!value.IsObject()) return nullValue;
+
+	rapidjson::SizeType keyLength = (rapidjson::SizeType) strlen(key);
+	rapidjson::Value::ConstMemberIterator member = nextMember;
+	for (rapidjson::SizeType i = 0; i < value.MemberCount(); ++i) {
+		if (member == value.MemberEnd()) {
+			member = value.MemberBegin();
+		}
+
+		const rapidjson::Value& name = member->name;
+		if (name.GetStringLength() == keyLength && memcmp(name.GetString(), key, keyLength) == 0) {
+			nextMember = member + 1;
+			return member->value;
+		}
+
+		++member;
+	}
+
+	return nullValue;
+}
+
+ConstJsonValue::operator bool() const {
+	return value.IsBool() ? value.GetBool() : false;
+}
+
+ConstJsonValue::operator int() const {
+	return value.IsInt() ? value.GetInt() : 0;
+}
+
+ConstJsonValue::operator unsigned() const {
+	return value.IsUint() ? value.GetUint() : 0;
+}
+
+ConstJsonValue::operator long long() const {
+	return value.IsInt64() ? value.GetInt64() : 0;
+}
+
+ConstJsonValue::operator unsigned long long() const {
+	return value.IsUint64() ? value.GetUint64() : 0;
+}
+
+ConstJsonValue::operator float() const {
+	return value.IsNumber() ? value.GetFloat() : 0;
+}
+
+ConstJsonValue::operator double() const {
+	return value.IsNumber() ? value.GetDouble() : 0;
+}
+
+ConstJsonValue::operator std::string() const {
+	return value.IsString() ? value.GetString() : "";
+}
+
+ConstJsonValue::operator InternedString() const {
+	return value.IsString() ? InternedString(value.GetString(), value.GetStringLength()) : InternedString();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "Utils/InternedString.h"
+
+#include "rapidjson/document.h"
+#include "string"
+
+/* Read-only counterpart of JsonValue, used when loading.
+*  Missing members and out of range elements read as null, so the document is never modified.
+*  Members are searched starting after the last one found, so reading them in the order they were saved doesn't rescan the object.
+*/
+
+class ConstJsonValue {
+public:
+	ConstJsonValue(const rapidjson::Value& value);
+
+	// Size of the array. Returns 0 if the value is not an array.
+	size_t Size() const;
+
+	// Object/array access (Returns a null value if the member or element doesn't exist)
+	template<typename T> ConstJsonValue operator[](T* key) const;
+	ConstJsonValue operator[](unsigned index) const;
+
+	// Conversion operators for easy access
+	operator bool() const;
+	operator int() const;
+	operator unsigned() const;
+	operator long long() const;
+	operator unsigned long long() const;
+	operator float() const;
+	operator double() const;
+	operator std::string() const;
+	operator InternedString() const;
+
+private:
+	const rapidjson::Value& FindMember(const char* key) const;
+
+private:
+	const rapidjson::Value& value;
+	mutable rapidjson::Value::ConstMemberIterator nextMember;
+};
+
+// Template is necessary to disambiguate with 'operator[](unsigned index)'
+template<typename T>
+inline ConstJsonValue ConstJsonValue::operator[](T* key) const {
+	return ConstJsonValue(FindMember(key));
+}
@@ -0,0 +1,267 @@
+#include "DDS.h"
+
+#include "Math/MathFunc.h"
+#include "Math/myassert.h"
+#include "GL/glew.h"
+#include <string.h>
+
+#include "Utils/Leaks.h"
+
+#define DDS_MAGIC 0x20534444 // "DDS "
+#define DDS_HEADER_SIZE 124
+#define DDS_PIXEL_FORMAT_SIZE 32
+
+#define DDSD_CAPS 0x1
+#define DDSD_HEIGHT 0x2
+#define DDSD_WIDTH 0x4
+#define DDSD_PIXELFORMAT 0x1000
+#define DDSD_MIPMAPCOUNT 0x20000
+#define DDSD_LINEARSIZE 0x80000
+#define DDPF_ALPHAPIXELS 0x1
+#define DDPF_FOURCC 0x4
+#define DDSCAPS_COMPLEX 0x8
+#define DDSCAPS_TEXTURE 0x1000
+#define DDSCAPS_MIPMAP 0x400000
+
+#define MAKE_FOURCC(a, b, c, d) ((unsigned) (a) | ((unsigned) (b) << 8) | ((unsigned) (c) << 16) | ((unsigned) (d) << 24))
+
+// DXGI formats that can appear in the DX10 extended header
+#define DXGI_FORMAT_BC1_UNORM 71
+#define DXGI_FORMAT_BC1_UNORM_SRGB 72
+#define DXGI_FORMAT_BC2_UNORM 74
+#define DXGI_FORMAT_BC2_UNORM_SRGB 75
+#define DXGI_FORMAT_BC3_UNORM 77
+#define DXGI_FORMAT_BC3_UNORM_SRGB 78
+#define DXGI_FORMAT_BC4_UNORM 80
+#define DXGI_FORMAT_BC5_UNORM 83
+#define DXGI_FORMAT_BC7_UNORM 98
+#define DXGI_FORMAT_BC7_UNORM_SRGB 99
+
+struct DDSPixelFormat {
+	unsigned size;
+	unsigned flags;
+	unsigned fourCC;
+	unsigned rgbBitCount;
+	unsigned rBitMask;
+	unsigned gBitMask;
+	unsigned bBitMask;
+	unsigned aBitMask;
+};
+
+struct DDSHeader {
+	unsigned size;
+	unsigned flags;
+	unsigned height;
+	unsigned width;
+	unsigned pitchOrLinearSize;
+	unsigned depth;
+	unsigned mipMapCount;
+	unsigned reserved1[11];
+	DDSPixelFormat pixelFormat;
+	unsigned caps;
+	unsigned caps2;
+	unsigned caps3;
+	unsigned caps4;
+	unsigned reserved2;
+};
+
+struct DDSHeaderDX10 {
+	unsigned dxgiFormat;
+	unsigned resourceDimension;
+	unsigned miscFlag;
+	unsigned arraySize;
+	unsigned miscFlags2;
+};
+
+static DDS::Format GetFormatFromFourCC(const DDSPixelFormat& pixelFormat) {
+	switch (pixelFormat.fourCC) {
+	case MAKE_FOURCC('D', 'X', 'T', '1'):
+		return (pixelFormat.flags & DDPF_ALPHAPIXELS) ? DDS::Format::BC1_ALPHA : DDS::Format::BC1;
+	case MAKE_FOURCC('D', 'X', 'T', '2'):
+	case MAKE_FOURCC('D', 'X', 'T', '3'):
+		return DDS::Format::BC2;
+	case MAKE_FOURCC('D', 'X', 'T', '4'):
+	case MAKE_FOURCC('D', 'X', 'T', '5'):
+		return DDS::Format::BC3;
+	case MAKE_FOURCC('A', 'T', 'I', '1'):
+	case MAKE_FOURCC('B', 'C', '4', 'U'):
+		return DDS::Format::BC4;
+	case MAKE_FOURCC('A', 'T', 'I', '2'):
+	case MAKE_FOURCC('B', 'C', '5', 'U'):
+		return DDS::Format::BC5;
+	default:
+		return DDS::Format::UNKNOWN;
+	}
+}
+
+static DDS::Format GetFormatFromDXGI(unsigned dxgiFormat) {
+	switch (dxgiFormat) {
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		return DDS::Format::BC1_ALPHA;
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+		return DDS::Format::BC2;
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+		return DDS::Format::BC3;
+	case DXGI_FORMAT_BC4_UNORM:
+		return DDS::Format::BC4;
+	case DXGI_FORMAT_BC5_UNORM:
+		return DDS::Format::BC5;
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return DDS::Format::BC7;
+	default:
+		return DDS::Format::UNKNOWN;
+	}
+}
+
+bool DDS::Parse(const char* data, size_t size, Image& image) {
+	const char* cursor = data;
+	const char* end = data + size;
+
+	// Magic number and header
+	if (size < sizeof(unsigned) + sizeof(DDSHeader)) return false;
+	unsigned magic;
+	memcpy(&magic, cursor, sizeof(unsigned));
+	cursor += sizeof(unsigned);
+	if (magic != DDS_MAGIC) return false;
+
+	DDSHeader header;
+	memcpy(&header, cursor, sizeof(DDSHeader));
+	cursor += sizeof(DDSHeader);
+	if (header.size != DDS_HEADER_SIZE || header.pixelFormat.size != DDS_PIXEL_FORMAT_SIZE) return false;
+	if ((header.pixelFormat.flags & DDPF_FOURCC) == 0) return false;
+
+	// Format
+	if (header.pixelFormat.fourCC == MAKE_FOURCC('D', 'X', '1', '0')) {
+		if (end - cursor < (ptrdiff_t) sizeof(DDSHeaderDX10)) return false;
+		DDSHeaderDX10 headerDX10;
+		memcpy(&headerDX10, cursor, sizeof(DDSHeaderDX10));
+		cursor += sizeof(DDSHeaderDX10);
+		if (headerDX10.arraySize > 1) return false;
+
+		image.format = GetFormatFromDXGI(headerDX10.dxgiFormat);
+	} else {
+		image.format = GetFormatFromFourCC(header.pixelFormat);
+	}
+	if (image.format == Format::UNKNOWN) return false;
+
+	// Mip levels
+	image.width = header.width;
+	image.height = header.height;
+	unsigned numLevels = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? header.mipMapCount : 1;
+	image.levels.clear();
+	image.levels.reserve(numLevels);
+
+	unsigned width = header.width;
+	unsigned height = header.height;
+	for (unsigned i = 0; i < numLevels; ++i) {
+		unsigned levelSize = GetLevelSize(image.format, width, height);
+		if (end - cursor < (ptrdiff_t) levelSize) break; // Truncated file: keep the complete levels
+
+		Level level;
+		level.width = width;
+		level.height = height;
+		level.data = cursor;
+		level.size = levelSize;
+		image.levels.push_back(level);
+
+		cursor += levelSize;
+		width = Max(width / 2, 1u);
+		height = Max(height / 2, 1u);
+	}
+
+	return !image.levels.empty();
+}
+
+unsigned DDS::GetHeaderSize() {
+	return sizeof(unsigned) + sizeof(DDSHeader);
+}
+
+void DDS::WriteHeader(char* data, Format format, unsigned width, unsigned height, unsigned numLevels) {
+	DDSHeader header;
+	memset(&header, 0, sizeof(DDSHeader));
+	header.size = DDS_HEADER_SIZE;
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE | DDSD_MIPMAPCOUNT;
+	header.height = height;
+	header.width = width;
+	header.pitchOrLinearSize = GetLevelSize(format, width, height);
+	header.mipMapCount = numLevels;
+	header.pixelFormat.size = DDS_PIXEL_FORMAT_SIZE;
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.caps = DDSCAPS_TEXTURE | (numLevels > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	switch (format) {
+	case Format::BC1:
+		header.pixelFormat.fourCC = MAKE_FOURCC('D', 'X', 'T', '1');
+		break;
+	case Format::BC1_ALPHA:
+		header.pixelFormat.fourCC = MAKE_FOURCC('D', 'X', 'T', '1');
+		header.pixelFormat.flags |= DDPF_ALPHAPIXELS;
+		break;
+	case Format::BC2:
+		header.pixelFormat.fourCC = MAKE_FOURCC('D', 'X', 'T', '3');
+		break;
+	case Format::BC3:
+		header.pixelFormat.fourCC = MAKE_FOURCC('D', 'X', 'T', '5');
+		break;
+	case Format::BC4:
+		header.pixelFormat.fourCC = MAKE_FOURCC('A', 'T', 'I', '1');
+		break;
+	case Format::BC5:
+		header.pixelFormat.fourCC = MAKE_FOURCC('A', 'T', 'I', '2');
+		break;
+	default:
+		assert(false); // Format needs the DX10 header
+		break;
+	}
+
+	unsigned magic = DDS_MAGIC;
+	memcpy(data, &magic, sizeof(unsigned));
+	memcpy(data + sizeof(unsigned), &header, sizeof(DDSHeader));
+}
+
+unsigned DDS::GetBlockSize(Format format) {
+	switch (format) {
+	case Format::BC1:
+	case Format::BC1_ALPHA:
+	case Format::BC4:
+		return 8;
+	case Format::BC2:
+	case Format::BC3:
+	case Format::BC5:
+	case Format::BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+unsigned DDS::GetLevelSize(Format format, unsigned width, unsigned height) {
+	unsigned blocksX = Max((width + 3) / 4, 1u);
+	unsigned blocksY = Max((height + 3) / 4, 1u);
+	return blocksX * blocksY * GetBlockSize(format);
+}
+
+unsigned DDS::GetGLInternalFormat(Format format) {
+	switch (format) {
+	case Format::BC1:
+		return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+	case Format::BC1_ALPHA:
+		return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : 0;
+	case Format::BC2:
+		return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT3_EXT : 0;
+	case Format::BC3:
+		return GLEW_EXT_texture_compression_s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+	case Format::BC4:
+		return GL_COMPRESSED_RED_RGTC1; // Core since OpenGL 3.0
+	case Format::BC5:
+		return GL_COMPRESSED_RG_RGTC2; // Core since OpenGL 3.0
+	case Format::BC7:
+		return GLEW_ARB_texture_compression_bptc ? GL_COMPRESSED_RGBA_BPTC_UNORM : 0;
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+/* Minimal reader and writer for the DDS container.
+*  Only block-compressed formats are understood. The parsed image points into the given file data,
+*  so that the blocks can be uploaded to the GPU without any copy or decompression.
+*/
+
+namespace DDS {
+	enum class Format {
+		UNKNOWN,
+		BC1,
+		BC1_ALPHA,
+		BC2,
+		BC3,
+		BC4,
+		BC5,
+		BC7
+	};
+
+	struct Level {
+		unsigned width = 0;
+		unsigned height = 0;
+		const char* data = nullptr;
+		unsigned size = 0;
+	};
+
+	struct Image {
+		Format format = Format::UNKNOWN;
+		unsigned width = 0;
+		unsigned height = 0;
+		std::vector<Level> levels;
+	};
+
+	// Returns false if the data is not a DDS file or its format is not block-compressed
+	bool Parse(const char* data, size_t size, Image& image);
+
+	// Writes the magic number and the header. The levels have to be written right after it, from biggest to smallest.
+	// Only formats with a FourCC code (BC1-BC5) can be written.
+	unsigned GetHeaderSize();
+	void WriteHeader(char* data, Format format, unsigned width, unsigned height, unsigned numLevels);
+
+	unsigned GetBlockSize(Format format);
+	unsigned GetLevelSize(Format format, unsigned width, unsigned height);
+
+	// OpenGL internal format for the given block format. Returns 0 if the driver doesn't support it.
+	unsigned GetGLInternalFormat(Format format);
+} // namespace DDS
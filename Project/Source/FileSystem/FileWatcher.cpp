@@ -0,0 +1,214 @@
+#include "FileWatcher.h"
+
+#include "Globals.h"
+#include "Utils/Logging.h"
+#include "Utils/Profiling.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#include "Utils/Leaks.h"
+
+// Time without events before a change is reported
+#define FILE_WATCHER_COALESCE_MS 200
+#define FILE_WATCHER_BUFFER_SIZE 16384
+
+static std::string JoinPath(const std::string& folderPath, const char* fileName) {
+	if (folderPath.empty()) return fileName;
+	return folderPath + "/" + fileName;
+}
+
+#ifdef _WIN32
+
+struct FileWatch {
+	std::string folderPath;
+	HANDLE directory = INVALID_HANDLE_VALUE;
+	OVERLAPPED overlapped = {};
+	bool reading = false;
+	DWORD buffer[FILE_WATCHER_BUFFER_SIZE / sizeof(DWORD)]; // The notifications must be DWORD aligned
+};
+
+static void ReadChanges(FileWatch* watch) {
+	ResetEvent(watch->overlapped.hEvent);
+	watch->reading = ReadDirectoryChangesW(watch->directory, watch->buffer, sizeof(watch->buffer), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE, nullptr, &watch->overlapped, nullptr) != FALSE;
+}
+
+static void CloseWatch(FileWatch* watch) {
+	// The pending read has to finish before the buffer is freed
+	if (watch->reading) {
+		DWORD bytes = 0;
+		CancelIo(watch->directory);
+		GetOverlappedResult(watch->directory, &watch->overlapped, &bytes, TRUE);
+	}
+	CloseHandle(watch->directory);
+	CloseHandle(watch->overlapped.hEvent);
+	delete watch;
+}
+
+static FileWatch* OpenWatch(const char* folderPath) {
+	HANDLE directory = CreateFileA(*folderPath != '\0' ? folderPath : ".", FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+	if (directory == INVALID_HANDLE_VALUE) return nullptr;
+
+	FileWatch* watch = new FileWatch();
+	watch->folderPath = folderPath;
+	watch->directory = directory;
+	watch->overlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	ReadChanges(watch);
+	if (!watch->reading) {
+		CloseWatch(watch);
+		return nullptr;
+	}
+	return watch;
+}
+
+static void ReadEvents(FileWatch* watch, std::vector<std::string>& events) {
+	if (!watch->reading) return;
+
+	DWORD bytes = 0;
+	if (!GetOverlappedResult(watch->directory, &watch->overlapped, &bytes, FALSE)) {
+		if (GetLastError() == ERROR_IO_INCOMPLETE) return;
+		LOG_WARNING(LogCategory::GENERAL, "Error watching folder \"%s\".", watch->folderPath.c_str());
+		ReadChanges(watch);
+		return;
+	}
+
+	// No bytes means that the buffer overflowed and the events were lost
+	const char* cursor = (const char*) watch->buffer;
+	while (bytes > 0) {
+		const FILE_NOTIFY_INFORMATION* info = (const FILE_NOTIFY_INFORMATION*) cursor;
+		if (info->Action == FILE_ACTION_ADDED || info->Action == FILE_ACTION_MODIFIED || info->Action == FILE_ACTION_RENAMED_NEW_NAME) {
+			char fileName[MAX_PATH];
+			int length = WideCharToMultiByte(CP_ACP, 0, info->FileName, info->FileNameLength / sizeof(WCHAR), fileName, sizeof(fileName) - 1, nullptr, nullptr);
+			fileName[length] = '\0';
+			events.push_back(JoinPath(watch->folderPath, fileName));
+		}
+
+		if (info->NextEntryOffset == 0) break;
+		cursor += info->NextEntryOffset;
+	}
+
+	ReadChanges(watch);
+}
+
+#else
+
+struct FileWatch {
+	std::string folderPath;
+	int notifyFd = -1;
+};
+
+static void CloseWatch(FileWatch* watch) {
+	close(watch->notifyFd);
+	delete watch;
+}
+
+static FileWatch* OpenWatch(const char* folderPath) {
+	int notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (notifyFd < 0) return nullptr;
+
+	// Closing after a write or moving into the folder means that the file is complete
+	if (inotify_add_watch(notifyFd, *folderPath != '\0' ? folderPath : ".", IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		close(notifyFd);
+		return nullptr;
+	}
+
+	FileWatch* watch = new FileWatch();
+	watch->folderPath = folderPath;
+	watch->notifyFd = notifyFd;
+	return watch;
+}
+
+static void ReadEvents(FileWatch* watch, std::vector<std::string>& events) {
+	alignas(struct inotify_event) char buffer[FILE_WATCHER_BUFFER_SIZE];
+	while (true) {
+		ssize_t bytes = read(watch->notifyFd, buffer, sizeof(buffer));
+		if (bytes <= 0) {
+			if (bytes < 0 && errno != EAGAIN && errno != EINTR) {
+				LOG_WARNING(LogCategory::GENERAL, "Error watching folder \"%s\".", watch->folderPath.c_str());
+			}
+			return;
+		}
+
+		const char* cursor = buffer;
+		while (cursor < buffer + bytes) {
+			const struct inotify_event* event = (const struct inotify_event*) cursor;
+			if (event->len > 0) {
+				events.push_back(JoinPath(watch->folderPath, event->name));
+			}
+			cursor += sizeof(struct inotify_event) + event->len;
+		}
+	}
+}
+
+#endif
+
+FileWatcher::~FileWatcher() {
+	Clear();
+}
+
+bool FileWatcher::Watch(const char* folderPath) {
+	for (FileWatch* watch : watches) {
+		if (watch->folderPath == folderPath) return true;
+	}
+
+	FileWatch* watch = OpenWatch(folderPath);
+	if (watch == nullptr) {
+		LOG_WARNING(LogCategory::GENERAL, "Unable to watch folder \"%s\".", folderPath);
+		return false;
+	}
+
+	LOG_VERBOSE(LogCategory::GENERAL, "Watching folder \"%s\".", folderPath);
+	watches.push_back(watch);
+	return true;
+}
+
+void FileWatcher::Clear() {
+	for (FileWatch* watch : watches) {
+		CloseWatch(watch);
+	}
+	watches.clear();
+	pendingChanges.clear();
+}
+
+void FileWatcher::Poll(std::vector<std::string>& changedFiles) {
+	unsigned long long nowNs = ProfilerNowNs();
+
+	for (FileWatch* watch : watches) {
+		ReadEvents(watch, events);
+	}
+
+	// Coalesce the events of each file
+	for (std::string& filePath : events) {
+		PendingChange* pendingChange = nullptr;
+		for (PendingChange& otherChange : pendingChanges) {
+			if (otherChange.filePath == filePath) {
+				pendingChange = &otherChange;
+				break;
+			}
+		}
+		if (pendingChange == nullptr) {
+			pendingChanges.emplace_back();
+			pendingChange = &pendingChanges.back();
+			pendingChange->filePath = std::move(filePath);
+		}
+		pendingChange->lastEventNs = nowNs;
+	}
+	events.clear();
+
+	// Report the files that have been quiet long enough
+	for (size_t i = 0; i < pendingChanges.size();) {
+		if (nowNs - pendingChanges[i].lastEventNs < FILE_WATCHER_COALESCE_MS * 1000000ull) {
+			i += 1;
+			continue;
+		}
+
+		changedFiles.push_back(std::move(pendingChanges[i].filePath));
+		pendingChanges[i] = std::move(pendingChanges.back());
+		pendingChanges.pop_back();
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct FileWatch; // Platform specific
+
+/* Watches folders for files that are written, created or renamed into them (ReadDirectoryChangesW on Windows, inotify on Linux).
+*  Editors and exporters usually write a file in several steps, so the events of each file are coalesced:
+*  a change is only reported once the file has been quiet for a while. Folders aren't watched recursively.
+*/
+
+class FileWatcher {
+public:
+	FileWatcher() {}
+	FileWatcher(const FileWatcher&) = delete;
+	FileWatcher& operator=(const FileWatcher&) = delete;
+	~FileWatcher();
+
+	bool Watch(const char* folderPath); // Watching the same folder twice does nothing
+	void Clear();
+
+	// Appends the files whose changes settled since the last call
+	void Poll(std::vector<std::string>& changedFiles);
+
+private:
+	struct PendingChange {
+		std::string filePath;
+		unsigned long long lastEventNs = 0;
+	};
+
+private:
+	std::vector<FileWatch*> watches;
+	std::vector<PendingChange> pendingChanges;
+	std::vector<std::string> events; // Reused between polls
+};
@@ -0,0 +1,268 @@
+#include "ImportDatabase.h"
+
+#include "Globals.h"
+#include "Application.h"
+#include "Utils/Logging.h"
+#include "Utils/Buffer.h"
+#include "Utils/FlatHashMap.h"
+#include "FileSystem/JsonValue.h"
+#include "FileSystem/ConstJsonValue.h"
+#include "Modules/ModuleFiles.h"
+
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/error/en.h"
+#include <string.h>
+#include <algorithm>
+
+#include "Utils/Leaks.h"
+
+#define JSON_TAG_RECORDS "Records"
+#define JSON_TAG_SOURCE_PATH "SourcePath"
+#define JSON_TAG_SOURCE_HASH "SourceHash"
+#define JSON_TAG_SETTINGS_HASH "SettingsHash"
+#define JSON_TAG_FILE_SIZE "FileSize"
+#define JSON_TAG_MODIFICATION_TIME "ModificationTime"
+#define JSON_TAG_ARTIFACTS "Artifacts"
+#define JSON_TAG_DEPENDENCIES "Dependencies"
+
+struct ImportDependency {
+	std::string sourcePath = "";
+	Hash sourceHash = 0;
+	Hash settingsHash = 0;
+};
+
+struct ImportRecord {
+	std::string sourcePath = "";
+	Hash sourceHash = 0;
+	Hash settingsHash = 0;
+	size_t fileSize = 0;
+	long long modificationTime = 0;
+	std::vector<std::string> artifactPaths;
+	std::vector<ImportDependency> dependencies;
+};
+
+static FlatHashMap<ImportRecord> records; // Indexed by the hash of the source path
+static bool dirty = false;
+
+// Both separators name the same file, and the file watcher always reports paths with '/'
+static std::string NormalizePath(const char* filePath) {
+	std::string path = filePath;
+	std::replace(path.begin(), path.end(), '\\', '/');
+	return path;
+}
+
+static Hash HashPath(const std::string& normalizedPath) {
+	return HashBuffer(normalizedPath.c_str(), normalizedPath.size());
+}
+
+static ImportRecord* FindRecord(const char* filePath) {
+	std::string normalizedPath = NormalizePath(filePath);
+	ImportRecord* record = records.Find(HashPath(normalizedPath));
+	if (record == nullptr || NormalizePath(record->sourcePath.c_str()) != normalizedPath) return nullptr;
+	return record;
+}
+
+static ImportRecord& ObtainRecord(const char* filePath) {
+	ImportRecord& record = records[HashPath(NormalizePath(filePath))];
+	record.sourcePath = filePath;
+	return record;
+}
+
+// Sources of old records may have been moved or deleted
+static void WatchSourceFolder(const char* filePath) {
+	std::string folderPath = App->files->GetFileFolder(filePath);
+	if (!folderPath.empty() && !App->files->Exists(folderPath.c_str())) return;
+
+	App->files->WatchFolder(folderPath.c_str());
+}
+
+void ImportDatabase::Load() {
+	records.Clear();
+	dirty = false;
+
+	if (!App->files->Exists(IMPORT_DATABASE_FILE_PATH)) return;
+
+	Buffer<char> buffer = App->files->Load(IMPORT_DATABASE_FILE_PATH);
+	if (buffer.Size() == 0) return;
+
+	rapidjson::Document document;
+	document.ParseInsitu(buffer.Data());
+	if (document.HasParseError()) {
+		LOG_WARNING(LogCategory::IMPORT, "Error parsing import database: %s (offset: %u)", rapidjson::GetParseError_En(document.GetParseError()), document.GetErrorOffset());
+		return;
+	}
+	ConstJsonValue jDatabase(document);
+
+	ConstJsonValue jRecords = jDatabase[JSON_TAG_RECORDS];
+	for (unsigned i = 0; i < jRecords.Size(); ++i) {
+		ConstJsonValue jRecord = jRecords[i];
+
+		std::string sourcePath = jRecord[JSON_TAG_SOURCE_PATH];
+		ImportRecord& record = ObtainRecord(sourcePath.c_str());
+		record.sourceHash = jRecord[JSON_TAG_SOURCE_HASH];
+		record.settingsHash = jRecord[JSON_TAG_SETTINGS_HASH];
+		record.fileSize = (size_t)(unsigned long long) jRecord[JSON_TAG_FILE_SIZE];
+		record.modificationTime = jRecord[JSON_TAG_MODIFICATION_TIME];
+		WatchSourceFolder(sourcePath.c_str());
+
+		ConstJsonValue jArtifacts = jRecord[JSON_TAG_ARTIFACTS];
+		for (unsigned j = 0; j < jArtifacts.Size(); ++j) {
+			std::string artifactPath = jArtifacts[j];
+			record.artifactPaths.push_back(artifactPath);
+		}
+
+		ConstJsonValue jDependencies = jRecord[JSON_TAG_DEPENDENCIES];
+		for (unsigned j = 0; j < jDependencies.Size(); ++j) {
+			ConstJsonValue jDependency = jDependencies[j];
+
+			std::string dependencyPath = jDependency[JSON_TAG_SOURCE_PATH];
+			ImportDependency dependency;
+			dependency.sourcePath = dependencyPath;
+			dependency.sourceHash = jDependency[JSON_TAG_SOURCE_HASH];
+			dependency.settingsHash = jDependency[JSON_TAG_SETTINGS_HASH];
+			record.dependencies.push_back(dependency);
+		}
+	}
+
+	LOG_INFO(LogCategory::IMPORT, "Import database loaded (%u records).", (unsigned) records.Size());
+}
+
+void ImportDatabase::Save() {
+	if (!dirty) return;
+
+	rapidjson::Document document;
+	document.SetObject();
+	JsonValue jDatabase(document, document);
+
+	JsonValue jRecords = jDatabase[JSON_TAG_RECORDS];
+	unsigned i = 0;
+	for (const FlatHashMap<ImportRecord>::Entry& entry : records) {
+		const ImportRecord& record = entry.value;
+		JsonValue jRecord = jRecords[i];
+
+		jRecord[JSON_TAG_SOURCE_PATH] = record.sourcePath.c_str();
+		jRecord[JSON_TAG_SOURCE_HASH] = record.sourceHash;
+		jRecord[JSON_TAG_SETTINGS_HASH] = record.settingsHash;
+		jRecord[JSON_TAG_FILE_SIZE] = (unsigned long long) record.fileSize;
+		jRecord[JSON_TAG_MODIFICATION_TIME] = record.modificationTime;
+
+		JsonValue jArtifacts = jRecord[JSON_TAG_ARTIFACTS];
+		for (unsigned j = 0; j < record.artifactPaths.size(); ++j) {
+			jArtifacts[j] = record.artifactPaths[j].c_str();
+		}
+
+		JsonValue jDependencies = jRecord[JSON_TAG_DEPENDENCIES];
+		for (unsigned j = 0; j < record.dependencies.size(); ++j) {
+			const ImportDependency& dependency = record.dependencies[j];
+			JsonValue jDependency = jDependencies[j];
+
+			jDependency[JSON_TAG_SOURCE_PATH] = dependency.sourcePath.c_str();
+			jDependency[JSON_TAG_SOURCE_HASH] = dependency.sourceHash;
+			jDependency[JSON_TAG_SETTINGS_HASH] = dependency.settingsHash;
+		}
+
+		i += 1;
+	}
+
+	rapidjson::StringBuffer stringBuffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(stringBuffer);
+	document.Accept(writer);
+
+	App->files->Save(IMPORT_DATABASE_FILE_PATH, stringBuffer.GetString(), stringBuffer.GetSize());
+	dirty = false;
+}
+
+bool ImportDatabase::GetSourceHash(const char* filePath, Hash& sourceHash) {
+	size_t fileSize = 0;
+	long long modificationTime = 0;
+	if (!App->files->GetFileStats(filePath, fileSize, modificationTime)) return false;
+
+	// Trust the stored hash if the file looks untouched
+	const ImportRecord* record = FindRecord(filePath);
+	if (record != nullptr && record->fileSize == fileSize && record->modificationTime == modificationTime) {
+		sourceHash = record->sourceHash;
+		return true;
+	}
+
+	Buffer<char> buffer = App->files->Load(filePath);
+	if (buffer.Size() == 0) return false;
+
+	// The loaded buffer has an extra null terminator that isn't part of the file
+	sourceHash = HashBuffer(buffer.Data(), buffer.Size() - 1);
+	return true;
+}
+
+bool ImportDatabase::IsUpToDate(const char* filePath, Hash sourceHash, Hash settingsHash) {
+	const ImportRecord* record = FindRecord(filePath);
+	if (record == nullptr) return false;
+
+	if (record->sourceHash != sourceHash || record->settingsHash != settingsHash) return false;
+
+	for (const std::string& artifactPath : record->artifactPaths) {
+		if (!App->files->Exists(artifactPath.c_str())) return false;
+	}
+
+	// A changed dependency leaves stale data in the artifacts, even if they all exist
+	for (const ImportDependency& dependency : record->dependencies) {
+		Hash dependencySourceHash;
+		if (!GetSourceHash(dependency.sourcePath.c_str(), dependencySourceHash)) return false;
+		if (dependencySourceHash != dependency.sourceHash) return false;
+
+		const ImportRecord* dependencyRecord = FindRecord(dependency.sourcePath.c_str());
+		if (dependencyRecord == nullptr || dependencyRecord->settingsHash != dependency.settingsHash) return false;
+	}
+
+	return true;
+}
+
+bool ImportDatabase::GetSettingsHash(const char* filePath, Hash& settingsHash) {
+	const ImportRecord* record = FindRecord(filePath);
+	if (record == nullptr) return false;
+
+	settingsHash = record->settingsHash;
+	return true;
+}
+
+void ImportDatabase::Register(const char* filePath, Hash sourceHash, Hash settingsHash, const std::vector<std::string>& artifactPaths, const std::vector<std::string>& dependencyPaths) {
+	// Recorded before obtaining the record, which can move the others
+	std::vector<ImportDependency> dependencies;
+	for (const std::string& dependencyPath : dependencyPaths) {
+		const ImportRecord* dependencyRecord = FindRecord(dependencyPath.c_str());
+		if (dependencyRecord == nullptr) continue;
+
+		ImportDependency dependency;
+		dependency.sourcePath = dependencyPath;
+		dependency.sourceHash = dependencyRecord->sourceHash;
+		dependency.settingsHash = dependencyRecord->settingsHash;
+		dependencies.push_back(dependency);
+	}
+
+	// Previous artifacts are kept: saved scenes may still reference them
+	ImportRecord& record = ObtainRecord(filePath);
+	record.sourceHash = sourceHash;
+	record.settingsHash = settingsHash;
+	record.artifactPaths = artifactPaths;
+	record.dependencies = std::move(dependencies);
+	App->files->GetFileStats(filePath, record.fileSize, record.modificationTime);
+	WatchSourceFolder(filePath);
+
+	dirty = true;
+}
+
+const std::vector<std::string>* ImportDatabase::GetArtifactPaths(const char* filePath) {
+	const ImportRecord* record = FindRecord(filePath);
+	return record != nullptr ? &record->artifactPaths : nullptr;
+}
+
+std::vector<std::string> ImportDatabase::GetDependencyPaths(const char* filePath) {
+	std::vector<std::string> dependencyPaths;
+	const ImportRecord* record = FindRecord(filePath);
+	if (record == nullptr) return dependencyPaths;
+
+	for (const ImportDependency& dependency : record->dependencies) {
+		dependencyPaths.push_back(dependency.sourcePath);
+	}
+	return dependencyPaths;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Utils/Hash.h"
+
+#include <string>
+#include <vector>
+
+/* The import database remembers what every source asset produced the last time it was imported.
+*  Each record stores the content hash of the source file, the hash of the import settings used and
+*  the Library artifacts that were generated. Artifact names are derived from those hashes, so the same
+*  content always maps to the same files and reimporting an unchanged asset can reuse them.
+*  Assets that are built from other sources (scenes and their textures) also record the hashes of those dependencies.
+*  The folders of the imported sources are watched, so that changed assets can be reimported while the engine runs.
+*/
+
+namespace ImportDatabase {
+	void Load();
+	void Save();
+
+	// Hash of the current contents of the source file. Returns false if the file can't be read.
+	// The stored hash is reused without reading the file if its size and modification time didn't change.
+	bool GetSourceHash(const char* filePath, Hash& sourceHash);
+
+	// True if the source was last imported with the same contents and settings, all its artifacts still exist
+	// and none of its dependencies changed their contents or import settings since then
+	bool IsUpToDate(const char* filePath, Hash sourceHash, Hash settingsHash);
+
+	// Settings hash of the last import. Returns false if the file was never imported.
+	bool GetSettingsHash(const char* filePath, Hash& settingsHash);
+
+	// Dependencies must have been registered before, their current hashes are recorded
+	void Register(const char* filePath, Hash sourceHash, Hash settingsHash, const std::vector<std::string>& artifactPaths, const std::vector<std::string>& dependencyPaths = {});
+
+	// Artifacts of the last import, or nullptr if the file was never imported. Invalidated by Register.
+	const std::vector<std::string>* GetArtifactPaths(const char* filePath);
+
+	// Sources the last import of the file depends on. Empty if the file was never imported.
+	std::vector<std::string> GetDependencyPaths(const char* filePath);
+} // namespace ImportDatabase
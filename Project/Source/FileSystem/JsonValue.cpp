@@ -15,6 +15,9 @@ JsonValue JsonValue::operator[](unsigned index) const {
 		value.SetArray();
 	}
 
+	if (index >= value.Capacity()) {
+		value.Reserve(index + 1, document.GetAllocator());
+	}
 	while (index >= value.Size()) {
 		value.PushBack(rapidjson::Value(), document.GetAllocator());
 	}
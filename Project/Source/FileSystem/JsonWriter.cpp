@@ -0,0 +1,112 @@
+#include "JsonWriter.h"
+
+#include "Utils/Logging.h"
+
+#include <string.h>
+#include <errno.h>
+
+#include "Utils/Leaks.h"
+
+#define JSON_WRITER_BUFFER_SIZE (64 * 1024)
+
+#define WRITE(call) (pretty ? prettyWriter.call : compactWriter.call)
+
+static FILE* OpenFile(const char* filePath) {
+	FILE* file = fopen(filePath, "wb");
+	if (!file) {
+		LOG_WARNING(LogCategory::GENERAL, "Error saving file %s (%s).\n", filePath, strerror(errno));
+	}
+	return file;
+}
+
+JsonWriter::FileStream::FileStream(FILE* file_)
+	: file(file_)
+	, failed(file_ == nullptr)
+	, buffer(JSON_WRITER_BUFFER_SIZE) {}
+
+void JsonWriter::FileStream::Put(char c) {
+	if (used == buffer.size()) Flush();
+	buffer[used++] = c;
+}
+
+void JsonWriter::FileStream::Flush() {
+	if (file != nullptr && used > 0 && fwrite(buffer.data(), sizeof(char), used, file) != used) {
+		failed = true;
+	}
+	used = 0;
+}
+
+JsonWriter::JsonWriter(const char* filePath, bool pretty_)
+	: pretty(pretty_)
+	, stream(OpenFile(filePath))
+	, compactWriter(stream)
+	, prettyWriter(stream) {}
+
+JsonWriter::~JsonWriter() {
+	Close();
+}
+
+bool JsonWriter::IsOpen() const {
+	return stream.file != nullptr;
+}
+
+bool JsonWriter::Close() {
+	if (stream.file == nullptr) return !stream.failed;
+
+	stream.Flush();
+	fclose(stream.file);
+	stream.file = nullptr;
+	return !stream.failed;
+}
+
+void JsonWriter::StartObject() {
+	WRITE(StartObject());
+}
+
+void JsonWriter::EndObject() {
+	WRITE(EndObject());
+}
+
+void JsonWriter::StartArray() {
+	WRITE(StartArray());
+}
+
+void JsonWriter::EndArray() {
+	WRITE(EndArray());
+}
+
+void JsonWriter::Key(const char* key) {
+	WRITE(Key(key));
+}
+
+void JsonWriter::Write(bool x) {
+	WRITE(Bool(x));
+}
+
+void JsonWriter::Write(int x) {
+	WRITE(Int(x));
+}
+
+void JsonWriter::Write(unsigned x) {
+	WRITE(Uint(x));
+}
+
+void JsonWriter::Write(long long x) {
+	WRITE(Int64(x));
+}
+
+void JsonWriter::Write(unsigned long long x) {
+	WRITE(Uint64(x));
+}
+
+void JsonWriter::Write(float x) {
+	WRITE(Double(x));
+}
+
+void JsonWriter::Write(double x) {
+	WRITE(Double(x));
+}
+
+void JsonWriter::Write(const char* x) {
+	WRITE(String(x));
+}
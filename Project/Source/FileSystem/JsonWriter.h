@@ -0,0 +1,70 @@
+#pragma once
+
+#include "rapidjson/writer.h"
+#include "rapidjson/prettywriter.h"
+#include <stdio.h>
+#include <vector>
+
+/* Streams JSON straight to a file through a write buffer, without building a document.
+*  Output is compact unless 'pretty' is set.
+*/
+
+class JsonWriter {
+public:
+	JsonWriter(const char* filePath, bool pretty = false);
+	~JsonWriter();
+
+	bool IsOpen() const;
+	bool Close(); // Flushes the buffer. Returns false if anything failed to be written.
+
+	void StartObject();
+	void EndObject();
+	void StartArray();
+	void EndArray();
+	void Key(const char* key);
+
+	void Write(bool x);
+	void Write(int x);
+	void Write(unsigned x);
+	void Write(long long x);
+	void Write(unsigned long long x);
+	void Write(float x);
+	void Write(double x);
+	void Write(const char* x);
+
+	// Key and value of an object member
+	template<typename T> void Member(const char* key, const T& value);
+
+private:
+	// Output stream for the rapidjson writers
+	class FileStream {
+	public:
+		typedef char Ch;
+
+		FileStream(FILE* file);
+		void Put(char c);
+		void Flush();
+
+	public:
+		FILE* file = nullptr;
+		bool failed = false;
+
+	private:
+		std::vector<char> buffer;
+		size_t used = 0;
+	};
+
+	typedef rapidjson::Writer<FileStream, rapidjson::UTF8<>, rapidjson::UTF8<>, rapidjson::CrtAllocator, rapidjson::kWriteNanAndInfFlag> CompactWriter;
+	typedef rapidjson::PrettyWriter<FileStream, rapidjson::UTF8<>, rapidjson::UTF8<>, rapidjson::CrtAllocator, rapidjson::kWriteNanAndInfFlag> PrettyWriter;
+
+	bool pretty = false;
+	FileStream stream;
+	CompactWriter compactWriter;
+	PrettyWriter prettyWriter;
+};
+
+template<typename T>
+inline void JsonWriter::Member(const char* key, const T& value) {
+	Key(key);
+	Write(value);
+}
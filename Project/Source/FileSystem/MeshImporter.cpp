@@ -3,6 +3,11 @@
 #include "Application.h"
 #include "Utils/Logging.h"
 #include "Utils/Buffer.h"
+#include "Utils/MSTimer.h"
+#include "Utils/Hash.h"
+#include "Utils/Profiling.h"
+#include "Utils/ParallelFor.h"
+#include "FileSystem/MeshSimplifier.h"
 #include "Resources/Mesh.h"
 #include "Modules/ModuleResources.h"
 #include "Modules/ModuleFiles.h"
@@ -10,41 +15,226 @@
 #include "assimp/mesh.h"
 #include "Math/float3.h"
 #include "Math/float4.h"
+#include "Math/MathFunc.h"
 #include "GL/glew.h"
 #include <list>
 #include <vector>
+#include <string>
+#include <memory>
+#include <string.h>
 
 #include "Utils/Leaks.h"
 
-Mesh* MeshImporter::ImportMesh(const aiMesh* assimpMesh, unsigned index) {
-	// Timer to measure importing a mesh
-	MSTimer timer;
-	timer.Start();
+// Increase when the mesh file format changes so that every mesh gets reimported
+#define MESH_IMPORTER_VERSION 2
 
-	// Create mesh
-	Mesh* mesh = App->resources->meshes.Obtain();
-	mesh->numVertices = assimpMesh->mNumVertices;
-	mesh->numIndices = assimpMesh->mNumFaces * 3;
-	mesh->materialIndex = assimpMesh->mMaterialIndex;
+// Levels of detail
+#define MESH_LOD_MIN_TRIANGLES 256 // Smaller meshes only have the full resolution level
+#define MESH_LOD_MIN_REDUCTION 0.75f // Levels need to have at most this fraction of the triangles of the previous one
+#define MESH_LOD_MAX_ERROR 0.1f // Relative to the radius of the mesh
+
+// Occluders
+#define MESH_OCCLUDER_MAX_TRIANGLES 512
+
+/* Mesh files: number of vertices, number of indices, vertices (position, normal and UV) and indices.
+*  Meshes with levels of detail append the number of levels, the number of indices and the error of every level after the first,
+*  and then the indices of those levels. Files without them are still valid, so older meshes load with a single level.
+*/
+
+// Each level is simplified from the full resolution mesh on its own thread. Returns the number of levels, including the first.
+static unsigned GenerateLods(const aiMesh* assimpMesh, const std::vector<unsigned>& indices, std::vector<unsigned> (&lodIndices)[MESH_MAX_LODS], float (&lodErrors)[MESH_MAX_LODS]) {
+	if (indices.size() / 3 < MESH_LOD_MIN_TRIANGLES || assimpMesh->mNumVertices == 0) return 1;
+
+	PROFILE_ZONE("MeshImporter - GenerateLods", ProfilerColor::Orange)
+
+	float3 minPoint = float3(assimpMesh->mVertices[0].x, assimpMesh->mVertices[0].y, assimpMesh->mVertices[0].z);
+	float3 maxPoint = minPoint;
+	for (unsigned i = 1; i < assimpMesh->mNumVertices; ++i) {
+		float3 vertex = float3(assimpMesh->mVertices[i].x, assimpMesh->mVertices[i].y, assimpMesh->mVertices[i].z);
+		minPoint = minPoint.Min(vertex);
+		maxPoint = maxPoint.Max(vertex);
+	}
+	float radius = (maxPoint - minPoint).Length() * 0.5f;
+	if (radius <= 0) return 1;
+
+	ParallelFor(MESH_MAX_LODS - 1, [&](unsigned i) {
+		unsigned lod = i + 1;
+		unsigned targetNumIndices = (unsigned) (indices.size() >> lod) / 3 * 3;
+		float error = MeshSimplifier::Simplify((const float*) assimpMesh->mVertices, assimpMesh->mNumVertices, sizeof(aiVector3D), indices.data(), (unsigned) indices.size(), targetNumIndices, MESH_LOD_MAX_ERROR * radius, lodIndices[lod]);
+		lodErrors[lod] = error / radius;
+	});
+
+	// Keep the levels that are worth switching to. Their errors can't decrease, so coarser levels are always picked later.
+	unsigned numLods = 1;
+	size_t previousNumIndices = indices.size();
+	for (unsigned lod = 1; lod < MESH_MAX_LODS; ++lod) {
+		if (lodIndices[lod].size() > previousNumIndices * MESH_LOD_MIN_REDUCTION) continue;
+
+		previousNumIndices = lodIndices[lod].size();
+		lodErrors[numLods] = Max(lodErrors[lod], lodErrors[numLods - 1]);
+		if (numLods != lod) lodIndices[numLods] = std::move(lodIndices[lod]);
+		numLods += 1;
+	}
+	return numLods;
+}
+
+// Reads the level of detail table that follows the full resolution indices. Returns the indices of the other levels, or nullptr if there are none.
+static const unsigned* ReadLods(Mesh* mesh, const char* cursor, const char* end) {
+	mesh->numLods = 1;
+	mesh->lodNumIndices[0] = mesh->numIndices;
+	mesh->lodIndexOffsets[0] = 0;
+	mesh->lodErrors[0] = 0;
+	if (end - cursor < (ptrdiff_t) sizeof(unsigned)) return nullptr;
+
+	unsigned numLods = *((unsigned*) cursor);
+	cursor += sizeof(unsigned);
+	if (numLods < 2 || numLods > MESH_MAX_LODS || end - cursor < (ptrdiff_t) ((sizeof(unsigned) + sizeof(float)) * (numLods - 1))) {
+		LOG_WARNING(LogCategory::IMPORT, "Invalid levels of detail in mesh \"%s\".", mesh->fileName.c_str());
+		return nullptr;
+	}
+
+	unsigned indexOffset = mesh->numIndices;
+	for (unsigned lod = 1; lod < numLods; ++lod) {
+		mesh->lodNumIndices[lod] = *((unsigned*) cursor);
+		cursor += sizeof(unsigned);
+		mesh->lodErrors[lod] = *((float*) cursor);
+		cursor += sizeof(float);
+		mesh->lodIndexOffsets[lod] = indexOffset;
+		indexOffset += mesh->lodNumIndices[lod];
+	}
+	if (end - cursor < (ptrdiff_t) (sizeof(unsigned) * (indexOffset - mesh->numIndices))) {
+		LOG_WARNING(LogCategory::IMPORT, "Invalid levels of detail in mesh \"%s\".", mesh->fileName.c_str());
+		return nullptr;
+	}
+
+	mesh->numLods = numLods;
+	return (const unsigned*) cursor;
+}
+
+// Keeps the coarsest level without error as the occluder of the mesh, with only the positions that it uses.
+// Simplified levels can stick out of the real surface and hide objects that are visible, so they are never used.
+static void ReadOccluder(Mesh* mesh, const float* vertices, const unsigned* indices, const unsigned* lodIndices) {
+	mesh->occluderVertices.clear();
+	mesh->occluderIndices.clear();
+
+	for (int lod = mesh->numLods - 1; lod >= 0; --lod) {
+		if (mesh->lodErrors[lod] > 0.0f || mesh->lodNumIndices[lod] / 3 > MESH_OCCLUDER_MAX_TRIANGLES) continue;
+
+		const unsigned* levelIndices = lod == 0 ? indices : lodIndices + (mesh->lodIndexOffsets[lod] - mesh->numIndices);
+		std::vector<unsigned> remap(mesh->numVertices, (unsigned) -1);
+		mesh->occluderIndices.reserve(mesh->lodNumIndices[lod]);
+		for (unsigned i = 0; i < mesh->lodNumIndices[lod]; ++i) {
+			unsigned index = levelIndices[i];
+			if (remap[index] == (unsigned) -1) {
+				remap[index] = (unsigned) mesh->occluderVertices.size();
+				const float* position = vertices + (size_t) index * 8; // Position, normal and UV
+				mesh->occluderVertices.push_back(float3(position[0], position[1], position[2]));
+			}
+			mesh->occluderIndices.push_back(remap[index]);
+		}
+		return;
+	}
+}
+
+static void UploadMesh(Mesh* mesh, const float* vertices, const unsigned* indices, const unsigned* lodIndices) {
+	if (mesh->vao) return;
 
-	// Save to custom format buffer
 	unsigned positionSize = sizeof(float) * 3;
 	unsigned normalSize = sizeof(float) * 3;
 	unsigned uvSize = sizeof(float) * 2;
 	unsigned indexSize = sizeof(unsigned);
 
-	unsigned headerSize = sizeof(unsigned) * 2;
 	unsigned vertexSize = positionSize + normalSize + uvSize;
 	unsigned vertexBufferSize = vertexSize * mesh->numVertices;
 	unsigned indexBufferSize = indexSize * mesh->numIndices;
+	unsigned lodIndexBufferSize = 0;
+	for (unsigned lod = 1; lod < mesh->numLods; ++lod) {
+		lodIndexBufferSize += indexSize * mesh->lodNumIndices[lod];
+	}
+
+	// Create VAO
+	glGenVertexArrays(1, &mesh->vao);
+	glGenBuffers(1, &mesh->vbo);
+	glGenBuffers(1, &mesh->ebo);
+
+	glBindVertexArray(mesh->vao);
+	glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
+
+	// Load VBO
+	glBufferData(GL_ARRAY_BUFFER, vertexBufferSize, vertices, GL_STATIC_DRAW);
+
+	// Load EBO. The other levels of detail go after the full resolution indices.
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize + lodIndexBufferSize, nullptr, GL_STATIC_DRAW);
+	glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indexBufferSize, indices);
+	if (lodIndexBufferSize > 0) glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, lodIndexBufferSize, lodIndices);
+
+	// Load vertex attributes
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*) 0);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*) positionSize);
+	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, vertexSize, (void*) (positionSize + normalSize));
+
+	// Unbind VAO
+	glBindVertexArray(0);
+}
+
+std::string MeshImporter::ImportMeshFile(const aiMesh* assimpMesh) {
+	unsigned numVertices = assimpMesh->mNumVertices;
+	unsigned numIndices = assimpMesh->mNumFaces * 3;
+
+	std::vector<unsigned> indices;
+	indices.reserve(numIndices);
+	for (unsigned i = 0; i < assimpMesh->mNumFaces; ++i) {
+		aiFace& assimpFace = assimpMesh->mFaces[i];
+
+		// Assume triangles = 3 indices per face
+		if (assimpFace.mNumIndices != 3) {
+			LOG_WARNING(LogCategory::IMPORT, "Found a face with %i vertices. Discarded.", assimpFace.mNumIndices);
+
+			indices.push_back(0);
+			indices.push_back(0);
+			indices.push_back(0);
+			continue;
+		}
+
+		indices.push_back(assimpFace.mIndices[0]);
+		indices.push_back(assimpFace.mIndices[1]);
+		indices.push_back(assimpFace.mIndices[2]);
+	}
+
+	std::vector<unsigned> lodIndices[MESH_MAX_LODS];
+	float lodErrors[MESH_MAX_LODS] = {};
+	unsigned numLods = GenerateLods(assimpMesh, indices, lodIndices, lodErrors);
+
+	// Save to custom format buffer
+	unsigned positionSize = sizeof(float) * 3;
+	unsigned normalSize = sizeof(float) * 3;
+	unsigned uvSize = sizeof(float) * 2;
+	unsigned indexSize = sizeof(unsigned);
+
+	unsigned headerSize = sizeof(unsigned) * 2;
+	unsigned vertexSize = positionSize + normalSize + uvSize;
+	unsigned vertexBufferSize = vertexSize * numVertices;
+	unsigned indexBufferSize = indexSize * numIndices;
+	unsigned lodBufferSize = 0;
+	if (numLods > 1) {
+		lodBufferSize = sizeof(unsigned) + (sizeof(unsigned) + sizeof(float)) * (numLods - 1);
+		for (unsigned lod = 1; lod < numLods; ++lod) {
+			lodBufferSize += indexSize * (unsigned) lodIndices[lod].size();
+		}
+	}
 
-	size_t size = headerSize + vertexBufferSize + indexBufferSize;
+	size_t size = headerSize + vertexBufferSize + indexBufferSize + lodBufferSize;
 	Buffer<char> buffer = Buffer<char>(size);
 	char* cursor = buffer.Data();
 
-	*((unsigned*) cursor) = mesh->numVertices;
+	*((unsigned*) cursor) = numVertices;
 	cursor += sizeof(unsigned);
-	*((unsigned*) cursor) = mesh->numIndices;
+	*((unsigned*) cursor) = numIndices;
 	cursor += sizeof(unsigned);
 
 	for (unsigned i = 0; i < assimpMesh->mNumVertices; ++i) {
@@ -70,53 +260,70 @@ Mesh* MeshImporter::ImportMesh(const aiMesh* assimpMesh, unsigned index) {
 		cursor += sizeof(float);
 	}
 
-	for (unsigned i = 0; i < assimpMesh->mNumFaces; ++i) {
-		aiFace& assimpFace = assimpMesh->mFaces[i];
-
-		// Assume triangles = 3 indices per face
-		if (assimpFace.mNumIndices != 3) {
-			LOG("Found a face with %i vertices. Discarded.", assimpFace.mNumIndices);
+	memcpy(cursor, indices.data(), indexBufferSize);
+	cursor += indexBufferSize;
 
-			*((unsigned*) cursor) = 0;
-			cursor += sizeof(unsigned);
-			*((unsigned*) cursor) = 0;
-			cursor += sizeof(unsigned);
-			*((unsigned*) cursor) = 0;
+	if (numLods > 1) {
+		*((unsigned*) cursor) = numLods;
+		cursor += sizeof(unsigned);
+		for (unsigned lod = 1; lod < numLods; ++lod) {
+			*((unsigned*) cursor) = (unsigned) lodIndices[lod].size();
 			cursor += sizeof(unsigned);
-			continue;
+			*((float*) cursor) = lodErrors[lod];
+			cursor += sizeof(float);
+		}
+		for (unsigned lod = 1; lod < numLods; ++lod) {
+			memcpy(cursor, lodIndices[lod].data(), indexSize * lodIndices[lod].size());
+			cursor += indexSize * lodIndices[lod].size();
 		}
+		LOG_VERBOSE(LogCategory::IMPORT, "Generated %u levels of detail. The coarsest has %u triangles.", numLods - 1, (unsigned) lodIndices[numLods - 1].size() / 3);
+	}
 
-		*((unsigned*) cursor) = assimpFace.mIndices[0];
-		cursor += sizeof(unsigned);
-		*((unsigned*) cursor) = assimpFace.mIndices[1];
-		cursor += sizeof(unsigned);
-		*((unsigned*) cursor) = assimpFace.mIndices[2];
-		cursor += sizeof(unsigned);
+	// Name the mesh after its contents. Identical meshes share the same file and unchanged meshes don't need to be written again.
+	std::string fileName = HashToString(HashBuffer(buffer.Data(), buffer.Size(), MESH_IMPORTER_VERSION));
+	std::string filePath = std::string(MESHES_PATH) + "/" + fileName + MESH_EXTENSION;
+	if (App->files->Exists(filePath.c_str())) {
+		LOG_VERBOSE(LogCategory::IMPORT, "Mesh \"%s\" is up to date.", filePath.c_str());
+	} else {
+		LOG_VERBOSE(LogCategory::IMPORT, "Saving mesh to \"%s\".", filePath.c_str());
+		App->files->Save(filePath.c_str(), buffer);
 	}
 
-	// Save buffer to file
+	return fileName;
+}
+
+Mesh* MeshImporter::ImportMesh(const aiMesh* assimpMesh) {
+	PROFILE_ZONE("MeshImporter - ImportMesh", ProfilerColor::Orange)
 
-	std::string fileName = std::string(assimpMesh->mName.C_Str()) + std::to_string(index);
-	mesh->fileName = fileName;
-	std::string filePath = std::string(MESHES_PATH) + "/" + fileName + MESH_EXTENSION;
-	LOG("Saving mesh to \"%s\".", filePath.c_str());
-	App->files->Save(filePath.c_str(), buffer);
+	// Timer to measure importing a mesh
+	MSTimer timer;
+	timer.Start();
+
+	std::string fileName = ImportMeshFile(assimpMesh);
+
+	// Create mesh
+	Mesh* mesh = App->resources->ObtainMeshWithFileName(fileName);
+	mesh->numVertices = assimpMesh->mNumVertices;
+	mesh->numIndices = assimpMesh->mNumFaces * 3;
 
 	unsigned timeMs = timer.Stop();
-	LOG("Mesh imported in %ums", timeMs);
+	LOG_VERBOSE(LogCategory::IMPORT, "Mesh imported in %ums", timeMs);
 	return mesh;
 }
 
 void MeshImporter::LoadMesh(Mesh* mesh) {
+	PROFILE_ZONE("MeshImporter - LoadMesh", ProfilerColor::Orange)
+
 	if (mesh == nullptr) return;
+	if (App->IsMainThread() ? mesh->vao != 0 : mesh->uploadQueued) return;
 
 	// Timer to measure loading a mesh
 	MSTimer timer;
 	timer.Start();
 
-	std::string filePath = std::string(MESHES_PATH) + "/" + mesh->fileName + MESH_EXTENSION;
+	std::string filePath = std::string(MESHES_PATH) + "/" + mesh->fileName.c_str() + MESH_EXTENSION;
 
-	LOG("Loading mesh from path: \"%s\".", filePath.c_str());
+	LOG_VERBOSE(LogCategory::IMPORT, "Loading mesh from path: \"%s\".", filePath.c_str());
 
 	// Load file
 	Buffer<char> buffer = App->files->Load(filePath.c_str());
@@ -131,11 +338,8 @@ void MeshImporter::LoadMesh(Mesh* mesh) {
 	unsigned positionSize = sizeof(float) * 3;
 	unsigned normalSize = sizeof(float) * 3;
 	unsigned uvSize = sizeof(float) * 2;
-	unsigned indexSize = sizeof(unsigned);
 
 	unsigned vertexSize = positionSize + normalSize + uvSize;
-	unsigned vertexBufferSize = vertexSize * mesh->numVertices;
-	unsigned indexBufferSize = indexSize * mesh->numIndices;
 
 	// Vertices
 	float* vertices = (float*) cursor;
@@ -143,42 +347,39 @@ void MeshImporter::LoadMesh(Mesh* mesh) {
 
 	// Indices
 	unsigned* indices = (unsigned*) cursor;
+	cursor += sizeof(unsigned) * mesh->numIndices;
+
+	// Levels of detail
+	const unsigned* lodIndices = ReadLods(mesh, cursor, buffer.Data() + buffer.Size());
+	ReadOccluder(mesh, vertices, indices, lodIndices);
+
+	LOG_VERBOSE(LogCategory::IMPORT, "Loading %i vertices...", mesh->numVertices);
+
+	// Headless: the mesh is read, but not uploaded
+	if (App->headless) return;
+
+	// Startup can load scenes on worker threads. The upload waits for the main thread, which owns the GL context.
+	if (!App->IsMainThread()) {
+		size_t verticesOffset = (char*) vertices - buffer.Data();
+		size_t indicesOffset = (char*) indices - buffer.Data();
+		size_t lodIndicesOffset = lodIndices != nullptr ? (const char*) lodIndices - buffer.Data() : 0;
+		std::shared_ptr<Buffer<char>> sharedBuffer = std::make_shared<Buffer<char>>(std::move(buffer));
+		mesh->uploadQueued = true;
+		App->RunOnMainThread([mesh, sharedBuffer, verticesOffset, indicesOffset, lodIndicesOffset]() {
+			const char* data = sharedBuffer->Data();
+			UploadMesh(mesh, (const float*) (data + verticesOffset), (const unsigned*) (data + indicesOffset), lodIndicesOffset > 0 ? (const unsigned*) (data + lodIndicesOffset) : nullptr);
+		});
+		return;
+	}
 
-	LOG("Loading %i vertices...", mesh->numVertices);
-
-	// Create VAO
-	glGenVertexArrays(1, &mesh->vao);
-	glGenBuffers(1, &mesh->vbo);
-	glGenBuffers(1, &mesh->ebo);
-
-	glBindVertexArray(mesh->vao);
-	glBindBuffer(GL_ARRAY_BUFFER, mesh->vbo);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh->ebo);
-
-	// Load VBO
-	glBufferData(GL_ARRAY_BUFFER, vertexBufferSize, vertices, GL_STATIC_DRAW);
-
-	// Load EBO
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBufferSize, indices, GL_STATIC_DRAW);
-
-	// Load vertex attributes
-	glEnableVertexAttribArray(0);
-	glEnableVertexAttribArray(1);
-	glEnableVertexAttribArray(2);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*) 0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, vertexSize, (void*) positionSize);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, vertexSize, (void*) (positionSize + normalSize));
-
-	// Unbind VAO
-	glBindVertexArray(0);
+	UploadMesh(mesh, vertices, indices, lodIndices);
 
 	unsigned timeMs = timer.Stop();
-	LOG("Mesh loaded in %ums", timeMs);
+	LOG_VERBOSE(LogCategory::IMPORT, "Mesh loaded in %ums", timeMs);
 }
 
-std::vector<Triangle> MeshImporter::ExtractMeshTriangles(Mesh* mesh, const float4x4& model) {
-	std::string filePath = std::string(MESHES_PATH) + "/" + mesh->fileName + MESH_EXTENSION;
+FrameVector<Triangle> MeshImporter::ExtractMeshTriangles(Mesh* mesh, const float4x4& model) {
+	std::string filePath = std::string(MESHES_PATH) + "/" + mesh->fileName.c_str() + MESH_EXTENSION;
 
 	// Load file
 	Buffer<char> buffer = App->files->Load(filePath.c_str());
@@ -191,7 +392,8 @@ std::vector<Triangle> MeshImporter::ExtractMeshTriangles(Mesh* mesh, const float
 	cursor += sizeof(unsigned);
 
 	// Vertices
-	std::vector<float3> vertices;
+	FrameVector<float3> vertices;
+	vertices.reserve(numVertices);
 	for (unsigned i = 0; i < numVertices; i++) {
 		float vertex[3] = {};
 		vertex[0] = *((float*) cursor);
@@ -203,7 +405,7 @@ std::vector<Triangle> MeshImporter::ExtractMeshTriangles(Mesh* mesh, const float
 		vertices.push_back((model * float4(vertex[0], vertex[1], vertex[2], 1)).xyz());
 	}
 
-	std::vector<Triangle> triangles;
+	FrameVector<Triangle> triangles;
 	triangles.reserve(numIndices / 3);
 	for (unsigned i = 0; i < numIndices / 3; i++) {
 		unsigned triangeIndices[3] = {};
@@ -220,9 +422,22 @@ std::vector<Triangle> MeshImporter::ExtractMeshTriangles(Mesh* mesh, const float
 }
 
 void MeshImporter::UnloadMesh(Mesh* mesh) {
+	mesh->occluderVertices.clear();
+	mesh->occluderIndices.clear();
+	mesh->uploadQueued = false;
+
 	if (!mesh->vao) return;
 
-	glDeleteVertexArrays(1, &mesh->vao);
-	glDeleteBuffers(1, &mesh->vbo);
-	glDeleteBuffers(1, &mesh->ebo);
+	// The GL names are deleted on the main thread, which owns the GL context
+	unsigned vao = mesh->vao;
+	unsigned vbo = mesh->vbo;
+	unsigned ebo = mesh->ebo;
+	mesh->vao = 0;
+	mesh->vbo = 0;
+	mesh->ebo = 0;
+	App->RunOnMainThread([vao, vbo, ebo]() {
+		glDeleteVertexArrays(1, &vao);
+		glDeleteBuffers(1, &vbo);
+		glDeleteBuffers(1, &ebo);
+	});
 }
\ No newline at end of file
@@ -2,14 +2,17 @@
 
 #include "Math/float4x4.h"
 #include "Geometry/Triangle.h"
+#include "Utils/FrameArena.h"
 #include <vector>
+#include <string>
 
 class Mesh;
 struct aiMesh;
 
 namespace MeshImporter {
-	Mesh* ImportMesh(const aiMesh* assimpMesh, unsigned index);
+	Mesh* ImportMesh(const aiMesh* assimpMesh);
+	std::string ImportMeshFile(const aiMesh* assimpMesh); // Only saves the mesh file. Returns its name.
 	void LoadMesh(Mesh* mesh);
-	std::vector<Triangle> ExtractMeshTriangles(Mesh* mesh, const float4x4& model);
+	FrameVector<Triangle> ExtractMeshTriangles(Mesh* mesh, const float4x4& model);
 	void UnloadMesh(Mesh* mesh);
 }; // namespace MeshImporter
\ No newline at end of file
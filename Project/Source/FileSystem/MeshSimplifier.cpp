@@ -0,0 +1,316 @@
+#include "MeshSimplifier.h"
+
+#include "Math/float3.h"
+#include "Math/MathFunc.h"
+#include <algorithm>
+#include <math.h>
+
+#include "Utils/Leaks.h"
+
+#define COLLAPSE_MIN_NORMAL_COS 0.25f // The normals of the triangles around a collapse can turn up to ~75 degrees
+
+// Quadrics -----------
+
+// Sum of squared distances to a set of planes, weighted by the area of the triangles that define them
+struct Quadric {
+	double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+	double b0 = 0, b1 = 0, b2 = 0;
+	double c = 0;
+	double weight = 0;
+
+	void AddPlane(const float3& normal, float distance, float planeWeight) {
+		double x = normal.x, y = normal.y, z = normal.z, d = distance;
+		a00 += planeWeight * x * x;
+		a01 += planeWeight * x * y;
+		a02 += planeWeight * x * z;
+		a11 += planeWeight * y * y;
+		a12 += planeWeight * y * z;
+		a22 += planeWeight * z * z;
+		b0 += planeWeight * x * d;
+		b1 += planeWeight * y * d;
+		b2 += planeWeight * z * d;
+		c += planeWeight * d * d;
+		weight += planeWeight;
+	}
+
+	void Add(const Quadric& other) {
+		a00 += other.a00;
+		a01 += other.a01;
+		a02 += other.a02;
+		a11 += other.a11;
+		a12 += other.a12;
+		a22 += other.a22;
+		b0 += other.b0;
+		b1 += other.b1;
+		b2 += other.b2;
+		c += other.c;
+		weight += other.weight;
+	}
+
+	// Mean squared distance from the point to the planes
+	float Evaluate(const float3& point) const {
+		if (weight <= 0) return 0;
+
+		double x = point.x, y = point.y, z = point.z;
+		double error = a00 * x * x + a11 * y * y + a22 * z * z + 2 * (a01 * x * y + a02 * x * z + a12 * y * z) + 2 * (b0 * x + b1 * y + b2 * z) + c;
+		return (float) (Max(error, 0.0) / weight);
+	}
+};
+
+struct Collapse {
+	unsigned from = 0; // Vertex that goes away
+	unsigned to = 0;
+	float error = 0;
+};
+
+// Mesh -----------
+
+struct SimplifierMesh {
+	const float* positions = nullptr;
+	unsigned positionStride = 0;
+
+	std::vector<unsigned> welded; // First vertex with the same position
+	std::vector<bool> locked;
+	std::vector<Quadric> quadrics; // Indexed by welded vertex
+
+	float3 Position(unsigned vertex) const {
+		const float* position = (const float*) ((const char*) positions + (size_t) vertex * positionStride);
+		return float3(position[0], position[1], position[2]);
+	}
+};
+
+static bool SamePosition(const float3& a, const float3& b) {
+	return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static void WeldVertices(SimplifierMesh& mesh, unsigned numVertices) {
+	std::vector<unsigned> sorted(numVertices);
+	for (unsigned i = 0; i < numVertices; ++i) {
+		sorted[i] = i;
+	}
+	std::sort(sorted.begin(), sorted.end(), [&mesh](unsigned a, unsigned b) {
+		float3 positionA = mesh.Position(a);
+		float3 positionB = mesh.Position(b);
+		if (positionA.x != positionB.x) return positionA.x < positionB.x;
+		if (positionA.y != positionB.y) return positionA.y < positionB.y;
+		if (positionA.z != positionB.z) return positionA.z < positionB.z;
+		return a < b;
+	});
+
+	mesh.welded.resize(numVertices);
+	mesh.locked.assign(numVertices, false);
+	for (unsigned i = 0; i < numVertices;) {
+		unsigned first = sorted[i];
+		float3 position = mesh.Position(first);
+		unsigned end = i + 1;
+		while (end < numVertices && SamePosition(mesh.Position(sorted[end]), position)) {
+			end += 1;
+		}
+
+		// Seams: moving one of the vertices would tear the surface apart
+		for (unsigned j = i; j < end; ++j) {
+			mesh.welded[sorted[j]] = first;
+			mesh.locked[sorted[j]] = end - i > 1;
+		}
+		i = end;
+	}
+}
+
+static void LockBorders(SimplifierMesh& mesh, const std::vector<unsigned>& indices) {
+	std::vector<unsigned long long> edges;
+	edges.reserve(indices.size());
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		for (unsigned e = 0; e < 3; ++e) {
+			unsigned a = mesh.welded[indices[i + e]];
+			unsigned b = mesh.welded[indices[i + (e + 1) % 3]];
+			if (a == b) continue;
+			edges.push_back(((unsigned long long) Min(a, b) << 32) | Max(a, b));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+
+	// Edges that only belong to one triangle
+	for (size_t i = 0; i < edges.size();) {
+		size_t end = i + 1;
+		while (end < edges.size() && edges[end] == edges[i]) {
+			end += 1;
+		}
+		if (end - i == 1) {
+			mesh.locked[(unsigned) (edges[i] >> 32)] = true;
+			mesh.locked[(unsigned) (edges[i] & 0xFFFFFFFF)] = true;
+		}
+		i = end;
+	}
+}
+
+static void ComputeQuadrics(SimplifierMesh& mesh, const std::vector<unsigned>& indices, unsigned numVertices) {
+	mesh.quadrics.assign(numVertices, Quadric());
+	for (size_t i = 0; i < indices.size(); i += 3) {
+		float3 p0 = mesh.Position(indices[i]);
+		float3 p1 = mesh.Position(indices[i + 1]);
+		float3 p2 = mesh.Position(indices[i + 2]);
+		float3 normal = (p1 - p0).Cross(p2 - p0);
+		float doubleArea = normal.Length();
+		if (doubleArea <= 0) continue;
+
+		normal /= doubleArea;
+		float distance = -normal.Dot(p0);
+		for (unsigned v = 0; v < 3; ++v) {
+			mesh.quadrics[mesh.welded[indices[i + v]]].AddPlane(normal, distance, doubleArea * 0.5f);
+		}
+	}
+}
+
+// Triangles around each welded vertex, in compressed rows
+struct Adjacency {
+	std::vector<unsigned> offsets;
+	std::vector<unsigned> triangles;
+};
+
+static void BuildAdjacency(const SimplifierMesh& mesh, const std::vector<unsigned>& indices, unsigned numVertices, Adjacency& adjacency) {
+	adjacency.offsets.assign(numVertices + 1, 0);
+	for (unsigned index : indices) {
+		adjacency.offsets[mesh.welded[index] + 1] += 1;
+	}
+	for (unsigned i = 0; i < numVertices; ++i) {
+		adjacency.offsets[i + 1] += adjacency.offsets[i];
+	}
+
+	adjacency.triangles.resize(indices.size());
+	std::vector<unsigned> cursors(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		adjacency.triangles[cursors[mesh.welded[indices[i]]]++] = (unsigned) (i / 3);
+	}
+}
+
+// Moving 'from' onto 'to' must not turn any of the remaining triangles around, or close to it.
+// The original normals are checked too, so that a triangle can't turn around over several passes either.
+static bool CollapseFlipsTriangles(const SimplifierMesh& mesh, const std::vector<unsigned>& indices, const std::vector<float3>& originalNormals, const Adjacency& adjacency, unsigned from, unsigned to) {
+	float3 target = mesh.Position(to);
+	for (unsigned i = adjacency.offsets[from]; i < adjacency.offsets[from + 1]; ++i) {
+		unsigned triangleIndex = adjacency.triangles[i];
+		const unsigned* triangle = &indices[triangleIndex * 3];
+		unsigned corners[3] = {mesh.welded[triangle[0]], mesh.welded[triangle[1]], mesh.welded[triangle[2]]};
+		if (corners[0] == to || corners[1] == to || corners[2] == to) continue; // Removed by the collapse
+
+		float3 before[3] = {mesh.Position(corners[0]), mesh.Position(corners[1]), mesh.Position(corners[2])};
+		float3 after[3] = {before[0], before[1], before[2]};
+		for (unsigned v = 0; v < 3; ++v) {
+			if (corners[v] == from) after[v] = target;
+		}
+
+		float3 normalBefore = (before[1] - before[0]).Cross(before[2] - before[0]);
+		float3 normalAfter = (after[1] - after[0]).Cross(after[2] - after[0]);
+		if (normalBefore.Dot(normalAfter) <= COLLAPSE_MIN_NORMAL_COS * normalBefore.Length() * normalAfter.Length()) return true;
+		if (originalNormals[triangleIndex].Dot(normalAfter) <= 0) return true;
+	}
+	return false;
+}
+
+// Simplification -----------
+
+float MeshSimplifier::Simplify(const float* positions, unsigned numVertices, unsigned positionStride, const unsigned* indices, unsigned numIndices, unsigned targetNumIndices, float maxError, std::vector<unsigned>& result) {
+	result.assign(indices, indices + numIndices);
+	if (numVertices == 0 || numIndices <= targetNumIndices) return 0;
+
+	SimplifierMesh mesh;
+	mesh.positions = positions;
+	mesh.positionStride = positionStride;
+	WeldVertices(mesh, numVertices);
+	LockBorders(mesh, result);
+	ComputeQuadrics(mesh, result, numVertices);
+
+	// Normals of the input triangles, kept in the same order as the remaining ones
+	std::vector<float3> originalNormals(result.size() / 3);
+	for (size_t i = 0; i < result.size(); i += 3) {
+		float3 p0 = mesh.Position(result[i]);
+		originalNormals[i / 3] = (mesh.Position(result[i + 1]) - p0).Cross(mesh.Position(result[i + 2]) - p0);
+	}
+
+	float maxSquaredError = maxError * maxError;
+	float squaredError = 0;
+	Adjacency adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<unsigned> remap(numVertices);
+	std::vector<bool> touched(numVertices);
+
+	// Every pass collapses a set of edges that don't share triangles, cheapest first
+	while (result.size() > targetNumIndices) {
+		BuildAdjacency(mesh, result, numVertices, adjacency);
+
+		collapses.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (unsigned e = 0; e < 3; ++e) {
+				unsigned a = result[i + e];
+				unsigned b = result[i + (e + 1) % 3];
+				unsigned weldedA = mesh.welded[a];
+				unsigned weldedB = mesh.welded[b];
+				if (weldedA == weldedB) continue;
+
+				// Unlocked vertices aren't seams, so they are their own welded vertex
+				if (!mesh.locked[weldedA]) collapses.push_back({a, b, mesh.quadrics[weldedA].Evaluate(mesh.Position(b))});
+				if (!mesh.locked[weldedB]) collapses.push_back({b, a, mesh.quadrics[weldedB].Evaluate(mesh.Position(a))});
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+			return a.error < b.error;
+		});
+
+		for (unsigned i = 0; i < numVertices; ++i) {
+			remap[i] = i;
+		}
+		touched.assign(numVertices, false);
+
+		// Interior collapses remove two triangles each
+		size_t numTrianglesToRemove = (result.size() - targetNumIndices + 2) / 3;
+		size_t numTrianglesRemoved = 0;
+		bool collapsed = false;
+		for (const Collapse& collapse : collapses) {
+			if (collapse.error > maxSquaredError) break;
+
+			unsigned from = mesh.welded[collapse.from];
+			unsigned to = mesh.welded[collapse.to];
+			if (touched[from] || touched[to]) continue;
+			if (CollapseFlipsTriangles(mesh, result, originalNormals, adjacency, from, to)) continue;
+
+			remap[collapse.from] = collapse.to;
+			mesh.quadrics[to].Add(mesh.quadrics[from]);
+
+			// The flip test used the positions from before the pass, so no other collapse can move a corner of these triangles
+			for (unsigned j = adjacency.offsets[from]; j < adjacency.offsets[from + 1]; ++j) {
+				const unsigned* triangle = &result[adjacency.triangles[j] * 3];
+				for (unsigned v = 0; v < 3; ++v) {
+					touched[mesh.welded[triangle[v]]] = true;
+				}
+			}
+			touched[to] = true;
+			squaredError = Max(squaredError, collapse.error);
+			collapsed = true;
+
+			numTrianglesRemoved += 2;
+			if (numTrianglesRemoved >= numTrianglesToRemove) break;
+		}
+		if (!collapsed) break;
+
+		// Apply the collapses and drop the triangles that became degenerate
+		size_t numResultIndices = 0;
+		for (size_t i = 0; i < result.size(); i += 3) {
+			unsigned a = remap[result[i]];
+			unsigned b = remap[result[i + 1]];
+			unsigned c = remap[result[i + 2]];
+			unsigned weldedA = mesh.welded[a];
+			unsigned weldedB = mesh.welded[b];
+			unsigned weldedC = mesh.welded[c];
+			if (weldedA == weldedB || weldedB == weldedC || weldedC == weldedA) continue;
+
+			originalNormals[numResultIndices / 3] = originalNormals[i / 3];
+			result[numResultIndices++] = a;
+			result[numResultIndices++] = b;
+			result[numResultIndices++] = c;
+		}
+		result.resize(numResultIndices);
+		originalNormals.resize(numResultIndices / 3);
+	}
+
+	return sqrtf(squaredError);
+}
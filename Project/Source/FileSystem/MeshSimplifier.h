@@ -0,0 +1,14 @@
+#pragma once
+
+#include <vector>
+
+/* Mesh simplification used at import time to build the levels of detail.
+*  Collapses edges onto one of their vertices in order of quadric error, so the simplified levels reuse the vertices of the original mesh.
+*  Vertices on borders and on attribute seams (same position, different normal or UV) never move, which keeps silhouettes and UVs intact.
+*/
+
+namespace MeshSimplifier {
+	// Positions are 3 floats, read every positionStride bytes. Collapses edges until the mesh has at most targetNumIndices indices
+	// or the next collapse would move the surface further than maxError. Returns the error of the result, in the units of the positions.
+	float Simplify(const float* positions, unsigned numVertices, unsigned positionStride, const unsigned* indices, unsigned numIndices, unsigned targetNumIndices, float maxError, std::vector<unsigned>& result);
+} // namespace MeshSimplifier
@@ -3,10 +3,21 @@
 #include "Application.h"
 #include "Utils/Logging.h"
 #include "Utils/MSTimer.h"
+#include "Utils/Buffer.h"
+#include "Utils/Hash.h"
+#include "Utils/UID.h"
+#include "Utils/FlatHashMap.h"
+#include "Utils/Profiling.h"
+#include "FileSystem/ImportDatabase.h"
+#include "FileSystem/ConstJsonValue.h"
+#include "FileSystem/JsonWriter.h"
+#include "FileSystem/BinaryWriter.h"
+#include "FileSystem/BinaryReader.h"
 #include "FileSystem/MeshImporter.h"
 #include "FileSystem/TextureImporter.h"
 #include "Resources/GameObject.h"
 #include "Resources/Material.h"
+#include "Resources/Mesh.h"
 #include "Components/ComponentTransform.h"
 #include "Components/ComponentBoundingBox.h"
 #include "Components/ComponentMaterial.h"
@@ -20,9 +31,14 @@
 #include "assimp/cimport.h"
 #include "assimp/postprocess.h"
 #include "rapidjson/document.h"
-#include "rapidjson/prettywriter.h"
+#include "rapidjson/reader.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
 #include "rapidjson/error/en.h"
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <string.h>
 
 #include "Utils/Leaks.h"
 
@@ -33,15 +49,53 @@
 #define JSON_TAG_QUADTREE_ELEMENTS_PER_NODE "QuadtreeElementsPerNode"
 #define JSON_TAG_PARENT_ID "ParentId"
 
-static void ImportNode(const aiScene* assimpScene, const std::vector<Material>& materials, const aiNode* node, GameObject* parent, const float4x4& accumulatedTransform) {
+// Increase when the generated artifacts change so that every scene gets reimported
+#define SCENE_IMPORTER_VERSION 2
+#define SCENE_IMPORTER_FLAGS aiProcessPreset_TargetRealtime_MaxQuality
+
+// Binary scenes. Increase the version when the layout of any record or component payload changes
+#define SCENE_BINARY_MAGIC "TSCN"
+#define SCENE_BINARY_VERSION 2
+
+struct SceneBinaryHeader {
+	char magic[4];
+	unsigned version;
+	unsigned numGameObjects;
+	unsigned numComponentBlocks;
+	float quadtreeBounds[4];
+	unsigned quadtreeMaxDepth;
+	unsigned quadtreeElementsPerNode;
+};
+
+// GameObjects are stored parents first, so the parent is always loaded before its children
+struct SceneBinaryGameObject {
+	UID id;
+	unsigned nameIndex;
+	int parentIndex;
+	bool active;
+};
+
+// All the components of the same type are stored together in a block
+struct SceneBinaryComponentBlock {
+	ComponentType type;
+	unsigned count;
+	unsigned byteSize;
+};
+
+struct SceneBinaryComponent {
+	unsigned ownerIndex;
+	bool active;
+};
+
+static void ImportNode(const aiScene* assimpScene, const std::vector<Material>& materials, const aiNode* node, GameObject* parent, const float4x4& accumulatedTransform, std::vector<std::string>& artifactPaths) {
 	std::string name = node->mName.C_Str();
-	LOG("Importing node: \"%s\"", name.c_str());
+	LOG_VERBOSE(LogCategory::IMPORT, "Importing node: \"%s\"", name.c_str());
 
 	if (name.find("$AssimpFbx$") != std::string::npos) { // Auxiliary node
 		// Import children nodes
 		for (unsigned int i = 0; i < node->mNumChildren; ++i) {
 			const float4x4& transform = accumulatedTransform * (*(float4x4*) &node->mTransformation);
-			ImportNode(assimpScene, materials, node->mChildren[i], parent, transform);
+			ImportNode(assimpScene, materials, node->mChildren[i], parent, transform, artifactPaths);
 		}
 	} else { // Normal node
 		// Create GameObject
@@ -61,7 +115,7 @@ static void ImportNode(const aiScene* assimpScene, const std::vector<Material>&
 		transform->SetRotation(rotation);
 		transform->SetScale(scale);
 		transform->CalculateGlobalMatrix();
-		LOG("Transform: (%f, %f, %f), (%f, %f, %f, %f), (%f, %f, %f)", position.x, position.y, position.z, rotation.x, rotation.y, rotation.z, rotation.w, scale.x, scale.y, scale.z);
+		LOG_VERBOSE(LogCategory::IMPORT, "Transform: (%f, %f, %f), (%f, %f, %f, %f), (%f, %f, %f)", position.x, position.y, position.z, rotation.x, rotation.y, rotation.z, rotation.w, scale.x, scale.y, scale.z);
 
 		// Save min and max points
 		vec minPoint = vec(FLOAT_INF, FLOAT_INF, FLOAT_INF);
@@ -69,21 +123,23 @@ static void ImportNode(const aiScene* assimpScene, const std::vector<Material>&
 
 		// Load meshes
 		for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
-			LOG("Importing mesh %i", i);
+			LOG_VERBOSE(LogCategory::IMPORT, "Importing mesh %i", i);
 			aiMesh* assimpMesh = assimpScene->mMeshes[node->mMeshes[i]];
 
 			ComponentMesh* mesh = gameObject->CreateComponent<ComponentMesh>();
-			mesh->mesh = MeshImporter::ImportMesh(assimpMesh, i);
-			mesh->mesh->materialIndex = i;
+			Mesh* meshResource = MeshImporter::ImportMesh(assimpMesh);
+			mesh->mesh = App->resources->meshes.GetHandle(meshResource);
+			mesh->materialIndex = i;
+			artifactPaths.push_back(std::string(MESHES_PATH) + "/" + meshResource->fileName.c_str() + MESH_EXTENSION);
 
 			// TODO: Move mesh loading to a better place
-			MeshImporter::LoadMesh(mesh->mesh);
+			MeshImporter::LoadMesh(meshResource);
 
 			ComponentMaterial* material = gameObject->CreateComponent<ComponentMaterial>();
 			if (materials.size() > 0) {
 				if (assimpMesh->mMaterialIndex >= materials.size()) {
 					material->material = materials.front();
-					LOG("Invalid material found", assimpMesh->mMaterialIndex);
+					LOG_WARNING(LogCategory::IMPORT, "Invalid material found", assimpMesh->mMaterialIndex);
 				} else {
 					material->material = materials[assimpMesh->mMaterialIndex];
 				}
@@ -110,12 +166,91 @@ static void ImportNode(const aiScene* assimpScene, const std::vector<Material>&
 
 		// Import children nodes
 		for (unsigned int i = 0; i < node->mNumChildren; ++i) {
-			ImportNode(assimpScene, materials, node->mChildren[i], gameObject, float4x4::identity);
+			ImportNode(assimpScene, materials, node->mChildren[i], gameObject, float4x4::identity, artifactPaths);
 		}
 	}
 }
 
+static void SavePrefabGameObject(const GameObject& gameObject, JsonWriter& writer) {
+	writer.StartObject();
+	gameObject.Save(writer);
+	writer.EndObject();
+
+	for (const GameObject* child : gameObject.GetChildren()) {
+		SavePrefabGameObject(*child, writer);
+	}
+}
+
+// Prefabs store the GameObject hierarchy generated by an import, so that an unchanged model can be instantiated without assimp
+static void SavePrefab(const char* filePath, const std::vector<GameObject*>& roots) {
+	JsonWriter writer(filePath);
+	if (!writer.IsOpen()) return;
+
+	writer.StartObject();
+	writer.Key(JSON_TAG_GAMEOBJECTS);
+	writer.StartArray();
+	for (const GameObject* root : roots) {
+		SavePrefabGameObject(*root, writer);
+	}
+	writer.EndArray();
+	writer.EndObject();
+}
+
+static bool LoadPrefab(const char* filePath, GameObject* parent) {
+	Buffer<char> buffer = App->files->Load(filePath);
+	if (buffer.Size() == 0) return false;
+
+	rapidjson::Document document;
+	document.ParseInsitu<rapidjson::kParseNanAndInfFlag>(buffer.Data());
+	if (document.HasParseError()) {
+		LOG_CRITICAL(LogCategory::IMPORT, "Error parsing JSON: %s (offset: %u)", rapidjson::GetParseError_En(document.GetParseError()), document.GetErrorOffset());
+		return false;
+	}
+	ConstJsonValue jPrefab(document);
+
+	// Load GameObjects with the ids stored in the prefab
+	ConstJsonValue jGameObjects = jPrefab[JSON_TAG_GAMEOBJECTS];
+	unsigned jGameObjectsSize = jGameObjects.Size();
+	Buffer<GameObject*> gameObjects(jGameObjectsSize);
+	FlatHashMap<GameObject*> prefabIdMap;
+	prefabIdMap.Reserve(jGameObjectsSize);
+	for (unsigned i = 0; i < jGameObjectsSize; ++i) {
+		GameObject* gameObject = App->scene->gameObjects.Obtain();
+		gameObject->Load(jGameObjects[i]);
+
+		prefabIdMap[gameObject->GetID()] = gameObject;
+		gameObjects[i] = gameObject;
+	}
+
+	// Link the hierarchy and give every instance a new id. Prefab roots hang from the given parent.
+	for (unsigned i = 0; i < jGameObjectsSize; ++i) {
+		GameObject* gameObject = gameObjects[i];
+
+		UID parentId = jGameObjects[i][JSON_TAG_PARENT_ID];
+		GameObject** prefabParent = prefabIdMap.Find(parentId);
+		gameObject->SetParent(prefabParent != nullptr ? *prefabParent : parent);
+
+		gameObject->id = GenerateUID();
+		App->scene->gameObjectsIdMap[gameObject->GetID()] = gameObject;
+	}
+
+	// Init components
+	for (unsigned i = 0; i < jGameObjectsSize; ++i) {
+		gameObjects[i]->InitComponents();
+	}
+
+	return true;
+}
+
+// The textures of a scene are imported with it, so their settings are part of the scene's
+static Hash GetSettingsHash() {
+	Hash textureSettingsHash = HashCombine(TextureImporter::GetSettingsHash(TextureType::COLOR), TextureImporter::GetSettingsHash(TextureType::NORMAL_MAP));
+	return HashCombine(HashCombine(SCENE_IMPORTER_VERSION, SCENE_IMPORTER_FLAGS), textureSettingsHash);
+}
+
 bool SceneImporter::ImportScene(const char* filePath, GameObject* parent) {
+	PROFILE_ZONE("SceneImporter - ImportScene", ProfilerColor::Orange)
+
 	// Timer to measure importing a scene
 	MSTimer timer;
 	timer.Start();
@@ -123,27 +258,50 @@ bool SceneImporter::ImportScene(const char* filePath, GameObject* parent) {
 	// Check for extension support
 	std::string extension = App->files->GetFileExtension(filePath);
 	if (!aiIsExtensionSupported(extension.c_str())) {
-		LOG("Extension is not supported by assimp: \"%s\".", extension);
+		LOG_WARNING(LogCategory::IMPORT, "Extension is not supported by assimp: \"%s\".", extension);
+		return false;
+	}
+
+	// Identify the scene by its contents and import settings
+	Hash sourceHash;
+	if (!ImportDatabase::GetSourceHash(filePath, sourceHash)) {
+		LOG_WARNING(LogCategory::IMPORT, "Unable to read file: \"%s\".", filePath);
 		return false;
 	}
+	Hash settingsHash = GetSettingsHash();
+	std::string prefabFilePath = std::string(PREFABS_PATH) + "/" + HashToString(HashCombine(sourceHash, settingsHash)) + PREFAB_EXTENSION;
+
+	// Instantiate the previous import if nothing changed
+	if (ImportDatabase::IsUpToDate(filePath, sourceHash, settingsHash)) {
+		LOG_INFO(LogCategory::IMPORT, "Scene is up to date, instantiating \"%s\".", prefabFilePath.c_str());
+		if (LoadPrefab(prefabFilePath.c_str(), parent)) {
+			unsigned timeMs = timer.Stop();
+			LOG_INFO(LogCategory::IMPORT, "Scene instantiated in %ums.", timeMs);
+			return true;
+		}
+	}
 
 	// Import scene
-	LOG("Importing scene from path: \"%s\".", filePath);
-	const aiScene* assimpScene = aiImportFile(filePath, aiProcessPreset_TargetRealtime_MaxQuality);
+	LOG_INFO(LogCategory::IMPORT, "Importing scene from path: \"%s\".", filePath);
+	const aiScene* assimpScene = aiImportFile(filePath, SCENE_IMPORTER_FLAGS);
 	DEFER {
 		aiReleaseImport(assimpScene);
 	};
 	if (!assimpScene) {
-		LOG("Error importing scene: %s", filePath, aiGetErrorString());
+		LOG_CRITICAL(LogCategory::IMPORT, "Error importing scene: %s", filePath, aiGetErrorString());
 		return false;
 	}
 
+	// Keep track of every generated Library file, and of the texture sources they were built from
+	std::vector<std::string> artifactPaths;
+	std::vector<std::string> dependencyPaths;
+
 	// Load materials
-	LOG("Importing %i materials...", assimpScene->mNumMaterials);
+	LOG_INFO(LogCategory::IMPORT, "Importing %i materials...", assimpScene->mNumMaterials);
 	std::vector<Material> materials;
 	materials.reserve(assimpScene->mNumMaterials);
 	for (unsigned int i = 0; i < assimpScene->mNumMaterials; ++i) {
-		LOG("Loading material %i...", i);
+		LOG_VERBOSE(LogCategory::IMPORT, "Loading material %i...", i);
 		aiMaterial* assimpMaterial = assimpScene->mMaterials[i];
 		aiString materialFilePath;
 		aiTextureMapping mapping;
@@ -156,36 +314,41 @@ bool SceneImporter::ImportScene(const char* filePath, GameObject* parent) {
 			assert(uvIndex == 0);
 
 			// Try to load from the path given in the model file
-			LOG("Trying to import diffuse texture...");
-			Texture* texture = TextureImporter::ImportTexture(materialFilePath.C_Str());
+			LOG_VERBOSE(LogCategory::IMPORT, "Trying to import diffuse texture...");
+			std::string textureFilePath = materialFilePath.C_Str();
+			Texture* texture = TextureImporter::ImportTexture(textureFilePath.c_str());
 
 			// Try to load relative to the model folder
 			if (texture == nullptr) {
-				LOG("Trying to import texture relative to model folder...");
+				LOG_VERBOSE(LogCategory::IMPORT, "Trying to import texture relative to model folder...");
 				std::string modelFolderPath = App->files->GetFileFolder(filePath);
 				std::string modelFolderMaterialFilePath = modelFolderPath + "/" + materialFilePath.C_Str();
-				texture = TextureImporter::ImportTexture(modelFolderMaterialFilePath.c_str());
+				textureFilePath = modelFolderMaterialFilePath;
+				texture = TextureImporter::ImportTexture(textureFilePath.c_str());
 			}
 
 			// Try to load relative to the textures folder
 			if (texture == nullptr) {
-				LOG("Trying to import texture relative to textures folder...");
+				LOG_VERBOSE(LogCategory::IMPORT, "Trying to import texture relative to textures folder...");
 				std::string materialFile = App->files->GetFileNameAndExtension(materialFilePath.C_Str());
 				std::string texturesFolderMaterialFileDir = std::string(TEXTURES_PATH) + "/" + materialFile;
-				texture = TextureImporter::ImportTexture(texturesFolderMaterialFileDir.c_str());
+				textureFilePath = texturesFolderMaterialFileDir;
+				texture = TextureImporter::ImportTexture(textureFilePath.c_str());
 			}
 
 			if (texture == nullptr) {
-				LOG("Unable to find diffuse texture file.");
+				LOG_WARNING(LogCategory::IMPORT, "Unable to find diffuse texture file.");
 			} else {
-				LOG("Diffuse texture imported successfuly.");
+				LOG_VERBOSE(LogCategory::IMPORT, "Diffuse texture imported successfuly.");
+				artifactPaths.push_back(std::string(TEXTURES_PATH) + "/" + texture->fileName.c_str() + TEXTURE_EXTENSION);
+				dependencyPaths.push_back(textureFilePath);
 				material.hasDiffuseMap = true;
-				material.diffuseMap = texture;
+				material.diffuseMap = App->resources->textures.GetHandle(texture);
 				// TODO: Move load to a better place
 				TextureImporter::LoadTexture(texture);
 			}
 		} else {
-			LOG("Diffuse texture not found.");
+			LOG_VERBOSE(LogCategory::IMPORT, "Diffuse texture not found.");
 		}
 
 		if (assimpMaterial->GetTexture(aiTextureType_SPECULAR, 0, &materialFilePath, &mapping, &uvIndex) == AI_SUCCESS) {
@@ -194,163 +357,717 @@ bool SceneImporter::ImportScene(const char* filePath, GameObject* parent) {
 			assert(uvIndex == 0);
 
 			// Try to load from the path given in the model file
-			LOG("Trying to import specular texture...");
-			Texture* texture = TextureImporter::ImportTexture(materialFilePath.C_Str());
+			LOG_VERBOSE(LogCategory::IMPORT, "Trying to import specular texture...");
+			std::string textureFilePath = materialFilePath.C_Str();
+			Texture* texture = TextureImporter::ImportTexture(textureFilePath.c_str());
 
 			// Try to load relative to the model folder
 			if (texture == nullptr) {
-				LOG("Trying to import texture relative to model folder...");
+				LOG_VERBOSE(LogCategory::IMPORT, "Trying to import texture relative to model folder...");
 				std::string modelFolderPath = App->files->GetFileFolder(filePath);
 				std::string modelFolderMaterialFilePath = modelFolderPath + "/" + materialFilePath.C_Str();
-				texture = TextureImporter::ImportTexture(modelFolderMaterialFilePath.c_str());
+				textureFilePath = modelFolderMaterialFilePath;
+				texture = TextureImporter::ImportTexture(textureFilePath.c_str());
 			}
 
 			// Try to load relative to the textures folder
 			if (texture == nullptr) {
-				LOG("Trying to import texture relative to textures folder...");
+				LOG_VERBOSE(LogCategory::IMPORT, "Trying to import texture relative to textures folder...");
 				std::string materialFileName = App->files->GetFileName(materialFilePath.C_Str());
 				std::string texturesFolderMaterialFileDir = std::string(TEXTURES_PATH) + "/" + materialFileName + TEXTURE_EXTENSION;
-				texture = TextureImporter::ImportTexture(texturesFolderMaterialFileDir.c_str());
+				textureFilePath = texturesFolderMaterialFileDir;
+				texture = TextureImporter::ImportTexture(textureFilePath.c_str());
 			}
 
 			if (texture == nullptr) {
-				LOG("Unable to find specular texture file.");
+				LOG_WARNING(LogCategory::IMPORT, "Unable to find specular texture file.");
 			} else {
-				LOG("Specular texture imported successfuly.");
+				LOG_VERBOSE(LogCategory::IMPORT, "Specular texture imported successfuly.");
+				artifactPaths.push_back(std::string(TEXTURES_PATH) + "/" + texture->fileName.c_str() + TEXTURE_EXTENSION);
+				dependencyPaths.push_back(textureFilePath);
 				material.hasSpecularMap = true;
-				material.specularMap = texture;
+				material.specularMap = App->resources->textures.GetHandle(texture);
+				// TODO: Move load to a better place
+				TextureImporter::LoadTexture(texture);
+			}
+		} else {
+			LOG_VERBOSE(LogCategory::IMPORT, "Specular texture not found.");
+		}
+
+		if (assimpMaterial->GetTexture(aiTextureType_NORMALS, 0, &materialFilePath, &mapping, &uvIndex) == AI_SUCCESS) {
+			// Check if the material is valid for our purposes
+			assert(mapping == aiTextureMapping_UV);
+			assert(uvIndex == 0);
+
+			// Try to load from the path given in the model file
+			LOG_VERBOSE(LogCategory::IMPORT, "Trying to import normal map...");
+			std::string textureFilePath = materialFilePath.C_Str();
+			Texture* texture = TextureImporter::ImportTexture(textureFilePath.c_str(), TextureType::NORMAL_MAP);
+
+			// Try to load relative to the model folder
+			if (texture == nullptr) {
+				LOG_VERBOSE(LogCategory::IMPORT, "Trying to import texture relative to model folder...");
+				std::string modelFolderPath = App->files->GetFileFolder(filePath);
+				std::string modelFolderMaterialFilePath = modelFolderPath + "/" + materialFilePath.C_Str();
+				textureFilePath = modelFolderMaterialFilePath;
+				texture = TextureImporter::ImportTexture(textureFilePath.c_str(), TextureType::NORMAL_MAP);
+			}
+
+			// Try to load relative to the textures folder
+			if (texture == nullptr) {
+				LOG_VERBOSE(LogCategory::IMPORT, "Trying to import texture relative to textures folder...");
+				std::string materialFile = App->files->GetFileNameAndExtension(materialFilePath.C_Str());
+				std::string texturesFolderMaterialFileDir = std::string(TEXTURES_PATH) + "/" + materialFile;
+				textureFilePath = texturesFolderMaterialFileDir;
+				texture = TextureImporter::ImportTexture(textureFilePath.c_str(), TextureType::NORMAL_MAP);
+			}
+
+			if (texture == nullptr) {
+				LOG_WARNING(LogCategory::IMPORT, "Unable to find normal map file.");
+			} else {
+				LOG_VERBOSE(LogCategory::IMPORT, "Normal map imported successfuly.");
+				artifactPaths.push_back(std::string(TEXTURES_PATH) + "/" + texture->fileName.c_str() + TEXTURE_EXTENSION);
+				dependencyPaths.push_back(textureFilePath);
+				material.hasNormalMap = true;
+				material.normalMap = App->resources->textures.GetHandle(texture);
 				// TODO: Move load to a better place
 				TextureImporter::LoadTexture(texture);
 			}
 		} else {
-			LOG("Specular texture not found.");
+			LOG_VERBOSE(LogCategory::IMPORT, "Normal map not found.");
 		}
 
 		assimpMaterial->Get(AI_MATKEY_COLOR_DIFFUSE, material.diffuseColor);
 		assimpMaterial->Get(AI_MATKEY_COLOR_SPECULAR, material.specularColor);
 		assimpMaterial->Get(AI_MATKEY_SHININESS, material.shininess);
 
-		LOG("Material imported.");
+		LOG_VERBOSE(LogCategory::IMPORT, "Material imported.");
 		materials.push_back(material);
 	}
 
 	// Create scene tree
-	LOG("Importing scene tree.");
-	ImportNode(assimpScene, materials, assimpScene->mRootNode, parent, float4x4::identity);
+	LOG_VERBOSE(LogCategory::IMPORT, "Importing scene tree.");
+	size_t firstRootIndex = parent->GetChildren().size();
+	ImportNode(assimpScene, materials, assimpScene->mRootNode, parent, float4x4::identity, artifactPaths);
+
+	// Save the imported hierarchy so that the next import can skip assimp
+	std::vector<GameObject*> roots(parent->GetChildren().begin() + firstRootIndex, parent->GetChildren().end());
+	SavePrefab(prefabFilePath.c_str(), roots);
+	artifactPaths.push_back(prefabFilePath);
+	ImportDatabase::Register(filePath, sourceHash, settingsHash, artifactPaths, dependencyPaths);
 
 	unsigned timeMs = timer.Stop();
-	LOG("Scene imported in %ums.", timeMs);
+	LOG_INFO(LogCategory::IMPORT, "Scene imported in %ums.", timeMs);
 	return true;
 }
 
-bool SceneImporter::LoadScene(const char* fileName) {
-	// Clear scene
-	App->scene->ClearScene();
-	App->editor->selectedGameObject = nullptr;
+// Meshes in the same order as ImportNode creates them
+static void CollectNodeMeshes(const aiScene* assimpScene, const aiNode* node, std::vector<const aiMesh*>& assimpMeshes) {
+	if (std::string(node->mName.C_Str()).find("$AssimpFbx$") == std::string::npos) {
+		for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
+			assimpMeshes.push_back(assimpScene->mMeshes[node->mMeshes[i]]);
+		}
+	}
 
-	// Timer to measure loading a scene
+	for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+		CollectNodeMeshes(assimpScene, node->mChildren[i], assimpMeshes);
+	}
+}
+
+static bool StartsWith(const std::string& string, const char* prefix) {
+	return string.compare(0, strlen(prefix), prefix) == 0;
+}
+
+bool SceneImporter::ReimportMeshes(const char* filePath) {
+	PROFILE_ZONE("SceneImporter - ReimportMeshes", ProfilerColor::Orange)
+
+	// Timer to measure reimporting the meshes of a scene
 	MSTimer timer;
 	timer.Start();
 
-	// Read from file
-	std::string filePath = std::string(SCENES_PATH) + "/" + fileName + SCENE_EXTENSION;
-	Buffer<char> buffer = App->files->Load(filePath.c_str());
+	const std::vector<std::string>* previousArtifactPaths = ImportDatabase::GetArtifactPaths(filePath);
+	if (previousArtifactPaths == nullptr) return false;
+	std::vector<std::string> artifactPaths = *previousArtifactPaths;
 
-	if (buffer.Size() == 0) return false;
+	Hash sourceHash;
+	if (!ImportDatabase::GetSourceHash(filePath, sourceHash)) {
+		LOG_WARNING(LogCategory::IMPORT, "Unable to read file: \"%s\".", filePath);
+		return false;
+	}
+	Hash settingsHash = GetSettingsHash();
+	if (ImportDatabase::IsUpToDate(filePath, sourceHash, settingsHash)) return true;
 
-	// Parse document from file
-	rapidjson::Document document;
-	document.ParseInsitu<rapidjson::kParseNanAndInfFlag>(buffer.Data());
-	if (document.HasParseError()) {
-		LOG("Error parsing JSON: %s (offset: %u)", rapidjson::GetParseError_En(document.GetParseError()), document.GetErrorOffset());
+	LOG_INFO(LogCategory::IMPORT, "Reimporting meshes from path: \"%s\".", filePath);
+	const aiScene* assimpScene = aiImportFile(filePath, SCENE_IMPORTER_FLAGS);
+	DEFER {
+		aiReleaseImport(assimpScene);
+	};
+	if (!assimpScene) {
+		LOG_CRITICAL(LogCategory::IMPORT, "Error importing scene: %s", filePath, aiGetErrorString());
+		return false;
+	}
+
+	// New meshes are matched with the previous ones by import order
+	std::vector<const aiMesh*> assimpMeshes;
+	CollectNodeMeshes(assimpScene, assimpScene->mRootNode, assimpMeshes);
+	std::vector<size_t> meshArtifactIndices;
+	for (size_t i = 0; i < artifactPaths.size(); ++i) {
+		if (StartsWith(artifactPaths[i], MESHES_PATH "/")) meshArtifactIndices.push_back(i);
+	}
+	if (assimpMeshes.size() != meshArtifactIndices.size()) {
+		LOG_WARNING(LogCategory::IMPORT, "The hierarchy of \"%s\" changed, import it again to update it.", filePath);
+		return false;
+	}
+
+	// Swap the new files into the live meshes, so that the GameObjects keep pointing to them
+	std::vector<Mesh*> replacedMeshes;
+	std::vector<AABB> replacedMeshAABBs;
+	for (size_t i = 0; i < assimpMeshes.size(); ++i) {
+		std::string& artifactPath = artifactPaths[meshArtifactIndices[i]];
+		InternedString previousFileName = App->files->GetFileName(artifactPath.c_str());
+		InternedString fileName = MeshImporter::ImportMeshFile(assimpMeshes[i]);
+		artifactPath = std::string(MESHES_PATH) + "/" + fileName.c_str() + MESH_EXTENSION;
+		if (fileName == previousFileName) continue;
+
+		const aiMesh* assimpMesh = assimpMeshes[i];
+		AABB aabb;
+		aabb.SetFrom((const vec*) assimpMesh->mVertices, assimpMesh->mNumVertices);
+		Mesh* mesh = App->resources->FindMesh(previousFileName);
+		if (mesh != nullptr) {
+			MeshImporter::UnloadMesh(mesh);
+			App->resources->SetMeshFileName(mesh, fileName);
+			MeshImporter::LoadMesh(mesh);
+			replacedMeshes.push_back(mesh);
+			replacedMeshAABBs.push_back(aabb);
+		}
+	}
+
+	// The prefab points to the previous meshes. Without it, the next ImportScene of the file imports it again.
+	for (size_t i = artifactPaths.size(); i > 0; --i) {
+		if (StartsWith(artifactPaths[i - 1], PREFABS_PATH "/")) artifactPaths.erase(artifactPaths.begin() + (i - 1));
+	}
+	ImportDatabase::Register(filePath, sourceHash, settingsHash, artifactPaths, ImportDatabase::GetDependencyPaths(filePath));
+
+	// Fit the bounding boxes to the new meshes
+	if (!replacedMeshes.empty()) {
+		for (GameObject& gameObject : App->scene->gameObjects) {
+			ComponentBoundingBox* boundingBox = gameObject.GetComponent<ComponentBoundingBox>();
+			if (boundingBox == nullptr) continue;
+
+			AABB aabb;
+			aabb.SetNegativeInfinity();
+			for (ComponentMesh* componentMesh : gameObject.GetComponents<ComponentMesh>()) {
+				std::vector<Mesh*>::iterator it = std::find(replacedMeshes.begin(), replacedMeshes.end(), componentMesh->GetMesh());
+				if (it != replacedMeshes.end()) aabb.Enclose(replacedMeshAABBs[it - replacedMeshes.begin()]);
+			}
+			if (!aabb.IsFinite()) continue;
+
+			boundingBox->SetLocalBoundingBox(aabb);
+			boundingBox->CalculateWorldBoundingBox(true);
+		}
+		App->scene->RebuildQuadtree();
+	}
+
+	unsigned timeMs = timer.Stop();
+	LOG_INFO(LogCategory::IMPORT, "%u meshes reimported in %ums.", (unsigned) replacedMeshes.size(), timeMs);
+	return true;
+}
+
+static bool IsBinaryScene(const Buffer<char>& buffer) {
+	return buffer.Size() >= sizeof(SceneBinaryHeader) && memcmp(buffer.Data(), SCENE_BINARY_MAGIC, 4) == 0;
+}
+
+// Parents first: the children of each GameObject are appended after it
+static void CollectGameObjects(std::vector<GameObject*>& gameObjects, std::vector<int>& parentIndices) {
+	gameObjects.reserve(App->scene->gameObjects.Count());
+	parentIndices.reserve(App->scene->gameObjects.Count());
+	if (App->scene->root == nullptr) return;
+
+	gameObjects.push_back(App->scene->root);
+	parentIndices.push_back(-1);
+	for (unsigned i = 0; i < gameObjects.size(); ++i) {
+		for (GameObject* child : gameObjects[i]->GetChildren()) {
+			gameObjects.push_back(child);
+			parentIndices.push_back(i);
+		}
+	}
+}
+
+static bool LoadBinaryScene(const char* data, size_t size) {
+	BinaryReader reader(data, size);
+
+	SceneBinaryHeader header = reader.Read<SceneBinaryHeader>();
+	if (header.version != SCENE_BINARY_VERSION) {
+		LOG_CRITICAL(LogCategory::IMPORT, "Unsupported binary scene version: %u (expected %u)", header.version, SCENE_BINARY_VERSION);
+		return false;
+	}
+	if (header.numGameObjects == 0 || !reader.ReadStringTable()) {
+		LOG_CRITICAL(LogCategory::IMPORT, "Error reading binary scene: invalid header or string table.");
 		return false;
 	}
-	JsonValue jScene(document, document);
 
 	// Load GameObjects
-	JsonValue jGameObjects = jScene[JSON_TAG_GAMEOBJECTS];
-	unsigned jGameObjectsSize = jGameObjects.Size();
-	Buffer<UID> ids(jGameObjectsSize);
-	for (unsigned i = 0; i < jGameObjectsSize; ++i) {
-		JsonValue jGameObject = jGameObjects[i];
+	Buffer<GameObject*> gameObjects(header.numGameObjects);
+	App->scene->gameObjectsIdMap.Reserve(header.numGameObjects);
+	for (unsigned i = 0; i < header.numGameObjects; ++i) {
+		SceneBinaryGameObject record = reader.Read<SceneBinaryGameObject>();
 
 		GameObject* gameObject = App->scene->gameObjects.Obtain();
-		gameObject->Load(jGameObject);
+		gameObject->id = record.id;
+		gameObject->name = reader.GetString(record.nameIndex);
+		record.active ? gameObject->Enable() : gameObject->Disable();
+		gameObject->isInQuadtree = false;
+		if (record.parentIndex >= 0 && (unsigned) record.parentIndex < i) {
+			gameObject->SetParent(gameObjects[record.parentIndex]);
+		}
 
-		UID id = gameObject->GetID();
-		App->scene->gameObjectsIdMap[id] = gameObject;
-		ids[i] = id;
+		App->scene->gameObjectsIdMap[record.id] = gameObject;
+		gameObjects[i] = gameObject;
 	}
+	App->scene->root = gameObjects[0];
 
-	// Post-load
-	App->scene->root = App->scene->GetGameObject(jScene[JSON_TAG_ROOT_ID]);
-	for (unsigned i = 0; i < jGameObjectsSize; ++i) {
-		JsonValue jGameObject = jGameObjects[i];
+	// Load components
+	for (unsigned i = 0; i < header.numComponentBlocks && !reader.HasFailed(); ++i) {
+		SceneBinaryComponentBlock block = reader.Read<SceneBinaryComponentBlock>();
+		size_t blockEnd = reader.Tell() + block.byteSize;
+
+		for (unsigned j = 0; j < block.count; ++j) {
+			SceneBinaryComponent record = reader.Read<SceneBinaryComponent>();
+			if (reader.HasFailed() || record.ownerIndex >= header.numGameObjects) break;
+
+			Component* component = CreateComponentByType(*gameObjects[record.ownerIndex], block.type, record.active);
+			if (component == nullptr) {
+				LOG_WARNING(LogCategory::IMPORT, "Skipping unknown component type: %u", (unsigned) block.type);
+				break;
+			}
+			component->Load(reader);
+		}
 
-		UID id = ids[i];
-		GameObject* gameObject = App->scene->GetGameObject(id);
-		gameObject->PostLoad(jGameObject);
+		if (reader.Tell() != blockEnd) {
+			LOG_WARNING(LogCategory::IMPORT, "Component block of type %u has an unexpected size.", (unsigned) block.type);
+			reader.Seek(blockEnd);
+		}
+	}
+
+	if (reader.HasFailed()) {
+		LOG_CRITICAL(LogCategory::IMPORT, "Error reading binary scene: unexpected end of file.");
 	}
 
 	// Init components
-	for (unsigned i = 0; i < jGameObjectsSize; ++i) {
-		JsonValue jGameObject = jGameObjects[i];
+	for (unsigned i = 0; i < header.numGameObjects; ++i) {
+		gameObjects[i]->InitComponents();
+	}
+
+	// Quadtree generation
+	App->scene->quadtreeBounds = {{header.quadtreeBounds[0], header.quadtreeBounds[1]}, {header.quadtreeBounds[2], header.quadtreeBounds[3]}};
+	App->scene->quadtreeMaxDepth = header.quadtreeMaxDepth;
+	App->scene->quadtreeElementsPerNode = header.quadtreeElementsPerNode;
+	App->scene->RebuildQuadtree();
+
+	return !reader.HasFailed();
+}
+
+// Builds the GameObjects of a JSON scene from the parser events.
+// Only the GameObject being read is turned into a document, so the scene is never fully in memory as a DOM.
+class SceneJsonHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, SceneJsonHandler> {
+public:
+	SceneJsonHandler()
+		: writer(gameObjectBuffer) {}
+
+	bool Null() {
+		return IsInGameObject() ? writer.Null() : true;
+	}
+
+	bool Bool(bool b) {
+		return IsInGameObject() ? writer.Bool(b) : true;
+	}
+
+	bool Int(int i) {
+		return IsInGameObject() ? writer.Int(i) : Number(i, i);
+	}
+
+	bool Uint(unsigned u) {
+		return IsInGameObject() ? writer.Uint(u) : Number(u, u);
+	}
+
+	bool Int64(int64_t i) {
+		return IsInGameObject() ? writer.Int64(i) : Number((double) i, i);
+	}
+
+	bool Uint64(uint64_t u) {
+		return IsInGameObject() ? writer.Uint64(u) : Number((double) u, u);
+	}
+
+	bool Double(double d) {
+		return IsInGameObject() ? writer.Double(d) : Number(d, (UID) d);
+	}
+
+	bool String(const char* str, rapidjson::SizeType length, bool copy) {
+		return IsInGameObject() ? writer.String(str, length, copy) : true;
+	}
+
+	bool StartObject() {
+		depth += 1;
+		if (inGameObjects && depth == GAMEOBJECT_DEPTH) {
+			gameObjectBuffer.Clear();
+			writer.Reset(gameObjectBuffer);
+		}
+
+		return IsInGameObject() ? writer.StartObject() : true;
+	}
+
+	bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+		if (IsInGameObject()) return writer.Key(str, length, copy);
+
+		if (depth == 1) key.assign(str, length);
+		return true;
+	}
+
+	bool EndObject(rapidjson::SizeType memberCount) {
+		bool result = IsInGameObject() ? writer.EndObject(memberCount) : true;
+		if (result && inGameObjects && depth == GAMEOBJECT_DEPTH) {
+			result = LoadGameObject();
+		}
 
-		UID id = ids[i];
-		GameObject* gameObject = App->scene->GetGameObject(id);
+		depth -= 1;
+		return result;
+	}
+
+	bool StartArray() {
+		depth += 1;
+		if (depth == 2 && key == JSON_TAG_GAMEOBJECTS) {
+			inGameObjects = true;
+		}
+
+		return IsInGameObject() ? writer.StartArray() : true;
+	}
+
+	bool EndArray(rapidjson::SizeType elementCount) {
+		bool result = IsInGameObject() ? writer.EndArray(elementCount) : true;
+		if (depth == 2) {
+			inGameObjects = false;
+		}
+
+		depth -= 1;
+		return result;
+	}
+
+public:
+	UID rootId = 0;
+	float quadtreeBounds[4] = {0, 0, 0, 0};
+	unsigned quadtreeMaxDepth = 0;
+	unsigned quadtreeElementsPerNode = 0;
+
+	std::vector<GameObject*> gameObjects;
+	std::vector<UID> parentIds;
+
+private:
+	static const unsigned GAMEOBJECT_DEPTH = 3; // Scene object > GameObjects array > GameObject object
+
+	bool IsInGameObject() const {
+		return inGameObjects && depth >= GAMEOBJECT_DEPTH;
+	}
+
+	bool Number(double value, UID integer) {
+		if (depth == 1) {
+			if (key == JSON_TAG_ROOT_ID) rootId = integer;
+			else if (key == JSON_TAG_QUADTREE_MAX_DEPTH) quadtreeMaxDepth = (unsigned) integer;
+			else if (key == JSON_TAG_QUADTREE_ELEMENTS_PER_NODE) quadtreeElementsPerNode = (unsigned) integer;
+		} else if (depth == 2 && key == JSON_TAG_QUADTREE_BOUNDS && quadtreeBoundsIndex < 4) {
+			quadtreeBounds[quadtreeBoundsIndex++] = (float) value;
+		}
+
+		return true;
+	}
+
+	bool LoadGameObject() {
+		{
+			rapidjson::Document document(&allocator);
+			document.Parse<rapidjson::kParseNanAndInfFlag>(gameObjectBuffer.GetString(), gameObjectBuffer.GetSize());
+			if (document.HasParseError()) {
+				LOG_CRITICAL(LogCategory::IMPORT, "Error parsing GameObject: %s", rapidjson::GetParseError_En(document.GetParseError()));
+				return false;
+			}
+			ConstJsonValue jGameObject(document);
+
+			GameObject* gameObject = App->scene->gameObjects.Obtain();
+			gameObject->Load(jGameObject);
+			App->scene->gameObjectsIdMap[gameObject->GetID()] = gameObject;
+
+			gameObjects.push_back(gameObject);
+			parentIds.push_back(jGameObject[JSON_TAG_PARENT_ID]);
+		}
+
+		// The memory of the document is reused for the next GameObject
+		allocator.Clear();
+		return true;
+	}
+
+private:
+	unsigned depth = 0;
+	std::string key;
+	bool inGameObjects = false;
+	unsigned quadtreeBoundsIndex = 0;
+
+	rapidjson::StringBuffer gameObjectBuffer;
+	rapidjson::Writer<rapidjson::StringBuffer, rapidjson::UTF8<>, rapidjson::UTF8<>, rapidjson::CrtAllocator, rapidjson::kWriteNanAndInfFlag> writer;
+	rapidjson::MemoryPoolAllocator<> allocator;
+};
+
+static bool LoadJsonScene(const Buffer<char>& buffer) {
+	// Load GameObjects
+	SceneJsonHandler handler;
+	rapidjson::Reader reader;
+	rapidjson::StringStream stream(buffer.Data());
+	rapidjson::ParseResult result = reader.Parse<rapidjson::kParseNanAndInfFlag>(stream, handler);
+	if (result.IsError()) {
+		LOG_CRITICAL(LogCategory::IMPORT, "Error parsing JSON: %s (offset: %u)", rapidjson::GetParseError_En(result.Code()), result.Offset());
+	}
+
+	// Link the hierarchy
+	App->scene->root = App->scene->GetGameObject(handler.rootId);
+	for (unsigned i = 0; i < handler.gameObjects.size(); ++i) {
+		handler.gameObjects[i]->SetParent(App->scene->GetGameObject(handler.parentIds[i]));
+	}
+
+	// Init components
+	for (GameObject* gameObject : handler.gameObjects) {
 		gameObject->InitComponents();
 	}
 
 	// Quadtree generation
-	JsonValue jQuadtreeBounds = jScene[JSON_TAG_QUADTREE_BOUNDS];
-	App->scene->quadtreeBounds = {{jQuadtreeBounds[0], jQuadtreeBounds[1]}, {jQuadtreeBounds[2], jQuadtreeBounds[3]}};
-	App->scene->quadtreeMaxDepth = jScene[JSON_TAG_QUADTREE_MAX_DEPTH];
-	App->scene->quadtreeElementsPerNode = jScene[JSON_TAG_QUADTREE_ELEMENTS_PER_NODE];
+	App->scene->quadtreeBounds = {{handler.quadtreeBounds[0], handler.quadtreeBounds[1]}, {handler.quadtreeBounds[2], handler.quadtreeBounds[3]}};
+	App->scene->quadtreeMaxDepth = handler.quadtreeMaxDepth;
+	App->scene->quadtreeElementsPerNode = handler.quadtreeElementsPerNode;
 	App->scene->RebuildQuadtree();
 
+	return !result.IsError();
+}
+
+static void SaveBinaryScene(BinaryWriter& file) {
+	std::vector<GameObject*> gameObjects;
+	std::vector<int> parentIndices;
+	CollectGameObjects(gameObjects, parentIndices);
+
+	// Save GameObjects
+	BinaryWriter body;
+	for (unsigned i = 0; i < gameObjects.size(); ++i) {
+		GameObject* gameObject = gameObjects[i];
+
+		SceneBinaryGameObject record;
+		record.id = gameObject->id;
+		record.nameIndex = body.AddString(gameObject->name);
+		record.parentIndex = parentIndices[i];
+		record.active = gameObject->IsActive();
+		body.Write(record);
+	}
+
+	// Save components, one block per type
+	std::vector<ComponentType> types;
+	for (GameObject* gameObject : gameObjects) {
+		for (Component* component : gameObject->components) {
+			if (std::find(types.begin(), types.end(), component->GetType()) == types.end()) {
+				types.push_back(component->GetType());
+			}
+		}
+	}
+	for (ComponentType type : types) {
+		size_t blockOffset = body.Size();
+		SceneBinaryComponentBlock block;
+		block.type = type;
+		block.count = 0;
+		block.byteSize = 0;
+		body.Write(block);
+
+		for (unsigned i = 0; i < gameObjects.size(); ++i) {
+			for (Component* component : gameObjects[i]->components) {
+				if (component->GetType() != type) continue;
+
+				SceneBinaryComponent record;
+				record.ownerIndex = i;
+				record.active = component->IsActive();
+				body.Write(record);
+				component->Save(body);
+
+				block.count += 1;
+			}
+		}
+
+		block.byteSize = (unsigned) (body.Size() - blockOffset - sizeof(SceneBinaryComponentBlock));
+		body.Overwrite(blockOffset, block);
+	}
+
+	// Header, string table and body
+	SceneBinaryHeader header;
+	memcpy(header.magic, SCENE_BINARY_MAGIC, 4);
+	header.version = SCENE_BINARY_VERSION;
+	header.numGameObjects = (unsigned) gameObjects.size();
+	header.numComponentBlocks = (unsigned) types.size();
+	header.quadtreeBounds[0] = App->scene->quadtreeBounds.minPoint.x;
+	header.quadtreeBounds[1] = App->scene->quadtreeBounds.minPoint.y;
+	header.quadtreeBounds[2] = App->scene->quadtreeBounds.maxPoint.x;
+	header.quadtreeBounds[3] = App->scene->quadtreeBounds.maxPoint.y;
+	header.quadtreeMaxDepth = App->scene->quadtreeMaxDepth;
+	header.quadtreeElementsPerNode = App->scene->quadtreeElementsPerNode;
+
+	file.Reserve(sizeof(SceneBinaryHeader) + body.Size() + 4096);
+	file.Write(header);
+	body.WriteStringTable(file);
+	file.WriteBytes(body.Data(), body.Size());
+}
+
+bool SceneImporter::LoadScene(const char* fileName) {
+	PROFILE_ZONE("SceneImporter - LoadScene", ProfilerColor::Orange)
+
+	// Clear scene
+	App->scene->ClearScene();
+	if (App->editor != nullptr) App->editor->SetSelectedGameObject(nullptr);
+
+	// Timer to measure loading a scene
+	MSTimer timer;
+	timer.Start();
+
+	// Read from file
+	std::string filePath = std::string(SCENES_PATH) + "/" + fileName + SCENE_EXTENSION;
+	Buffer<char> buffer = App->files->Load(filePath.c_str());
+
+	if (buffer.Size() == 0) return false;
+
+	// Binary and JSON scenes share the extension. Binary scenes start with a magic number.
+	bool loaded = IsBinaryScene(buffer) ? LoadBinaryScene(buffer.Data(), buffer.Size()) : LoadJsonScene(buffer);
+
 	unsigned timeMs = timer.Stop();
-	LOG("Scene loaded in %ums.", timeMs);
-	return true;
+	LOG_INFO(LogCategory::IMPORT, "Scene loaded in %ums.", timeMs);
+	return loaded;
 }
 
-bool SceneImporter::SaveScene(const char* fileName) {
-	// Create document
-	rapidjson::Document document;
-	document.SetObject();
-	JsonValue jScene(document, document);
+bool SceneImporter::SaveScene(const char* fileName, SceneFormat format) {
+	PROFILE_ZONE("SceneImporter - SaveScene", ProfilerColor::Orange)
+
+	std::string filePath = std::string(SCENES_PATH) + "/" + fileName + SCENE_EXTENSION;
+
+	if (format == SceneFormat::BINARY) {
+		BinaryWriter file;
+		SaveBinaryScene(file);
+		return App->files->Save(filePath.c_str(), file.Data(), file.Size());
+	}
+
+	// Stream the scene to the file
+	JsonWriter writer(filePath.c_str(), format == SceneFormat::JSON_PRETTY);
+	if (!writer.IsOpen()) return false;
+
+	writer.StartObject();
 
 	// Save scene information
-	jScene[JSON_TAG_ROOT_ID] = App->scene->root->GetID();
-	JsonValue jQuadtreeBounds = jScene[JSON_TAG_QUADTREE_BOUNDS];
-	jQuadtreeBounds[0] = App->scene->quadtreeBounds.minPoint.x;
-	jQuadtreeBounds[1] = App->scene->quadtreeBounds.minPoint.y;
-	jQuadtreeBounds[2] = App->scene->quadtreeBounds.maxPoint.x;
-	jQuadtreeBounds[3] = App->scene->quadtreeBounds.maxPoint.y;
-	jScene[JSON_TAG_QUADTREE_MAX_DEPTH] = App->scene->quadtreeMaxDepth;
-	jScene[JSON_TAG_QUADTREE_ELEMENTS_PER_NODE] = App->scene->quadtreeElementsPerNode;
+	writer.Member(JSON_TAG_ROOT_ID, App->scene->root->GetID());
+	writer.Key(JSON_TAG_QUADTREE_BOUNDS);
+	writer.StartArray();
+	writer.Write(App->scene->quadtreeBounds.minPoint.x);
+	writer.Write(App->scene->quadtreeBounds.minPoint.y);
+	writer.Write(App->scene->quadtreeBounds.maxPoint.x);
+	writer.Write(App->scene->quadtreeBounds.maxPoint.y);
+	writer.EndArray();
+	writer.Member(JSON_TAG_QUADTREE_MAX_DEPTH, App->scene->quadtreeMaxDepth);
+	writer.Member(JSON_TAG_QUADTREE_ELEMENTS_PER_NODE, App->scene->quadtreeElementsPerNode);
 
 	// Save GameObjects
-	JsonValue jGameObjects = jScene[JSON_TAG_GAMEOBJECTS];
-	unsigned i = 0;
+	writer.Key(JSON_TAG_GAMEOBJECTS);
+	writer.StartArray();
 	for (const GameObject& gameObject : App->scene->gameObjects) {
-		JsonValue jGameObject = jGameObjects[i];
+		writer.StartObject();
+		gameObject.Save(writer);
+		writer.EndObject();
+	}
+	writer.EndArray();
+
+	writer.EndObject();
+
+	return writer.Close();
+}
+
+void SceneImporter::SaveSceneToBuffer(BinaryWriter& writer) {
+	SaveBinaryScene(writer);
+}
+
+bool SceneImporter::LoadSceneFromBuffer(const char* data, size_t size) {
+	App->scene->ClearScene();
+	if (App->editor != nullptr) App->editor->SetSelectedGameObject(nullptr);
+
+	return LoadBinaryScene(data, size);
+}
+
+bool SceneImporter::RestoreSceneFromBuffer(const char* data, size_t size) {
+	PROFILE_ZONE("SceneImporter - RestoreSceneFromBuffer", ProfilerColor::Orange)
 
-		GameObject* parent = gameObject.GetParent();
-		jGameObject[JSON_TAG_PARENT_ID] = parent != nullptr ? parent->id : 0;
+	BinaryReader reader(data, size);
 
-		gameObject.Save(jGameObject);
+	SceneBinaryHeader header = reader.Read<SceneBinaryHeader>();
+	if (header.version != SCENE_BINARY_VERSION || !reader.ReadStringTable()) return false;
 
-		i += 1;
+	std::vector<GameObject*> gameObjects;
+	std::vector<int> parentIndices;
+	CollectGameObjects(gameObjects, parentIndices);
+	if (gameObjects.size() != header.numGameObjects) return false;
+
+	// Restore GameObjects
+	for (unsigned i = 0; i < header.numGameObjects; ++i) {
+		SceneBinaryGameObject record = reader.Read<SceneBinaryGameObject>();
+
+		GameObject* gameObject = gameObjects[i];
+		if (gameObject->id != record.id || parentIndices[i] != record.parentIndex) return false;
+		gameObject->name = reader.GetString(record.nameIndex);
+		record.active ? gameObject->Enable() : gameObject->Disable();
 	}
 
-	// Write document to buffer
-	rapidjson::StringBuffer stringBuffer;
-	rapidjson::PrettyWriter<rapidjson::StringBuffer, rapidjson::UTF8<>, rapidjson::UTF8<>, rapidjson::CrtAllocator, rapidjson::kWriteNanAndInfFlag> writer(stringBuffer);
-	document.Accept(writer);
+	// Restore components in the same order they were saved. Resources that are already loaded are kept.
+	for (unsigned i = 0; i < header.numComponentBlocks && !reader.HasFailed(); ++i) {
+		SceneBinaryComponentBlock block = reader.Read<SceneBinaryComponentBlock>();
+		size_t blockEnd = reader.Tell() + block.byteSize;
 
-	// Save to file
-	std::string filePath = std::string(SCENES_PATH) + "/" + fileName + SCENE_EXTENSION;
-	App->files->Save(filePath.c_str(), stringBuffer.GetString(), stringBuffer.GetSize());
+		for (unsigned j = 0; j < gameObjects.size(); ++j) {
+			for (Component* component : gameObjects[j]->components) {
+				if (component->GetType() != block.type) continue;
+
+				SceneBinaryComponent record = reader.Read<SceneBinaryComponent>();
+				if (record.ownerIndex != j) return false;
+				record.active ? component->Enable() : component->Disable();
+				component->Load(reader);
+			}
+		}
+
+		if (reader.Tell() != blockEnd) return false;
+	}
+	if (reader.HasFailed()) return false;
+
+	// Recalculate transforms and bounding boxes. Parents go first.
+	for (GameObject* gameObject : gameObjects) {
+		gameObject->InitComponents();
+	}
+
+	// The quadtree is only rebuilt if its settings changed, as the restored bounding boxes are the ones it was built with
+	AABB2D quadtreeBounds = {{header.quadtreeBounds[0], header.quadtreeBounds[1]}, {header.quadtreeBounds[2], header.quadtreeBounds[3]}};
+	if (!App->scene->quadtree.IsOperative() || !quadtreeBounds.minPoint.Equals(App->scene->quadtreeBounds.minPoint) || !quadtreeBounds.maxPoint.Equals(App->scene->quadtreeBounds.maxPoint) || header.quadtreeMaxDepth != App->scene->quadtreeMaxDepth || header.quadtreeElementsPerNode != App->scene->quadtreeElementsPerNode) {
+		App->scene->quadtreeBounds = quadtreeBounds;
+		App->scene->quadtreeMaxDepth = header.quadtreeMaxDepth;
+		App->scene->quadtreeElementsPerNode = header.quadtreeElementsPerNode;
+		App->scene->RebuildQuadtree();
+	}
 
 	return true;
 }
+
+Hash SceneImporter::HashSceneStructure() {
+	std::vector<GameObject*> gameObjects;
+	std::vector<int> parentIndices;
+	CollectGameObjects(gameObjects, parentIndices);
+
+	Hash hash = HashBuffer(parentIndices.data(), parentIndices.size() * sizeof(int));
+	for (GameObject* gameObject : gameObjects) {
+		hash = HashCombine(hash, gameObject->id);
+		hash = HashCombine(hash, (Hash) gameObject);
+		for (Component* component : gameObject->components) {
+			hash = HashCombine(hash, (Hash) component);
+		}
+	}
+	return hash;
+}
@@ -1,9 +1,27 @@
 #pragma once
 
+#include "Utils/Hash.h"
+
+#include <stddef.h>
+
 class GameObject;
+class BinaryWriter;
+
+enum class SceneFormat {
+	BINARY,
+	JSON,
+	JSON_PRETTY
+};
 
 namespace SceneImporter {
 	bool ImportScene(const char* filePath, GameObject* parent);
+	bool ReimportMeshes(const char* filePath); // Updates the live meshes imported from the file. Fails if its hierarchy changed.
 	bool LoadScene(const char* fileName);
-	bool SaveScene(const char* fileName);
+	bool SaveScene(const char* fileName, SceneFormat format = SceneFormat::BINARY);
+
+	// In-memory binary scenes
+	void SaveSceneToBuffer(BinaryWriter& writer);
+	bool LoadSceneFromBuffer(const char* data, size_t size);
+	bool RestoreSceneFromBuffer(const char* data, size_t size); // Restores the current GameObjects in place. Fails if the scene structure changed.
+	Hash HashSceneStructure();
 } // namespace SceneImporter
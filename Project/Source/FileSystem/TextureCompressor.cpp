@@ -0,0 +1,377 @@
+#include "TextureCompressor.h"
+
+#include "Utils/ParallelFor.h"
+
+#include "Math/MathFunc.h"
+#include "Math/myassert.h"
+#include <emmintrin.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include <utility>
+
+#include "Utils/Leaks.h"
+
+#define BLOCK_PIXELS 16
+#define BLOCK_BYTES (BLOCK_PIXELS * 4)
+#define BAND_LEVELS 4 // Mip levels built inside each band of rows, after the first one
+#define BAND_ROWS (4 << BAND_LEVELS) // Rows of the first level in each band. Every level built in a band still has whole rows of blocks.
+
+// Gamma tables -----------
+
+static float SRGBToLinear(float value) {
+	return value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+static float LinearToSRGB(float value) {
+	return value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+}
+
+struct GammaTables {
+	GammaTables() {
+		for (unsigned i = 0; i < 256; ++i) {
+			toLinear[i] = SRGBToLinear(i / 255.0f);
+		}
+		for (unsigned i = 0; i < 4096; ++i) {
+			toSRGB[i] = (unsigned char) (LinearToSRGB(i / 4095.0f) * 255.0f + 0.5f);
+		}
+	}
+
+	float toLinear[256];
+	unsigned char toSRGB[4096];
+};
+
+static const GammaTables& GetGammaTables() {
+	static const GammaTables gammaTables;
+	return gammaTables;
+}
+
+// Mip chain -----------
+
+struct MipLevel {
+	unsigned width = 0;
+	unsigned height = 0;
+	std::vector<unsigned char> pixels;
+};
+
+// 2x2 box filter of the rows [rowBegin, rowEnd) of the target. Color channels of sRGB images are averaged in linear space so that mips don't get darker.
+static void DownsampleRows(const MipLevel& source, MipLevel& target, bool gammaCorrect, unsigned rowBegin, unsigned rowEnd) {
+	const GammaTables& gammaTables = GetGammaTables();
+
+	for (unsigned y = rowBegin; y < rowEnd; ++y) {
+		unsigned y0 = Min(y * 2, source.height - 1);
+		unsigned y1 = Min(y * 2 + 1, source.height - 1);
+		for (unsigned x = 0; x < target.width; ++x) {
+			unsigned x0 = Min(x * 2, source.width - 1);
+			unsigned x1 = Min(x * 2 + 1, source.width - 1);
+			const unsigned char* p00 = &source.pixels[(y0 * source.width + x0) * 4];
+			const unsigned char* p01 = &source.pixels[(y0 * source.width + x1) * 4];
+			const unsigned char* p10 = &source.pixels[(y1 * source.width + x0) * 4];
+			const unsigned char* p11 = &source.pixels[(y1 * source.width + x1) * 4];
+			unsigned char* result = &target.pixels[(y * target.width + x) * 4];
+
+			for (unsigned c = 0; c < 3; ++c) {
+				if (gammaCorrect) {
+					float linear = (gammaTables.toLinear[p00[c]] + gammaTables.toLinear[p01[c]] + gammaTables.toLinear[p10[c]] + gammaTables.toLinear[p11[c]]) * 0.25f;
+					result[c] = gammaTables.toSRGB[(unsigned) (linear * 4095.0f + 0.5f)];
+				} else {
+					result[c] = (unsigned char) ((p00[c] + p01[c] + p10[c] + p11[c] + 2) / 4);
+				}
+			}
+			result[3] = (unsigned char) ((p00[3] + p01[3] + p10[3] + p11[3] + 2) / 4);
+		}
+	}
+}
+
+// Block helpers -----------
+
+static void FetchBlock(const MipLevel& level, unsigned blockX, unsigned blockY, unsigned char block[BLOCK_BYTES]) {
+	// Pixels outside the image replicate the border
+	for (unsigned y = 0; y < 4; ++y) {
+		unsigned sourceY = Min(blockY * 4 + y, level.height - 1);
+		for (unsigned x = 0; x < 4; ++x) {
+			unsigned sourceX = Min(blockX * 4 + x, level.width - 1);
+			memcpy(&block[(y * 4 + x) * 4], &level.pixels[(sourceY * level.width + sourceX) * 4], 4);
+		}
+	}
+}
+
+static unsigned short EncodeRGB565(const int color[3]) {
+	return (unsigned short) (((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+}
+
+static void DecodeRGB565(unsigned short value, int color[3]) {
+	int r = (value >> 11) & 31;
+	int g = (value >> 5) & 63;
+	int b = value & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// SSE2 is always available on the targets of the engine, so there's no scalar fallback
+
+static void GetMinMaxColors(const unsigned char block[BLOCK_BYTES], int minColor[4], int maxColor[4]) {
+	const __m128i* rows = (const __m128i*) block;
+	__m128i minRows = _mm_min_epu8(_mm_min_epu8(_mm_loadu_si128(rows), _mm_loadu_si128(rows + 1)), _mm_min_epu8(_mm_loadu_si128(rows + 2), _mm_loadu_si128(rows + 3)));
+	__m128i maxRows = _mm_max_epu8(_mm_max_epu8(_mm_loadu_si128(rows), _mm_loadu_si128(rows + 1)), _mm_max_epu8(_mm_loadu_si128(rows + 2), _mm_loadu_si128(rows + 3)));
+
+	// Reduce the 4 pixels of each register to one
+	minRows = _mm_min_epu8(minRows, _mm_shuffle_epi32(minRows, _MM_SHUFFLE(1, 0, 3, 2)));
+	minRows = _mm_min_epu8(minRows, _mm_shuffle_epi32(minRows, _MM_SHUFFLE(2, 3, 0, 1)));
+	maxRows = _mm_max_epu8(maxRows, _mm_shuffle_epi32(maxRows, _MM_SHUFFLE(1, 0, 3, 2)));
+	maxRows = _mm_max_epu8(maxRows, _mm_shuffle_epi32(maxRows, _MM_SHUFFLE(2, 3, 0, 1)));
+
+	// Widen the channels of the first pixel to 32 bits
+	__m128i zero = _mm_setzero_si128();
+	_mm_storeu_si128((__m128i*) minColor, _mm_unpacklo_epi16(_mm_unpacklo_epi8(minRows, zero), zero));
+	_mm_storeu_si128((__m128i*) maxColor, _mm_unpacklo_epi16(_mm_unpacklo_epi8(maxRows, zero), zero));
+}
+
+// Position (0..3) of every pixel along the line from endColor to startColor
+static void GetColorRamp(const unsigned char block[BLOCK_BYTES], const int startColor[3], const int endColor[3], int ramp[BLOCK_PIXELS]) {
+	int direction[3] = {startColor[0] - endColor[0], startColor[1] - endColor[1], startColor[2] - endColor[2]};
+	int length = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+	int base = endColor[0] * direction[0] + endColor[1] * direction[1] + endColor[2] * direction[2];
+
+	__m128i zero = _mm_setzero_si128();
+	__m128i directionX2 = _mm_setr_epi16((short) direction[0], (short) direction[1], (short) direction[2], 0, (short) direction[0], (short) direction[1], (short) direction[2], 0);
+	__m128i baseX4 = _mm_set1_epi32(base);
+	__m128i threshold1 = _mm_set1_epi32(length - 1);
+	__m128i threshold3 = _mm_set1_epi32(3 * length - 1);
+	__m128i threshold5 = _mm_set1_epi32(5 * length - 1);
+
+	for (unsigned i = 0; i < 4; ++i) {
+		__m128i pixels = _mm_loadu_si128((const __m128i*) &block[i * 16]);
+
+		// Dot product of each pixel with the direction. Each pixel gives two partial sums, which are added in pairs.
+		__m128 productsLow = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), directionX2));
+		__m128 productsHigh = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), directionX2));
+		__m128i even = _mm_castps_si128(_mm_shuffle_ps(productsLow, productsHigh, _MM_SHUFFLE(2, 0, 2, 0)));
+		__m128i odd = _mm_castps_si128(_mm_shuffle_ps(productsLow, productsHigh, _MM_SHUFFLE(3, 1, 3, 1)));
+		__m128i t = _mm_sub_epi32(_mm_add_epi32(even, odd), baseX4);
+
+		// Compare 6t against length, 3 * length and 5 * length. Masks are -1, so subtracting them counts the passed thresholds.
+		__m128i t6 = _mm_add_epi32(_mm_slli_epi32(t, 2), _mm_slli_epi32(t, 1));
+		__m128i result = _mm_setzero_si128();
+		result = _mm_sub_epi32(result, _mm_cmpgt_epi32(t6, threshold1));
+		result = _mm_sub_epi32(result, _mm_cmpgt_epi32(t6, threshold3));
+		result = _mm_sub_epi32(result, _mm_cmpgt_epi32(t6, threshold5));
+		_mm_storeu_si128((__m128i*) &ramp[i * 4], result);
+	}
+}
+
+// Position (0..7) of every value between minValue and maxValue
+static void GetValueRamp(const unsigned char values[BLOCK_PIXELS], int minValue, int maxValue, int ramp[BLOCK_PIXELS]) {
+	__m128i zero = _mm_setzero_si128();
+	__m128i minX4 = _mm_set1_epi32(minValue);
+	__m128 scale = _mm_set1_ps(7.0f / (maxValue - minValue));
+	__m128 half = _mm_set1_ps(0.5f);
+	__m128i all = _mm_loadu_si128((const __m128i*) values);
+	__m128i words[2] = {_mm_unpacklo_epi8(all, zero), _mm_unpackhi_epi8(all, zero)};
+
+	for (unsigned i = 0; i < 4; ++i) {
+		__m128i valuesX4 = (i % 2 == 0) ? _mm_unpacklo_epi16(words[i / 2], zero) : _mm_unpackhi_epi16(words[i / 2], zero);
+
+		__m128 position = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(valuesX4, minX4)), scale), half);
+		_mm_storeu_si128((__m128i*) &ramp[i * 4], _mm_cvttps_epi32(position));
+	}
+}
+
+// Block encoders -----------
+
+// BC1 (also the color part of BC3): two RGB565 endpoints and 2-bit indices
+static void EncodeColorBlock(const unsigned char block[BLOCK_BYTES], unsigned char* output) {
+	int minColor[4];
+	int maxColor[4];
+	GetMinMaxColors(block, minColor, maxColor);
+
+	// Pick the bounding box diagonal that follows the colors in the block
+	int center[3] = {(minColor[0] + maxColor[0]) / 2, (minColor[1] + maxColor[1]) / 2, (minColor[2] + maxColor[2]) / 2};
+	int covarianceRB = 0;
+	int covarianceGB = 0;
+	for (unsigned i = 0; i < BLOCK_PIXELS; ++i) {
+		int b = block[i * 4 + 2] - center[2];
+		covarianceRB += (block[i * 4 + 0] - center[0]) * b;
+		covarianceGB += (block[i * 4 + 1] - center[1]) * b;
+	}
+	if (covarianceRB < 0) std::swap(minColor[0], maxColor[0]);
+	if (covarianceGB < 0) std::swap(minColor[1], maxColor[1]);
+
+	// Inset the endpoints to reduce the error at the extremes
+	for (unsigned c = 0; c < 3; ++c) {
+		int inset = (maxColor[c] - minColor[c]) / 16;
+		minColor[c] = Clamp(minColor[c] + inset, 0, 255);
+		maxColor[c] = Clamp(maxColor[c] - inset, 0, 255);
+	}
+
+	unsigned short color0 = EncodeRGB565(maxColor);
+	unsigned short color1 = EncodeRGB565(minColor);
+	if (color0 < color1) std::swap(color0, color1); // color0 > color1 selects the 4 color mode
+
+	unsigned indices = 0;
+	if (color0 != color1) {
+		int startColor[3];
+		int endColor[3];
+		DecodeRGB565(color0, startColor);
+		DecodeRGB565(color1, endColor);
+
+		int ramp[BLOCK_PIXELS];
+		GetColorRamp(block, startColor, endColor, ramp);
+
+		// Ramp goes from color1 to color0. Palette order is color0, color1, 2/3 color0, 1/3 color0.
+		static const unsigned rampToIndex[4] = {1, 3, 2, 0};
+		for (unsigned i = 0; i < BLOCK_PIXELS; ++i) {
+			indices |= rampToIndex[ramp[i]] << (i * 2);
+		}
+	}
+
+	memcpy(output, &color0, 2);
+	memcpy(output + 2, &color1, 2);
+	memcpy(output + 4, &indices, 4);
+}
+
+// BC4 (also the alpha part of BC3 and each channel of BC5): two 8-bit endpoints and 3-bit indices
+static void EncodeChannelBlock(const unsigned char block[BLOCK_BYTES], unsigned channel, unsigned char* output) {
+	unsigned char values[BLOCK_PIXELS];
+	int minValue = 255;
+	int maxValue = 0;
+	for (unsigned i = 0; i < BLOCK_PIXELS; ++i) {
+		values[i] = block[i * 4 + channel];
+		minValue = Min(minValue, (int) values[i]);
+		maxValue = Max(maxValue, (int) values[i]);
+	}
+
+	// maxValue > minValue selects the 8 value mode
+	output[0] = (unsigned char) maxValue;
+	output[1] = (unsigned char) minValue;
+
+	unsigned long long indices = 0;
+	if (maxValue != minValue) {
+		int ramp[BLOCK_PIXELS];
+		GetValueRamp(values, minValue, maxValue, ramp);
+
+		// Ramp goes from minValue to maxValue. Palette order is maxValue, minValue and then the interpolated values from maxValue to minValue.
+		static const unsigned long long rampToIndex[8] = {1, 7, 6, 5, 4, 3, 2, 0};
+		for (unsigned i = 0; i < BLOCK_PIXELS; ++i) {
+			indices |= rampToIndex[ramp[i]] << (i * 3);
+		}
+	}
+
+	for (unsigned i = 0; i < 6; ++i) {
+		output[2 + i] = (unsigned char) (indices >> (i * 8));
+	}
+}
+
+static void EncodeBlock(const unsigned char block[BLOCK_BYTES], DDS::Format format, unsigned char* output) {
+	switch (format) {
+	case DDS::Format::BC1:
+		EncodeColorBlock(block, output);
+		break;
+	case DDS::Format::BC3:
+		EncodeChannelBlock(block, 3, output);
+		EncodeColorBlock(block, output + 8);
+		break;
+	case DDS::Format::BC4:
+		EncodeChannelBlock(block, 0, output);
+		break;
+	case DDS::Format::BC5:
+		EncodeChannelBlock(block, 0, output);
+		EncodeChannelBlock(block, 1, output + 8);
+		break;
+	default:
+		assert(false); // Format not supported by the encoder
+		break;
+	}
+}
+
+// Encodes the rows of blocks [blockRowBegin, blockRowEnd) of the level into output, which points to the start of the level
+static void EncodeBlockRows(const MipLevel& level, DDS::Format format, unsigned blockRowBegin, unsigned blockRowEnd, char* output) {
+	unsigned blockSize = DDS::GetBlockSize(format);
+	unsigned blocksX = (level.width + 3) / 4;
+
+	unsigned char block[BLOCK_BYTES];
+	for (unsigned blockY = blockRowBegin; blockY < blockRowEnd; ++blockY) {
+		unsigned char* blockOutput = (unsigned char*) output + blockY * blocksX * blockSize;
+		for (unsigned blockX = 0; blockX < blocksX; ++blockX) {
+			FetchBlock(level, blockX, blockY, block);
+			EncodeBlock(block, format, blockOutput);
+			blockOutput += blockSize;
+		}
+	}
+}
+
+// Public functions -----------
+
+DDS::Format TextureCompressor::ChooseFormat(const unsigned char* pixels, unsigned width, unsigned height, bool isNormalMap) {
+	// BC5 has no blue channel, so it's only safe when the shader knows to reconstruct it
+	if (isNormalMap) return DDS::Format::BC5;
+
+	bool hasAlpha = false;
+	bool isGrayscale = true;
+
+	unsigned numPixels = width * height;
+	for (unsigned i = 0; i < numPixels; ++i) {
+		const unsigned char* pixel = &pixels[i * 4];
+		hasAlpha = hasAlpha || pixel[3] != 255;
+		isGrayscale = isGrayscale && pixel[0] == pixel[1] && pixel[1] == pixel[2];
+	}
+
+	if (hasAlpha) return DDS::Format::BC3;
+	if (isGrayscale) return DDS::Format::BC4;
+	return DDS::Format::BC1;
+}
+
+Buffer<char> TextureCompressor::CompressToDDS(const unsigned char* pixels, unsigned width, unsigned height, DDS::Format format) {
+	// Size the mip chain
+	std::vector<MipLevel> levels(1);
+	levels[0].width = width;
+	levels[0].height = height;
+	levels[0].pixels.assign(pixels, pixels + width * height * 4);
+	while (levels.back().width > 1 || levels.back().height > 1) {
+		MipLevel level;
+		level.width = Max(levels.back().width / 2, 1u);
+		level.height = Max(levels.back().height / 2, 1u);
+		level.pixels.resize(level.width * level.height * 4);
+		levels.push_back(std::move(level));
+	}
+
+	// Lay out the file
+	unsigned numLevels = (unsigned) levels.size();
+	std::vector<unsigned> levelOffsets(numLevels);
+	unsigned size = DDS::GetHeaderSize();
+	for (unsigned i = 0; i < numLevels; ++i) {
+		levelOffsets[i] = size;
+		size += DDS::GetLevelSize(format, levels[i].width, levels[i].height);
+	}
+
+	Buffer<char> buffer(size);
+	DDS::WriteHeader(buffer.Data(), format, width, height, numLevels);
+	char* data = buffer.Data();
+
+	// Two-channel data is not color, so it's filtered as is
+	bool gammaCorrect = format != DDS::Format::BC5;
+
+	// Each row of a level only reads two rows of the previous one, so bands of rows can build their part of the first levels on their own.
+	// Downsampling and encoding all of them takes a single parallel call.
+	unsigned numBandLevels = Min(numLevels, (unsigned) BAND_LEVELS + 1);
+	unsigned numBands = (height + BAND_ROWS - 1) / BAND_ROWS;
+	ParallelFor(numBands, [&](unsigned band) {
+		for (unsigned i = 0; i < numBandLevels; ++i) {
+			unsigned rowBegin = (band * BAND_ROWS) >> i;
+			unsigned rowEnd = Min(((band + 1) * BAND_ROWS) >> i, levels[i].height);
+			if (rowBegin >= rowEnd) break;
+
+			if (i > 0) DownsampleRows(levels[i - 1], levels[i], gammaCorrect, rowBegin, rowEnd);
+			EncodeBlockRows(levels[i], format, rowBegin / 4, (rowEnd + 3) / 4, data + levelOffsets[i]);
+		}
+	});
+
+	// The rest of the levels are small
+	for (unsigned i = numBandLevels; i < numLevels; ++i) {
+		DownsampleRows(levels[i - 1], levels[i], gammaCorrect, 0, levels[i].height);
+		EncodeBlockRows(levels[i], format, 0, (levels[i].height + 3) / 4, data + levelOffsets[i]);
+	}
+
+	return buffer;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "FileSystem/DDS.h"
+#include "Utils/Buffer.h"
+
+/* CPU texture compression used at import time.
+*  Builds the whole mip chain (gamma-correct for color data) and encodes every level into BC1, BC3, BC4 or BC5 blocks.
+*  Bands of rows are downsampled and encoded in parallel, using SSE2 for the block encoders.
+*/
+
+namespace TextureCompressor {
+	// Picks the smallest format that keeps the information of the image:
+	// BC5 for normal maps (only X and Y are stored), BC4 for opaque grayscale, BC3 when there's alpha and BC1 otherwise.
+	DDS::Format ChooseFormat(const unsigned char* pixels, unsigned width, unsigned height, bool isNormalMap);
+
+	// Pixels are RGBA8. Returns the contents of a DDS file with all the mip levels.
+	Buffer<char> CompressToDDS(const unsigned char* pixels, unsigned width, unsigned height, DDS::Format format);
+} // namespace TextureCompressor
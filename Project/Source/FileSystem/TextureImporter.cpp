@@ -4,6 +4,12 @@
 #include "Application.h"
 #include "Utils/Logging.h"
 #include "Utils/Buffer.h"
+#include "Utils/MSTimer.h"
+#include "Utils/Hash.h"
+#include "Utils/Profiling.h"
+#include "FileSystem/ImportDatabase.h"
+#include "FileSystem/DDS.h"
+#include "FileSystem/TextureCompressor.h"
 #include "Resources/Texture.h"
 #include "Resources/CubeMap.h"
 #include "Modules/ModuleResources.h"
@@ -12,15 +18,131 @@
 #include "IL/il.h"
 #include "IL/ilu.h"
 #include "GL/glew.h"
+#include <string>
+#include <vector>
+#include <memory>
 
 #include "Utils/Leaks.h"
 
-Texture* TextureImporter::ImportTexture(const char* filePath) {
-	// Timer to measure importing a texture
-	MSTimer timer;
-	timer.Start();
+// Increase when the generated artifacts change so that every texture gets reimported
+#define TEXTURE_IMPORTER_VERSION 4
+
+// Uploads every level stored in the file without decompressing. Returns false if the driver doesn't support the format.
+static bool UploadCompressedImage(unsigned target, const DDS::Image& image) {
+	unsigned internalFormat = DDS::GetGLInternalFormat(image.format);
+	if (internalFormat == 0) return false;
+
+	for (unsigned i = 0; i < image.levels.size(); ++i) {
+		const DDS::Level& level = image.levels[i];
+		glCompressedTexImage2D(target, i, internalFormat, level.width, level.height, 0, level.size, level.data);
+	}
+
+	return true;
+}
+
+// BC4 only stores red. Grayscale images read it in every color channel.
+static void SetSwizzle(unsigned target, DDS::Format format) {
+	if (format != DDS::Format::BC4) return;
+
+	GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+	glTexParameteriv(target, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+}
+
+static bool UploadImageWithDevIL(unsigned target, const char* data, size_t size) {
+	// Generate image handler
+	unsigned image;
+	ilGenImages(1, &image);
+	DEFER {
+		ilDeleteImages(1, &image);
+	};
+
+	// Load image
+	ilBindImage(image);
+	bool imageLoaded = ilLoadL(IL_DDS, data, (ILuint) size);
+	if (!imageLoaded) {
+		LOG_WARNING(LogCategory::IMPORT, "Failed to load image.");
+		return false;
+	}
+
+	glTexImage2D(target, 0, ilGetInteger(IL_IMAGE_BPP), ilGetInteger(IL_IMAGE_WIDTH), ilGetInteger(IL_IMAGE_HEIGHT), 0, ilGetInteger(IL_IMAGE_FORMAT), GL_UNSIGNED_BYTE, ilGetData());
+	return true;
+}
+
+static void UploadTexture(Texture* texture, const char* data, size_t size) {
+	if (texture->glTexture) return;
+
+	// Generate texture from image
+	glGenTextures(1, &texture->glTexture);
+	glBindTexture(GL_TEXTURE_2D, texture->glTexture);
+
+	DDS::Image image;
+	if (DDS::Parse(data, size, image) && UploadCompressedImage(GL_TEXTURE_2D, image)) {
+		// Only the stored levels exist, the texture is complete without generating the rest
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint) image.levels.size() - 1);
+		SetSwizzle(GL_TEXTURE_2D, image.format);
+	} else {
+		LOG_INFO(LogCategory::IMPORT, "Format not supported by the driver, decompressing with DevIL.");
+		if (!UploadImageWithDevIL(GL_TEXTURE_2D, data, size)) {
+			// Not UnloadTexture, which would clear uploadQueued while the startup worker may read it
+			glDeleteTextures(1, &texture->glTexture);
+			texture->glTexture = 0;
+			return;
+		}
+		glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	// Set filtering and wrapping
+	App->resources->SetTextureParameters(texture);
+}
 
-	LOG("Importing texture from path: \"%s\".", filePath);
+static void UploadCubeMap(CubeMap* cubeMap, const std::vector<Buffer<char>>& faceBuffers) {
+	if (cubeMap->glTexture) return;
+
+	// Create texture handle
+	glGenTextures(1, &cubeMap->glTexture);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap->glTexture);
+
+	// Load cube map
+	for (unsigned i = 0; i < 6; ++i) {
+		const Buffer<char>& buffer = faceBuffers[i];
+		size_t size = buffer.Size() - 1;
+
+		DDS::Image image;
+		if (DDS::Parse(buffer.Data(), size, image) && UploadCompressedImage(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, image)) {
+			// Every face has the same format
+			if (i == 0) SetSwizzle(GL_TEXTURE_CUBE_MAP, image.format);
+			continue;
+		}
+
+		LOG_INFO(LogCategory::IMPORT, "Format not supported by the driver, decompressing with DevIL.");
+		if (!UploadImageWithDevIL(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, buffer.Data(), size)) return;
+	}
+
+	// Set filtering and wrapping
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+}
+
+// Compresses the image to a DDS file named after its contents and the import settings. Returns the name of the file, or an empty string if the image can't be read.
+static std::string ImportTextureFile(const char* filePath, TextureType type) {
+	// Identify the texture by its contents and import settings
+	Hash sourceHash;
+	if (!ImportDatabase::GetSourceHash(filePath, sourceHash)) {
+		LOG_WARNING(LogCategory::IMPORT, "Failed to read file.");
+		return std::string();
+	}
+	Hash settingsHash = TextureImporter::GetSettingsHash(type);
+	std::string fileName = HashToString(HashCombine(sourceHash, settingsHash));
+	std::string ddsFilePath = std::string(TEXTURES_PATH) + "/" + fileName + TEXTURE_EXTENSION;
+
+	// Reuse the previous artifact if nothing changed
+	if (ImportDatabase::IsUpToDate(filePath, sourceHash, settingsHash)) {
+		LOG_VERBOSE(LogCategory::IMPORT, "Texture is up to date, reusing \"%s\".", ddsFilePath.c_str());
+		return fileName;
+	}
 
 	// Generate image handler
 	unsigned image;
@@ -33,13 +155,13 @@ Texture* TextureImporter::ImportTexture(const char* filePath) {
 	ilBindImage(image);
 	bool imageLoaded = ilLoadImage(filePath);
 	if (!imageLoaded) {
-		LOG("Failed to load image.");
-		return nullptr;
+		LOG_WARNING(LogCategory::IMPORT, "Failed to load image.");
+		return std::string();
 	}
 	bool imageConverted = ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
 	if (!imageConverted) {
-		LOG("Failed to convert image.");
-		return nullptr;
+		LOG_WARNING(LogCategory::IMPORT, "Failed to convert image.");
+		return std::string();
 	}
 
 	// Flip image if neccessary
@@ -48,88 +170,147 @@ Texture* TextureImporter::ImportTexture(const char* filePath) {
 	if (info.Origin == IL_ORIGIN_UPPER_LEFT) {
 		iluFlipImage();
 	}
-	// Create texture
-	Texture* texture = App->resources->ObtainTexture();
-
-	// Save texture to custom DDS file
-	texture->fileName = App->files->GetFileName(filePath);
-	std::string ddsFilePath = std::string(TEXTURES_PATH) + "/" + texture->fileName + TEXTURE_EXTENSION;
-
-	LOG("Saving image to \"%s\".", ddsFilePath.c_str());
-	ilSetInteger(IL_DXTC_FORMAT, IL_DXT5);
-	size_t size = ilSaveL(IL_DDS, nullptr, 0);
-	if (size == 0) {
-		LOG("Failed to save image.");
-		return nullptr;
-	}
-	Buffer<char> buffer = Buffer<char>(size);
-	size = ilSaveL(IL_DDS, buffer.Data(), size);
-	if (size == 0) {
-		LOG("Failed to save image.");
-		return nullptr;
-	}
+
+	// Compress the texture and its mip chain to a custom DDS file
+	unsigned width = ilGetInteger(IL_IMAGE_WIDTH);
+	unsigned height = ilGetInteger(IL_IMAGE_HEIGHT);
+	const unsigned char* pixels = ilGetData();
+	DDS::Format format = TextureCompressor::ChooseFormat(pixels, width, height, type == TextureType::NORMAL_MAP);
+	Buffer<char> buffer = TextureCompressor::CompressToDDS(pixels, width, height, format);
+
+	LOG_VERBOSE(LogCategory::IMPORT, "Saving image to \"%s\".", ddsFilePath.c_str());
 	App->files->Save(ddsFilePath.c_str(), buffer);
 
+	ImportDatabase::Register(filePath, sourceHash, settingsHash, {ddsFilePath});
+
+	return fileName;
+}
+
+Texture* TextureImporter::ImportTexture(const char* filePath, TextureType type) {
+	PROFILE_ZONE("TextureImporter - ImportTexture", ProfilerColor::Orange)
+
+	// Timer to measure importing a texture
+	MSTimer timer;
+	timer.Start();
+
+	LOG_VERBOSE(LogCategory::IMPORT, "Importing texture from path: \"%s\".", filePath);
+
+	std::string fileName = ImportTextureFile(filePath, type);
+	if (fileName.empty()) return nullptr;
+
+	// Create texture
+	Texture* texture = App->resources->ObtainTextureWithFileName(fileName);
+
 	unsigned timeMs = timer.Stop();
-	LOG("Texture imported in %ums.", timeMs);
+	LOG_VERBOSE(LogCategory::IMPORT, "Texture imported in %ums.", timeMs);
 	return texture;
 }
 
+Hash TextureImporter::GetSettingsHash(TextureType type) {
+	return HashCombine(TEXTURE_IMPORTER_VERSION, (Hash) type);
+}
+
+bool TextureImporter::ReimportTexture(const char* filePath) {
+	PROFILE_ZONE("TextureImporter - ReimportTexture", ProfilerColor::Orange)
+
+	// Timer to measure reimporting a texture
+	MSTimer timer;
+	timer.Start();
+
+	const std::vector<std::string>* artifactPaths = ImportDatabase::GetArtifactPaths(filePath);
+	if (artifactPaths == nullptr || artifactPaths->empty()) return false;
+	InternedString previousFileName = App->files->GetFileName(artifactPaths->front().c_str());
+
+	// Keep the type it was imported with
+	Hash previousSettingsHash = 0;
+	ImportDatabase::GetSettingsHash(filePath, previousSettingsHash);
+	TextureType type = previousSettingsHash == GetSettingsHash(TextureType::NORMAL_MAP) ? TextureType::NORMAL_MAP : TextureType::COLOR;
+
+	LOG_INFO(LogCategory::IMPORT, "Reimporting texture from path: \"%s\".", filePath);
+
+	std::string fileName = ImportTextureFile(filePath, type);
+	if (fileName.empty()) return false;
+
+	// Swap the new file into the live textures, so that materials keep pointing to them
+	InternedString internedFileName = fileName;
+	if (internedFileName != previousFileName) {
+		Texture* texture = App->resources->FindTexture(previousFileName);
+		if (texture != nullptr) {
+			UnloadTexture(texture);
+			App->resources->SetTextureFileName(texture, internedFileName);
+			LoadTexture(texture);
+		}
+	}
+
+	unsigned timeMs = timer.Stop();
+	LOG_INFO(LogCategory::IMPORT, "Texture reimported in %ums.", timeMs);
+	return true;
+}
+
 void TextureImporter::LoadTexture(Texture* texture) {
+	PROFILE_ZONE("TextureImporter - LoadTexture", ProfilerColor::Orange)
+
 	if (texture == nullptr) return;
+	if (App->IsMainThread() ? texture->glTexture != 0 : texture->uploadQueued) return;
 
 	// Timer to measure loading a texture
 	MSTimer timer;
 	timer.Start();
 
-	std::string filePath = std::string(TEXTURES_PATH) + "/" + texture->fileName + TEXTURE_EXTENSION;
+	std::string filePath = std::string(TEXTURES_PATH) + "/" + texture->fileName.c_str() + TEXTURE_EXTENSION;
 
-	LOG("Loading texture from path: \"%s\".", filePath.c_str());
+	LOG_VERBOSE(LogCategory::IMPORT, "Loading texture from path: \"%s\".", filePath.c_str());
 
-	// Generate image handler
-	unsigned image;
-	ilGenImages(1, &image);
-	DEFER {
-		ilDeleteImages(1, &image);
-	};
+	// Load file
+	Buffer<char> buffer = App->files->Load(filePath.c_str());
+	if (buffer.Size() == 0) return;
 
-	// Load image
-	ilBindImage(image);
-	bool imageLoaded = ilLoad(IL_DDS, filePath.c_str());
-	if (!imageLoaded) {
-		LOG("Failed to load image.");
+	// Headless: the texture is read, but not uploaded
+	if (App->headless) return;
+
+	// Startup can load scenes on worker threads. The upload waits for the main thread, which owns the GL context.
+	if (!App->IsMainThread()) {
+		std::shared_ptr<Buffer<char>> sharedBuffer = std::make_shared<Buffer<char>>(std::move(buffer));
+		texture->uploadQueued = true;
+		App->RunOnMainThread([texture, sharedBuffer]() {
+			UploadTexture(texture, sharedBuffer->Data(), sharedBuffer->Size() - 1);
+		});
 		return;
 	}
 
-	// Generate texture from image
-	glGenTextures(1, &texture->glTexture);
-	glBindTexture(GL_TEXTURE_2D, texture->glTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, ilGetInteger(IL_IMAGE_BPP), ilGetInteger(IL_IMAGE_WIDTH), ilGetInteger(IL_IMAGE_HEIGHT), 0, ilGetInteger(IL_IMAGE_FORMAT), GL_UNSIGNED_BYTE, ilGetData());
-
-	// Generate mipmaps and set filtering and wrapping
-	glGenerateMipmap(GL_TEXTURE_2D);
-	App->resources->SetWrap(App->resources->GetWrap());
-	App->resources->SetMinFilter(App->resources->GetMinFilter());
-	App->resources->SetMagFilter(App->resources->GetMagFilter());
+	UploadTexture(texture, buffer.Data(), buffer.Size() - 1);
 
 	unsigned timeMs = timer.Stop();
-	LOG("Texture loaded in %ums.", timeMs);
+	LOG_VERBOSE(LogCategory::IMPORT, "Texture loaded in %ums.", timeMs);
 }
 
 void TextureImporter::UnloadTexture(Texture* texture) {
+	texture->uploadQueued = false;
+
 	if (!texture->glTexture) return;
 
-	glDeleteTextures(1, &texture->glTexture);
+	// The GL name is deleted on the main thread, which owns the GL context
+	unsigned glTexture = texture->glTexture;
+	texture->glTexture = 0;
+	App->RunOnMainThread([glTexture]() {
+		glDeleteTextures(1, &glTexture);
+	});
 }
 
 CubeMap* TextureImporter::ImportCubeMap(const char* filePaths[6]) {
-	// Create cube map
-	CubeMap* cubeMap = App->resources->ObtainCubeMap();
+	PROFILE_ZONE("TextureImporter - ImportCubeMap", ProfilerColor::Orange)
 
+	// Load the faces first. They are compressed together, since every face needs the same format.
+	struct FaceImage {
+		unsigned width = 0;
+		unsigned height = 0;
+		std::vector<unsigned char> pixels;
+	};
+	FaceImage faces[6];
 	for (unsigned i = 0; i < 6; ++i) {
 		const char* filePath = filePaths[i];
 
-		LOG("Importing cube map texture from path: \"%s\".", filePath);
+		LOG_INFO(LogCategory::IMPORT, "Importing cube map texture from path: \"%s\".", filePath);
 
 		// Generate image handler
 		unsigned image;
@@ -142,12 +323,12 @@ CubeMap* TextureImporter::ImportCubeMap(const char* filePaths[6]) {
 		ilBindImage(image);
 		bool imageLoaded = ilLoadImage(filePath);
 		if (!imageLoaded) {
-			LOG("Failed to load image.");
+			LOG_WARNING(LogCategory::IMPORT, "Failed to load image.");
 			return nullptr;
 		}
-		bool imageConverted = ilConvertImage(IL_RGB, IL_UNSIGNED_BYTE);
+		bool imageConverted = ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
 		if (!imageConverted) {
-			LOG("Failed to convert image.");
+			LOG_WARNING(LogCategory::IMPORT, "Failed to convert image.");
 			return nullptr;
 		}
 
@@ -159,70 +340,75 @@ CubeMap* TextureImporter::ImportCubeMap(const char* filePaths[6]) {
 			iluFlipImage();
 		}
 
-		// Save texture to custom DDS file
-		cubeMap->fileNames[i] = App->files->GetFileName(filePath);
-		std::string ddsFilePath = std::string(TEXTURES_PATH) + "/" + cubeMap->fileNames[i] + TEXTURE_EXTENSION;
+		FaceImage& face = faces[i];
+		face.width = ilGetInteger(IL_IMAGE_WIDTH);
+		face.height = ilGetInteger(IL_IMAGE_HEIGHT);
+		const unsigned char* pixels = ilGetData();
+		face.pixels.assign(pixels, pixels + face.width * face.height * 4);
+	}
 
-		LOG("Saving image to \"%s\".", ddsFilePath.c_str());
-		ilSetInteger(IL_DXTC_FORMAT, IL_DXT5);
-		size_t size = ilSaveL(IL_DDS, nullptr, 0);
-		if (size == 0) {
-			LOG("Failed to save image.");
-			return nullptr;
-		}
-		Buffer<char> buffer = Buffer<char>(size);
-		size = ilSaveL(IL_DDS, buffer.Data(), size);
-		if (size == 0) {
-			LOG("Failed to save image.");
-			return nullptr;
+	// Mixing formats would leave the cube map incomplete. BC3 covers every face, and BC1 covers BC4.
+	DDS::Format format = DDS::Format::BC4;
+	for (const FaceImage& face : faces) {
+		DDS::Format faceFormat = TextureCompressor::ChooseFormat(face.pixels.data(), face.width, face.height, false);
+		if (faceFormat == DDS::Format::BC3) {
+			format = DDS::Format::BC3;
+		} else if (faceFormat == DDS::Format::BC1 && format == DDS::Format::BC4) {
+			format = DDS::Format::BC1;
 		}
+	}
+
+	// Create cube map
+	CubeMap* cubeMap = App->resources->ObtainCubeMap();
+
+	for (unsigned i = 0; i < 6; ++i) {
+		// Compress texture to custom DDS file
+		const FaceImage& face = faces[i];
+		Buffer<char> buffer = TextureCompressor::CompressToDDS(face.pixels.data(), face.width, face.height, format);
+
+		cubeMap->fileNames[i] = App->files->GetFileName(filePaths[i]);
+		std::string ddsFilePath = std::string(TEXTURES_PATH) + "/" + cubeMap->fileNames[i].c_str() + TEXTURE_EXTENSION;
+
+		LOG_VERBOSE(LogCategory::IMPORT, "Saving image to \"%s\".", ddsFilePath.c_str());
 		App->files->Save(ddsFilePath.c_str(), buffer);
 
-		LOG("Cube map texture imported successfuly.");
+		LOG_INFO(LogCategory::IMPORT, "Cube map texture imported successfuly.");
 	}
 
 	return cubeMap;
 }
 
 void TextureImporter::LoadCubeMap(CubeMap* cubeMap) {
-	// Create texture handle
-	glGenTextures(1, &cubeMap->glTexture);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMap->glTexture);
+	PROFILE_ZONE("TextureImporter - LoadCubeMap", ProfilerColor::Orange)
 
-	// Load cube map
-	for (unsigned i = 0; i < 6; ++i) {
-		std::string filePath = std::string(TEXTURES_PATH) + "/" + cubeMap->fileNames[i] + TEXTURE_EXTENSION;
+	if (cubeMap == nullptr) return;
+	if (App->IsMainThread() ? cubeMap->glTexture != 0 : cubeMap->uploadQueued) return;
+	if (App->headless) return;
 
-		LOG("Loading cubemap texture from path: \"%s\".", filePath.c_str());
-
-		// Generate image handler
-		unsigned image;
-		ilGenImages(1, &image);
-		DEFER {
-			ilDeleteImages(1, &image);
-		};
+	// Load the files of the faces
+	std::shared_ptr<std::vector<Buffer<char>>> faceBuffers = std::make_shared<std::vector<Buffer<char>>>();
+	faceBuffers->reserve(6);
+	for (unsigned i = 0; i < 6; ++i) {
+		std::string filePath = std::string(TEXTURES_PATH) + "/" + cubeMap->fileNames[i].c_str() + TEXTURE_EXTENSION;
 
-		// Load image
-		ilBindImage(image);
-		bool imageLoaded = ilLoad(IL_DDS, filePath.c_str());
-		if (!imageLoaded) {
-			LOG("Failed to load image.");
-			return;
-		}
+		LOG_VERBOSE(LogCategory::IMPORT, "Loading cubemap texture from path: \"%s\".", filePath.c_str());
 
-		glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, ilGetInteger(IL_IMAGE_BPP), ilGetInteger(IL_IMAGE_WIDTH), ilGetInteger(IL_IMAGE_HEIGHT), 0, ilGetInteger(IL_IMAGE_FORMAT), GL_UNSIGNED_BYTE, ilGetData());
+		faceBuffers->push_back(App->files->Load(filePath.c_str()));
+		if (faceBuffers->back().Size() == 0) return;
 	}
 
-	// Set filtering and wrapping
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+	// Startup can load scenes on worker threads. The upload waits for the main thread, which owns the GL context.
+	if (!App->IsMainThread()) cubeMap->uploadQueued = true;
+	App->RunOnMainThread([cubeMap, faceBuffers]() {
+		UploadCubeMap(cubeMap, *faceBuffers);
+	});
 }
 
 void TextureImporter::UnloadCubeMap(CubeMap* cubeMap) {
+	cubeMap->uploadQueued = false;
+
 	if (!cubeMap->glTexture) return;
 
 	glDeleteTextures(1, &cubeMap->glTexture);
+	cubeMap->glTexture = 0;
 }
\ No newline at end of file
@@ -1,10 +1,19 @@
 #pragma once
 
+#include "Utils/Hash.h"
+
 class Texture;
 class CubeMap;
 
+enum class TextureType {
+	COLOR,
+	NORMAL_MAP // Tangent space normals. Only X and Y are stored, the shader reconstructs Z.
+};
+
 namespace TextureImporter {
-	Texture* ImportTexture(const char* filePath);
+	Texture* ImportTexture(const char* filePath, TextureType type = TextureType::COLOR);
+	Hash GetSettingsHash(TextureType type); // Changes whenever textures of the type would be imported differently
+	bool ReimportTexture(const char* filePath); // Updates the live textures imported from the file
 	void LoadTexture(Texture* texture);
 	void UnloadTexture(Texture* texture);
 
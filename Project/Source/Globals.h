@@ -15,13 +15,28 @@ enum class UpdateStatus {
 #define TEXTURES_PATH "Library/Textures"
 #define MESHES_PATH "Library/Meshes"
 #define SCENES_PATH "Library/Scenes"
+#define PREFABS_PATH "Library/Prefabs"
+#define PROGRAMS_PATH "Library/Programs"
 #define TEXTURE_EXTENSION ".dds"
 #define MESH_EXTENSION ".mesh"
 #define SCENE_EXTENSION ".scene"
+#define PREFAB_EXTENSION ".prefab"
+#define PROGRAM_EXTENSION ".program"
+#define IMPORT_DATABASE_FILE_PATH "Library/ImportDatabase.json"
 
 // Configuration -----------
 #define GLSL_VERSION "#version 330"
 
+// Pools (objects per page, max objects) -----------
+#define GAMEOBJECTS_PAGE_SIZE 1024
+#define GAMEOBJECTS_MAX_CAPACITY 1000000
+#define TEXTURES_PAGE_SIZE 64
+#define TEXTURES_MAX_CAPACITY 65536
+#define CUBEMAPS_PAGE_SIZE 8
+#define CUBEMAPS_MAX_CAPACITY 1024
+#define MESHES_PAGE_SIZE 256
+#define MESHES_MAX_CAPACITY 65536
+
 // Delete helpers -----------
 #define RELEASE(x)          \
 	{                       \
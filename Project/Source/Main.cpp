@@ -1,13 +1,23 @@
 #include "Globals.h"
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/AllocationCounter.h"
+#include "Utils/Profiling.h"
+#include "Utils/MSTimer.h"
+#include "Benchmarks/Benchmarks.h"
+#include "FileSystem/SceneImporter.h"
+#include "Modules/ModuleTime.h"
+#include "Modules/ModuleRender.h"
 
 #include "SDL.h"
 #include <stdlib.h>
-#include "Brofiler.h"
+#include <string.h>
 
 #include "Utils/Leaks.h"
 
+#define HEADLESS_DEFAULT_FRAMES 1000
+#define STARTUP_TRACE_FILE_PATH "StartupTrace.json"
+
 enum class MainState {
 	CREATION,
 	INIT,
@@ -19,20 +29,87 @@ enum class MainState {
 
 Application* App = nullptr;
 
+// Loads a scene without a window or GPU, updates it for a number of frames as fast as possible and exports the frame stats
+static bool RunHeadless(const char* sceneName, int numFrames) {
+	LOG("Headless Application Creation --------------");
+	App = new Application(true);
+
+	bool ret = App->Init() && App->Start();
+	if (ret) {
+		App->time->limitFramerate = false;
+
+		MSTimer loadTimer;
+		loadTimer.Start();
+		ret = SceneImporter::LoadScene(sceneName);
+		LOG("Scene \"%s\" loaded in %ums.", sceneName, loadTimer.Stop());
+
+		LOG("Headless Application Update (%d frames) --------------", numFrames);
+		App->frameStats.Reset();
+		unsigned long long numDrawPackets = 0;
+		unsigned long long numTriangles = 0;
+		int frame = 0;
+		for (; frame < numFrames && ret; ++frame) {
+			ret = App->Update() == UpdateStatus::CONTINUE;
+			numDrawPackets += App->renderer->drawPackets.size();
+			for (const DrawPacket& packet : App->renderer->drawPackets) {
+				numTriangles += packet.numTriangles;
+			}
+		}
+
+		TimingStats frameTiming = App->frameStats.GetSeries()[0]->GetSessionStats();
+		LOG("%d frames: p50 %.3fms, p99 %.3fms, max %.3fms, %.1f draws and %.0f triangles per frame.", frame, frameTiming.p50Ns / 1000000.0, frameTiming.p99Ns / 1000000.0, frameTiming.maxNs / 1000000.0, frame > 0 ? (double) numDrawPackets / frame : 0.0, frame > 0 ? (double) numTriangles / frame : 0.0);
+		App->frameStats.ExportCsv(FRAME_STATS_CSV_FILE_PATH);
+		App->frameStats.ExportJson(FRAME_STATS_JSON_FILE_PATH);
+
+		LOG("Headless Application CleanUp --------------");
+		ret = App->CleanUp() && ret;
+	}
+
+	RELEASE(App);
+	return ret;
+}
+
 int main(int argc, char** argv) {
 #ifdef _DEBUG
 	_CrtMemState memState;
 	_CrtMemCheckpoint(&memState);
 #endif
-
-	// Initialize logging
-	logString = new std::string();
+	InitAllocationCounter();
+
+	// Initialize logging and profiling
+	InitLogging();
+	SetProfilerThreadName("Main");
+
+	// Benchmarks (--benchmark [baseline]), headless runs (--headless <scene> [--frames <count>]) and startup traces (--startup-trace)
+	const char* headlessScene = nullptr;
+	int headlessFrames = HEADLESS_DEFAULT_FRAMES;
+	bool startupTrace = false;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--benchmark") == 0) {
+			const char* baselineFilePath = i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0 ? argv[i + 1] : nullptr;
+			int benchmarkReturn = Benchmarks::Run(baselineFilePath) ? EXIT_SUCCESS : EXIT_FAILURE;
+			ShutdownProfiler();
+			ShutdownLogging();
+			return benchmarkReturn;
+		} else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+			headlessScene = argv[++i];
+		} else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			headlessFrames = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--startup-trace") == 0) {
+			startupTrace = true;
+		}
+	}
+	if (headlessScene != nullptr) {
+		int headlessReturn = RunHeadless(headlessScene, headlessFrames) ? EXIT_SUCCESS : EXIT_FAILURE;
+		ShutdownProfiler();
+		ShutdownLogging();
+		return headlessReturn;
+	}
 
 	// Game loop
 	int mainReturn = EXIT_FAILURE;
 	MainState state = MainState::CREATION;
 	while (state != MainState::EXIT) {
-		BROFILER_FRAME("Main");
 		switch (state) {
 		case MainState::CREATION:
 			LOG("Application Creation --------------");
@@ -56,6 +133,8 @@ int main(int argc, char** argv) {
 				LOG("Application Start exits with error -----");
 				state = MainState::EXIT;
 			} else {
+				// Shows the modules that Init and Start in parallel
+				if (startupTrace) ExportProfilerTrace(STARTUP_TRACE_FILE_PATH);
 				state = MainState::UPDATE;
 				LOG("Application Update --------------");
 			}
@@ -91,7 +170,8 @@ int main(int argc, char** argv) {
 	LOG("Bye :)\n");
 
 	RELEASE(App);
-	RELEASE(logString);
+	ShutdownProfiler();
+	ShutdownLogging();
 
 #ifdef _DEBUG
 	_CrtMemDumpAllObjectsSince(&memState);
@@ -29,3 +29,11 @@ UpdateStatus Module::PostUpdate() {
 bool Module::CleanUp() {
 	return true;
 }
+
+bool Module::InitOnWorker() const {
+	return false;
+}
+
+bool Module::StartOnWorker() const {
+	return false;
+}
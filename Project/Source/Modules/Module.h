@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 enum class UpdateStatus;
 
 class Module {
@@ -12,4 +14,13 @@ public:
 	virtual UpdateStatus Update();
 	virtual UpdateStatus PostUpdate();
 	virtual bool CleanUp();
+
+	// Init and Start of modules that return true here run on worker threads, in parallel with the rest.
+	// They can't touch the GL context or SDL video directly: that work goes through Application::RunOnMainThread.
+	virtual bool InitOnWorker() const;
+	virtual bool StartOnWorker() const;
+
+public:
+	const char* name = "Module"; // Used for timing stats
+	std::vector<Module*> dependencies; // Modules whose Init (or Start) finish before this one's begins
 };
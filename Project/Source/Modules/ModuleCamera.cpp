@@ -4,6 +4,7 @@
 #include "Application.h"
 #include "Utils/Logging.h"
 #include "Utils/MSTimer.h"
+#include "Utils/Profiling.h"
 #include "FileSystem/MeshImporter.h"
 #include "Resources/GameObject.h"
 #include "Components/ComponentBoundingBox.h"
@@ -24,7 +25,6 @@
 #include "SDL_mouse.h"
 #include "SDL_scancode.h"
 #include "SDL_video.h"
-#include "Brofiler.h"
 #include <vector>
 
 #include "Utils/Leaks.h"
@@ -68,8 +68,9 @@ bool ModuleCamera::Init() {
 }
 
 UpdateStatus ModuleCamera::Update() {
-	BROFILER_CATEGORY("ModuleCamera - Update", Profiler::Color::Blue)
+	PROFILE_ZONE("ModuleCamera - Update", ProfilerColor::Blue)
 
+	if (App->headless) return UpdateStatus::CONTINUE;
 	if (activeFrustum != &engineCameraFrustum) return UpdateStatus::CONTINUE;
 
 	float deltaTime = App->time->GetRealTimeDeltaTime();
@@ -135,7 +136,7 @@ UpdateStatus ModuleCamera::Update() {
 	} else {
 		// Focus camera around geometry with f key
 		if (App->input->GetKey(SDL_SCANCODE_F)) {
-			Focus(App->editor->selectedGameObject);
+			Focus(App->editor->GetSelectedGameObject());
 		}
 
 		// Move with arrow keys
@@ -254,7 +255,17 @@ void ModuleCamera::CalculateFrustumNearestObject(float2 pos) {
 
 	if (activeFrustum != &engineCameraFrustum) return;
 
-	std::vector<GameObject*> intersectingObjects;
+	GameObject* selectedGameObject = PickGameObject(pos);
+	if (selectedGameObject != nullptr) {
+		App->editor->SetSelectedGameObject(selectedGameObject);
+	}
+
+	LOG("Ray Tracing in %ums", timer.Stop());
+}
+
+GameObject* ModuleCamera::PickGameObject(float2 pos) {
+	ArenaScope arenaScope;
+	FrameVector<GameObject*> intersectingObjects;
 	LineSegment ray = engineCameraFrustum.UnProjectLineSegment(pos.x, pos.y);
 
 	// Check with AABB
@@ -278,10 +289,14 @@ void ModuleCamera::CalculateFrustumNearestObject(float2 pos) {
 	float minDistance = inf;
 	float distance = 0;
 	for (GameObject* gameObject : intersectingObjects) {
-		std::vector<ComponentMesh*> meshes = gameObject->GetComponents<ComponentMesh>();
+		FrameVector<ComponentMesh*> meshes = gameObject->GetComponents<ComponentMesh>();
 		for (ComponentMesh* mesh : meshes) {
+			Mesh* meshResource = mesh->GetMesh();
+			if (meshResource == nullptr) continue;
+
+			ArenaScope meshArenaScope;
 			const float4x4& model = gameObject->GetComponent<ComponentTransform>()->GetGlobalMatrix();
-			std::vector<Triangle> triangles = MeshImporter::ExtractMeshTriangles(mesh->mesh, model);
+			FrameVector<Triangle> triangles = MeshImporter::ExtractMeshTriangles(meshResource, model);
 			for (Triangle& triangle : triangles) {
 				if (ray.Intersects(triangle, &distance, NULL)) {
 					if (distance < minDistance) {
@@ -293,39 +308,35 @@ void ModuleCamera::CalculateFrustumNearestObject(float2 pos) {
 		}
 	}
 
-	if (selectedGameObject != nullptr) {
-		App->editor->selectedGameObject = selectedGameObject;
-	}
-
-	LOG("Ray Tracing in %ums", timer.Stop());
+	return selectedGameObject;
 }
 
-void ModuleCamera::GetIntersectingAABBRecursive(const Quadtree<GameObject>::Node& node, const AABB2D& nodeAABB, const LineSegment& ray, std::vector<GameObject*>& intersectingObjects) {
+void ModuleCamera::GetIntersectingAABBRecursive(const Quadtree<PoolHandle<GameObject>>::Node& node, const AABB2D& nodeAABB, const LineSegment& ray, FrameVector<GameObject*>& intersectingObjects) {
 	AABB nodeAABB3d = AABB({nodeAABB.minPoint.x, -1000000.0f, nodeAABB.minPoint.y}, {nodeAABB.maxPoint.x, 1000000.0f, nodeAABB.maxPoint.y});
 	if (ray.Intersects(nodeAABB3d)) {
 		if (node.IsBranch()) {
 			vec2d center = nodeAABB.minPoint + (nodeAABB.maxPoint - nodeAABB.minPoint) * 0.5f;
 
-			const Quadtree<GameObject>::Node& topLeft = node.childNodes->nodes[0];
+			const Quadtree<PoolHandle<GameObject>>::Node& topLeft = node.childNodes->nodes[0];
 			AABB2D topLeftAABB = {{nodeAABB.minPoint.x, center.y}, {center.x, nodeAABB.maxPoint.y}};
 			GetIntersectingAABBRecursive(topLeft, topLeftAABB, ray, intersectingObjects);
 
-			const Quadtree<GameObject>::Node& topRight = node.childNodes->nodes[1];
+			const Quadtree<PoolHandle<GameObject>>::Node& topRight = node.childNodes->nodes[1];
 			AABB2D topRightAABB = {{center.x, center.y}, {nodeAABB.maxPoint.x, nodeAABB.maxPoint.y}};
 			GetIntersectingAABBRecursive(topRight, topRightAABB, ray, intersectingObjects);
 
-			const Quadtree<GameObject>::Node& bottomLeft = node.childNodes->nodes[2];
+			const Quadtree<PoolHandle<GameObject>>::Node& bottomLeft = node.childNodes->nodes[2];
 			AABB2D bottomLeftAABB = {{nodeAABB.minPoint.x, nodeAABB.minPoint.y}, {center.x, center.y}};
 			GetIntersectingAABBRecursive(bottomLeft, bottomLeftAABB, ray, intersectingObjects);
 
-			const Quadtree<GameObject>::Node& bottomRight = node.childNodes->nodes[3];
+			const Quadtree<PoolHandle<GameObject>>::Node& bottomRight = node.childNodes->nodes[3];
 			AABB2D bottomRightAABB = {{center.x, nodeAABB.minPoint.y}, {nodeAABB.maxPoint.x, center.y}};
 			GetIntersectingAABBRecursive(bottomRight, bottomRightAABB, ray, intersectingObjects);
 		} else {
-			const Quadtree<GameObject>::Element* element = node.firstElement;
+			const Quadtree<PoolHandle<GameObject>>::Element* element = node.firstElement;
 			while (element != nullptr) {
-				GameObject* gameObject = element->object;
-				if (!gameObject->flag) {
+				GameObject* gameObject = App->scene->gameObjects.Get(element->object);
+				if (gameObject != nullptr && !gameObject->flag) {
 					ComponentBoundingBox* boundingBox = gameObject->GetComponent<ComponentBoundingBox>();
 					const AABB& gameObjectAABB = boundingBox->GetWorldAABB();
 					if (ray.Intersects(gameObjectAABB)) {
@@ -2,6 +2,7 @@
 
 #include "Module.h"
 #include "Utils/Quadtree.h"
+#include "Utils/FrameArena.h"
 
 #include "MathGeoLibFwd.h"
 #include "Math/float4x4.h"
@@ -38,6 +39,7 @@ public:
 	void LookAt(float x, float y, float z);
 	void Focus(const GameObject* gameObject);
 	void CalculateFrustumNearestObject(float2 pos);
+	GameObject* PickGameObject(float2 pos); // Nearest GameObject under a point of the engine camera, in normalized device coordinates
 	void ChangeActiveFrustum(Frustum& frustum, bool change);
 	void ChangeCullingFrustum(Frustum& frustum, bool change);
 	void CalculateFrustumPlanes();
@@ -67,7 +69,7 @@ public:
 	Frustum engineCameraFrustum = Frustum();
 
 private:
-	void GetIntersectingAABBRecursive(const Quadtree<GameObject>::Node& node, const AABB2D& nodeAABB, const LineSegment& ray, std::vector<GameObject*>& intersectingObjects);
+	void GetIntersectingAABBRecursive(const Quadtree<PoolHandle<GameObject>>::Node& node, const AABB2D& nodeAABB, const LineSegment& ray, FrameVector<GameObject*>& intersectingObjects);
 
 private:
 	float focusDistance = 0.0f;
@@ -1,12 +1,12 @@
 #include "ModuleDebugDraw.h"
 
 #include "Globals.h"
+#include "Utils/Profiling.h"
 
 #define DEBUG_DRAW_IMPLEMENTATION
 #include "debugdraw.h" // Debug Draw API. Notice that we need the DEBUG_DRAW_IMPLEMENTATION macro here!
 
 #include "GL/glew.h"
-#include "Brofiler.h"
 
 #include "Utils/Leaks.h"
 
@@ -552,7 +552,7 @@ bool ModuleDebugDraw::CleanUp() {
 }
 
 UpdateStatus ModuleDebugDraw::Update() {
-	BROFILER_CATEGORY("ModuleDebugDraw - Update", Profiler::Color::Purple)
+	PROFILE_ZONE("ModuleDebugDraw - Update", ProfilerColor::Purple)
 
 	//dd::axisTriad(float4x4::identity, 0.1f, 1.0f);
 	dd::xzSquareGrid(-10, 10, 0.0f, 1.0f, dd::colors::Gray);
@@ -2,6 +2,7 @@
 
 #include "Globals.h"
 #include "Application.h"
+#include "Utils/Profiling.h"
 #include "FileSystem/SceneImporter.h"
 #include "Modules/ModuleWindow.h"
 #include "Modules/ModuleRender.h"
@@ -17,7 +18,6 @@
 #include "IconsForkAwesome.h"
 #include "GL/glew.h"
 #include "SDL_video.h"
-#include "Brofiler.h"
 
 #include "Utils/Leaks.h"
 
@@ -135,13 +135,14 @@ bool ModuleEditor::Start() {
 	panels.push_back(&panelConfiguration);
 	panels.push_back(&panelHierarchy);
 	panels.push_back(&panelInspector);
+	panels.push_back(&panelProfiler);
 	panels.push_back(&panelAbout);
 
 	return true;
 }
 
 UpdateStatus ModuleEditor::PreUpdate() {
-	BROFILER_CATEGORY("ModuleEditor - PreUpdate", Profiler::Color::Azure)
+	PROFILE_ZONE("ModuleEditor - PreUpdate", ProfilerColor::Azure)
 
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplSDL2_NewFrame(App->window->window);
@@ -152,7 +153,7 @@ UpdateStatus ModuleEditor::PreUpdate() {
 }
 
 UpdateStatus ModuleEditor::Update() {
-	BROFILER_CATEGORY("ModuleEditor - Update", Profiler::Color::Azure)
+	PROFILE_ZONE("ModuleEditor - Update", ProfilerColor::Azure)
 
 	ImGui::CaptureMouseFromApp(true);
 	ImGui::CaptureKeyboardFromApp(true);
@@ -180,6 +181,7 @@ UpdateStatus ModuleEditor::Update() {
 		ImGui::MenuItem(panelInspector.name, "", &panelInspector.enabled);
 		ImGui::MenuItem(panelHierarchy.name, "", &panelHierarchy.enabled);
 		ImGui::MenuItem(panelConfiguration.name, "", &panelConfiguration.enabled);
+		ImGui::MenuItem(panelProfiler.name, "", &panelProfiler.enabled);
 		ImGui::EndMenu();
 	}
 	if (ImGui::BeginMenu("Help")) {
@@ -249,6 +251,11 @@ UpdateStatus ModuleEditor::Update() {
 			ImGui::CloseCurrentPopup();
 		}
 		ImGui::SameLine();
+		if (ImGui::Button("Export JSON")) {
+			SceneImporter::SaveScene(fileNameBuffer, SceneFormat::JSON_PRETTY);
+			ImGui::CloseCurrentPopup();
+		}
+		ImGui::SameLine();
 		if (ImGui::Button("Cancel")) {
 			ImGui::CloseCurrentPopup();
 		}
@@ -307,7 +314,7 @@ UpdateStatus ModuleEditor::Update() {
 }
 
 UpdateStatus ModuleEditor::PostUpdate() {
-	BROFILER_CATEGORY("ModuleEditor - PostUpdate", Profiler::Color::Azure)
+	PROFILE_ZONE("ModuleEditor - PostUpdate", ProfilerColor::Azure)
 
 	// Draw to default frame buffer (main window)
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -337,3 +344,11 @@ bool ModuleEditor::CleanUp() {
 
 	return true;
 }
+
+GameObject* ModuleEditor::GetSelectedGameObject() const {
+	return App->scene->gameObjects.Get(selectedGameObject);
+}
+
+void ModuleEditor::SetSelectedGameObject(GameObject* gameObject) {
+	selectedGameObject = App->scene->gameObjects.GetHandle(gameObject);
+}
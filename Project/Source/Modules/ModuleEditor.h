@@ -3,17 +3,20 @@
 #include "Module.h"
 
 #include "Utils/Buffer.h"
+#include "Utils/PoolHandle.h"
 #include "Panels/PanelScene.h"
 #include "Panels/PanelConsole.h"
 #include "Panels/PanelConfiguration.h"
 #include "Panels/PanelInspector.h"
 #include "Panels/PanelHierarchy.h"
+#include "Panels/PanelProfiler.h"
 #include "Panels/PanelAbout.h"
 
 #include "imgui.h"
 #include <vector>
 
 class Panel;
+class GameObject;
 
 enum class Modal {
 	NONE,
@@ -32,6 +35,9 @@ public:
 	UpdateStatus PostUpdate() override;
 	bool CleanUp() override;
 
+	GameObject* GetSelectedGameObject() const;
+	void SetSelectedGameObject(GameObject* gameObject);
+
 public:
 	Modal modalToOpen = Modal::NONE;
 
@@ -47,10 +53,9 @@ public:
 	PanelConfiguration panelConfiguration;
 	PanelInspector panelInspector;
 	PanelHierarchy panelHierarchy;
+	PanelProfiler panelProfiler;
 	PanelAbout panelAbout;
 
-	GameObject* selectedGameObject = nullptr;
-
 	ImVec4 titleColor = ImVec4(0.35f, 0.69f, 0.87f, 1.0f);
 	ImVec4 textColor = ImVec4(0.5f, 0.5f, 0.5f, 1.0f);
 	float dragSpeed1f = 0.5f;
@@ -59,5 +64,6 @@ public:
 	float dragSpeed5f = 0.00005f;
 
 private:
+	PoolHandle<GameObject> selectedGameObject; // Handle, so that destroyed GameObjects are never accessed
 	char fileNameBuffer[32] = {'\0'};
 };
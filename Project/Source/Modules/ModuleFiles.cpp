@@ -2,20 +2,50 @@
 
 #include "Globals.h"
 #include "Utils/Logging.h"
+#include "Utils/Profiling.h"
 
 #include "Math/MathFunc.h"
 #include <string.h>
-#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include <algorithm>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+#endif
 
 #include "Utils/Leaks.h"
 
+UpdateStatus ModuleFiles::PreUpdate() {
+	PROFILE_ZONE("ModuleFiles - PreUpdate", ProfilerColor::Black)
+
+	changedFiles.clear();
+	{
+		std::lock_guard<std::mutex> lock(watcherMutex);
+		watcher.Poll(changedFiles);
+	}
+	for (const std::string& filePath : changedFiles) {
+		LOG_INFO(LogCategory::GENERAL, "File changed: \"%s\".", filePath.c_str());
+	}
+
+	return UpdateStatus::CONTINUE;
+}
+
+bool ModuleFiles::CleanUp() {
+	watcher.Clear();
+	changedFiles.clear();
+
+	return true;
+}
+
 Buffer<char> ModuleFiles::Load(const char* filePath) const {
 	Buffer<char> buffer = Buffer<char>();
 
 	FILE* file = fopen(filePath, "rb");
 	if (!file) {
-		LOG("Error loading file %s (%s).\n", filePath, strerror(errno));
+		LOG_WARNING(LogCategory::GENERAL, "Error loading file %s (%s).\n", filePath, strerror(errno));
 		return buffer;
 	}
 	DEFER {
@@ -41,7 +71,7 @@ bool ModuleFiles::Save(const char* filePath, const Buffer<char>& buffer, bool ap
 bool ModuleFiles::Save(const char* filePath, const char* buffer, size_t size, bool append) const {
 	FILE* file = fopen(filePath, append ? "ab" : "wb");
 	if (!file) {
-		LOG("Error saving file %s (%s).\n", filePath, strerror(errno));
+		LOG_WARNING(LogCategory::GENERAL, "Error saving file %s (%s).\n", filePath, strerror(errno));
 		return nullptr;
 	}
 	DEFER {
@@ -54,32 +84,62 @@ bool ModuleFiles::Save(const char* filePath, const char* buffer, size_t size, bo
 }
 
 void ModuleFiles::CreateFolder(const char* folderPath) const {
-	CreateDirectory(folderPath, nullptr);
+#ifdef _WIN32
+	CreateDirectoryA(folderPath, nullptr);
+#else
+	mkdir(folderPath, 0755);
+#endif
 }
 
 void ModuleFiles::EraseFolder(const char* folderPath) const {
-	RemoveDirectory(folderPath);
+#ifdef _WIN32
+	RemoveDirectoryA(folderPath);
+#else
+	rmdir(folderPath);
+#endif
 }
 
 void ModuleFiles::EraseFile(const char* filePath) const {
 	remove(filePath);
 }
 
+bool ModuleFiles::Exists(const char* filePath) const {
+	struct stat fileStats;
+	return stat(filePath, &fileStats) == 0;
+}
+
+bool ModuleFiles::GetFileStats(const char* filePath, size_t& size, long long& modificationTime) const {
+	struct stat fileStats;
+	if (stat(filePath, &fileStats) != 0) return false;
+
+	size = (size_t) fileStats.st_size;
+	modificationTime = (long long) fileStats.st_mtime;
+	return true;
+}
+
 std::vector<std::string> ModuleFiles::GetFilesInFolder(const char* folderPath) const {
-	std::string folderPathEx = std::string(folderPath) + "\\*";
 	std::vector<std::string> filePaths;
-	WIN32_FIND_DATA data;
-	HANDLE handle = FindFirstFile(folderPathEx.c_str(), &data);
+
+#ifdef _WIN32
+	std::string folderPathEx = std::string(folderPath) + "\\*";
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA(folderPathEx.c_str(), &data);
 	if (handle == INVALID_HANDLE_VALUE) return filePaths;
-	unsigned i = 0;
 	do {
-		if (i >= 2) // Ignore '.' and '..'
-		{
-			filePaths.push_back(data.cFileName);
-		}
-		i++;
-	} while (FindNextFile(handle, &data));
+		if (strcmp(data.cFileName, ".") == 0 || strcmp(data.cFileName, "..") == 0) continue;
+		filePaths.push_back(data.cFileName);
+	} while (FindNextFileA(handle, &data));
 	FindClose(handle);
+#else
+	DIR* directory = opendir(folderPath);
+	if (directory == nullptr) return filePaths;
+	while (const dirent* entry = readdir(directory)) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+		filePaths.push_back(entry->d_name);
+	}
+	closedir(directory);
+#endif
+
 	return filePaths;
 }
 
@@ -137,3 +197,12 @@ std::string ModuleFiles::GetFileFolder(const char* filePath) const {
 
 	return std::string(filePath).substr(0, lastSeparator - filePath);
 }
+
+void ModuleFiles::WatchFolder(const char* folderPath) {
+	std::lock_guard<std::mutex> lock(watcherMutex);
+	watcher.Watch(folderPath);
+}
+
+const std::vector<std::string>& ModuleFiles::GetChangedFiles() const {
+	return changedFiles;
+}
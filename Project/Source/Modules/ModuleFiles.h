@@ -2,12 +2,17 @@
 
 #include "Module.h"
 #include "Utils/Buffer.h"
+#include "FileSystem/FileWatcher.h"
 
 #include <string>
 #include <vector>
+#include <mutex>
 
 class ModuleFiles : public Module {
 public:
+	UpdateStatus PreUpdate() override;
+	bool CleanUp() override;
+
 	Buffer<char> Load(const char* filePath) const;
 	bool Save(const char* filePath, const Buffer<char>& buffer, bool append = false) const;
 	bool Save(const char* filePath, const char* buffer, size_t size, bool append = false) const;
@@ -16,10 +21,23 @@ public:
 	void EraseFolder(const char* folderPath) const;
 	void EraseFile(const char* filePath) const;
 
+	bool Exists(const char* filePath) const;
+	bool GetFileStats(const char* filePath, size_t& size, long long& modificationTime) const;
+
 	std::vector<std::string> GetFilesInFolder(const char* folderPath) const;
 
 	std::string GetFileNameAndExtension(const char* filePath) const;
 	std::string GetFileName(const char* filePath) const;
 	std::string GetFileExtension(const char* filePath) const;
 	std::string GetFileFolder(const char* filePath) const;
+
+	// Files written to watched folders, reported once their changes settle. Valid until the next frame.
+	// Folders can be watched from the startup workers.
+	void WatchFolder(const char* folderPath);
+	const std::vector<std::string>& GetChangedFiles() const;
+
+private:
+	FileWatcher watcher;
+	std::mutex watcherMutex;
+	std::vector<std::string> changedFiles;
 };
@@ -2,6 +2,7 @@
 
 #include "Globals.h"
 #include "Application.h"
+#include "Utils/Profiling.h"
 
 #include "SDL_version.h"
 #include "SDL_cpuinfo.h"
@@ -9,11 +10,10 @@
 #include "GL/glew.h"
 #include "IL/il.h"
 #include "assimp/version.h"
-#include "Brofiler.h"
 
 #include "Utils/Leaks.h"
 
-bool ModuleHardwareInfo::Start() {
+bool ModuleHardwareInfo::Init() {
 	SDL_version sdlVersionStruct;
 	SDL_VERSION(&sdlVersionStruct);
 
@@ -40,6 +40,12 @@ bool ModuleHardwareInfo::Start() {
 	caps[12] = SDL_HasSSE41();
 	caps[13] = SDL_HasSSE42();
 
+	return true;
+}
+
+bool ModuleHardwareInfo::Start() {
+	if (App->headless) return true;
+
 	gpuVendor = (const char*) glGetString(GL_VENDOR);
 	gpuRenderer = (const char*) glGetString(GL_RENDERER);
 	gpuOpenglVersion = (const char*) glGetString(GL_VERSION);
@@ -48,7 +54,9 @@ bool ModuleHardwareInfo::Start() {
 }
 
 UpdateStatus ModuleHardwareInfo::Update() {
-	BROFILER_CATEGORY("ModuleHardwareInfo - PreUpdate", Profiler::Color::Orange)
+	PROFILE_ZONE("ModuleHardwareInfo - PreUpdate", ProfilerColor::Orange)
+
+	if (App->headless) return UpdateStatus::CONTINUE;
 
 	int vramBudgetKb;
 	int vramAvailableKb;
@@ -64,3 +72,7 @@ UpdateStatus ModuleHardwareInfo::Update() {
 bool ModuleHardwareInfo::CleanUp() {
 	return true;
 }
+
+bool ModuleHardwareInfo::InitOnWorker() const {
+	return true;
+}
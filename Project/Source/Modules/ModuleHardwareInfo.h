@@ -7,10 +7,13 @@ struct SDL_version;
 
 class ModuleHardwareInfo : public Module {
 public:
+	bool Init() override;
 	bool Start() override;
 	UpdateStatus Update() override;
 	bool CleanUp() override;
 
+	bool InitOnWorker() const override;
+
 public:
 	char glewVersion[20] = "Not available";
 	char sdlVersion[20] = "Not available";
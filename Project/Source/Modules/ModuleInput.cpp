@@ -3,13 +3,13 @@
 #include "Globals.h"
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/Profiling.h"
 #include "Modules/ModuleWindow.h"
 #include "Modules/ModuleRender.h"
 #include "Modules/ModuleCamera.h"
 
 #include "imgui_impl_sdl.h"
 #include "SDL.h"
-#include "Brofiler.h"
 
 #include "Utils/Leaks.h"
 
@@ -19,7 +19,7 @@ bool ModuleInput::Init() {
 	SDL_Init(0);
 
 	if (SDL_InitSubSystem(SDL_INIT_EVENTS) < 0) {
-		LOG("SDL_EVENTS could not initialize! SDL_Error: %s\n", SDL_GetError());
+		LOG_CRITICAL(LogCategory::GENERAL, "SDL_EVENTS could not initialize! SDL_Error: %s\n", SDL_GetError());
 		ret = false;
 	}
 
@@ -27,7 +27,7 @@ bool ModuleInput::Init() {
 }
 
 UpdateStatus ModuleInput::PreUpdate() {
-	BROFILER_CATEGORY("ModuleInput - PreUpdate", Profiler::Color::AntiqueWhite)
+	PROFILE_ZONE("ModuleInput - PreUpdate", ProfilerColor::AntiqueWhite)
 
 	ImGuiIO& io = ImGui::GetIO();
 
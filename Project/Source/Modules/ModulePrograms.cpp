@@ -3,23 +3,68 @@
 #include "Globals.h"
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/Profiling.h"
+#include "Utils/Hash.h"
 #include "Modules/ModuleFiles.h"
 
 #include "GL/glew.h"
+#include <string>
+#include <string.h>
 
 #include "Utils/Leaks.h"
 
-static unsigned CreateShader(unsigned type, const char* filePath) {
-	LOG("Creating shader from file: \"%s\"...", filePath);
+#define SHADERS_PATH "Shaders"
+#define DEFAULT_VERTEX_SHADER_FILE_PATH SHADERS_PATH "/default_vertex.glsl"
+#define DEFAULT_FRAGMENT_SHADER_FILE_PATH SHADERS_PATH "/default_fragment.glsl"
+#define PHONG_PBR_VERTEX_SHADER_FILE_PATH SHADERS_PATH "/phong_pbr_vertex.glsl"
+#define PHONG_PBR_FRAGMENT_SHADER_FILE_PATH SHADERS_PATH "/phong_pbr_fragment.glsl"
+#define SKYBOX_VERTEX_SHADER_FILE_PATH SHADERS_PATH "/skybox_vertex.glsl"
+#define SKYBOX_FRAGMENT_SHADER_FILE_PATH SHADERS_PATH "/skybox_fragment.glsl"
 
-	Buffer<char> sourceBuffer = App->files->Load(filePath);
-	char* source = sourceBuffer.Data();
+// Increase when the layout of the cache files changes
+#define PROGRAM_CACHE_MAGIC "TPRG"
+#define PROGRAM_CACHE_VERSION 1
+
+struct ProgramCacheHeader {
+	char magic[4];
+	unsigned version;
+	unsigned binaryFormat;
+	unsigned binarySize;
+};
+
+/* Programs are built in two steps: Begin issues every compile and link, and Finish queries the results.
+*  Drivers with parallel shader compilation work on all the programs begun before the first query.
+*  Linked programs are cached as driver binaries, keyed by their sources and the driver, so later launches skip compilation.
+*/
+struct ProgramBuild {
+	const char* vertexShaderFilePath = nullptr;
+	const char* fragmentShaderFilePath = nullptr;
+	std::string cacheFilePath = "";
+	unsigned programId = 0;
+	unsigned vertexShader = 0;
+	unsigned fragmentShader = 0;
+	bool fromCache = false;
+};
+
+static bool programBinariesSupported = false;
+static Hash driverHash = 0;
+
+static Hash HashGLString(Hash hash, unsigned name) {
+	const char* string = (const char*) glGetString(name);
+	if (string == nullptr) return hash;
+	return HashCombine(hash, HashBuffer(string, strlen(string)));
+}
+
+static unsigned CompileShader(unsigned type, const Buffer<char>& sourceBuffer) {
+	const char* source = sourceBuffer.Data();
 
 	unsigned shaderId = glCreateShader(type);
 	glShaderSource(shaderId, 1, &source, 0);
-
 	glCompileShader(shaderId);
+	return shaderId;
+}
 
+static bool CheckShader(unsigned shaderId, const char* filePath) {
 	int res = GL_FALSE;
 	glGetShaderiv(shaderId, GL_COMPILE_STATUS, &res);
 	if (res == GL_FALSE) {
@@ -29,34 +74,100 @@ static unsigned CreateShader(unsigned type, const char* filePath) {
 			int written = 0;
 			Buffer<char> info = Buffer<char>(len);
 			glGetShaderInfoLog(shaderId, len, &written, info.Data());
-			LOG("Log Info: %s", info.Data());
+			LOG_WARNING(LogCategory::RENDER, "Log Info (\"%s\"): %s", filePath, info.Data());
 		}
+		return false;
 	}
 
-	LOG("Shader created successfuly.");
-	return shaderId;
+	LOG_VERBOSE(LogCategory::RENDER, "Shader \"%s\" compiled successfuly.", filePath);
+	return true;
 }
 
-static unsigned CreateProgram(const char* vertexShaderFilePath, const char* fragmentShaderFilePath) {
-	LOG("Creating program...");
+static bool LoadProgramBinary(ProgramBuild& build) {
+	if (!App->files->Exists(build.cacheFilePath.c_str())) return false;
 
-	// Compile the shaders and delete them at the end
-	LOG("Compiling shaders...");
-	unsigned vertexShader = CreateShader(GL_VERTEX_SHADER, vertexShaderFilePath);
-	DEFER {
-		glDeleteShader(vertexShader);
-	};
-	unsigned fragmentShader = CreateShader(GL_FRAGMENT_SHADER, fragmentShaderFilePath);
+	Buffer<char> buffer = App->files->Load(build.cacheFilePath.c_str());
+	if (buffer.Size() < sizeof(ProgramCacheHeader)) return false;
+	const ProgramCacheHeader* header = (const ProgramCacheHeader*) buffer.Data();
+	if (memcmp(header->magic, PROGRAM_CACHE_MAGIC, 4) != 0 || header->version != PROGRAM_CACHE_VERSION || buffer.Size() - 1 != sizeof(ProgramCacheHeader) + header->binarySize) return false;
+
+	unsigned programId = glCreateProgram();
+	glProgramBinary(programId, header->binaryFormat, header + 1, header->binarySize);
+	int res = GL_FALSE;
+	glGetProgramiv(programId, GL_LINK_STATUS, &res);
+	if (res == GL_FALSE) {
+		// Usually a driver update that the version string didn't reflect
+		LOG_INFO(LogCategory::RENDER, "Cached program \"%s\" rejected by the driver, compiling.", build.cacheFilePath.c_str());
+		glDeleteProgram(programId);
+		return false;
+	}
+
+	LOG_VERBOSE(LogCategory::RENDER, "Program loaded from \"%s\".", build.cacheFilePath.c_str());
+	build.programId = programId;
+	build.fromCache = true;
+	return true;
+}
+
+static void SaveProgramBinary(const ProgramBuild& build) {
+	int binarySize = 0;
+	glGetProgramiv(build.programId, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+	if (binarySize <= 0) return;
+
+	Buffer<char> buffer = Buffer<char>(sizeof(ProgramCacheHeader) + binarySize);
+	ProgramCacheHeader* header = (ProgramCacheHeader*) buffer.Data();
+	memcpy(header->magic, PROGRAM_CACHE_MAGIC, 4);
+	header->version = PROGRAM_CACHE_VERSION;
+
+	int written = 0;
+	GLenum binaryFormat = 0;
+	glGetProgramBinary(build.programId, binarySize, &written, &binaryFormat, header + 1);
+	if (written != binarySize) return;
+	header->binaryFormat = binaryFormat;
+	header->binarySize = (unsigned) binarySize;
+
+	LOG_VERBOSE(LogCategory::RENDER, "Saving program to \"%s\".", build.cacheFilePath.c_str());
+	App->files->Save(build.cacheFilePath.c_str(), buffer);
+}
+
+static void BeginProgram(ProgramBuild& build) {
+	LOG_VERBOSE(LogCategory::RENDER, "Creating program (\"%s\", \"%s\")...", build.vertexShaderFilePath, build.fragmentShaderFilePath);
+
+	Buffer<char> vertexSource = App->files->Load(build.vertexShaderFilePath);
+	Buffer<char> fragmentSource = App->files->Load(build.fragmentShaderFilePath);
+
+	// The loaded buffers have an extra null terminator that isn't part of the files
+	if (programBinariesSupported && vertexSource.Size() > 0 && fragmentSource.Size() > 0) {
+		Hash sourceHash = HashCombine(HashBuffer(vertexSource.Data(), vertexSource.Size() - 1), HashBuffer(fragmentSource.Data(), fragmentSource.Size() - 1));
+		build.cacheFilePath = std::string(PROGRAMS_PATH) + "/" + HashToString(HashCombine(sourceHash, driverHash)) + PROGRAM_EXTENSION;
+		if (LoadProgramBinary(build)) return;
+	}
+
+	// Compile the shaders and link the program without waiting for the results
+	LOG_VERBOSE(LogCategory::RENDER, "Compiling shaders...");
+	build.vertexShader = CompileShader(GL_VERTEX_SHADER, vertexSource);
+	build.fragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+	LOG_VERBOSE(LogCategory::RENDER, "Linking program...");
+	build.programId = glCreateProgram();
+	glAttachShader(build.programId, build.vertexShader);
+	glAttachShader(build.programId, build.fragmentShader);
+	if (programBinariesSupported) glProgramParameteri(build.programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	glLinkProgram(build.programId);
+}
+
+// Returns the program, or 0 if it failed
+static unsigned FinishProgram(ProgramBuild& build) {
+	if (build.fromCache) return build.programId;
+
+	// Delete the shaders at the end
 	DEFER {
-		glDeleteShader(fragmentShader);
+		glDeleteShader(build.vertexShader);
+		glDeleteShader(build.fragmentShader);
 	};
+	CheckShader(build.vertexShader, build.vertexShaderFilePath);
+	CheckShader(build.fragmentShader, build.fragmentShaderFilePath);
 
-	// Link the program
-	LOG("Linking program...");
-	unsigned programId = glCreateProgram();
-	glAttachShader(programId, vertexShader);
-	glAttachShader(programId, fragmentShader);
-	glLinkProgram(programId);
+	unsigned programId = build.programId;
 	int res = GL_FALSE;
 	glGetProgramiv(programId, GL_LINK_STATUS, &res);
 	if (res == GL_FALSE) {
@@ -66,25 +177,86 @@ static unsigned CreateProgram(const char* vertexShaderFilePath, const char* frag
 			int written = 0;
 			Buffer<char> info = Buffer<char>(len);
 			glGetProgramInfoLog(programId, len, &written, info.Data());
-			LOG("Program Log Info: %s", info.Data());
+			LOG_WARNING(LogCategory::RENDER, "Program Log Info: %s", info.Data());
 		}
 
-		LOG("Error linking program.");
-	} else {
-		LOG("Program linked.");
+		LOG_CRITICAL(LogCategory::RENDER, "Error linking program.");
+		glDeleteProgram(programId);
+		return 0;
 	}
 
+	LOG_VERBOSE(LogCategory::RENDER, "Program linked.");
+	if (!build.cacheFilePath.empty()) SaveProgramBinary(build);
+
 	return programId;
 }
 
+static unsigned CreateProgram(const char* vertexShaderFilePath, const char* fragmentShaderFilePath) {
+	ProgramBuild build = {vertexShaderFilePath, fragmentShaderFilePath};
+	BeginProgram(build);
+	return FinishProgram(build);
+}
+
+// Rebuilds the program if one of its shaders changed. The previous program is kept if the new one fails.
+static void ReloadProgram(unsigned& program, const char* vertexShaderFilePath, const char* fragmentShaderFilePath, const std::string& changedFilePath) {
+	if (changedFilePath != vertexShaderFilePath && changedFilePath != fragmentShaderFilePath) return;
+
+	LOG_INFO(LogCategory::RENDER, "Reloading program (\"%s\", \"%s\").", vertexShaderFilePath, fragmentShaderFilePath);
+	unsigned newProgram = CreateProgram(vertexShaderFilePath, fragmentShaderFilePath);
+	if (newProgram == 0) return;
+
+	glDeleteProgram(program);
+	program = newProgram;
+}
+
 bool ModulePrograms::Start() {
-	defaultProgram = CreateProgram("Shaders/default_vertex.glsl", "Shaders/default_fragment.glsl");
-	phongPbrProgram = CreateProgram("Shaders/phong_pbr_vertex.glsl", "Shaders/phong_pbr_fragment.glsl");
-	skyboxProgram = CreateProgram("Shaders/skybox_vertex.glsl", "Shaders/skybox_fragment.glsl");
+	PROFILE_ZONE("ModulePrograms - Start", ProfilerColor::Black)
+
+	// Program binaries are only valid for the driver that created them
+	int numBinaryFormats = 0;
+	if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+	programBinariesSupported = numBinaryFormats > 0;
+	driverHash = HashGLString(HashGLString(HashGLString(PROGRAM_CACHE_VERSION, GL_VENDOR), GL_RENDERER), GL_VERSION);
+	App->files->CreateFolder("Library");
+	App->files->CreateFolder(PROGRAMS_PATH);
+
+	// Let the driver compile on as many threads as it wants
+	if (GLEW_KHR_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+	} else if (GLEW_ARB_parallel_shader_compile) {
+		glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+	}
+
+	ProgramBuild builds[] = {
+		{DEFAULT_VERTEX_SHADER_FILE_PATH, DEFAULT_FRAGMENT_SHADER_FILE_PATH},
+		{PHONG_PBR_VERTEX_SHADER_FILE_PATH, PHONG_PBR_FRAGMENT_SHADER_FILE_PATH},
+		{SKYBOX_VERTEX_SHADER_FILE_PATH, SKYBOX_FRAGMENT_SHADER_FILE_PATH},
+	};
+	unsigned* programs[] = {&defaultProgram, &phongPbrProgram, &skyboxProgram};
+	for (ProgramBuild& build : builds) {
+		BeginProgram(build);
+	}
+	for (unsigned i = 0; i < sizeof(builds) / sizeof(builds[0]); ++i) {
+		*programs[i] = FinishProgram(builds[i]);
+	}
+
+	App->files->WatchFolder(SHADERS_PATH);
 
 	return true;
 }
 
+UpdateStatus ModulePrograms::Update() {
+	PROFILE_ZONE("ModulePrograms - Update", ProfilerColor::Black)
+
+	for (const std::string& filePath : App->files->GetChangedFiles()) {
+		ReloadProgram(defaultProgram, DEFAULT_VERTEX_SHADER_FILE_PATH, DEFAULT_FRAGMENT_SHADER_FILE_PATH, filePath);
+		ReloadProgram(phongPbrProgram, PHONG_PBR_VERTEX_SHADER_FILE_PATH, PHONG_PBR_FRAGMENT_SHADER_FILE_PATH, filePath);
+		ReloadProgram(skyboxProgram, SKYBOX_VERTEX_SHADER_FILE_PATH, SKYBOX_FRAGMENT_SHADER_FILE_PATH, filePath);
+	}
+
+	return UpdateStatus::CONTINUE;
+}
+
 bool ModulePrograms::CleanUp() {
 	glDeleteProgram(defaultProgram);
 	glDeleteProgram(phongPbrProgram);
@@ -5,6 +5,7 @@
 class ModulePrograms : public Module {
 public:
 	bool Start() override;
+	UpdateStatus Update() override;
 	bool CleanUp() override;
 
 public:
@@ -3,10 +3,14 @@
 #include "Globals.h"
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/FrameArena.h"
+#include "Utils/AllocationCounter.h"
+#include "Utils/Profiling.h"
 #include "Components/ComponentMesh.h"
 #include "Components/ComponentBoundingBox.h"
 #include "Components/ComponentTransform.h"
 #include "Components/ComponentMaterial.h"
+#include "Resources/Mesh.h"
 #include "Modules/ModuleInput.h"
 #include "Modules/ModuleWindow.h"
 #include "Modules/ModuleCamera.h"
@@ -19,13 +23,20 @@
 #include "Geometry/AABB.h"
 #include "Geometry/AABB2D.h"
 #include "Geometry/OBB.h"
+#include "Geometry/Frustum.h"
+#include "Math/MathFunc.h"
 #include "debugdraw.h"
 #include "GL/glew.h"
 #include "SDL.h"
-#include "Brofiler.h"
+#include <algorithm>
+#include <functional>
+#include <math.h>
 
 #include "Utils/Leaks.h"
 
+#define OCCLUSION_MAX_OCCLUDERS 32
+#define OCCLUSION_MIN_OCCLUDER_SCREEN_SIZE 0.1f // Radius relative to half the screen height
+
 static void __stdcall OurOpenGLErrorFunction(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
 	const char *tmpSource = "", *tmpType = "", *tmpSeverity = "";
 	switch (source) {
@@ -96,10 +107,18 @@ static void __stdcall OurOpenGLErrorFunction(GLenum source, GLenum type, GLuint
 		return;
 	}
 
-	LOG("<Source:%s> <Type:%s> <Severity:%s> <ID:%d> <Message:%s>", tmpSource, tmpType, tmpSeverity, id, message);
+	LOG_WARNING(LogCategory::RENDER, "<Source:%s> <Type:%s> <Severity:%s> <ID:%d> <Message:%s>", tmpSource, tmpType, tmpSeverity, id, message);
 }
 
 bool ModuleRender::Init() {
+	if (App->headless) {
+		LOG("Using the null render backend");
+
+		// Levels of detail are picked as if there was a 1080p viewport
+		ViewportResized(1920, 1080);
+		return true;
+	}
+
 	LOG("Creating Renderer context");
 
 	context = SDL_GL_CreateContext(App->window->window);
@@ -128,7 +147,12 @@ bool ModuleRender::Init() {
 }
 
 UpdateStatus ModuleRender::PreUpdate() {
-	BROFILER_CATEGORY("ModuleRender - PreUpdate", Profiler::Color::Green)
+	PROFILE_ZONE("ModuleRender - PreUpdate", ProfilerColor::Green)
+
+	if (App->headless) {
+		drawPackets.clear();
+		return UpdateStatus::CONTINUE;
+	}
 
 	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 	glViewport(0, 0, viewportWidth, viewportHeight);
@@ -140,15 +164,17 @@ UpdateStatus ModuleRender::PreUpdate() {
 }
 
 UpdateStatus ModuleRender::Update() {
-	BROFILER_CATEGORY("ModuleRender - Update", Profiler::Color::Green)
+	PROFILE_ZONE("ModuleRender - Update", ProfilerColor::Green)
 
 	// Draw Skybox as a first element
-	DrawSkyBox();
+	if (!App->headless) DrawSkyBox();
 
 	// Draw the scene
 	//PerformanceTimer timer;
 	//timer.Start();
+	unsigned long long allocationCount = GetAllocationCount();
 	App->camera->CalculateFrustumPlanes();
+	visibleGameObjects.clear();
 	for (GameObject& gameObject : App->scene->gameObjects) {
 		gameObject.flag = false;
 		if (gameObject.isInQuadtree) continue;
@@ -159,16 +185,23 @@ UpdateStatus ModuleRender::Update() {
 		const AABB& gameObjectAABB = boundingBox->GetWorldAABB();
 		const OBB& gameObjectOBB = boundingBox->GetWorldOBB();
 		if (CheckIfInsideFrustum(gameObjectAABB, gameObjectOBB)) {
-			DrawGameObject(&gameObject);
+			visibleGameObjects.push_back(App->scene->gameObjects.GetHandle(&gameObject));
 		}
 	}
 	if (App->scene->quadtree.IsOperative()) {
-		DrawSceneRecursive(App->scene->quadtree.root, App->scene->quadtree.bounds);
+		CullSceneRecursive(App->scene->quadtree.root, App->scene->quadtree.bounds);
 	}
+	CullOccludedGameObjects();
+	for (PoolHandle<GameObject> handle : visibleGameObjects) {
+		DrawGameObject(App->scene->gameObjects.Get(handle));
+	}
+	sceneDrawHeapAllocations = GetAllocationCount() - allocationCount;
 	//LOG("Scene draw: %llu mis", timer.Stop());
 
+	if (App->headless) return UpdateStatus::CONTINUE;
+
 	// Draw Guizmos
-	GameObject* selectedGameObject = App->editor->selectedGameObject;
+	GameObject* selectedGameObject = App->editor->GetSelectedGameObject();
 	if (selectedGameObject) selectedGameObject->DrawGizmos();
 
 	// Draw quadtree
@@ -183,7 +216,9 @@ UpdateStatus ModuleRender::Update() {
 }
 
 UpdateStatus ModuleRender::PostUpdate() {
-	BROFILER_CATEGORY("ModuleRender - PostUpdate", Profiler::Color::Green)
+	PROFILE_ZONE("ModuleRender - PostUpdate", ProfilerColor::Green)
+
+	if (App->headless) return UpdateStatus::CONTINUE;
 
 	SDL_GL_SwapWindow(App->window->window);
 
@@ -191,6 +226,8 @@ UpdateStatus ModuleRender::PostUpdate() {
 }
 
 bool ModuleRender::CleanUp() {
+	if (App->headless) return true;
+
 	glDeleteTextures(1, &renderTexture);
 	glDeleteRenderbuffers(1, &depthRenderbuffer);
 	glDeleteFramebuffers(1, &framebuffer);
@@ -202,6 +239,8 @@ void ModuleRender::ViewportResized(int width, int height) {
 	viewportWidth = width;
 	viewportHeight = height;
 
+	if (App->headless) return;
+
 	// Framebuffer calculations
 	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
 
@@ -216,31 +255,33 @@ void ModuleRender::ViewportResized(int width, int height) {
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRenderbuffer);
 
 	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
-		LOG("ERROR: Framebuffer is not complete!");
+		LOG_CRITICAL(LogCategory::RENDER, "ERROR: Framebuffer is not complete!");
 	}
 }
 
 void ModuleRender::SetVSync(bool vsync) {
+	if (App->headless) return;
+
 	SDL_GL_SetSwapInterval(vsync);
 }
 
-void ModuleRender::DrawQuadtreeRecursive(const Quadtree<GameObject>::Node& node, const AABB2D& aabb) {
+void ModuleRender::DrawQuadtreeRecursive(const Quadtree<PoolHandle<GameObject>>::Node& node, const AABB2D& aabb) {
 	if (node.IsBranch()) {
 		vec2d center = aabb.minPoint + (aabb.maxPoint - aabb.minPoint) * 0.5f;
 
-		const Quadtree<GameObject>::Node& topLeft = node.childNodes->nodes[0];
+		const Quadtree<PoolHandle<GameObject>>::Node& topLeft = node.childNodes->nodes[0];
 		AABB2D topLeftAABB = {{aabb.minPoint.x, center.y}, {center.x, aabb.maxPoint.y}};
 		DrawQuadtreeRecursive(topLeft, topLeftAABB);
 
-		const Quadtree<GameObject>::Node& topRight = node.childNodes->nodes[1];
+		const Quadtree<PoolHandle<GameObject>>::Node& topRight = node.childNodes->nodes[1];
 		AABB2D topRightAABB = {{center.x, center.y}, {aabb.maxPoint.x, aabb.maxPoint.y}};
 		DrawQuadtreeRecursive(topRight, topRightAABB);
 
-		const Quadtree<GameObject>::Node& bottomLeft = node.childNodes->nodes[2];
+		const Quadtree<PoolHandle<GameObject>>::Node& bottomLeft = node.childNodes->nodes[2];
 		AABB2D bottomLeftAABB = {{aabb.minPoint.x, aabb.minPoint.y}, {center.x, center.y}};
 		DrawQuadtreeRecursive(bottomLeft, bottomLeftAABB);
 
-		const Quadtree<GameObject>::Node& bottomRight = node.childNodes->nodes[3];
+		const Quadtree<PoolHandle<GameObject>>::Node& bottomRight = node.childNodes->nodes[3];
 		AABB2D bottomRightAABB = {{center.x, aabb.minPoint.y}, {aabb.maxPoint.x, center.y}};
 		DrawQuadtreeRecursive(bottomRight, bottomRightAABB);
 	} else {
@@ -258,37 +299,38 @@ void ModuleRender::DrawQuadtreeRecursive(const Quadtree<GameObject>::Node& node,
 	}
 }
 
-void ModuleRender::DrawSceneRecursive(const Quadtree<GameObject>::Node& node, const AABB2D& aabb) {
+void ModuleRender::CullSceneRecursive(const Quadtree<PoolHandle<GameObject>>::Node& node, const AABB2D& aabb) {
 	AABB aabb3d = AABB({aabb.minPoint.x, -1000000.0f, aabb.minPoint.y}, {aabb.maxPoint.x, 1000000.0f, aabb.maxPoint.y});
 	if (CheckIfInsideFrustum(aabb3d, OBB(aabb3d))) {
 		if (node.IsBranch()) {
 			vec2d center = aabb.minPoint + (aabb.maxPoint - aabb.minPoint) * 0.5f;
 
-			const Quadtree<GameObject>::Node& topLeft = node.childNodes->nodes[0];
+			const Quadtree<PoolHandle<GameObject>>::Node& topLeft = node.childNodes->nodes[0];
 			AABB2D topLeftAABB = {{aabb.minPoint.x, center.y}, {center.x, aabb.maxPoint.y}};
-			DrawSceneRecursive(topLeft, topLeftAABB);
+			CullSceneRecursive(topLeft, topLeftAABB);
 
-			const Quadtree<GameObject>::Node& topRight = node.childNodes->nodes[1];
+			const Quadtree<PoolHandle<GameObject>>::Node& topRight = node.childNodes->nodes[1];
 			AABB2D topRightAABB = {{center.x, center.y}, {aabb.maxPoint.x, aabb.maxPoint.y}};
-			DrawSceneRecursive(topRight, topRightAABB);
+			CullSceneRecursive(topRight, topRightAABB);
 
-			const Quadtree<GameObject>::Node& bottomLeft = node.childNodes->nodes[2];
+			const Quadtree<PoolHandle<GameObject>>::Node& bottomLeft = node.childNodes->nodes[2];
 			AABB2D bottomLeftAABB = {{aabb.minPoint.x, aabb.minPoint.y}, {center.x, center.y}};
-			DrawSceneRecursive(bottomLeft, bottomLeftAABB);
+			CullSceneRecursive(bottomLeft, bottomLeftAABB);
 
-			const Quadtree<GameObject>::Node& bottomRight = node.childNodes->nodes[3];
+			const Quadtree<PoolHandle<GameObject>>::Node& bottomRight = node.childNodes->nodes[3];
 			AABB2D bottomRightAABB = {{center.x, aabb.minPoint.y}, {aabb.maxPoint.x, center.y}};
-			DrawSceneRecursive(bottomRight, bottomRightAABB);
+			CullSceneRecursive(bottomRight, bottomRightAABB);
 		} else {
-			const Quadtree<GameObject>::Element* element = node.firstElement;
+			const Quadtree<PoolHandle<GameObject>>::Element* element = node.firstElement;
 			while (element != nullptr) {
-				GameObject* gameObject = element->object;
-				if (!gameObject->flag) {
+				// Elements of destroyed GameObjects resolve to nullptr, even if their slot has been reused
+				GameObject* gameObject = App->scene->gameObjects.Get(element->object);
+				if (gameObject != nullptr && !gameObject->flag) {
 					ComponentBoundingBox* boundingBox = gameObject->GetComponent<ComponentBoundingBox>();
 					const AABB& gameObjectAABB = boundingBox->GetWorldAABB();
 					const OBB& gameObjectOBB = boundingBox->GetWorldOBB();
 					if (CheckIfInsideFrustum(gameObjectAABB, gameObjectOBB)) {
-						DrawGameObject(gameObject);
+						visibleGameObjects.push_back(element->object);
 					}
 
 					gameObject->flag = true;
@@ -337,10 +379,88 @@ bool ModuleRender::CheckIfInsideFrustum(const AABB& aabb, const OBB& obb) {
 	return true;
 }
 
+void ModuleRender::CullOccludedGameObjects() {
+	PROFILE_ZONE("ModuleRender - CullOccludedGameObjects", ProfilerColor::Green)
+
+	numOccluders = 0;
+	numOccludedGameObjects = 0;
+
+	// Depth as 1/w only works with perspective
+	const Frustum* frustum = App->camera->GetCullingFrustum();
+	if (!occlusionCulling || frustum->Type() != FrustumType::PerspectiveFrustum) return;
+
+	// Occluders: the visible objects with occluder meshes that cover the most screen
+	float tanHalfFov = tanf(frustum->VerticalFov() * 0.5f);
+	occluderCandidates.clear();
+	for (unsigned i = 0; i < visibleGameObjects.size(); ++i) {
+		ArenaScope arenaScope;
+
+		GameObject* gameObject = App->scene->gameObjects.Get(visibleGameObjects[i]);
+		const AABB& aabb = gameObject->GetComponent<ComponentBoundingBox>()->GetWorldAABB();
+		float radius = aabb.HalfDiagonal().Length();
+		float distance = aabb.CenterPoint().Distance(frustum->Pos());
+		float screenSize = distance > radius ? radius / (distance * tanHalfFov) : FLOAT_INF; // Relative to half the screen height
+		if (screenSize < OCCLUSION_MIN_OCCLUDER_SCREEN_SIZE) continue;
+
+		FrameVector<ComponentMesh*> meshes = gameObject->GetComponents<ComponentMesh>();
+		for (ComponentMesh* mesh : meshes) {
+			const Mesh* occluder = mesh->GetMesh();
+			if (!mesh->IsActive() || occluder == nullptr || occluder->occluderIndices.empty()) continue;
+
+			occluderCandidates.push_back(std::make_pair(screenSize, i));
+			break;
+		}
+	}
+	if (occluderCandidates.empty()) return;
+
+	if (occluderCandidates.size() > OCCLUSION_MAX_OCCLUDERS) {
+		std::partial_sort(occluderCandidates.begin(), occluderCandidates.begin() + OCCLUSION_MAX_OCCLUDERS, occluderCandidates.end(), std::greater<std::pair<float, unsigned>>());
+		occluderCandidates.resize(OCCLUSION_MAX_OCCLUDERS);
+	}
+
+	occlusionBuffer.Begin(frustum->ViewProjMatrix(), frustum->NearPlaneDistance());
+	isOccluder.assign(visibleGameObjects.size(), false);
+	for (const std::pair<float, unsigned>& candidate : occluderCandidates) {
+		ArenaScope arenaScope;
+
+		GameObject* gameObject = App->scene->gameObjects.Get(visibleGameObjects[candidate.second]);
+		const float4x4& modelMatrix = gameObject->GetComponent<ComponentTransform>()->GetGlobalMatrix();
+		FrameVector<ComponentMesh*> meshes = gameObject->GetComponents<ComponentMesh>();
+		for (ComponentMesh* mesh : meshes) {
+			const Mesh* occluder = mesh->GetMesh();
+			if (!mesh->IsActive() || occluder == nullptr || occluder->occluderIndices.empty()) continue;
+
+			occlusionBuffer.AddOccluder(occluder->occluderVertices.data(), occluder->occluderIndices.data(), (unsigned) occluder->occluderIndices.size(), modelMatrix);
+		}
+		isOccluder[candidate.second] = true;
+	}
+	occlusionBuffer.Rasterize();
+	numOccluders = (unsigned) occluderCandidates.size();
+
+	// Occluders are always drawn: their boxes are as close as their own surface
+	unsigned numVisible = 0;
+	for (unsigned i = 0; i < visibleGameObjects.size(); ++i) {
+		GameObject* gameObject = App->scene->gameObjects.Get(visibleGameObjects[i]);
+		if (!isOccluder[i] && occlusionBuffer.IsOccluded(gameObject->GetComponent<ComponentBoundingBox>()->GetWorldAABB())) {
+			numOccludedGameObjects += 1;
+			continue;
+		}
+		visibleGameObjects[numVisible++] = visibleGameObjects[i];
+	}
+	visibleGameObjects.resize(numVisible);
+}
+
 void ModuleRender::DrawGameObject(GameObject* gameObject) {
+	if (App->headless) {
+		RecordDrawPackets(gameObject);
+		return;
+	}
+
+	ArenaScope arenaScope;
+
 	ComponentTransform* transform = gameObject->GetComponent<ComponentTransform>();
-	std::vector<ComponentMesh*> meshes = gameObject->GetComponents<ComponentMesh>();
-	std::vector<ComponentMaterial*> materials = gameObject->GetComponents<ComponentMaterial>();
+	FrameVector<ComponentMesh*> meshes = gameObject->GetComponents<ComponentMesh>();
+	FrameVector<ComponentMaterial*> materials = gameObject->GetComponents<ComponentMaterial>();
 	ComponentBoundingBox* boundingBox = gameObject->GetComponent<ComponentBoundingBox>();
 
 	if (boundingBox && drawAllBoundingBoxes) {
@@ -348,7 +468,46 @@ void ModuleRender::DrawGameObject(GameObject* gameObject) {
 	}
 
 	for (ComponentMesh* mesh : meshes) {
-		mesh->Draw(materials, transform->GetGlobalMatrix());
+		if (boundingBox) mesh->SelectLod(boundingBox->GetWorldAABB());
+		mesh->Draw(materials, transform->GetRenderMatrix());
+	}
+}
+
+void ModuleRender::RecordDrawPackets(GameObject* gameObject) {
+	ArenaScope arenaScope;
+
+	ComponentTransform* transform = gameObject->GetComponent<ComponentTransform>();
+	FrameVector<ComponentMesh*> meshes = gameObject->GetComponents<ComponentMesh>();
+	FrameVector<ComponentMaterial*> materials = gameObject->GetComponents<ComponentMaterial>();
+	ComponentBoundingBox* boundingBox = gameObject->GetComponent<ComponentBoundingBox>();
+
+	// Same work as ComponentMesh::Draw, without the OpenGL calls
+	for (ComponentMesh* mesh : meshes) {
+		const Mesh* meshResource = mesh->GetMesh();
+		if (!mesh->IsActive() || meshResource == nullptr) continue;
+
+		if (boundingBox) mesh->SelectLod(boundingBox->GetWorldAABB());
+
+		DrawPacket packet;
+		packet.gameObject = gameObject;
+		packet.mesh = meshResource;
+		packet.modelMatrix = transform->GetRenderMatrix();
+		packet.lod = Min(mesh->lod, meshResource->numLods - 1);
+		packet.numTriangles = meshResource->lodNumIndices[packet.lod] / 3;
+
+		unsigned materialIndex = mesh->materialIndex;
+		if (materials.size() > materialIndex && materials[materialIndex]->material.materialType == ShaderType::PHONG) {
+			ComponentLight* directionalLight = nullptr;
+			FrameVector<ComponentLight*> pointLights;
+			FrameVector<ComponentLight*> spotLights;
+			mesh->GatherLights(directionalLight, pointLights, spotLights);
+
+			packet.numPointLights = (unsigned) pointLights.size();
+			packet.numSpotLights = (unsigned) spotLights.size();
+			packet.directionalLight = directionalLight != nullptr;
+		}
+
+		drawPackets.push_back(packet);
 	}
 }
 
@@ -2,11 +2,29 @@
 
 #include "Module.h"
 #include "Utils/Quadtree.h"
+#include "Utils/OcclusionBuffer.h"
 
 #include "MathGeoLibFwd.h"
 #include "Math/float3.h"
+#include "Math/float4x4.h"
+
+#include <vector>
+#include <utility>
 
 class GameObject;
+class Mesh;
+
+// A draw recorded by the null backend instead of being submitted to OpenGL
+struct DrawPacket {
+	const GameObject* gameObject = nullptr;
+	const Mesh* mesh = nullptr;
+	float4x4 modelMatrix = float4x4::identity;
+	unsigned numPointLights = 0;
+	unsigned numSpotLights = 0;
+	bool directionalLight = false;
+	unsigned lod = 0;
+	unsigned numTriangles = 0;
+};
 
 class ModuleRender : public Module {
 public:
@@ -36,10 +54,31 @@ public:
 	bool skyboxActive = true;
 	float3 ambientColor = {0.0f, 0.0f, 0.0f};
 
+	// Levels of detail are picked so that the simplification error stays below this many pixels
+	bool lodEnabled = true;
+	float lodMaxErrorPixels = 1.0f;
+
+	// The largest visible objects are rasterized on the CPU, and the objects behind them aren't drawn
+	bool occlusionCulling = true;
+	unsigned numOccluders = 0; // Last frame
+	unsigned numOccludedGameObjects = 0; // Last frame
+
+	unsigned long long sceneDrawHeapAllocations = 0; // Heap allocations while drawing the scene in the last frame. Only counted in debug builds.
+
+	std::vector<DrawPacket> drawPackets; // Draws of the last frame. Only recorded by the null backend (headless applications).
+
 private:
-	void DrawQuadtreeRecursive(const Quadtree<GameObject>::Node& node, const AABB2D& aabb);
-	void DrawSceneRecursive(const Quadtree<GameObject>::Node& node, const AABB2D& aabb);
+	void DrawQuadtreeRecursive(const Quadtree<PoolHandle<GameObject>>::Node& node, const AABB2D& aabb);
+	void CullSceneRecursive(const Quadtree<PoolHandle<GameObject>>::Node& node, const AABB2D& aabb);
 	bool CheckIfInsideFrustum(const AABB& aabb, const OBB& obb);
+	void CullOccludedGameObjects();
 	void DrawGameObject(GameObject* gameObject);
+	void RecordDrawPackets(GameObject* gameObject);
 	void DrawSkyBox();
+
+private:
+	std::vector<PoolHandle<GameObject>> visibleGameObjects; // Inside the frustum
+	std::vector<std::pair<float, unsigned>> occluderCandidates; // Screen size and index in visibleGameObjects
+	std::vector<bool> isOccluder;
+	OcclusionBuffer occlusionBuffer;
 };
@@ -3,10 +3,14 @@
 #include "Globals.h"
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/Profiling.h"
+#include "FileSystem/ImportDatabase.h"
 #include "FileSystem/MeshImporter.h"
 #include "FileSystem/TextureImporter.h"
+#include "FileSystem/SceneImporter.h"
 #include "Modules/ModuleFiles.h"
 
+#include "assimp/cimport.h"
 #include "IL/il.h"
 #include "IL/ilu.h"
 #include "GL/glew.h"
@@ -14,10 +18,70 @@
 
 #include "Utils/Leaks.h"
 
+// Filtering and wrapping of the texture bound to GL_TEXTURE_2D
+static void SetBoundTextureMinFilter(TextureMinFilter filter) {
+	switch (filter) {
+	case TextureMinFilter::NEAREST:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		break;
+	case TextureMinFilter::LINEAR:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		break;
+	case TextureMinFilter::NEAREST_MIPMAP_NEAREST:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		break;
+	case TextureMinFilter::LINEAR_MIPMAP_NEAREST:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+		break;
+	case TextureMinFilter::NEAREST_MIPMAP_LINEAR:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+		break;
+	case TextureMinFilter::LINEAR_MIPMAP_LINEAR:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		break;
+	}
+}
+
+static void SetBoundTextureMagFilter(TextureMagFilter filter) {
+	switch (filter) {
+	case TextureMagFilter::NEAREST:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		break;
+	case TextureMagFilter::LINEAR:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		break;
+	}
+}
+
+static void SetBoundTextureWrap(TextureWrap wrap) {
+	switch (wrap) {
+	case TextureWrap::REPEAT:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		break;
+	case TextureWrap::CLAMP_TO_EDGE:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		break;
+	case TextureWrap::CLAMP_TO_BORDER:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		break;
+	case TextureWrap::MIRROR_REPEAT:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+		break;
+	case TextureWrap::MIRROR_CLAMP_TO_EDGE:
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRROR_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRROR_CLAMP_TO_EDGE);
+		break;
+	}
+}
+
 bool ModuleResources::Init() {
-	textures.Allocate(100);
-	cubeMaps.Allocate(10);
-	meshes.Allocate(1000);
+	textures.AllocatePaged(TEXTURES_PAGE_SIZE, TEXTURES_MAX_CAPACITY);
+	cubeMaps.AllocatePaged(CUBEMAPS_PAGE_SIZE, CUBEMAPS_MAX_CAPACITY);
+	meshes.AllocatePaged(MESHES_PAGE_SIZE, MESHES_MAX_CAPACITY);
 
 	ilInit();
 	iluInit();
@@ -25,18 +89,68 @@ bool ModuleResources::Init() {
 	return true;
 }
 
+bool ModuleResources::Start() {
+	ImportDatabase::Load();
+
+	return true;
+}
+
+UpdateStatus ModuleResources::Update() {
+	PROFILE_ZONE("ModuleResources - Update", ProfilerColor::Orange)
+
+	// Hot reimport: only the changed sources are imported again, and their live resources are updated in place
+	for (const std::string& filePath : App->files->GetChangedFiles()) {
+		if (ImportDatabase::GetArtifactPaths(filePath.c_str()) == nullptr) continue;
+
+		std::string extension = App->files->GetFileExtension(filePath.c_str());
+		if (aiIsExtensionSupported(extension.c_str())) {
+			SceneImporter::ReimportMeshes(filePath.c_str());
+		} else {
+			TextureImporter::ReimportTexture(filePath.c_str());
+		}
+	}
+
+	return UpdateStatus::CONTINUE;
+}
+
 bool ModuleResources::CleanUp() {
+	ImportDatabase::Save();
 	ReleaseAll();
 
 	return true;
 }
 
-Texture* ModuleResources::ObtainTexture() {
-	return textures.Obtain();
+bool ModuleResources::InitOnWorker() const {
+	return true;
+}
+
+bool ModuleResources::StartOnWorker() const {
+	return true;
+}
+
+Texture* ModuleResources::ObtainTextureWithFileName(InternedString fileName) {
+	Texture* texture = FindTexture(fileName);
+	if (texture != nullptr) return texture;
+
+	texture = textures.Obtain();
+	SetTextureFileName(texture, fileName);
+	return texture;
+}
+
+Texture* ModuleResources::FindTexture(InternedString fileName) const {
+	PoolHandle<Texture>* handle = texturesByFileName.Find(fileName.Id());
+	return handle != nullptr ? textures.Get(*handle) : nullptr;
+}
+
+void ModuleResources::SetTextureFileName(Texture* texture, InternedString fileName) {
+	if (FindTexture(texture->fileName) == texture) texturesByFileName.Erase(texture->fileName.Id());
+	texture->fileName = fileName;
+	if (!fileName.empty()) texturesByFileName[fileName.Id()] = textures.GetHandle(texture);
 }
 
 void ModuleResources::ReleaseTexture(Texture* texture) {
 	TextureImporter::UnloadTexture(texture);
+	SetTextureFileName(texture, InternedString());
 	textures.Release(texture);
 }
 
@@ -49,12 +163,29 @@ void ModuleResources::ReleaseCubeMap(CubeMap* cubeMap) {
 	cubeMaps.Release(cubeMap);
 }
 
-Mesh* ModuleResources::ObtainMesh() {
-	return meshes.Obtain();
+Mesh* ModuleResources::ObtainMeshWithFileName(InternedString fileName) {
+	Mesh* mesh = FindMesh(fileName);
+	if (mesh != nullptr) return mesh;
+
+	mesh = meshes.Obtain();
+	SetMeshFileName(mesh, fileName);
+	return mesh;
+}
+
+Mesh* ModuleResources::FindMesh(InternedString fileName) const {
+	PoolHandle<Mesh>* handle = meshesByFileName.Find(fileName.Id());
+	return handle != nullptr ? meshes.Get(*handle) : nullptr;
+}
+
+void ModuleResources::SetMeshFileName(Mesh* mesh, InternedString fileName) {
+	if (FindMesh(mesh->fileName) == mesh) meshesByFileName.Erase(mesh->fileName.Id());
+	mesh->fileName = fileName;
+	if (!fileName.empty()) meshesByFileName[fileName.Id()] = meshes.GetHandle(mesh);
 }
 
 void ModuleResources::ReleaseMesh(Mesh* mesh) {
 	MeshImporter::UnloadMesh(mesh);
+	SetMeshFileName(mesh, InternedString());
 	meshes.Release(mesh);
 }
 
@@ -75,26 +206,7 @@ void ModuleResources::ReleaseAll() {
 void ModuleResources::SetMinFilter(TextureMinFilter filter) {
 	for (Texture& texture : textures) {
 		glBindTexture(GL_TEXTURE_2D, texture.glTexture);
-		switch (filter) {
-		case TextureMinFilter::NEAREST:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-			break;
-		case TextureMinFilter::LINEAR:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-			break;
-		case TextureMinFilter::NEAREST_MIPMAP_NEAREST:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-			break;
-		case TextureMinFilter::LINEAR_MIPMAP_NEAREST:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
-			break;
-		case TextureMinFilter::NEAREST_MIPMAP_LINEAR:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
-			break;
-		case TextureMinFilter::LINEAR_MIPMAP_LINEAR:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-			break;
-		}
+		SetBoundTextureMinFilter(filter);
 	}
 
 	minFilter = filter;
@@ -103,14 +215,7 @@ void ModuleResources::SetMinFilter(TextureMinFilter filter) {
 void ModuleResources::SetMagFilter(TextureMagFilter filter) {
 	for (Texture& texture : textures) {
 		glBindTexture(GL_TEXTURE_2D, texture.glTexture);
-		switch (filter) {
-		case TextureMagFilter::NEAREST:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-			break;
-		case TextureMagFilter::LINEAR:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-			break;
-		}
+		SetBoundTextureMagFilter(filter);
 	}
 
 	magFilter = filter;
@@ -119,33 +224,19 @@ void ModuleResources::SetMagFilter(TextureMagFilter filter) {
 void ModuleResources::SetWrap(TextureWrap wrap) {
 	for (Texture& texture : textures) {
 		glBindTexture(GL_TEXTURE_2D, texture.glTexture);
-		switch (wrap) {
-		case TextureWrap::REPEAT:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-			break;
-		case TextureWrap::CLAMP_TO_EDGE:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-			break;
-		case TextureWrap::CLAMP_TO_BORDER:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-			break;
-		case TextureWrap::MIRROR_REPEAT:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
-			break;
-		case TextureWrap::MIRROR_CLAMP_TO_EDGE:
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_MIRROR_CLAMP_TO_EDGE);
-			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_MIRROR_CLAMP_TO_EDGE);
-			break;
-		}
+		SetBoundTextureWrap(wrap);
 	}
 
 	textureWrap = wrap;
 }
 
+void ModuleResources::SetTextureParameters(Texture* texture) const {
+	glBindTexture(GL_TEXTURE_2D, texture->glTexture);
+	SetBoundTextureMinFilter(minFilter);
+	SetBoundTextureMagFilter(magFilter);
+	SetBoundTextureWrap(textureWrap);
+}
+
 TextureMinFilter ModuleResources::GetMinFilter() const {
 	return minFilter;
 }
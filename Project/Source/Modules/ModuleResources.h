@@ -2,6 +2,7 @@
 
 #include "Module.h"
 #include "Utils/Pool.h"
+#include "Utils/FlatHashMap.h"
 #include "Resources/Texture.h"
 #include "Resources/CubeMap.h"
 #include "Resources/Mesh.h"
@@ -31,15 +32,26 @@ enum class TextureWrap {
 class ModuleResources : public Module {
 public:
 	bool Init() override;
+	bool Start() override;
+	UpdateStatus Update() override;
 	bool CleanUp() override;
 
-	Texture* ObtainTexture();
+	bool InitOnWorker() const override;
+	bool StartOnWorker() const override;
+
+	// Textures and meshes are unique per file name. The Find functions return nullptr if there's none with the name,
+	// and ObtainWithFileName returns the existing one or a new one. File names must be changed with SetFileName to keep them unique.
+	Texture* ObtainTextureWithFileName(InternedString fileName);
+	Texture* FindTexture(InternedString fileName) const;
+	void SetTextureFileName(Texture* texture, InternedString fileName);
 	void ReleaseTexture(Texture* texture);
 
 	CubeMap* ObtainCubeMap();
 	void ReleaseCubeMap(CubeMap* cubeMap);
 
-	Mesh* ObtainMesh();
+	Mesh* ObtainMeshWithFileName(InternedString fileName);
+	Mesh* FindMesh(InternedString fileName) const;
+	void SetMeshFileName(Mesh* mesh, InternedString fileName);
 	void ReleaseMesh(Mesh* mesh);
 
 	void ReleaseAll();
@@ -47,6 +59,7 @@ public:
 	void SetMinFilter(TextureMinFilter filter);
 	void SetMagFilter(TextureMagFilter filter);
 	void SetWrap(TextureWrap wrap);
+	void SetTextureParameters(Texture* texture) const; // Only this texture, so it doesn't read the pool while a worker may be changing it
 
 	TextureMinFilter GetMinFilter() const;
 	TextureMagFilter GetMagFilter() const;
@@ -58,6 +71,10 @@ public:
 	Pool<Mesh> meshes;
 
 private:
+	// Indexed by the id of the interned file name
+	FlatHashMap<PoolHandle<Texture>> texturesByFileName;
+	FlatHashMap<PoolHandle<Mesh>> meshesByFileName;
+
 	TextureMinFilter minFilter = TextureMinFilter::NEAREST_MIPMAP_LINEAR;
 	TextureMagFilter magFilter = TextureMagFilter::LINEAR;
 	TextureWrap textureWrap = TextureWrap::REPEAT;
@@ -3,8 +3,10 @@
 #include "Globals.h"
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/Profiling.h"
 #include "FileSystem/SceneImporter.h"
 #include "FileSystem/TextureImporter.h"
+#include "FileSystem/ImportDatabase.h"
 #include "FileSystem/JsonValue.h"
 #include "Resources/Texture.h"
 #include "Resources/CubeMap.h"
@@ -21,6 +23,7 @@
 #include "Modules/ModuleResources.h"
 #include "Modules/ModuleFiles.h"
 #include "Modules/ModuleEditor.h"
+#include "Modules/ModuleTime.h"
 #include "Panels/PanelHierarchy.h"
 
 #include "GL/glew.h"
@@ -36,7 +39,6 @@
 #include "rapidjson/reader.h"
 #include "rapidjson/error/en.h"
 #include <string>
-#include "Brofiler.h"
 
 #include "Utils/Leaks.h"
 
@@ -49,7 +51,7 @@ static void AssimpLogCallback(const char* message, char* user) {
 }
 
 bool ModuleScene::Init() {
-	gameObjects.Allocate(10000);
+	gameObjects.AllocatePaged(GAMEOBJECTS_PAGE_SIZE, GAMEOBJECTS_MAX_CAPACITY, true);
 
 #ifdef _DEBUG
 	logStream.callback = AssimpLogCallback;
@@ -64,14 +66,18 @@ bool ModuleScene::Start() {
 	App->files->CreateFolder(TEXTURES_PATH);
 	App->files->CreateFolder(MESHES_PATH);
 	App->files->CreateFolder(SCENES_PATH);
+	App->files->CreateFolder(PREFABS_PATH);
 
 	CreateEmptyScene();
 
+	// Headless runs load their own scene
+	if (App->headless) return true;
+
 	SceneImporter::LoadScene("survival_shooter");
 
 	// Load skybox
 	// clang-format off
-	float skyboxVertices[] = {
+	static const float skyboxVertices[] = {
 		// Front (x, y, z)
 		-1.0f,  1.0f, -1.0f,
 		-1.0f, -1.0f, -1.0f,
@@ -121,15 +127,17 @@ bool ModuleScene::Start() {
 		 1.0f, -1.0f,  1.0f
 	}; // clang-format on
 
-	// Skybox VAO
-	glGenVertexArrays(1, &skyboxVao);
-	glGenBuffers(1, &skyboxVbo);
-	glBindVertexArray(skyboxVao);
-	glBindBuffer(GL_ARRAY_BUFFER, skyboxVbo);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*) 0);
-	glBindVertexArray(0);
+	// Skybox VAO. Start runs on a worker thread, GL work goes to the main thread.
+	App->RunOnMainThread([this]() {
+		glGenVertexArrays(1, &skyboxVao);
+		glGenBuffers(1, &skyboxVbo);
+		glBindVertexArray(skyboxVao);
+		glBindBuffer(GL_ARRAY_BUFFER, skyboxVbo);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(skyboxVertices), &skyboxVertices, GL_STATIC_DRAW);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*) 0);
+		glBindVertexArray(0);
+	});
 
 	skyboxCubeMap = App->resources->ObtainCubeMap();
 	skyboxCubeMap->fileNames[0] = "right";
@@ -144,31 +152,48 @@ bool ModuleScene::Start() {
 }
 
 UpdateStatus ModuleScene::Update() {
-	BROFILER_CATEGORY("ModuleScene - Update", Profiler::Color::Green)
+	PROFILE_ZONE("ModuleScene - Update", ProfilerColor::Green)
 
 	// Load scene/fbx if one gets dropped
-	const char* droppedFilePath = App->input->GetDroppedFilePath();
+	const char* droppedFilePath = App->input != nullptr ? App->input->GetDroppedFilePath() : nullptr;
 	if (droppedFilePath != nullptr) {
 		std::string droppedFileExtension = App->files->GetFileExtension(droppedFilePath);
 		std::string droppedFileName = App->files->GetFileName(droppedFilePath);
 		if (droppedFileExtension == SCENE_EXTENSION) {
 			SceneImporter::LoadScene(droppedFileName.c_str());
 
-			LOG("Scene loaded");
+			LOG_INFO(LogCategory::SCENE, "Scene loaded");
 		} else if (droppedFileExtension == ".fbx") {
 			SceneImporter::ImportScene(droppedFilePath, root);
 
-			LOG("Scene imported");
+			LOG_INFO(LogCategory::SCENE, "Scene imported");
 		} else if (droppedFileExtension == ".png" || droppedFileExtension == ".tif" || droppedFileExtension == ".dds") {
 			Texture* texture = TextureImporter::ImportTexture(droppedFilePath);
 			TextureImporter::LoadTexture(texture);
 
-			LOG("Texture imported");
+			LOG_INFO(LogCategory::SCENE, "Texture imported");
 		}
 
+		ImportDatabase::Save();
+
 		App->input->ReleaseDroppedFilePath();
 	}
 
+	// Simulate fixed steps
+	unsigned numFixedSteps = App->time->GetNumFixedSteps();
+	simulatingFixedStep = true;
+	for (unsigned step = 0; step < numFixedSteps; ++step) {
+		for (GameObject& gameObject : gameObjects) {
+			ComponentTransform* transform = gameObject.GetComponent<ComponentTransform>();
+			if (transform != nullptr) transform->SaveFixedStepState();
+		}
+
+		for (GameObject& gameObject : gameObjects) {
+			gameObject.FixedUpdate();
+		}
+	}
+	simulatingFixedStep = false;
+
 	// Update GameObjects
 	for (GameObject& gameObject : gameObjects) {
 		gameObject.Update();
@@ -178,8 +203,8 @@ UpdateStatus ModuleScene::Update() {
 }
 
 bool ModuleScene::CleanUp() {
-	glDeleteVertexArrays(1, &skyboxVao);
-	glDeleteBuffers(1, &skyboxVbo);
+	if (skyboxVao) glDeleteVertexArrays(1, &skyboxVao);
+	if (skyboxVbo) glDeleteBuffers(1, &skyboxVbo);
 
 	ClearScene();
 
@@ -190,6 +215,14 @@ bool ModuleScene::CleanUp() {
 	return true;
 }
 
+bool ModuleScene::InitOnWorker() const {
+	return true;
+}
+
+bool ModuleScene::StartOnWorker() const {
+	return true;
+}
+
 void ModuleScene::CreateEmptyScene() {
 	ClearScene();
 
@@ -240,7 +273,7 @@ void ModuleScene::RebuildQuadtree() {
 
 		boundingBox->CalculateWorldBoundingBox();
 		const AABB& worldAABB = boundingBox->GetWorldAABB();
-		quadtree.Add(&gameObject, AABB2D(worldAABB.minPoint.xz(), worldAABB.maxPoint.xz()));
+		quadtree.Add(gameObjects.GetHandle(&gameObject), AABB2D(worldAABB.minPoint.xz(), worldAABB.maxPoint.xz()));
 		gameObject.isInQuadtree = true;
 	}
 	quadtree.Optimize();
@@ -277,10 +310,10 @@ void ModuleScene::DestroyGameObject(GameObject* gameObject) {
 	}
 
 	if (gameObject->isInQuadtree) {
-		quadtree.Remove(gameObject);
+		quadtree.Remove(gameObjects.GetHandle(gameObject));
 	}
 
-	gameObjectsIdMap.erase(gameObject->GetID());
+	gameObjectsIdMap.Erase(gameObject->GetID());
 	gameObject->id = 0;
 	for (Component* component : gameObject->components) {
 		delete component;
@@ -292,7 +325,6 @@ void ModuleScene::DestroyGameObject(GameObject* gameObject) {
 }
 
 GameObject* ModuleScene::GetGameObject(UID id) const {
-	if (gameObjectsIdMap.count(id) == 0) return nullptr;
-
-	return gameObjectsIdMap.at(id);
+	GameObject** gameObject = gameObjectsIdMap.Find(id);
+	return gameObject != nullptr ? *gameObject : nullptr;
 }
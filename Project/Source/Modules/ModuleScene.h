@@ -4,9 +4,9 @@
 #include "Resources/GameObject.h"
 #include "Utils/UID.h"
 #include "Utils/Pool.h"
+#include "Utils/FlatHashMap.h"
 #include "Utils/Quadtree.h"
 
-#include <unordered_map>
 #include <string>
 
 class CubeMap;
@@ -20,6 +20,9 @@ public:
 	UpdateStatus Update() override;
 	bool CleanUp() override;
 
+	bool InitOnWorker() const override;
+	bool StartOnWorker() const override;
+
 	void CreateEmptyScene();
 	void ClearScene();
 	void RebuildQuadtree();
@@ -35,10 +38,12 @@ public:
 	GameObject* root = nullptr;
 
 	Pool<GameObject> gameObjects;
-	std::unordered_map<UID, GameObject*> gameObjectsIdMap;
+	FlatHashMap<GameObject*> gameObjectsIdMap;
+	bool simulatingFixedStep = false; // Transform changes made during fixed steps are interpolated when rendering
+	unsigned hierarchyVersion = 0; // Changes when GameObjects are created, destroyed, reparented or renamed. Used to cache editor views.
 
 	// Quadtree
-	Quadtree<GameObject> quadtree;
+	Quadtree<PoolHandle<GameObject>> quadtree; // Handles, so that elements of destroyed GameObjects are never accessed
 	AABB2D quadtreeBounds = {{-1000, -1000}, {1000, 1000}};
 	unsigned quadtreeMaxDepth = 4;
 	unsigned quadtreeElementsPerNode = 200;
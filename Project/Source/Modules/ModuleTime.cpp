@@ -3,73 +3,119 @@
 #include "Globals.h"
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/Profiling.h"
+#include "Utils/MSTimer.h"
 #include "FileSystem/SceneImporter.h"
 #include "Modules/ModuleScene.h"
-#include "Modules/ModuleFiles.h"
 
 #include "SDL_timer.h"
-#include "Brofiler.h"
+#include <emmintrin.h>
+#include <math.h>
 
 #include "Utils/Leaks.h"
 
-#define TEMP_SCENE_FILE_NAME "_scene_snapshot.temp"
+#define SLEEP_STATISTICS_MAX_SAMPLES 100 // Older sleeps are forgotten, so the estimate follows changes in the scheduler
 
 ModuleTime::ModuleTime() {
-	timer.Start();
+	realTimeLastNs = ProfilerNowNs();
 }
 
 UpdateStatus ModuleTime::PreUpdate() {
-	BROFILER_CATEGORY("ModuleTime - PreUpdate", Profiler::Color::Black)
+	PROFILE_ZONE("ModuleTime - PreUpdate", ProfilerColor::Black)
 
 	frameCount += 1;
 
-	unsigned int realTime = timer.Read();
-	realTimeDeltaMs = realTime - realTimeLastMs;
-	realTimeLastMs = realTime;
+	unsigned long long realTime = ProfilerNowNs();
+	realTimeDeltaNs = realTime - realTimeLastNs;
+	realTimeLastNs = realTime;
 
 	if (gameRunning) {
-		timeDeltaMs = lroundf(realTimeDeltaMs * timeScale);
-		timeLastMs += timeDeltaMs;
+		timeDeltaNs = (unsigned long long) (realTimeDeltaNs * (double) timeScale);
+		timeLastNs += timeDeltaNs;
 	} else if (gameStepOnce) {
-		timeDeltaMs = stepDeltaTimeMs;
-		timeLastMs += timeDeltaMs;
+		timeDeltaNs = stepDeltaTimeMs * 1000000ull;
+		timeLastNs += timeDeltaNs;
 
 		gameStepOnce = false;
 	} else {
-		timeDeltaMs = 0;
+		timeDeltaNs = 0;
 	}
 
-	LogDeltaMS((float) realTimeDeltaMs);
+	// Split game time in fixed steps. The remainder is carried to the next frame.
+	unsigned long long fixedStepNs = 1000000000ull / fixedStepsPerSecond;
+	fixedAccumulatorNs += timeDeltaNs;
+	unsigned long long steps = fixedAccumulatorNs / fixedStepNs;
+	fixedAccumulatorNs -= steps * fixedStepNs;
+	numFixedSteps = (unsigned) std::min(steps, (unsigned long long) maxFixedStepsPerFrame);
+	fixedStepAlpha = (float) fixedAccumulatorNs / fixedStepNs;
+
+	LogDeltaMS(realTimeDeltaNs / 1000000.0f);
 
 	return UpdateStatus::CONTINUE;
 }
 
 void ModuleTime::WaitForEndOfFrame() {
-	BROFILER_CATEGORY("ModuleTime - WaitForEndOfFrame", Profiler::Color::Black)
-	if (limitFramerate) {
-		unsigned int realTimeMs = timer.Read();
-		unsigned int frameMs = realTimeMs - realTimeLastMs;
-		unsigned int minMs = 1000 / maxFps;
-		if (frameMs < minMs) {
-			SDL_Delay(minMs - frameMs);
-		}
+	PROFILE_ZONE("ModuleTime - WaitForEndOfFrame", ProfilerColor::Black)
+	if (!limitFramerate) {
+		frameEndNs = 0;
+		return;
+	}
+
+	unsigned long long frameNs = 1000000000ull / maxFps;
+	unsigned long long now = ProfilerNowNs();
+	unsigned long long targetNs = frameEndNs + frameNs;
+	if (frameEndNs == 0 || now >= targetNs + frameNs) {
+		// More than a frame late (or the first limited frame): start a new schedule instead of rushing to catch up
+		frameEndNs = now;
+		return;
+	}
+
+	if (now < targetNs) {
+		WaitUntil(targetNs);
+	}
+	frameEndNs = targetNs;
+}
+
+void ModuleTime::WaitUntil(unsigned long long targetNs) {
+	// Sleep in 1ms steps while there's enough time left for a sleep that oversleeps
+	unsigned long long now = ProfilerNowNs();
+	while (now < targetNs && targetNs - now > sleepEstimateNs) {
+		SDL_Delay(1);
+		unsigned long long sleptNs = ProfilerNowNs() - now;
+		now += sleptNs;
+
+		// Running mean and variance of the sleep duration
+		if (sleepCount < SLEEP_STATISTICS_MAX_SAMPLES) sleepCount += 1;
+		double delta = sleptNs - sleepMeanNs;
+		sleepMeanNs += delta / sleepCount;
+		sleepVariance += (delta * (sleptNs - sleepMeanNs) - sleepVariance) / sleepCount;
+		sleepEstimateNs = sleepMeanNs + sqrt(std::max(0.0, sleepVariance));
+	}
+
+	// Spin for the rest
+	while (ProfilerNowNs() < targetNs) {
+		_mm_pause();
 	}
 }
 
 float ModuleTime::GetDeltaTime() const {
-	return timeDeltaMs / 1000.0f;
+	return timeDeltaNs / 1000000000.0f;
+}
+
+float ModuleTime::GetFixedDeltaTime() const {
+	return 1.0f / fixedStepsPerSecond;
 }
 
 float ModuleTime::GetRealTimeDeltaTime() const {
-	return realTimeDeltaMs / 1000.0f;
+	return realTimeDeltaNs / 1000000000.0f;
 }
 
 float ModuleTime::GetTimeSinceStartup() const {
-	return timeLastMs / 1000.0f;
+	return timeLastNs / 1000000000.0f;
 }
 
 float ModuleTime::GetRealTimeSinceStartup() const {
-	return realTimeLastMs / 1000.0f;
+	return realTimeLastNs / 1000000000.0f;
 }
 
 float ModuleTime::GetTimeScale() const {
@@ -91,7 +137,13 @@ bool ModuleTime::IsGameRunning() const {
 void ModuleTime::StartGame() {
 	if (gameStarted) return;
 
-	SceneImporter::SaveScene(TEMP_SCENE_FILE_NAME);
+	// The snapshot buffer keeps its memory between plays
+	MSTimer snapshotTimer;
+	snapshotTimer.Start();
+	sceneSnapshot.Clear();
+	SceneImporter::SaveSceneToBuffer(sceneSnapshot);
+	sceneSnapshotStructure = SceneImporter::HashSceneStructure();
+	LOG_INFO(LogCategory::SCENE, "Scene snapshot taken in %ums (%u bytes).", snapshotTimer.Stop(), (unsigned) sceneSnapshot.Size());
 
 	gameStarted = true;
 	gameRunning = true;
@@ -100,14 +152,26 @@ void ModuleTime::StartGame() {
 void ModuleTime::StopGame() {
 	if (!gameStarted) return;
 
-	SceneImporter::LoadScene(TEMP_SCENE_FILE_NAME);
-	std::string tempSceneFilePath = std::string(SCENES_PATH) + "/" + TEMP_SCENE_FILE_NAME + SCENE_EXTENSION;
-	App->files->EraseFile(tempSceneFilePath.c_str());
+	// Restore in place unless GameObjects or components were added, removed or reparented while playing
+	MSTimer snapshotTimer;
+	snapshotTimer.Start();
+	bool restored = false;
+	if (SceneImporter::HashSceneStructure() == sceneSnapshotStructure) {
+		restored = SceneImporter::RestoreSceneFromBuffer(sceneSnapshot.Data(), sceneSnapshot.Size());
+	}
+	if (!restored) {
+		SceneImporter::LoadSceneFromBuffer(sceneSnapshot.Data(), sceneSnapshot.Size());
+	}
+	sceneSnapshot.Clear();
+	LOG_INFO(LogCategory::SCENE, "Scene snapshot %s in %ums.", restored ? "restored" : "reloaded", snapshotTimer.Stop());
 
 	gameStarted = false;
 	gameRunning = false;
 
-	timeLastMs = 0;
+	timeLastNs = 0;
+	fixedAccumulatorNs = 0;
+	numFixedSteps = 0;
+	fixedStepAlpha = 0.0f;
 }
 
 void ModuleTime::PauseGame() {
@@ -134,3 +198,11 @@ void ModuleTime::StepGame() {
 unsigned int ModuleTime::GetFrameCount() const {
 	return frameCount;
 }
+
+unsigned ModuleTime::GetNumFixedSteps() const {
+	return numFixedSteps;
+}
+
+float ModuleTime::GetFixedStepAlpha() const {
+	return fixedStepAlpha;
+}
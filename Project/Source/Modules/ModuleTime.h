@@ -1,7 +1,8 @@
 #pragma once
 
 #include "Module.h"
-#include "Utils/MSTimer.h"
+#include "Utils/Hash.h"
+#include "FileSystem/BinaryWriter.h"
 
 class ModuleTime : public Module {
 public:
@@ -12,6 +13,7 @@ public:
 	void WaitForEndOfFrame();
 
 	float GetDeltaTime() const;
+	float GetFixedDeltaTime() const;
 	float GetRealTimeDeltaTime() const;
 
 	float GetTimeSinceStartup() const;
@@ -31,25 +33,48 @@ public:
 
 	unsigned int GetFrameCount() const;
 
+	unsigned GetNumFixedSteps() const; // Fixed steps to simulate this frame
+	float GetFixedStepAlpha() const; // How far game time is between the last fixed step and the next one, in [0, 1). Used to interpolate render state.
+
+private:
+	void WaitUntil(unsigned long long targetNs);
+
 public:
 	int maxFps = 60;
 	bool limitFramerate = true;
 	bool vsync = true;
 	int stepDeltaTimeMs = 100;
+	int fixedStepsPerSecond = 50;
+	int maxFixedStepsPerFrame = 5; // Game time beyond this many steps is dropped, so that a slow frame can't make the next ones slower
 
 private:
-	MSTimer timer = MSTimer();
-
 	unsigned int frameCount = 0;
 
-	unsigned int realTimeDeltaMs = 0;
-	unsigned int realTimeLastMs = 0;
+	// Times are in nanoseconds
+	unsigned long long realTimeDeltaNs = 0;
+	unsigned long long realTimeLastNs = 0;
 
 	float timeScale = 1.0f;
-	unsigned int timeDeltaMs = 0;
-	unsigned int timeLastMs = 0;
+	unsigned long long timeDeltaNs = 0;
+	unsigned long long timeLastNs = 0;
+
+	// Fixed timestep
+	unsigned long long fixedAccumulatorNs = 0;
+	unsigned numFixedSteps = 0;
+	float fixedStepAlpha = 0.0f;
+
+	// Frame pacing
+	unsigned long long frameEndNs = 0; // Target end of the last frame. Frames are scheduled from it, not from when the wait finished, so errors don't add up.
+	double sleepEstimateNs = 2000000.0; // Pessimistic duration of a 1ms sleep (mean + standard deviation)
+	double sleepMeanNs = 1000000.0;
+	double sleepVariance = 0.0;
+	unsigned sleepCount = 1;
 
 	bool gameStarted = false;
 	bool gameRunning = false;
 	bool gameStepOnce = false;
+
+	// Scene state before the game started
+	BinaryWriter sceneSnapshot;
+	Hash sceneSnapshotStructure = 0;
 };
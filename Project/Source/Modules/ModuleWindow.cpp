@@ -12,7 +12,7 @@ bool ModuleWindow::Init() {
 	LOG("Init SDL window & surface");
 
 	if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-		LOG("SDL_VIDEO could not initialize! SDL_Error: %s\n", SDL_GetError());
+		LOG_CRITICAL(LogCategory::GENERAL, "SDL_VIDEO could not initialize! SDL_Error: %s\n", SDL_GetError());
 		return false;
 	}
 
@@ -30,7 +30,7 @@ bool ModuleWindow::Init() {
 	SDL_GetDesktopDisplayMode(0, &desktopDisplayMode);
 	window = SDL_CreateWindow(App->appName, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, desktopDisplayMode.w - 100, desktopDisplayMode.h - 100, flags);
 	if (window == NULL) {
-		LOG("Window could not be created! SDL_Error: %s\n", SDL_GetError());
+		LOG_CRITICAL(LogCategory::GENERAL, "Window could not be created! SDL_Error: %s\n", SDL_GetError());
 		return false;
 	}
 
@@ -2,6 +2,9 @@
 
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/FrameArena.h"
+#include "Utils/AllocationCounter.h"
+#include "Utils/InternedString.h"
 #include "Modules/ModuleEditor.h"
 #include "Modules/ModuleTime.h"
 #include "Modules/ModuleHardwareInfo.h"
@@ -17,6 +20,13 @@
 
 #include "Utils/Leaks.h"
 
+template<typename T>
+static void DrawPoolStats(const char* name, const Pool<T>& pool) {
+	ImGui::TextColored(App->editor->titleColor, "%s", name);
+	ImGui::Text("Count: %u / High-water: %u", (unsigned) pool.Count(), (unsigned) pool.HighWater());
+	ImGui::Text("Committed: %u (%u pages) / Max: %u", (unsigned) pool.CommittedCapacity(), pool.NumPages(), (unsigned) pool.Capacity());
+}
+
 PanelConfiguration::PanelConfiguration()
 	: Panel("Configuration", true) {}
 
@@ -40,6 +50,8 @@ void PanelConfiguration::Update() {
 				App->renderer->SetVSync(App->time->vsync);
 			}
 			ImGui::SliderInt("Step delta time (MS)", &App->time->stepDeltaTimeMs, 1, 1000);
+			ImGui::SliderInt("Fixed steps per second", &App->time->fixedStepsPerSecond, 1, 240);
+			ImGui::SliderInt("Max fixed steps per frame", &App->time->maxFixedStepsPerFrame, 1, 20);
 
 			// FPS Graph
 			char title[25];
@@ -49,6 +61,57 @@ void PanelConfiguration::Update() {
 			ImGui::PlotHistogram("##milliseconds", &msLog[0], FPS_LOG_SIZE, fpsLogIndex, title, 0.0f, 40.0f, ImVec2(310, 100));
 		}
 
+		// Frame timing
+		if (ImGui::CollapsingHeader("Frame Timing")) {
+			if (ImGui::Button("Export CSV")) {
+				if (App->frameStats.ExportCsv(FRAME_STATS_CSV_FILE_PATH)) {
+					LOG("Frame stats exported to \"%s\".", FRAME_STATS_CSV_FILE_PATH);
+				}
+			}
+			ImGui::SameLine();
+			if (ImGui::Button("Export JSON")) {
+				if (App->frameStats.ExportJson(FRAME_STATS_JSON_FILE_PATH)) {
+					LOG("Frame stats exported to \"%s\".", FRAME_STATS_JSON_FILE_PATH);
+				}
+			}
+			ImGui::SameLine();
+			if (ImGui::Button("Reset")) {
+				App->frameStats.Reset();
+			}
+			ImGui::Checkbox("Hide series under 0.01 ms", &hideFastTimingSeries);
+			ImGui::TextColored(App->editor->textColor, "Last %d seconds, in milliseconds", FRAME_STATS_WINDOW_SECONDS);
+
+			ImGui::Columns(5, "FrameTiming");
+			ImGui::SetColumnWidth(0, 220.0f);
+			ImGui::TextColored(App->editor->titleColor, "Series");
+			ImGui::NextColumn();
+			ImGui::TextColored(App->editor->titleColor, "p50");
+			ImGui::NextColumn();
+			ImGui::TextColored(App->editor->titleColor, "p95");
+			ImGui::NextColumn();
+			ImGui::TextColored(App->editor->titleColor, "p99");
+			ImGui::NextColumn();
+			ImGui::TextColored(App->editor->titleColor, "Max");
+			ImGui::NextColumn();
+			ImGui::Separator();
+			for (const TimingSeries* series : App->frameStats.GetSeries()) {
+				TimingStats stats = series->GetWindowStats();
+				if (stats.count == 0 || (hideFastTimingSeries && stats.maxNs < 10000)) continue;
+
+				ImGui::TextUnformatted(series->name.c_str());
+				ImGui::NextColumn();
+				ImGui::Text("%.3f", stats.p50Ns / 1000000.0);
+				ImGui::NextColumn();
+				ImGui::Text("%.3f", stats.p95Ns / 1000000.0);
+				ImGui::NextColumn();
+				ImGui::Text("%.3f", stats.p99Ns / 1000000.0);
+				ImGui::NextColumn();
+				ImGui::Text("%.3f", stats.maxNs / 1000000.0);
+				ImGui::NextColumn();
+			}
+			ImGui::Columns(1);
+		}
+
 		// Hardware
 		if (ImGui::CollapsingHeader("Hardware")) {
 			ImGui::Text("GLEW version:");
@@ -208,11 +271,45 @@ void PanelConfiguration::Update() {
 			}
 			ImGui::Separator();
 
+			ImGui::TextColored(App->editor->titleColor, "Level of Detail");
+			ImGui::Checkbox("Enabled", &App->renderer->lodEnabled);
+			ImGui::SliderFloat("Max Error (px)", &App->renderer->lodMaxErrorPixels, 0.1f, 10.0f);
+			ImGui::Separator();
+			ImGui::TextColored(App->editor->titleColor, "Occlusion Culling");
+			ImGui::Checkbox("Cull Occluded Objects", &App->renderer->occlusionCulling);
+			ImGui::Text("Occluders: %u", App->renderer->numOccluders);
+			ImGui::Text("Occluded objects: %u", App->renderer->numOccludedGameObjects);
+			ImGui::Separator();
+
 			ImGui::Checkbox("Skybox", &App->renderer->skyboxActive);
 			ImGui::ColorEdit3("Background", App->renderer->clearColor.ptr());
 			ImGui::ColorEdit3("Ambient Color", App->renderer->ambientColor.ptr());
 		}
 
+		// Pools
+		if (ImGui::CollapsingHeader("Pools")) {
+			DrawPoolStats("GameObjects", App->scene->gameObjects);
+			DrawPoolStats("Meshes", App->resources->meshes);
+			DrawPoolStats("Textures", App->resources->textures);
+			DrawPoolStats("CubeMaps", App->resources->cubeMaps);
+			ImGui::TextColored(App->editor->titleColor, "Interned strings");
+			ImGui::Text("Count: %u / Memory: %u KB", GetNumInternedStrings(), (unsigned) (GetInternedStringsMemory() / 1024));
+		}
+
+		// Frame memory
+		if (ImGui::CollapsingHeader("Frame Memory")) {
+			FrameArena& arena = FrameArena::Get();
+			ImGui::TextColored(App->editor->titleColor, "Frame arena (main thread)");
+			ImGui::Text("Used: %u KB / High-water: %u KB / Capacity: %u KB", (unsigned) (arena.Used() / 1024), (unsigned) (arena.HighWater() / 1024), (unsigned) (arena.Capacity() / 1024));
+			ImGui::Text("Block allocations: %llu", arena.NumHeapAllocations());
+			ImGui::TextColored(App->editor->titleColor, "Heap allocations per frame");
+			if (IsAllocationCounterAvailable()) {
+				ImGui::Text("Frame: %llu / Scene draw: %llu", App->frameHeapAllocations, App->renderer->sceneDrawHeapAllocations);
+			} else {
+				ImGui::TextUnformatted("Only counted in debug builds");
+			}
+		}
+
 		// Camera
 		if (ImGui::CollapsingHeader("Engine Camera")) {
 			Frustum& frustum = App->camera->GetEngineFrustum();
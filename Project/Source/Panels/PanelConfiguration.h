@@ -11,4 +11,5 @@ public:
 private:
 	int windowWidth = 0;
 	int windowHeight = 0;
+	bool hideFastTimingSeries = true;
 };
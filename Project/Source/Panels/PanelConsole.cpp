@@ -6,6 +6,7 @@
 
 #include "imgui.h"
 #include "IconsForkAwesome.h"
+#include <string.h>
 
 #include "Utils/Leaks.h"
 
@@ -20,10 +21,71 @@ void PanelConsole::Update() {
 	ImGui::SetNextWindowDockID(App->editor->dockDownId, ImGuiCond_FirstUseEver);
 	std::string windowName = std::string(ICON_FK_TERMINAL " ") + name;
 	if (ImGui::Begin(windowName.c_str(), &enabled)) {
-		// Output
+		// Filters
+		ImGui::Checkbox("Verbose", &showLevels[(int) LogLevel::VERBOSE]);
+		ImGui::SameLine();
+		ImGui::Checkbox("Info", &showLevels[(int) LogLevel::INFO]);
+		ImGui::SameLine();
+		ImGui::Checkbox("Warnings", &showLevels[(int) LogLevel::WARNING]);
+		ImGui::SameLine();
+		ImGui::Checkbox("Critical", &showLevels[(int) LogLevel::CRITICAL]);
+		for (unsigned i = 0; i < (unsigned) LogCategory::COUNT; ++i) {
+			if (i > 0) ImGui::SameLine();
+			ImGui::CheckboxFlags(GetLogCategoryName((LogCategory) i), &categoryMask, 1u << i);
+		}
+		unsigned long long numDropped = GetNumDroppedLogMessages();
+		if (numDropped > 0) {
+			ImGui::SameLine();
+			ImGui::TextColored(ImVec4(1.0f, 0.8f, 0.4f, 1.0f), "%llu messages dropped", numDropped);
+		}
+
+		// Output. Only the visible lines are drawn.
 		const float footerHeightToReserve = ImGui::GetStyle().ItemSpacing.y + ImGui::GetFrameHeightWithSpacing();
 		ImGui::BeginChild("ScrollingRegion", ImVec2(0, -footerHeightToReserve), false, ImGuiWindowFlags_HorizontalScrollbar);
-		ImGui::TextUnformattedWithColorMD(logString->c_str());
+		// Lines have a known height, so the clipper gives the range in view without drawing anything.
+		// Only that range is copied under the lock, so the drain thread and the logging threads don't wait for the draw.
+		ImGuiListClipper clipper;
+		drawnLines.clear();
+		{
+			std::lock_guard<std::mutex> lock(GetLogHistoryMutex());
+
+			unsigned historySize = GetLogHistorySize();
+			visibleLines.clear();
+			for (unsigned i = 0; i < historySize; ++i) {
+				const LogLine& line = GetLogHistoryLine(i);
+				if (showLevels[(int) line.level] && (categoryMask & (1u << (unsigned) line.category))) visibleLines.push_back(i);
+			}
+
+			clipper.Begin((int) visibleLines.size(), ImGui::GetTextLineHeightWithSpacing());
+			if (clipper.Step()) {
+				for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+					drawnLines.push_back(GetLogHistoryLine(visibleLines[i]));
+				}
+			}
+		}
+
+		for (const LogLine& line : drawnLines) {
+			const char* textEnd = line.text + strlen(line.text);
+			if (textEnd > line.text && textEnd[-1] == '\n') textEnd -= 1;
+
+			switch (line.level) {
+			case LogLevel::VERBOSE:
+				ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
+				break;
+			case LogLevel::WARNING:
+				ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.8f, 0.4f, 1.0f));
+				break;
+			case LogLevel::CRITICAL:
+				ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.4f, 0.4f, 1.0f));
+				break;
+			default:
+				ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetStyleColorVec4(ImGuiCol_Text));
+				break;
+			}
+			ImGui::TextUnformatted(line.text, textEnd);
+			ImGui::PopStyleColor();
+		}
+		clipper.End(); // Moves the cursor past the lines that weren't drawn
 		if (ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) {
 			ImGui::SetScrollHereY(1.0f);
 		}
@@ -36,9 +98,7 @@ void PanelConsole::Update() {
 		char inputBuf[256] = {0};
 		ImGuiInputTextFlags inputTextFlags = ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_CallbackCompletion | ImGuiInputTextFlags_CallbackHistory;
 		if (ImGui::InputText("Input", inputBuf, IM_ARRAYSIZE(inputBuf), inputTextFlags, &ExecuteCommand)) {
-			logString->append("$FFB86CFF # ");
-			logString->append(inputBuf);
-			logString->append("\n");
+			LOG("# %s", inputBuf);
 			reclaimFocus = true;
 		}
 		ImGui::SetItemDefaultFocus();
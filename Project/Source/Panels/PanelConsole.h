@@ -1,10 +1,21 @@
 #pragma once
 
 #include "Panel.h"
+#include "Utils/Logging.h"
+
+#include <vector>
 
 class PanelConsole : public Panel {
 public:
 	PanelConsole();
 
 	void Update() override;
+
+public:
+	bool showLevels[4] = {true, true, true, true}; // Indexed by LogLevel.
+	unsigned categoryMask = (1u << (unsigned) LogCategory::COUNT) - 1; // One bit per LogCategory.
+
+private:
+	std::vector<unsigned> visibleLines; // History indices of the lines that pass the filters.
+	std::vector<LogLine> drawnLines; // Copies of the lines in view, drawn after releasing the history lock.
 };
@@ -2,6 +2,7 @@
 
 #include "Application.h"
 #include "Utils/Logging.h"
+#include "Utils/FrameArena.h"
 #include "Resources/GameObject.h"
 #include "Components/ComponentTransform.h"
 #include "Modules/ModuleEditor.h"
@@ -9,9 +10,19 @@
 
 #include "imgui.h"
 #include "IconsFontAwesome5.h"
+#include <algorithm>
+#include <ctype.h>
 
 #include "Utils/Leaks.h"
 
+static std::string ToLowercase(const char* text) {
+	std::string lowercase = text;
+	for (char& c : lowercase) {
+		c = (char) tolower((unsigned char) c);
+	}
+	return lowercase;
+}
+
 PanelHierarchy::PanelHierarchy()
 	: Panel("Hierarchy", true) {}
 
@@ -19,35 +30,136 @@ void PanelHierarchy::Update() {
 	ImGui::SetNextWindowDockID(App->editor->dockLeftId, ImGuiCond_FirstUseEver);
 	std::string windowName = std::string(ICON_FA_SITEMAP " ") + name;
 	if (ImGui::Begin(windowName.c_str(), &enabled)) {
-		GameObject* root = App->scene->root;
-		if (root != nullptr) {
-			UpdateHierarchyNode(root);
+		ImGui::InputTextWithHint("##filter", ICON_FA_SEARCH " Filter by name", filter, IM_ARRAYSIZE(filter));
+		ImGui::Separator();
+
+		ImGui::BeginChild("Rows");
+		if (rowsDirty || rowsHierarchyVersion != App->scene->hierarchyVersion || rowsFilter != filter) {
+			RebuildRows();
 		}
+
+		ImGuiListClipper clipper;
+		clipper.Begin((int) rows.size());
+		while (clipper.Step()) {
+			for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+				UpdateHierarchyRow(rows[i]);
+			}
+		}
+		ImGui::EndChild();
+
+		ApplyAction();
 	}
 	ImGui::End();
 }
 
-void PanelHierarchy::UpdateHierarchyNode(GameObject* gameObject) {
-	const std::vector<GameObject*>& children = gameObject->GetChildren();
+void PanelHierarchy::RebuildRows() {
+	rows.clear();
+	rowsDirty = false;
+	rowsHierarchyVersion = App->scene->hierarchyVersion;
+	rowsFilter = filter;
+
+	GameObject* root = App->scene->root;
+	if (root == nullptr) return;
+
+	// Filtered: flat list of the GameObjects whose name contains the filter
+	if (filter[0] != '\0') {
+		RebuildNameIndex();
+
+		std::string lowercaseFilter = ToLowercase(filter);
+		for (const NameIndexEntry& entry : nameIndex) {
+			if (entry.lowercaseName.find(lowercaseFilter) == std::string::npos) continue;
+
+			for (unsigned i = entry.first; i < entry.first + entry.count; ++i) {
+				HierarchyRow row;
+				row.gameObject = nameIndexGameObjects[i];
+				rows.push_back(row);
+			}
+		}
+		return;
+	}
+
+	// Depth-first, skipping the children of collapsed nodes. Children are pushed in reverse so that they are listed in order.
+	FrameVector<HierarchyRow> stack;
+	HierarchyRow rootRow;
+	rootRow.gameObject = root;
+	stack.push_back(rootRow);
+	while (!stack.empty()) {
+		HierarchyRow row = stack.back();
+		stack.pop_back();
+
+		const std::vector<GameObject*>& children = row.gameObject->GetChildren();
+		row.hasChildren = !children.empty();
+		rows.push_back(row);
+
+		if (!row.hasChildren || collapsedNodes.Find(row.gameObject->GetID()) != nullptr) continue;
+		for (unsigned i = (unsigned) children.size(); i > 0; --i) {
+			HierarchyRow childRow;
+			childRow.gameObject = children[i - 1];
+			childRow.depth = row.depth + 1;
+			stack.push_back(childRow);
+		}
+	}
+}
+
+void PanelHierarchy::RebuildNameIndex() {
+	if (!nameIndexDirty && nameIndexHierarchyVersion == App->scene->hierarchyVersion) return;
+	nameIndexDirty = false;
+	nameIndexHierarchyVersion = App->scene->hierarchyVersion;
+
+	// Group the GameObjects by interned name, so that each unique name is only compared once
+	nameIndexGameObjects.clear();
+	for (GameObject& gameObject : App->scene->gameObjects) {
+		nameIndexGameObjects.push_back(&gameObject);
+	}
+	std::stable_sort(nameIndexGameObjects.begin(), nameIndexGameObjects.end(), [](const GameObject* a, const GameObject* b) {
+		return a->name.Id() < b->name.Id();
+	});
+
+	nameIndex.clear();
+	for (unsigned i = 0; i < nameIndexGameObjects.size(); ++i) {
+		const InternedString& name = nameIndexGameObjects[i]->name;
+		if (i == 0 || name != nameIndexGameObjects[i - 1]->name) {
+			NameIndexEntry entry;
+			entry.lowercaseName = ToLowercase(name.c_str());
+			entry.first = i;
+			nameIndex.push_back(entry);
+		}
+		nameIndex.back().count += 1;
+	}
+}
+
+void PanelHierarchy::UpdateHierarchyRow(const HierarchyRow& row) {
+	GameObject* gameObject = row.gameObject;
 
 	char label[160];
 	sprintf_s(label, "%s###%p", gameObject->name.c_str(), gameObject);
 
-	ImGuiTreeNodeFlags baseFlags = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_OpenOnArrow;
-	ImGuiTreeNodeFlags flags = baseFlags;
-
-	if (children.empty()) flags |= ImGuiTreeNodeFlags_Leaf;
-	bool isSelected = App->editor->selectedGameObject == gameObject;
+	ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+	if (!row.hasChildren) flags |= ImGuiTreeNodeFlags_Leaf;
+	bool isSelected = App->editor->GetSelectedGameObject() == gameObject;
 	if (isSelected) flags |= ImGuiTreeNodeFlags_Selected;
 
+	float indent = row.depth * ImGui::GetStyle().IndentSpacing;
+	if (indent > 0) ImGui::Indent(indent);
+
+	bool collapsed = row.hasChildren && collapsedNodes.Find(gameObject->GetID()) != nullptr;
+	if (row.hasChildren) ImGui::SetNextItemOpen(!collapsed);
 	bool open = ImGui::TreeNodeEx(label, flags);
+	if (row.hasChildren && open == collapsed) {
+		if (open) {
+			collapsedNodes.Erase(gameObject->GetID());
+		} else {
+			collapsedNodes[gameObject->GetID()] = true;
+		}
+		rowsDirty = true;
+	}
 
 	ImGui::PushID(label);
 	if (ImGui::BeginPopupContextItem("Options")) {
 		if (gameObject != App->scene->root) {
 			if (ImGui::Selectable("Delete")) {
-				App->scene->DestroyGameObject(gameObject);
-				if (isSelected) App->editor->selectedGameObject = nullptr;
+				action = HierarchyAction::DESTROY;
+				actionTarget = gameObject;
 			}
 
 			ImGui::Selectable("Duplicate");
@@ -59,13 +171,8 @@ void PanelHierarchy::UpdateHierarchyNode(GameObject* gameObject) {
 		}
 
 		if (ImGui::Selectable("Create Empty")) {
-			GameObject* newGameObject = App->scene->CreateGameObject(gameObject);
-			newGameObject->name = "Game Object";
-			ComponentTransform* transform = newGameObject->CreateComponent<ComponentTransform>();
-			transform->SetPosition(float3(0, 0, 0));
-			transform->SetRotation(Quat::identity);
-			transform->SetScale(float3(1, 1, 1));
-			newGameObject->InitComponents();
+			action = HierarchyAction::CREATE_EMPTY;
+			actionTarget = gameObject;
 		}
 
 		ImGui::EndPopup();
@@ -73,7 +180,7 @@ void PanelHierarchy::UpdateHierarchyNode(GameObject* gameObject) {
 	ImGui::PopID();
 
 	if (ImGui::IsItemClicked()) {
-		App->editor->selectedGameObject = gameObject;
+		App->editor->SetSelectedGameObject(gameObject);
 	}
 
 	if (ImGui::BeginDragDropSource()) {
@@ -83,20 +190,44 @@ void PanelHierarchy::UpdateHierarchyNode(GameObject* gameObject) {
 
 	if (ImGui::BeginDragDropTarget()) {
 		if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("_HIERARCHY")) {
-			if (!gameObject->IsDescendantOf(App->editor->selectedGameObject)) {
-				App->editor->selectedGameObject->SetParent(gameObject);
-				ComponentTransform* transform = App->editor->selectedGameObject->GetComponent<ComponentTransform>();
-				transform->InvalidateHierarchy();
-				transform->CalculateGlobalMatrix();
-			}
+			action = HierarchyAction::SET_PARENT;
+			actionTarget = gameObject;
 		}
 		ImGui::EndDragDropTarget();
 	}
 
-	if (open) {
-		for (unsigned i = 0; i < children.size(); i++) {
-			UpdateHierarchyNode(children[i]);
+	if (indent > 0) ImGui::Unindent(indent);
+}
+
+void PanelHierarchy::ApplyAction() {
+	switch (action) {
+	case HierarchyAction::CREATE_EMPTY: {
+		GameObject* newGameObject = App->scene->CreateGameObject(actionTarget);
+		newGameObject->name = "Game Object";
+		ComponentTransform* transform = newGameObject->CreateComponent<ComponentTransform>();
+		transform->SetPosition(float3(0, 0, 0));
+		transform->SetRotation(Quat::identity);
+		transform->SetScale(float3(1, 1, 1));
+		newGameObject->InitComponents();
+		break;
+	}
+	case HierarchyAction::DESTROY:
+		App->scene->DestroyGameObject(actionTarget);
+		break;
+	case HierarchyAction::SET_PARENT: {
+		GameObject* selectedGameObject = App->editor->GetSelectedGameObject();
+		if (selectedGameObject != nullptr && selectedGameObject != actionTarget && !actionTarget->IsDescendantOf(selectedGameObject)) {
+			selectedGameObject->SetParent(actionTarget);
+			ComponentTransform* transform = selectedGameObject->GetComponent<ComponentTransform>();
+			transform->InvalidateHierarchy();
+			transform->CalculateGlobalMatrix();
 		}
-		ImGui::TreePop();
+		break;
 	}
+	default:
+		break;
+	}
+
+	action = HierarchyAction::NONE;
+	actionTarget = nullptr;
 }
@@ -2,9 +2,18 @@
 
 #include "Panel.h"
 #include "Utils/UID.h"
+#include "Utils/FlatHashMap.h"
+
+#include <vector>
+#include <string>
 
 class GameObject;
 
+/* The hierarchy is flattened into a list of visible rows that is only rebuilt when the scene hierarchy,
+*  the expanded nodes or the name filter change. Rows are drawn with a list clipper, so only the rows on screen cost anything.
+*  Name filtering goes through an index of the unique GameObject names.
+*/
+
 class PanelHierarchy : public Panel {
 public:
 	PanelHierarchy();
@@ -12,9 +21,44 @@ public:
 	void Update() override;
 
 private:
-	void UpdateHierarchyNode(GameObject* gameObject);
+	struct HierarchyRow {
+		GameObject* gameObject = nullptr;
+		unsigned depth = 0;
+		bool hasChildren = false;
+	};
+
+	struct NameIndexEntry {
+		std::string lowercaseName;
+		unsigned first = 0; // First GameObject with this name in nameIndexGameObjects.
+		unsigned count = 0;
+	};
+
+	// Changes to the hierarchy are applied after drawing, so that rows stay valid while they are drawn
+	enum class HierarchyAction {
+		NONE,
+		CREATE_EMPTY,
+		DESTROY,
+		SET_PARENT
+	};
+
+	void RebuildRows();
+	void RebuildNameIndex();
+	void UpdateHierarchyRow(const HierarchyRow& row);
+	void ApplyAction();
 
 private:
-	int windowWidth = 0;
-	int windowHeight = 0;
+	std::vector<HierarchyRow> rows;
+	FlatHashMap<bool> collapsedNodes; // UIDs of the collapsed GameObjects. Nodes are open by default.
+	bool rowsDirty = true;
+	unsigned rowsHierarchyVersion = 0;
+
+	char filter[64] = {'\0'};
+	std::string rowsFilter = "";
+	std::vector<NameIndexEntry> nameIndex;
+	std::vector<GameObject*> nameIndexGameObjects; // GameObjects sorted by name.
+	bool nameIndexDirty = true;
+	unsigned nameIndexHierarchyVersion = 0;
+
+	HierarchyAction action = HierarchyAction::NONE;
+	GameObject* actionTarget = nullptr;
 };
@@ -4,6 +4,7 @@
 #include "Resources/GameObject.h"
 #include "Components/Component.h"
 #include "Modules/ModuleEditor.h"
+#include "Modules/ModuleScene.h"
 
 #include "Math/float3.h"
 #include "Math/float3x3.h"
@@ -22,7 +23,7 @@ void PanelInspector::Update() {
 	ImGui::SetNextWindowDockID(App->editor->dockRightId, ImGuiCond_FirstUseEver);
 	std::string windowName = std::string(ICON_FA_CUBE " ") + name;
 	if (ImGui::Begin(windowName.c_str(), &enabled)) {
-		GameObject* selected = App->editor->selectedGameObject;
+		GameObject* selected = App->editor->GetSelectedGameObject();
 		if (selected != nullptr) {
 			ImGui::TextUnformatted("Id:");
 			ImGui::SameLine();
@@ -32,6 +33,7 @@ void PanelInspector::Update() {
 			sprintf_s(name, 100, "%s", selected->name.c_str());
 			if (ImGui::InputText("Name", name, 100)) {
 				selected->name = name;
+				App->scene->hierarchyVersion += 1;
 			}
 			bool active = selected->IsActive();
 			if (ImGui::Checkbox("Active##game_object", &active)) {
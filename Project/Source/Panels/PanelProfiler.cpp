@@ -0,0 +1,110 @@
+#include "PanelProfiler.h"
+
+#include "Application.h"
+#include "Utils/Logging.h"
+#include "Modules/ModuleEditor.h"
+
+#include "imgui.h"
+#include "IconsFontAwesome5.h"
+
+#include "Utils/Leaks.h"
+
+// Converts an ARGB zone color to ImGui's ABGR
+static ImU32 ToImGuiColor(unsigned argb) {
+	unsigned r = (argb >> 16) & 0xFF;
+	unsigned g = (argb >> 8) & 0xFF;
+	unsigned b = argb & 0xFF;
+	return IM_COL32(r, g, b, 255);
+}
+
+static bool IsLightColor(unsigned argb) {
+	unsigned r = (argb >> 16) & 0xFF;
+	unsigned g = (argb >> 8) & 0xFF;
+	unsigned b = argb & 0xFF;
+	return r * 299 + g * 587 + b * 114 > 140000;
+}
+
+PanelProfiler::PanelProfiler()
+	: Panel("Profiler", false) {}
+
+void PanelProfiler::Update() {
+	ImGui::SetNextWindowDockID(App->editor->dockDownId, ImGuiCond_FirstUseEver);
+	std::string windowName = std::string(ICON_FA_STOPWATCH " ") + name;
+	if (ImGui::Begin(windowName.c_str(), &enabled)) {
+		if (!paused) {
+			hasCapture = CaptureProfilerFrame(capture);
+		}
+
+		if (ImGui::Button(paused ? "Resume" : "Pause")) {
+			paused = !paused;
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Export trace")) {
+			if (ExportProfilerTrace(PROFILER_TRACE_FILE_PATH)) {
+				LOG("Profiler trace exported to \"%s\".", PROFILER_TRACE_FILE_PATH);
+			} else {
+				LOG_WARNING(LogCategory::GENERAL, "Unable to export profiler trace to \"%s\".", PROFILER_TRACE_FILE_PATH);
+			}
+		}
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(150.0f);
+		ImGui::SliderFloat("Zoom", &zoom, 1.0f, 64.0f, "%.1fx");
+
+		if (!hasCapture) {
+			ImGui::TextColored(App->editor->textColor, "No frames captured yet.");
+			ImGui::End();
+			return;
+		}
+
+		double frameNs = (double) (capture.endNs - capture.startNs);
+		if (frameNs <= 0.0) frameNs = 1.0;
+		ImGui::TextUnformatted("Frame:");
+		ImGui::SameLine();
+		ImGui::TextColored(App->editor->textColor, "%llu (%.3f ms)", capture.frame, frameNs / 1000000.0);
+
+		// Timeline. Every thread is a row of zones stacked by depth.
+		ImGui::BeginChild("Timeline", ImVec2(0, 0), true, ImGuiWindowFlags_HorizontalScrollbar);
+		float width = ImGui::GetContentRegionAvail().x * zoom;
+		float zoneHeight = ImGui::GetTextLineHeightWithSpacing();
+		ImDrawList* drawList = ImGui::GetWindowDrawList();
+		ImVec2 mousePos = ImGui::GetMousePos();
+		for (const ProfilerThreadCapture& thread : capture.threads) {
+			ImGui::TextColored(App->editor->titleColor, "%s", thread.threadName.c_str());
+
+			unsigned maxDepth = 0;
+			for (const ProfilerZone& zone : thread.zones) {
+				if (zone.depth > maxDepth) maxDepth = zone.depth;
+			}
+
+			ImVec2 origin = ImGui::GetCursorScreenPos();
+			ImGui::PushID(thread.threadId);
+			ImGui::InvisibleButton("Zones", ImVec2(width, (maxDepth + 1) * zoneHeight));
+			ImGui::PopID();
+			bool hovered = ImGui::IsItemHovered();
+
+			const ImVec2 clipMin = drawList->GetClipRectMin();
+			const ImVec2 clipMax = drawList->GetClipRectMax();
+			for (const ProfilerZone& zone : thread.zones) {
+				float x0 = origin.x + (float) ((zone.startNs - capture.startNs) / frameNs) * width;
+				float x1 = origin.x + (float) ((zone.endNs - capture.startNs) / frameNs) * width;
+				if (x1 < clipMin.x || x0 > clipMax.x) continue;
+				if (x1 - x0 < 1.0f) x1 = x0 + 1.0f;
+				float y0 = origin.y + zone.depth * zoneHeight;
+				float y1 = y0 + zoneHeight - 1.0f;
+
+				drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), ToImGuiColor(zone.color));
+				if (x1 - x0 > 8.0f) {
+					ImVec4 clipRect(x0 + 2.0f, y0, x1 - 2.0f, y1);
+					ImU32 textColor = IsLightColor(zone.color) ? IM_COL32(0, 0, 0, 255) : IM_COL32(255, 255, 255, 255);
+					drawList->AddText(nullptr, 0.0f, ImVec2(x0 + 2.0f, y0), textColor, zone.name, nullptr, 0.0f, &clipRect);
+				}
+
+				if (hovered && mousePos.x >= x0 && mousePos.x < x1 && mousePos.y >= y0 && mousePos.y < y1) {
+					ImGui::SetTooltip("%s\n%.3f ms", zone.name, (zone.endNs - zone.startNs) / 1000000.0);
+				}
+			}
+		}
+		ImGui::EndChild();
+	}
+	ImGui::End();
+}
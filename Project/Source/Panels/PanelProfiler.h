@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Panel.h"
+#include "Utils/Profiling.h"
+
+class PanelProfiler : public Panel {
+public:
+	PanelProfiler();
+
+	void Update() override;
+
+public:
+	bool paused = false;
+	float zoom = 1.0f;
+
+private:
+	ProfilerFrameCapture capture; // Reused every frame
+	bool hasCapture = false;
+};
@@ -158,7 +158,7 @@ void PanelScene::Update() {
 		float4x4 cameraView = float4x4(engineFrustum.ViewMatrix()).Transposed();
 		float4x4 cameraProjection = engineFrustum.ProjectionMatrix().Transposed();
 
-		GameObject* selectedGameObject = App->editor->selectedGameObject;
+		GameObject* selectedGameObject = App->editor->GetSelectedGameObject();
 		if (selectedGameObject) {
 			ComponentTransform* transform = selectedGameObject->GetComponent<ComponentTransform>();
 			float4x4 globalMatrix = transform->GetGlobalMatrix().Transposed();
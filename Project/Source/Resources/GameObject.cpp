@@ -35,6 +35,13 @@ void GameObject::Update() {
 	}
 }
 
+// Doesn't recurse: the scene steps every GameObject once
+void GameObject::FixedUpdate() {
+	for (Component* component : components) {
+		component->FixedUpdate();
+	}
+}
+
 void GameObject::DrawGizmos() {
 	for (Component* component : components) {
 		component->DrawGizmos();
@@ -85,6 +92,7 @@ void GameObject::SetParent(GameObject* gameObject) {
 	if (gameObject != nullptr) {
 		gameObject->children.push_back(this);
 	}
+	App->scene->hierarchyVersion += 1;
 }
 
 GameObject* GameObject::GetParent() const {
@@ -109,44 +117,39 @@ bool GameObject::IsDescendantOf(GameObject* gameObject) {
 	return GetParent()->IsDescendantOf(gameObject);
 }
 
-void GameObject::Save(JsonValue jGameObject) const {
-	jGameObject[JSON_TAG_ID] = id;
-	jGameObject[JSON_TAG_NAME] = name.c_str();
-	jGameObject[JSON_TAG_ACTIVE] = active;
-	jGameObject[JSON_TAG_PARENT_ID] = parent != nullptr ? parent->id : 0;
-
-	JsonValue jComponents = jGameObject[JSON_TAG_COMPONENTS];
-	for (unsigned i = 0; i < components.size(); ++i) {
-		JsonValue jComponent = jComponents[i];
-		Component& component = *components[i];
-
-		jComponent[JSON_TAG_TYPE] = (unsigned) component.GetType();
-		jComponent[JSON_TAG_ACTIVE] = component.IsActive();
-		component.Save(jComponent);
+void GameObject::Save(JsonWriter& writer) const {
+	writer.Member(JSON_TAG_ID, id);
+	writer.Member(JSON_TAG_NAME, name.c_str());
+	writer.Member(JSON_TAG_ACTIVE, active);
+	writer.Member(JSON_TAG_PARENT_ID, parent != nullptr ? parent->id : 0);
+
+	writer.Key(JSON_TAG_COMPONENTS);
+	writer.StartArray();
+	for (const Component* component : components) {
+		writer.StartObject();
+		writer.Member(JSON_TAG_TYPE, (unsigned) component->GetType());
+		writer.Member(JSON_TAG_ACTIVE, component->IsActive());
+		component->Save(writer);
+		writer.EndObject();
 	}
+	writer.EndArray();
 }
 
-void GameObject::Load(JsonValue jGameObject) {
+void GameObject::Load(ConstJsonValue jGameObject) {
 	id = jGameObject[JSON_TAG_ID];
 	name = jGameObject[JSON_TAG_NAME];
 	active = jGameObject[JSON_TAG_ACTIVE];
 
-	JsonValue jComponents = jGameObject[JSON_TAG_COMPONENTS];
+	ConstJsonValue jComponents = jGameObject[JSON_TAG_COMPONENTS];
 	for (unsigned i = 0; i < jComponents.Size(); ++i) {
-		JsonValue jComponent = jComponents[i];
+		ConstJsonValue jComponent = jComponents[i];
 
 		ComponentType type = (ComponentType)(unsigned) jComponent[JSON_TAG_TYPE];
 		bool active = jComponent[JSON_TAG_ACTIVE];
 
-		Component* component = CreateComponentByType(*this, type);
-		component->Load(jComponent);
+		Component* component = CreateComponentByType(*this, type, active);
+		if (component != nullptr) component->Load(jComponent);
 	}
 
 	isInQuadtree = false;
 }
-
-void GameObject::PostLoad(JsonValue jGameObject) {
-	UID parentId = jGameObject[JSON_TAG_PARENT_ID];
-	GameObject* parent = App->scene->GetGameObject(parentId);
-	SetParent(parent);
-}
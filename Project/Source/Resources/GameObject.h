@@ -4,7 +4,10 @@
 #include "Application.h"
 #include "Modules/ModuleScene.h"
 #include "Utils/UID.h"
-#include "FileSystem/JsonValue.h"
+#include "Utils/InternedString.h"
+#include "Utils/FrameArena.h"
+#include "FileSystem/JsonWriter.h"
+#include "FileSystem/ConstJsonValue.h"
 
 #include <vector>
 #include <string>
@@ -14,6 +17,7 @@ public:
 	void Init();
 	void InitComponents();
 	void Update();
+	void FixedUpdate();
 	void DrawGizmos();
 	void CleanUp();
 	void Enable();
@@ -24,7 +28,7 @@ public:
 
 	template<class T> T* CreateComponent(bool active = true);
 	template<class T> T* GetComponent() const;
-	template<class T> std::vector<T*> GetComponents() const;
+	template<class T> FrameVector<T*> GetComponents() const; // Allocated in the frame arena
 
 	void RemoveComponent(Component* component);
 
@@ -36,13 +40,12 @@ public:
 	const std::vector<GameObject*>& GetChildren() const;
 	bool IsDescendantOf(GameObject* gameObject);
 
-	void Save(JsonValue jGameObject) const;
-	void Load(JsonValue jGameObject);
-	void PostLoad(JsonValue jGameObject);
+	void Save(JsonWriter& writer) const;
+	void Load(ConstJsonValue jGameObject);
 
 public:
 	UID id = 0;
-	std::string name = "GameObject";
+	InternedString name = "GameObject";
 	std::vector<Component*> components;
 
 	bool isInQuadtree = false;
@@ -75,8 +78,8 @@ inline T* GameObject::GetComponent() const {
 }
 
 template<class T>
-inline std::vector<T*> GameObject::GetComponents() const {
-	std::vector<T*> auxComponents;
+inline FrameVector<T*> GameObject::GetComponents() const {
+	FrameVector<T*> auxComponents;
 
 	for (Component* component : components) {
 		if (component->GetType() == T::staticType) {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Utils/PoolHandle.h"
+
 #include "Math/float3.h"
 
 class Texture;
@@ -13,15 +15,18 @@ class Material {
 public:
 	ShaderType materialType = ShaderType::PHONG;
 
-	// Phong
+	// Phong. Textures are handles, so that a released Texture whose slot is reused is never bound.
 
 	bool hasDiffuseMap = false;
 	float3 diffuseColor = {0.137f, 0.263f, 0.424f};
-	Texture* diffuseMap = nullptr;
+	PoolHandle<Texture> diffuseMap;
 
 	bool hasSpecularMap = false;
 	float3 specularColor = {1.0f, 1.0f, 1.0f};
-	Texture* specularMap = nullptr;
+	PoolHandle<Texture> specularMap;
+
+	bool hasNormalMap = false;
+	PoolHandle<Texture> normalMap; // Two-channel tangent space normals, see TextureType::NORMAL_MAP
 
 	float shininess = 300;
 	bool hasShininessInAlphaChannel = false;
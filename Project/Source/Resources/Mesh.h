@@ -1,14 +1,29 @@
 #pragma once
 
-#include <string>
+#include "Utils/InternedString.h"
+
+#include "Math/float3.h"
+#include <vector>
+
+#define MESH_MAX_LODS 4
 
 class Mesh {
 public:
-	std::string fileName = "";
+	InternedString fileName;
 	unsigned vbo = 0;
 	unsigned ebo = 0;
 	unsigned vao = 0;
+	bool uploadQueued = false; // Set by the startup worker instead of reading the GL handles, which the main thread writes
 	unsigned numVertices = 0;
-	unsigned numIndices = 0;
-	unsigned materialIndex = 0;
-};
\ No newline at end of file
+	unsigned numIndices = 0; // Full resolution level
+
+	// Levels of detail. Level 0 is the full resolution mesh. All the levels share the vertices, and their indices go one after the other in the EBO.
+	unsigned numLods = 1;
+	unsigned lodNumIndices[MESH_MAX_LODS] = {};
+	unsigned lodIndexOffsets[MESH_MAX_LODS] = {};
+	float lodErrors[MESH_MAX_LODS] = {}; // Simplification error, relative to the radius of the mesh
+
+	// Low-poly copy of the mesh for occlusion culling, in object space. Empty if no level is simple enough.
+	std::vector<float3> occluderVertices;
+	std::vector<unsigned> occluderIndices;
+};
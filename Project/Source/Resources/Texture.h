@@ -1,9 +1,10 @@
 #pragma once
 
-#include <string>
+#include "Utils/InternedString.h"
 
 class Texture {
 public:
-	std::string fileName = "";
+	InternedString fileName;
 	unsigned glTexture = 0;
+	bool uploadQueued = false; // Set by the startup worker instead of reading glTexture, which the main thread writes
 };
\ No newline at end of file
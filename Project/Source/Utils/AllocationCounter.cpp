@@ -0,0 +1,35 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+
+#include "Utils/Leaks.h"
+
+static std::atomic<unsigned long long> allocationCount(0);
+
+#ifdef _DEBUG
+static int AllocationHook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* fileName, int lineNumber) {
+	// Allocations of the CRT itself are ignored
+	if (blockType != _CRT_BLOCK && (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC)) {
+		allocationCount += 1;
+	}
+	return 1; // Allow the allocation
+}
+#endif
+
+void InitAllocationCounter() {
+#ifdef _DEBUG
+	_CrtSetAllocHook(AllocationHook);
+#endif
+}
+
+bool IsAllocationCounterAvailable() {
+#ifdef _DEBUG
+	return true;
+#else
+	return false;
+#endif
+}
+
+unsigned long long GetAllocationCount() {
+	return allocationCount;
+}
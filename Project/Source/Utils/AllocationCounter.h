@@ -0,0 +1,7 @@
+#pragma once
+
+// Counts the heap allocations of the whole process with the CRT allocation hook.
+// Only available in debug builds. In release builds the count is always 0.
+void InitAllocationCounter();
+bool IsAllocationCounterAvailable();
+unsigned long long GetAllocationCount();
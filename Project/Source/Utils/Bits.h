@@ -0,0 +1,29 @@
+#pragma once
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit. 'x' must not be 0.
+inline unsigned CountTrailingZeros64(unsigned long long x) {
+#ifdef _MSC_VER
+	unsigned long index;
+	if (_BitScanForward(&index, (unsigned long) x)) return index;
+	_BitScanForward(&index, (unsigned long) (x >> 32));
+	return index + 32;
+#else
+	return (unsigned) __builtin_ctzll(x);
+#endif
+}
+
+// Number of zero bits above the highest set bit. 'x' must not be 0.
+inline unsigned CountLeadingZeros64(unsigned long long x) {
+#ifdef _MSC_VER
+	unsigned long index;
+	if (_BitScanReverse(&index, (unsigned long) (x >> 32))) return 31 - index;
+	_BitScanReverse(&index, (unsigned long) x);
+	return 63 - index;
+#else
+	return (unsigned) __builtin_clzll(x);
+#endif
+}
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "Globals.h"
+
+#include "Math/myassert.h"
+#include <utility>
+
+/* Open-addressing hash map with 64-bit keys (UIDs, hashes).
+*  Robin Hood linear probing over one contiguous array of entries, so lookups don't chase pointers and usually touch a single cache line.
+*  The load factor is kept under 1/2: probe lengths, and the branch mispredictions that come with them, grow fast above that.
+*  Erase shifts the following entries back, so there are no tombstones. Growing or erasing invalidates pointers to values.
+*/
+
+template<typename V>
+class FlatHashMap {
+public:
+	typedef unsigned long long Key;
+
+	struct Entry {
+		Key key = 0;
+		V value = V();
+		unsigned distance = 0; // Probe length + 1. 0 means that the entry is empty.
+	};
+
+public:
+	FlatHashMap() {}
+
+	FlatHashMap(const FlatHashMap&) = delete;
+	FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+	~FlatHashMap() {
+		RELEASE_ARRAY(entries);
+	}
+
+	void Reserve(size_t count) {
+		size_t newCapacity = capacity > 0 ? capacity : MIN_CAPACITY;
+		while (count * 2 > newCapacity) {
+			newCapacity *= 2;
+		}
+		if (newCapacity != capacity) Rehash(newCapacity);
+	}
+
+	void Clear() {
+		for (size_t i = 0; i < capacity; ++i) {
+			if (entries[i].distance == 0) continue;
+			entries[i].value = V();
+			entries[i].distance = 0;
+		}
+		size = 0;
+	}
+
+	// Returns nullptr if the key isn't in the map
+	V* Find(Key key) const {
+		size_t index = FindIndex(key);
+		return index < capacity ? &entries[index].value : nullptr;
+	}
+
+	// Returns the value of the key, inserting a default one if it isn't in the map
+	V& operator[](Key key) {
+		if ((size + 1) * 2 > capacity) Rehash(capacity > 0 ? capacity * 2 : MIN_CAPACITY);
+
+		size_t mask = capacity - 1;
+		size_t index = HashKey(key) & mask;
+		unsigned distance = 1;
+		for (; entries[index].distance >= distance; ++distance) {
+			if (entries[index].key == key) return entries[index].value;
+			index = (index + 1) & mask;
+		}
+
+		// Not found: the new entry takes this position and the rest of the cluster moves one step further
+		if (entries[index].distance != 0) {
+			Entry displaced = std::move(entries[index]);
+			ShiftInsert(std::move(displaced), (index + 1) & mask);
+		}
+		Entry& entry = entries[index];
+		entry.key = key;
+		entry.value = V();
+		entry.distance = distance;
+		size += 1;
+		return entry.value;
+	}
+
+	bool Erase(Key key) {
+		size_t index = FindIndex(key);
+		if (index == capacity) return false;
+
+		// Shift the following entries of the cluster back one position
+		size_t mask = capacity - 1;
+		size_t next = (index + 1) & mask;
+		while (entries[next].distance > 1) {
+			entries[index] = std::move(entries[next]);
+			entries[index].distance -= 1;
+			index = next;
+			next = (next + 1) & mask;
+		}
+		entries[index].value = V();
+		entries[index].distance = 0;
+		size -= 1;
+		return true;
+	}
+
+	size_t Size() const {
+		return size;
+	}
+
+	size_t Capacity() const {
+		return capacity;
+	}
+
+	// Iteration. The order is unspecified and keys must not be modified.
+
+	class Iterator {
+	public:
+		Iterator(const FlatHashMap<V>& map__, size_t index__)
+			: map(&map__)
+			, index(index__) {}
+
+		const Iterator& operator++() {
+			index = map->NextUsedIndex(index + 1);
+			return *this;
+		}
+
+		bool operator!=(const Iterator& other) const {
+			return index != other.index;
+		}
+
+		Entry& operator*() const {
+			return map->entries[index];
+		}
+
+	private:
+		const FlatHashMap<V>* map;
+		size_t index;
+	};
+
+	Iterator begin() const {
+		return Iterator(*this, NextUsedIndex(0));
+	}
+
+	Iterator end() const {
+		return Iterator(*this, capacity);
+	}
+
+private:
+	static const size_t MIN_CAPACITY = 16;
+
+	static size_t HashKey(Key key) {
+		// MurmurHash3 finalizer. UIDs are already random, but hashes of sequential keys would cluster otherwise.
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdull;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ull;
+		key ^= key >> 33;
+		return (size_t) key;
+	}
+
+	// Returns capacity if the key isn't in the map
+	size_t FindIndex(Key key) const {
+		if (size == 0) return capacity;
+
+		size_t mask = capacity - 1;
+		size_t index = HashKey(key) & mask;
+		for (unsigned distance = 1; entries[index].distance >= distance; ++distance) {
+			if (entries[index].key == key) return index;
+			index = (index + 1) & mask;
+		}
+		return capacity;
+	}
+
+	void ShiftInsert(Entry&& entry, size_t index) {
+		size_t mask = capacity - 1;
+		entry.distance += 1;
+		while (entries[index].distance != 0) {
+			if (entries[index].distance < entry.distance) {
+				std::swap(entries[index], entry);
+			}
+			entry.distance += 1;
+			index = (index + 1) & mask;
+		}
+		entries[index] = std::move(entry);
+	}
+
+	void Rehash(size_t newCapacity) {
+		assert((newCapacity & (newCapacity - 1)) == 0); // Capacity must be a power of 2
+
+		Entry* oldEntries = entries;
+		size_t oldCapacity = capacity;
+
+		entries = new Entry[newCapacity];
+		capacity = newCapacity;
+		size = 0;
+
+		for (size_t i = 0; i < oldCapacity; ++i) {
+			Entry& entry = oldEntries[i];
+			if (entry.distance == 0) continue;
+			(*this)[entry.key] = std::move(entry.value);
+		}
+
+		RELEASE_ARRAY(oldEntries);
+	}
+
+	size_t NextUsedIndex(size_t index) const {
+		while (index < capacity && entries[index].distance == 0) {
+			++index;
+		}
+		return index;
+	}
+
+private:
+	Entry* entries = nullptr;
+	size_t capacity = 0; // Always 0 or a power of 2
+	size_t size = 0;
+};
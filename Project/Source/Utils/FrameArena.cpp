@@ -0,0 +1,113 @@
+#include "FrameArena.h"
+
+#include "Globals.h"
+
+#include "Math/MathFunc.h"
+#include <atomic>
+#include <stdint.h>
+
+#include "Utils/Leaks.h"
+
+#define FRAME_ARENA_BLOCK_SIZE (256 * 1024)
+
+static std::atomic<unsigned> currentFrame(0);
+
+FrameArena::FrameArena() {
+	AddBlock(FRAME_ARENA_BLOCK_SIZE);
+	frame = currentFrame;
+}
+
+FrameArena::~FrameArena() {
+	for (Block& block : blocks) {
+		RELEASE_ARRAY(block.data);
+	}
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+	while (true) {
+		Block& block = blocks[currentBlock];
+		uintptr_t address = (uintptr_t) (block.data + currentOffset);
+		size_t offset = currentOffset + (size_t) (((address + alignment - 1) & ~(uintptr_t) (alignment - 1)) - address);
+		if (offset + size <= block.size) {
+			currentOffset = offset + size;
+			highWater = Max(highWater, currentBlockStart + currentOffset);
+			return block.data + offset;
+		}
+
+		// Continue in the next block
+		currentBlockStart += block.size;
+		if (currentBlock + 1 == blocks.size()) AddBlock(size + alignment);
+		currentBlock += 1;
+		currentOffset = 0;
+	}
+}
+
+void FrameArena::Reset() {
+	// Merge the blocks so that a frame like this one fits in a single block next time
+	if (blocks.size() > 1) {
+		size_t totalSize = Capacity();
+		for (Block& block : blocks) {
+			RELEASE_ARRAY(block.data);
+		}
+		blocks.clear();
+		AddBlock(totalSize);
+	}
+
+	currentBlock = 0;
+	currentBlockStart = 0;
+	currentOffset = 0;
+	frame = currentFrame;
+}
+
+ArenaMarker FrameArena::GetMarker() const {
+	ArenaMarker marker;
+	marker.block = currentBlock;
+	marker.offset = currentOffset;
+	return marker;
+}
+
+void FrameArena::FreeToMarker(ArenaMarker marker) {
+	while (currentBlock > marker.block) {
+		currentBlock -= 1;
+		currentBlockStart -= blocks[currentBlock].size;
+	}
+	currentOffset = marker.offset;
+}
+
+size_t FrameArena::Used() const {
+	return currentBlockStart + currentOffset;
+}
+
+size_t FrameArena::HighWater() const {
+	return highWater;
+}
+
+size_t FrameArena::Capacity() const {
+	size_t capacity = 0;
+	for (const Block& block : blocks) {
+		capacity += block.size;
+	}
+	return capacity;
+}
+
+unsigned long long FrameArena::NumHeapAllocations() const {
+	return numHeapAllocations;
+}
+
+FrameArena& FrameArena::Get() {
+	thread_local FrameArena arena;
+	if (arena.frame != currentFrame) arena.Reset();
+	return arena;
+}
+
+void FrameArena::EndFrame() {
+	currentFrame += 1;
+}
+
+void FrameArena::AddBlock(size_t minSize) {
+	Block block;
+	block.size = Max(minSize, blocks.empty() ? (size_t) FRAME_ARENA_BLOCK_SIZE : blocks.back().size * 2);
+	block.data = new char[block.size];
+	blocks.push_back(block);
+	numHeapAllocations += 1;
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+/* Linear allocator for transient data that only lives during the current frame.
+*  Every thread has its own arena (FrameArena::Get()). Allocating only moves an offset forward and nothing is freed
+*  individually: ArenaScope rewinds to a marker and the whole arena is reset once per frame.
+*  If a frame needs more memory than the arena has, extra blocks are allocated and merged into a single bigger block
+*  on the next reset, so steady-state frames don't touch the heap.
+*/
+
+struct ArenaMarker {
+	unsigned block = 0;
+	size_t offset = 0;
+};
+
+class FrameArena {
+public:
+	FrameArena();
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment);
+	void Reset();
+
+	ArenaMarker GetMarker() const;
+	void FreeToMarker(ArenaMarker marker);
+
+	// Stats
+	size_t Used() const;
+	size_t HighWater() const;
+	size_t Capacity() const;
+	unsigned long long NumHeapAllocations() const;
+
+	// Arena of the calling thread. It's reset automatically the first time it's used in a new frame.
+	static FrameArena& Get();
+
+	// Ends the current frame: every arena is reset before it's used again. Called at the end of Application::Update.
+	static void EndFrame();
+
+private:
+	struct Block {
+		char* data = nullptr;
+		size_t size = 0;
+	};
+
+	void AddBlock(size_t minSize);
+
+private:
+	std::vector<Block> blocks;
+	unsigned currentBlock = 0;
+	size_t currentBlockStart = 0; // Bytes in the blocks before the current one.
+	size_t currentOffset = 0;
+
+	size_t highWater = 0; // Max bytes used in a frame.
+	unsigned long long numHeapAllocations = 0; // Blocks allocated since the arena was created.
+	unsigned frame = 0; // Frame in which the arena was last reset.
+};
+
+// Rewinds the arena to where it was when the scope started. Everything allocated inside the scope is freed.
+class ArenaScope {
+public:
+	ArenaScope(FrameArena& arena_ = FrameArena::Get())
+		: arena(arena_)
+		, marker(arena_.GetMarker()) {}
+
+	~ArenaScope() {
+		arena.FreeToMarker(marker);
+	}
+
+	ArenaScope(const ArenaScope&) = delete;
+	ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+	FrameArena& arena;
+	ArenaMarker marker;
+};
+
+// STL allocator over a FrameArena. Deallocation does nothing: the memory is freed with the arena.
+// Containers keep the arena of the thread that created them, so they shouldn't be grown from other threads.
+template<typename T>
+class ArenaAllocator {
+public:
+	typedef T value_type;
+
+	ArenaAllocator()
+		: arena(&FrameArena::Get()) {}
+
+	ArenaAllocator(FrameArena& arena_)
+		: arena(&arena_) {}
+
+	template<typename U>
+	ArenaAllocator(const ArenaAllocator<U>& other)
+		: arena(other.arena) {}
+
+	T* allocate(size_t count) {
+		return (T*) arena->Allocate(count * sizeof(T), alignof(T));
+	}
+
+	void deallocate(T* pointer, size_t count) {}
+
+	template<typename U>
+	bool operator==(const ArenaAllocator<U>& other) const {
+		return arena == other.arena;
+	}
+
+	template<typename U>
+	bool operator!=(const ArenaAllocator<U>& other) const {
+		return arena != other.arena;
+	}
+
+public:
+	FrameArena* arena = nullptr;
+};
+
+// Vector for transient data. Its memory is only valid until the end of the frame.
+template<typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
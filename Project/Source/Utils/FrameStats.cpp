@@ -0,0 +1,170 @@
+#include "FrameStats.h"
+
+#include "Globals.h"
+#include "Modules/Module.h"
+#include "FileSystem/JsonWriter.h"
+
+#include <stdio.h>
+
+#include "Utils/Leaks.h"
+
+#define FRAME_STATS_FRAME_SERIES 0
+#define FRAME_STATS_CPU_SERIES 1
+#define FRAME_STATS_FIRST_MODULE_SERIES 2
+
+static const char* phaseNames[(int) ModulePhase::COUNT] = {"PreUpdate", "Update", "PostUpdate"};
+
+static TimingStats GetStats(const LatencyHistogram& histogram) {
+	TimingStats stats;
+	stats.count = histogram.Count();
+	stats.meanNs = histogram.MeanNs();
+	stats.p50Ns = histogram.Percentile(50.0);
+	stats.p95Ns = histogram.Percentile(95.0);
+	stats.p99Ns = histogram.Percentile(99.0);
+	stats.maxNs = histogram.MaxNs();
+	return stats;
+}
+
+TimingSeries::TimingSeries(const std::string& name_)
+	: name(name_) {}
+
+TimingStats TimingSeries::GetWindowStats() const {
+	LatencyHistogram window;
+	for (const LatencyHistogram& second : seconds) {
+		window.Merge(second);
+	}
+	return GetStats(window);
+}
+
+TimingStats TimingSeries::GetSessionStats() const {
+	return GetStats(session);
+}
+
+FrameStats::~FrameStats() {
+	for (TimingSeries* timingSeries : series) {
+		RELEASE(timingSeries);
+	}
+}
+
+void FrameStats::Init(const std::vector<Module*>& modules) {
+	for (TimingSeries* timingSeries : series) {
+		RELEASE(timingSeries);
+	}
+	series.clear();
+
+	series.push_back(new TimingSeries("Frame"));
+	series.push_back(new TimingSeries("CPU"));
+	for (Module* module : modules) {
+		for (const char* phaseName : phaseNames) {
+			series.push_back(new TimingSeries(std::string(module->name) + " - " + phaseName));
+		}
+	}
+
+	frameStartNs = 0;
+	currentSecond = 0;
+}
+
+void FrameStats::BeginFrame(unsigned long long nowNs) {
+	// Move the rolling window, clearing the seconds that are left behind
+	unsigned long long second = nowNs / 1000000000ull;
+	if (second != currentSecond) {
+		unsigned long long numSeconds = second - currentSecond;
+		if (numSeconds > FRAME_STATS_WINDOW_SECONDS) numSeconds = FRAME_STATS_WINDOW_SECONDS;
+		for (unsigned long long i = 1; i <= numSeconds; ++i) {
+			unsigned slot = (unsigned) ((currentSecond + i) % FRAME_STATS_WINDOW_SECONDS);
+			for (TimingSeries* timingSeries : series) {
+				timingSeries->seconds[slot].Clear();
+			}
+		}
+		currentSecond = second;
+	}
+
+	if (frameStartNs != 0 && !series.empty()) {
+		Record(*series[FRAME_STATS_FRAME_SERIES], nowNs - frameStartNs);
+	}
+	frameStartNs = nowNs;
+}
+
+void FrameStats::EndFrameWork(unsigned long long nowNs) {
+	if (frameStartNs == 0 || series.empty()) return;
+
+	Record(*series[FRAME_STATS_CPU_SERIES], nowNs - frameStartNs);
+}
+
+void FrameStats::RecordModule(unsigned moduleIndex, ModulePhase phase, unsigned long long durationNs) {
+	unsigned index = FRAME_STATS_FIRST_MODULE_SERIES + moduleIndex * (unsigned) ModulePhase::COUNT + (unsigned) phase;
+	if (index >= series.size()) return;
+
+	Record(*series[index], durationNs);
+}
+
+void FrameStats::Reset() {
+	for (TimingSeries* timingSeries : series) {
+		for (LatencyHistogram& second : timingSeries->seconds) {
+			second.Clear();
+		}
+		timingSeries->session.Clear();
+	}
+	frameStartNs = 0;
+}
+
+const std::vector<TimingSeries*>& FrameStats::GetSeries() const {
+	return series;
+}
+
+bool FrameStats::ExportCsv(const char* filePath) const {
+	FILE* file = fopen(filePath, "w");
+	if (!file) return false;
+
+	fprintf(file, "series,scope,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n");
+	for (const TimingSeries* timingSeries : series) {
+		TimingStats scopes[2] = {timingSeries->GetWindowStats(), timingSeries->GetSessionStats()};
+		const char* scopeNames[2] = {"window", "session"};
+		for (unsigned i = 0; i < 2; ++i) {
+			const TimingStats& stats = scopes[i];
+			fprintf(file, "%s,%s,%llu,%.4f,%.4f,%.4f,%.4f,%.4f\n", timingSeries->name.c_str(), scopeNames[i], stats.count, stats.meanNs / 1000000.0, stats.p50Ns / 1000000.0, stats.p95Ns / 1000000.0, stats.p99Ns / 1000000.0, stats.maxNs / 1000000.0);
+		}
+	}
+
+	bool ok = ferror(file) == 0;
+	fclose(file);
+	return ok;
+}
+
+static void WriteStats(JsonWriter& writer, const char* key, const TimingStats& stats) {
+	writer.Key(key);
+	writer.StartObject();
+	writer.Member("count", stats.count);
+	writer.Member("meanMs", stats.meanNs / 1000000.0);
+	writer.Member("p50Ms", stats.p50Ns / 1000000.0);
+	writer.Member("p95Ms", stats.p95Ns / 1000000.0);
+	writer.Member("p99Ms", stats.p99Ns / 1000000.0);
+	writer.Member("maxMs", stats.maxNs / 1000000.0);
+	writer.EndObject();
+}
+
+bool FrameStats::ExportJson(const char* filePath) const {
+	JsonWriter writer(filePath, true);
+	if (!writer.IsOpen()) return false;
+
+	writer.StartObject();
+	writer.Member("windowSeconds", (unsigned) FRAME_STATS_WINDOW_SECONDS);
+	writer.Key("series");
+	writer.StartArray();
+	for (const TimingSeries* timingSeries : series) {
+		writer.StartObject();
+		writer.Member("name", timingSeries->name.c_str());
+		WriteStats(writer, "window", timingSeries->GetWindowStats());
+		WriteStats(writer, "session", timingSeries->GetSessionStats());
+		writer.EndObject();
+	}
+	writer.EndArray();
+	writer.EndObject();
+
+	return writer.Close();
+}
+
+void FrameStats::Record(TimingSeries& timingSeries, unsigned long long durationNs) {
+	timingSeries.seconds[currentSecond % FRAME_STATS_WINDOW_SECONDS].Record(durationNs);
+	timingSeries.session.Record(durationNs);
+}
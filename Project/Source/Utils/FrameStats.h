@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Utils/LatencyHistogram.h"
+
+#include <vector>
+#include <string>
+
+#define FRAME_STATS_WINDOW_SECONDS 10
+#define FRAME_STATS_CSV_FILE_PATH "FrameStats.csv"
+#define FRAME_STATS_JSON_FILE_PATH "FrameStats.json"
+
+class Module;
+
+enum class ModulePhase {
+	PRE_UPDATE,
+	UPDATE,
+	POST_UPDATE,
+	COUNT
+};
+
+struct TimingStats {
+	unsigned long long count = 0;
+	unsigned long long meanNs = 0;
+	unsigned long long p50Ns = 0;
+	unsigned long long p95Ns = 0;
+	unsigned long long p99Ns = 0;
+	unsigned long long maxNs = 0;
+};
+
+// Durations of something that happens every frame, over a rolling window and over the whole session
+class TimingSeries {
+public:
+	TimingSeries(const std::string& name);
+
+	TimingStats GetWindowStats() const;
+	TimingStats GetSessionStats() const;
+
+public:
+	std::string name = "";
+
+private:
+	friend class FrameStats;
+
+	LatencyHistogram seconds[FRAME_STATS_WINDOW_SECONDS]; // One histogram per second. The window is the last FRAME_STATS_WINDOW_SECONDS.
+	LatencyHistogram session;
+};
+
+/* Frame and per-module timing with nanosecond resolution.
+*  Series: whole frame (including the frame rate limit wait), CPU time of the frame (without the wait) and PreUpdate/Update/PostUpdate of every module.
+*/
+
+class FrameStats {
+public:
+	~FrameStats();
+
+	void Init(const std::vector<Module*>& modules);
+
+	void BeginFrame(unsigned long long nowNs); // Records the duration of the previous frame
+	void EndFrameWork(unsigned long long nowNs); // Records the CPU time of the frame, before waiting for the frame rate limit
+	void RecordModule(unsigned moduleIndex, ModulePhase phase, unsigned long long durationNs);
+
+	void Reset();
+
+	const std::vector<TimingSeries*>& GetSeries() const;
+	bool ExportCsv(const char* filePath) const;
+	bool ExportJson(const char* filePath) const;
+
+private:
+	void Record(TimingSeries& series, unsigned long long durationNs);
+
+private:
+	std::vector<TimingSeries*> series; // Frame, CPU and then the phases of every module
+	unsigned long long frameStartNs = 0;
+	unsigned long long currentSecond = 0;
+};
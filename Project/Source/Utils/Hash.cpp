@@ -0,0 +1,66 @@
+#include "Hash.h"
+
+#include <string.h>
+
+#include "Utils/Leaks.h"
+
+#define MURMUR_MULTIPLIER 0xc6a4a7935bd1e995ULL
+#define MURMUR_SHIFT 47
+
+Hash HashBuffer(const void* data, size_t size, Hash seed) {
+	Hash hash = seed ^ (size * MURMUR_MULTIPLIER);
+
+	const unsigned char* bytes = (const unsigned char*) data;
+	const unsigned char* end = bytes + (size / 8) * 8;
+	while (bytes != end) {
+		Hash block;
+		memcpy(&block, bytes, sizeof(Hash));
+		bytes += sizeof(Hash);
+
+		block *= MURMUR_MULTIPLIER;
+		block ^= block >> MURMUR_SHIFT;
+		block *= MURMUR_MULTIPLIER;
+
+		hash ^= block;
+		hash *= MURMUR_MULTIPLIER;
+	}
+
+	switch (size & 7) {
+	case 7:
+		hash ^= Hash(bytes[6]) << 48;
+	case 6:
+		hash ^= Hash(bytes[5]) << 40;
+	case 5:
+		hash ^= Hash(bytes[4]) << 32;
+	case 4:
+		hash ^= Hash(bytes[3]) << 24;
+	case 3:
+		hash ^= Hash(bytes[2]) << 16;
+	case 2:
+		hash ^= Hash(bytes[1]) << 8;
+	case 1:
+		hash ^= Hash(bytes[0]);
+		hash *= MURMUR_MULTIPLIER;
+	}
+
+	hash ^= hash >> MURMUR_SHIFT;
+	hash *= MURMUR_MULTIPLIER;
+	hash ^= hash >> MURMUR_SHIFT;
+
+	return hash;
+}
+
+Hash HashCombine(Hash hash, Hash value) {
+	return HashBuffer(&value, sizeof(Hash), hash);
+}
+
+std::string HashToString(Hash hash) {
+	static const char* digits = "0123456789abcdef";
+
+	std::string string(16, '0');
+	for (int i = 15; i >= 0; --i) {
+		string[i] = digits[hash & 0xF];
+		hash >>= 4;
+	}
+	return string;
+}
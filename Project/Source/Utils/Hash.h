@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+
+typedef unsigned long long Hash;
+
+// 64-bit MurmurHash2 (MurmurHash64A). Processes 8 bytes per step, fast enough to hash big source assets on every import.
+Hash HashBuffer(const void* data, size_t size, Hash seed = 0);
+Hash HashCombine(Hash hash, Hash value);
+
+// Fixed-length hexadecimal representation. Used to build deterministic file names.
+std::string HashToString(Hash hash);
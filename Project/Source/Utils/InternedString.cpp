@@ -0,0 +1,109 @@
+#include "InternedString.h"
+
+#include "Globals.h"
+#include "Utils/Hash.h"
+#include "Utils/FlatHashMap.h"
+
+#include "Math/MathFunc.h"
+#include <vector>
+#include <string.h>
+
+#include "Utils/Leaks.h"
+
+#define STRING_TABLE_BLOCK_SIZE (64 * 1024)
+
+struct StringTableEntry {
+	const char* string = nullptr;
+	unsigned length = 0;
+};
+
+struct StringTable {
+	StringTable() {
+		// Id 0 is the empty string
+		StringTableEntry empty;
+		empty.string = "";
+		entries.push_back(empty);
+	}
+
+	~StringTable() {
+		for (char* block : blocks) {
+			RELEASE_ARRAY(block);
+		}
+	}
+
+	const char* Store(const char* string, size_t length) {
+		if (blockOffset + length + 1 > blockSize) {
+			blockSize = Max(length + 1, (size_t) STRING_TABLE_BLOCK_SIZE);
+			blocks.push_back(new char[blockSize]);
+			blockOffset = 0;
+			memory += blockSize;
+		}
+
+		char* storedString = blocks.back() + blockOffset;
+		memcpy(storedString, string, length);
+		storedString[length] = '\0';
+		blockOffset += length + 1;
+		return storedString;
+	}
+
+	std::vector<StringTableEntry> entries;
+	FlatHashMap<unsigned> ids; // Ids indexed by the hash of their contents. Collisions continue at the next hash.
+
+	std::vector<char*> blocks;
+	size_t blockSize = 0;
+	size_t blockOffset = 0;
+	size_t memory = 0;
+};
+
+static StringTable& GetStringTable() {
+	// Constructed on first use, so that strings can be interned during static initialization
+	static StringTable stringTable;
+	return stringTable;
+}
+
+InternedString::InternedString(const char* string)
+	: InternedString(string, strlen(string)) {}
+
+InternedString::InternedString(const std::string& string)
+	: InternedString(string.c_str(), string.size()) {}
+
+InternedString::InternedString(const char* string, size_t length) {
+	if (length == 0) return;
+
+	StringTable& table = GetStringTable();
+	for (Hash hash = HashBuffer(string, length);; ++hash) {
+		unsigned* existingId = table.ids.Find(hash);
+		if (existingId == nullptr) {
+			StringTableEntry entry;
+			entry.string = table.Store(string, length);
+			entry.length = (unsigned) length;
+			id = (unsigned) table.entries.size();
+			table.entries.push_back(entry);
+			table.ids[hash] = id;
+			return;
+		}
+
+		const StringTableEntry& entry = table.entries[*existingId];
+		if (entry.length == length && memcmp(entry.string, string, length) == 0) {
+			id = *existingId;
+			return;
+		}
+	}
+}
+
+const char* InternedString::c_str() const {
+	return GetStringTable().entries[id].string;
+}
+
+unsigned InternedString::size() const {
+	return GetStringTable().entries[id].length;
+}
+
+unsigned GetNumInternedStrings() {
+	return (unsigned) GetStringTable().entries.size() - 1;
+}
+
+size_t GetInternedStringsMemory() {
+	StringTable& table = GetStringTable();
+	return table.memory + table.entries.capacity() * sizeof(StringTableEntry);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+
+/* 32-bit id of a string stored once in the global string table.
+*  Interning the same contents always gives the same id, so comparing and hashing interned strings is an integer operation.
+*  The characters live in big blocks that are never moved or freed, so c_str() pointers stay valid for the whole execution.
+*  Not thread-safe: strings are interned from one thread at a time (the main thread, or the startup worker that loads the scene).
+*/
+
+class InternedString {
+public:
+	InternedString() {}
+	InternedString(const char* string);
+	InternedString(const char* string, size_t length);
+	InternedString(const std::string& string);
+
+	const char* c_str() const;
+	unsigned size() const;
+
+	bool empty() const {
+		return id == 0;
+	}
+
+	unsigned Id() const {
+		return id;
+	}
+
+	bool operator==(InternedString other) const {
+		return id == other.id;
+	}
+
+	bool operator!=(InternedString other) const {
+		return id != other.id;
+	}
+
+private:
+	unsigned id = 0; // 0 is the empty string.
+};
+
+// Stats of the global string table
+unsigned GetNumInternedStrings();
+size_t GetInternedStringsMemory();
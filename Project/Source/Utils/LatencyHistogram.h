@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Utils/Bits.h"
+
+#include <string.h>
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS 5 // Recorded values keep 5 significant bits: 3% max relative error.
+#define LATENCY_HISTOGRAM_MAX_BITS 36 // Values up to 2^36 ns (68 s). Bigger values are clamped.
+#define LATENCY_HISTOGRAM_SUB_BUCKETS (1u << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+#define LATENCY_HISTOGRAM_NUM_BUCKETS ((LATENCY_HISTOGRAM_MAX_BITS - LATENCY_HISTOGRAM_SUB_BUCKET_BITS + 1) * LATENCY_HISTOGRAM_SUB_BUCKETS)
+
+/* HDR-style histogram of durations in nanoseconds.
+*  Buckets are log-linear: every power of 2 is split in LATENCY_HISTOGRAM_SUB_BUCKETS linear sub-buckets, so the relative error
+*  is the same for microseconds and for seconds, and recording is a couple of bit operations and an increment.
+*  Histograms can be merged, which is how rolling windows are built from per-second histograms.
+*/
+
+class LatencyHistogram {
+public:
+	void Record(unsigned long long valueNs) {
+		unsigned long long maxValue = (1ull << LATENCY_HISTOGRAM_MAX_BITS) - 1;
+		if (valueNs > maxValue) valueNs = maxValue;
+
+		counts[BucketIndex(valueNs)] += 1;
+		count += 1;
+		sumNs += valueNs;
+		if (valueNs > maxNs) maxNs = valueNs;
+	}
+
+	void Merge(const LatencyHistogram& other) {
+		if (other.count == 0) return;
+
+		for (unsigned i = 0; i < LATENCY_HISTOGRAM_NUM_BUCKETS; ++i) {
+			counts[i] += other.counts[i];
+		}
+		count += other.count;
+		sumNs += other.sumNs;
+		if (other.maxNs > maxNs) maxNs = other.maxNs;
+	}
+
+	void Clear() {
+		memset(counts, 0, sizeof(counts));
+		count = 0;
+		sumNs = 0;
+		maxNs = 0;
+	}
+
+	// Smallest recorded value such that 'percentile'% of the values are lower or equal, up to the bucket precision
+	unsigned long long Percentile(double percentile) const {
+		if (count == 0) return 0;
+
+		unsigned long long target = (unsigned long long) (percentile / 100.0 * count + 0.5);
+		if (target < 1) target = 1;
+		if (target > count) target = count;
+
+		unsigned long long accumulated = 0;
+		for (unsigned i = 0; i < LATENCY_HISTOGRAM_NUM_BUCKETS; ++i) {
+			accumulated += counts[i];
+			if (accumulated >= target) {
+				unsigned long long value = BucketMaxValue(i);
+				return value < maxNs ? value : maxNs;
+			}
+		}
+		return maxNs;
+	}
+
+	unsigned long long Count() const {
+		return count;
+	}
+
+	unsigned long long MeanNs() const {
+		return count > 0 ? sumNs / count : 0;
+	}
+
+	unsigned long long MaxNs() const {
+		return maxNs;
+	}
+
+private:
+	static unsigned BucketIndex(unsigned long long value) {
+		if (value < LATENCY_HISTOGRAM_SUB_BUCKETS) return (unsigned) value;
+
+		// Keep the most significant bit and the next LATENCY_HISTOGRAM_SUB_BUCKET_BITS bits
+		unsigned msb = 63 - CountLeadingZeros64(value);
+		unsigned shift = msb - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+		unsigned subBucket = (unsigned) (value >> shift) - LATENCY_HISTOGRAM_SUB_BUCKETS;
+		return (shift + 1) * LATENCY_HISTOGRAM_SUB_BUCKETS + subBucket;
+	}
+
+	static unsigned long long BucketMaxValue(unsigned index) {
+		if (index < LATENCY_HISTOGRAM_SUB_BUCKETS) return index;
+
+		unsigned shift = index / LATENCY_HISTOGRAM_SUB_BUCKETS - 1;
+		unsigned long long mantissa = index % LATENCY_HISTOGRAM_SUB_BUCKETS + LATENCY_HISTOGRAM_SUB_BUCKETS;
+		return ((mantissa + 1) << shift) - 1;
+	}
+
+private:
+	unsigned counts[LATENCY_HISTOGRAM_NUM_BUCKETS] = {0};
+	unsigned long long count = 0;
+	unsigned long long sumNs = 0;
+	unsigned long long maxNs = 0;
+};
@@ -1,24 +1,197 @@
 #include "Logging.h"
 
-#include <sstream>
 #include <windows.h>
 #include <stdio.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 
 #include "Leaks.h"
 
-void Log(const char file[], int line, const char* format, ...) {
-	static char tmpString[4096];
-	static char tmpString2[4096];
-	static va_list ap;
+#define LOG_RING_MASK (LOG_RING_SIZE - 1)
+#define LOG_DRAIN_INTERVAL_MS 10
 
+struct LogMessage {
+	std::atomic<size_t> sequence;
+	LogLevel level = LogLevel::INFO;
+	LogCategory category = LogCategory::GENERAL;
+	const char* file = nullptr;
+	int line = 0;
+	char text[LOG_MESSAGE_SIZE] = {'\0'};
+};
+
+// Bounded multi-producer queue (D. Vyukov). A slot can be written when its sequence equals the enqueue position
+// and read when it equals the position + 1, so producers only contend on a single atomic increment.
+struct LogRing {
+	LogRing() {
+		for (size_t i = 0; i < LOG_RING_SIZE; ++i) {
+			messages[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	LogMessage messages[LOG_RING_SIZE];
+	std::atomic<size_t> enqueuePosition {0};
+	size_t dequeuePosition = 0; // Only used by the thread that drains the ring.
+	std::atomic<unsigned long long> numDropped {0};
+};
+
+struct LogHistory {
+	std::mutex mutex;
+	LogLine lines[LOG_HISTORY_SIZE];
+	unsigned first = 0;
+	unsigned count = 0;
+	std::atomic<unsigned long long> version {0};
+};
+
+struct LogSink {
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wakeUp;
+	bool stop = false;
+	FILE* file = nullptr;
+};
+
+static LogRing& GetLogRing() {
+	static LogRing ring;
+	return ring;
+}
+
+static LogHistory& GetLogHistory() {
+	static LogHistory history;
+	return history;
+}
+
+static LogSink sink;
+
+static const char* GetLogLevelPrefix(LogLevel level) {
+	switch (level) {
+	case LogLevel::WARNING:
+		return "[Warning] ";
+	case LogLevel::CRITICAL:
+		return "[Critical] ";
+	default:
+		return "";
+	}
+}
+
+// Moves every message in the ring to the outputs. Returns the number of messages.
+static unsigned DrainLog() {
+	LogRing& ring = GetLogRing();
+	LogHistory& history = GetLogHistory();
+
+	unsigned numMessages = 0;
+	while (true) {
+		LogMessage& message = ring.messages[ring.dequeuePosition & LOG_RING_MASK];
+		if (message.sequence.load(std::memory_order_acquire) != ring.dequeuePosition + 1) break;
+
+		LogLine line;
+		line.level = message.level;
+		line.category = message.category;
+		snprintf(line.text, sizeof(line.text), "%s(%d) : %s%s\n", message.file, message.line, GetLogLevelPrefix(message.level), message.text);
+
+		message.sequence.store(ring.dequeuePosition + LOG_RING_SIZE, std::memory_order_release);
+		ring.dequeuePosition += 1;
+
+		OutputDebugString(line.text);
+		if (sink.file != nullptr) fputs(line.text, sink.file);
+
+		{
+			std::lock_guard<std::mutex> lock(history.mutex);
+			history.lines[(history.first + history.count) % LOG_HISTORY_SIZE] = line;
+			if (history.count < LOG_HISTORY_SIZE) {
+				history.count += 1;
+			} else {
+				history.first = (history.first + 1) % LOG_HISTORY_SIZE;
+			}
+		}
+
+		numMessages += 1;
+	}
+
+	if (numMessages > 0) {
+		history.version.fetch_add(1, std::memory_order_release);
+		if (sink.file != nullptr) fflush(sink.file);
+	}
+	return numMessages;
+}
+
+static void DrainLogThread() {
+	std::unique_lock<std::mutex> lock(sink.mutex);
+	while (!sink.stop) {
+		lock.unlock();
+		DrainLog();
+		lock.lock();
+		sink.wakeUp.wait_for(lock, std::chrono::milliseconds(LOG_DRAIN_INTERVAL_MS));
+	}
+}
+
+// Copies a piece of a message to a free slot. Returns false if the ring is full.
+static bool EnqueueLogMessage(LogLevel level, LogCategory category, const char file[], int line, const char* text, size_t length) {
+	LogRing& ring = GetLogRing();
+
+	// Claim a slot
+	size_t position = ring.enqueuePosition.load(std::memory_order_relaxed);
+	LogMessage* message;
+	while (true) {
+		message = &ring.messages[position & LOG_RING_MASK];
+		intptr_t difference = (intptr_t) message->sequence.load(std::memory_order_acquire) - (intptr_t) position;
+		if (difference == 0) {
+			if (ring.enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+		} else if (difference < 0) {
+			// The ring is full
+			ring.numDropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		} else {
+			position = ring.enqueuePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	message->level = level;
+	message->category = category;
+	message->file = file;
+	message->line = line;
+	memcpy(message->text, text, length);
+	message->text[length] = '\0';
+
+	message->sequence.store(position + 1, std::memory_order_release);
+
+	// Wake the sink early on critical messages and when the ring starts filling up
+	if (level == LogLevel::CRITICAL || (position & (LOG_RING_SIZE / 4 - 1)) == 0) sink.wakeUp.notify_one();
+	return true;
+}
+
+void Log(LogLevel level, LogCategory category, const char file[], int line, const char* format, ...) {
 	// Construct the string from variable arguments
+	char text[LOG_MAX_MESSAGE_SIZE];
+	va_list ap;
 	va_start(ap, format);
-	vsprintf_s(tmpString, 4096, format, ap);
+	int result = vsnprintf(text, LOG_MAX_MESSAGE_SIZE, format, ap);
 	va_end(ap);
-	sprintf_s(tmpString2, 4096, "%s(%d) : %s\n", file, line, tmpString);
-	OutputDebugString(tmpString2);
+	if (result < 0) return;
+	size_t length = (size_t) result < LOG_MAX_MESSAGE_SIZE ? (size_t) result : LOG_MAX_MESSAGE_SIZE - 1;
 
-	logString->append(tmpString2);
+	// Long messages (shader info logs, for example) are split into slots, preferably after a line break
+	const char* piece = text;
+	size_t remaining = length;
+	do {
+		size_t pieceLength = remaining;
+		size_t skip = 0;
+		if (remaining > LOG_MESSAGE_SIZE - 1) {
+			pieceLength = LOG_MESSAGE_SIZE - 1;
+			for (size_t i = pieceLength; i > 0; --i) {
+				if (piece[i - 1] == '\n') {
+					pieceLength = i - 1;
+					skip = 1;
+					break;
+				}
+			}
+		}
+		if (!EnqueueLogMessage(level, category, file, line, piece, pieceLength)) return;
+		piece += pieceLength + skip;
+		remaining -= pieceLength + skip;
+	} while (remaining > 0);
 }
 
 void LogDeltaMS(float deltaMs) {
@@ -31,7 +204,69 @@ void LogDeltaMS(float deltaMs) {
 	msLog[fpsLogIndex] = deltaMs;
 }
 
-std::string* logString = nullptr;
+void InitLogging() {
+	if (sink.thread.joinable()) return;
+
+	sink.file = fopen(LOG_FILE_PATH, "w");
+	sink.stop = false;
+	sink.thread = std::thread(DrainLogThread);
+}
+
+void ShutdownLogging() {
+	if (sink.thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(sink.mutex);
+			sink.stop = true;
+		}
+		sink.wakeUp.notify_one();
+		sink.thread.join();
+	}
+
+	// Write the messages logged since the last drain
+	DrainLog();
+
+	if (sink.file != nullptr) {
+		fclose(sink.file);
+		sink.file = nullptr;
+	}
+}
+
+std::mutex& GetLogHistoryMutex() {
+	return GetLogHistory().mutex;
+}
+
+unsigned GetLogHistorySize() {
+	return GetLogHistory().count;
+}
+
+const LogLine& GetLogHistoryLine(unsigned index) {
+	LogHistory& history = GetLogHistory();
+	return history.lines[(history.first + index) % LOG_HISTORY_SIZE];
+}
+
+unsigned long long GetLogHistoryVersion() {
+	return GetLogHistory().version.load(std::memory_order_acquire);
+}
+
+unsigned long long GetNumDroppedLogMessages() {
+	return GetLogRing().numDropped.load(std::memory_order_relaxed);
+}
+
+const char* GetLogCategoryName(LogCategory category) {
+	switch (category) {
+	case LogCategory::GENERAL:
+		return "General";
+	case LogCategory::IMPORT:
+		return "Import";
+	case LogCategory::SCENE:
+		return "Scene";
+	case LogCategory::RENDER:
+		return "Render";
+	default:
+		return "";
+	}
+}
+
 int fpsLogIndex = FPS_LOG_SIZE - 1;
 float fpsLog[FPS_LOG_SIZE] = {0};
 float msLog[FPS_LOG_SIZE] = {0};
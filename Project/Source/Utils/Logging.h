@@ -1,16 +1,97 @@
 #pragma once
 
-#include <string>
+#include <string.h>
+#include <mutex>
 
 #define __FILENAME__ (strrchr(__FILE__, '\\') ? strrchr(__FILE__, '\\') + 1 : __FILE__)
 
-#define LOG(format, ...) Log(__FILENAME__, __LINE__, format, __VA_ARGS__);
+/* Thread-safe logging.
+*  Messages are formatted by the calling thread into a fixed lock-free ring. A background thread drains the ring,
+*  writes the messages to LOG_FILE_PATH and keeps the last LOG_HISTORY_SIZE lines for the console.
+*  Messages longer than a slot take several slots, split at line breaks where possible, up to LOG_MAX_MESSAGE_SIZE.
+*  If the ring is full, new messages are dropped and counted instead of blocking the caller.
+*  Messages below LOG_MIN_LEVEL are removed at compile time.
+*/
+
+#define LOG_LEVEL_VERBOSE 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARNING 2
+#define LOG_LEVEL_CRITICAL 3
+
+#ifndef LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define LOG_MIN_LEVEL LOG_LEVEL_VERBOSE
+#else
+#define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+#endif
+
+#define LOG_FILE_PATH "Log.txt"
+#define LOG_RING_SIZE 4096 // Must be a power of 2
+#define LOG_MESSAGE_SIZE 256 // Per ring slot
+#define LOG_MAX_MESSAGE_SIZE 4096 // Longer messages are cut
+#define LOG_HISTORY_SIZE 2048
+
+enum class LogLevel {
+	VERBOSE = LOG_LEVEL_VERBOSE,
+	INFO = LOG_LEVEL_INFO,
+	WARNING = LOG_LEVEL_WARNING,
+	CRITICAL = LOG_LEVEL_CRITICAL
+};
+
+enum class LogCategory {
+	GENERAL,
+	IMPORT,
+	SCENE,
+	RENDER,
+	COUNT
+};
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_VERBOSE
+#define LOG_VERBOSE(category, format, ...) Log(LogLevel::VERBOSE, category, __FILENAME__, __LINE__, format, __VA_ARGS__);
+#else
+#define LOG_VERBOSE(category, format, ...)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(category, format, ...) Log(LogLevel::INFO, category, __FILENAME__, __LINE__, format, __VA_ARGS__);
+#else
+#define LOG_INFO(category, format, ...)
+#endif
+
+#if LOG_MIN_LEVEL <= LOG_LEVEL_WARNING
+#define LOG_WARNING(category, format, ...) Log(LogLevel::WARNING, category, __FILENAME__, __LINE__, format, __VA_ARGS__);
+#else
+#define LOG_WARNING(category, format, ...)
+#endif
+
+#define LOG_CRITICAL(category, format, ...) Log(LogLevel::CRITICAL, category, __FILENAME__, __LINE__, format, __VA_ARGS__);
+
+#define LOG(format, ...) LOG_INFO(LogCategory::GENERAL, format, __VA_ARGS__)
+
 #define FPS_LOG_SIZE 100
 
-void Log(const char file[], int line, const char* format, ...);
+void Log(LogLevel level, LogCategory category, const char file[], int line, const char* format, ...);
 void LogDeltaMS(float deltaMs);
 
-extern std::string* logString;
+// Starts and stops the thread that drains the log. Messages logged before starting are kept in the ring.
+void InitLogging();
+void ShutdownLogging();
+
+// Console history. Lock GetLogHistoryMutex() while reading it.
+struct LogLine {
+	LogLevel level = LogLevel::INFO;
+	LogCategory category = LogCategory::GENERAL;
+	char text[LOG_MESSAGE_SIZE + 64] = {'\0'};
+};
+
+std::mutex& GetLogHistoryMutex();
+unsigned GetLogHistorySize();
+const LogLine& GetLogHistoryLine(unsigned index); // 0 is the oldest line
+unsigned long long GetLogHistoryVersion(); // Changes every time lines are added
+unsigned long long GetNumDroppedLogMessages();
+const char* GetLogCategoryName(LogCategory category);
+
 extern int fpsLogIndex;
 extern float fpsLog[];
 extern float msLog[];
@@ -0,0 +1,252 @@
+#include "OcclusionBuffer.h"
+
+#include "Utils/ParallelFor.h"
+#include "Utils/Profiling.h"
+
+#include "Math/float4.h"
+#include "Math/MathFunc.h"
+#include "Geometry/AABB.h"
+#include <emmintrin.h>
+#include <math.h>
+#include <utility>
+
+#include "Utils/Leaks.h"
+
+// Below this, starting the threads costs more than the bands save
+#define OCCLUSION_PARALLEL_MIN_TRIANGLES 512
+
+#define OCCLUSION_TILES_X (OCCLUSION_BUFFER_WIDTH / OCCLUSION_TILE_SIZE)
+#define OCCLUSION_TILES_Y (OCCLUSION_BUFFER_HEIGHT / OCCLUSION_TILE_SIZE)
+#define OCCLUSION_BAND_HEIGHT (OCCLUSION_BUFFER_HEIGHT / OCCLUSION_BUFFER_BANDS)
+
+void OcclusionBuffer::Begin(const float4x4& viewProjection_, float nearPlaneDistance_) {
+	viewProjection = viewProjection_;
+	nearPlaneDistance = nearPlaneDistance_;
+	triangles.clear();
+	for (std::vector<unsigned>& band : bandTriangles) {
+		band.clear();
+	}
+	depth.assign(OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT, 0.0f);
+	tileDepth.assign(OCCLUSION_TILES_X * OCCLUSION_TILES_Y, 0.0f);
+}
+
+void OcclusionBuffer::AddOccluder(const float3* vertices, const unsigned* indices, unsigned numIndices, const float4x4& modelMatrix) {
+	float4x4 modelViewProjection = viewProjection * modelMatrix;
+	for (unsigned i = 0; i + 2 < numIndices; i += 3) {
+		float4 clipVertices[3];
+		for (unsigned v = 0; v < 3; ++v) {
+			clipVertices[v] = modelViewProjection * float4(vertices[indices[i + v]], 1.0f);
+		}
+		AddClippedTriangle(clipVertices);
+	}
+}
+
+// In perspective projections, w is the distance along the view direction, so the near plane is w = nearPlaneDistance
+void OcclusionBuffer::AddClippedTriangle(const float4* clipVertices) {
+	float4 polygon[4];
+	unsigned numVertices = 0;
+	for (unsigned v = 0; v < 3; ++v) {
+		const float4& current = clipVertices[v];
+		const float4& next = clipVertices[(v + 1) % 3];
+		bool currentInside = current.w >= nearPlaneDistance;
+		bool nextInside = next.w >= nearPlaneDistance;
+		if (currentInside) polygon[numVertices++] = current;
+		if (currentInside != nextInside) {
+			float t = (nearPlaneDistance - current.w) / (next.w - current.w);
+			polygon[numVertices++] = current + (next - current) * t;
+		}
+	}
+	if (numVertices < 3) return;
+
+	float screenX[4];
+	float screenY[4];
+	float screenDepth[4];
+	for (unsigned v = 0; v < numVertices; ++v) {
+		float invW = 1.0f / polygon[v].w;
+		screenX[v] = (polygon[v].x * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH;
+		screenY[v] = (polygon[v].y * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_HEIGHT;
+		screenDepth[v] = invW;
+	}
+
+	// Clipping a corner leaves a quad, split in two triangles
+	for (unsigned v = 1; v + 1 < numVertices; ++v) {
+		unsigned corners[3] = {0, v, v + 1};
+		ScreenTriangle triangle;
+		for (unsigned i = 0; i < 3; ++i) {
+			triangle.x[i] = screenX[corners[i]];
+			triangle.y[i] = screenY[corners[i]];
+			triangle.depth[i] = screenDepth[corners[i]];
+		}
+
+		// Bands that the rows of the triangle overlap
+		int minY = Max((int) floorf(Min(triangle.y[0], Min(triangle.y[1], triangle.y[2]))), 0);
+		int maxY = Min((int) ceilf(Max(triangle.y[0], Max(triangle.y[1], triangle.y[2]))), OCCLUSION_BUFFER_HEIGHT);
+		if (minY < maxY) {
+			for (int band = minY / OCCLUSION_BAND_HEIGHT; band <= (maxY - 1) / OCCLUSION_BAND_HEIGHT; ++band) {
+				bandTriangles[band].push_back((unsigned) triangles.size());
+			}
+		}
+		triangles.push_back(triangle);
+	}
+}
+
+void OcclusionBuffer::Rasterize() {
+	PROFILE_ZONE("OcclusionBuffer - Rasterize", ProfilerColor::Green)
+
+	if (triangles.size() < OCCLUSION_PARALLEL_MIN_TRIANGLES) {
+		for (unsigned band = 0; band < OCCLUSION_BUFFER_BANDS; ++band) {
+			RasterizeBand(band);
+		}
+		return;
+	}
+
+	// Bands write disjoint rows and tiles, so they run on the workers without locks
+	ParallelFor(OCCLUSION_BUFFER_BANDS, [this](unsigned band) {
+		RasterizeBand(band);
+	});
+}
+
+void OcclusionBuffer::RasterizeBand(unsigned band) {
+	int bandMinY = band * OCCLUSION_BAND_HEIGHT;
+	int bandMaxY = bandMinY + OCCLUSION_BAND_HEIGHT;
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+	for (unsigned triangleIndex : bandTriangles[band]) {
+		const ScreenTriangle& triangle = triangles[triangleIndex];
+
+		// Both sides are rasterized, so clockwise triangles are flipped
+		float x0 = triangle.x[0], y0 = triangle.y[0], z0 = triangle.depth[0];
+		float x1 = triangle.x[1], y1 = triangle.y[1], z1 = triangle.depth[1];
+		float x2 = triangle.x[2], y2 = triangle.y[2], z2 = triangle.depth[2];
+		float area = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+		if (area == 0.0f) continue;
+		if (area < 0.0f) {
+			std::swap(x1, x2);
+			std::swap(y1, y2);
+			std::swap(z1, z2);
+			area = -area;
+		}
+
+		// Pixel centers inside the bounds
+		int minX = Max((int) floorf(Min(x0, Min(x1, x2))), 0) & ~3;
+		int maxX = Min((int) ceilf(Max(x0, Max(x1, x2))), OCCLUSION_BUFFER_WIDTH);
+		int minY = Max((int) floorf(Min(y0, Min(y1, y2))), bandMinY);
+		int maxY = Min((int) ceilf(Max(y0, Max(y1, y2))), bandMaxY);
+		if (minX >= maxX || minY >= maxY) continue;
+
+		// Edge functions, positive inside: A * x + B * y + C
+		float edgeA[3] = {y0 - y1, y1 - y2, y2 - y0};
+		float edgeB[3] = {x1 - x0, x2 - x1, x0 - x2};
+		float edgeC[3] = {
+			-(edgeA[0] * x0 + edgeB[0] * y0),
+			-(edgeA[1] * x1 + edgeB[1] * y1),
+			-(edgeA[2] * x2 + edgeB[2] * y2),
+		};
+
+		// 1/w is linear in screen space
+		float depthDx = ((z1 - z0) * (y2 - y0) - (z2 - z0) * (y1 - y0)) / area;
+		float depthDy = ((z2 - z0) * (x1 - x0) - (z1 - z0) * (x2 - x0)) / area;
+		float depthC = z0 - depthDx * x0 - depthDy * y0;
+
+		__m128 edgeA0 = _mm_set1_ps(edgeA[0]), edgeA1 = _mm_set1_ps(edgeA[1]), edgeA2 = _mm_set1_ps(edgeA[2]);
+		__m128 depthA = _mm_set1_ps(depthDx);
+		__m128 edgeStep0 = _mm_set1_ps(edgeA[0] * 4.0f), edgeStep1 = _mm_set1_ps(edgeA[1] * 4.0f), edgeStep2 = _mm_set1_ps(edgeA[2] * 4.0f);
+		__m128 depthStep = _mm_set1_ps(depthDx * 4.0f);
+		__m128 zero = _mm_setzero_ps();
+		for (int y = minY; y < maxY; ++y) {
+			float pixelY = y + 0.5f;
+			__m128 pixelX = _mm_add_ps(_mm_set1_ps((float) minX), laneOffsets);
+			__m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelX), _mm_set1_ps(edgeB[0] * pixelY + edgeC[0]));
+			__m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelX), _mm_set1_ps(edgeB[1] * pixelY + edgeC[1]));
+			__m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelX), _mm_set1_ps(edgeB[2] * pixelY + edgeC[2]));
+			__m128 pixelDepth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), _mm_set1_ps(depthDy * pixelY + depthC));
+
+			float* row = &depth[y * OCCLUSION_BUFFER_WIDTH];
+			for (int x = minX; x < maxX; x += 4) {
+				__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+				if (_mm_movemask_ps(inside) != 0) {
+					__m128 stored = _mm_loadu_ps(row + x);
+					__m128 closest = _mm_max_ps(stored, pixelDepth);
+					_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, stored)));
+				}
+
+				edge0 = _mm_add_ps(edge0, edgeStep0);
+				edge1 = _mm_add_ps(edge1, edgeStep1);
+				edge2 = _mm_add_ps(edge2, edgeStep2);
+				pixelDepth = _mm_add_ps(pixelDepth, depthStep);
+			}
+		}
+	}
+
+	// Farthest depth of the tiles in the band
+	for (int tileY = bandMinY / OCCLUSION_TILE_SIZE; tileY < bandMaxY / OCCLUSION_TILE_SIZE; ++tileY) {
+		for (int tileX = 0; tileX < OCCLUSION_TILES_X; ++tileX) {
+			__m128 farthest = _mm_set1_ps(FLOAT_INF);
+			for (int y = tileY * OCCLUSION_TILE_SIZE; y < (tileY + 1) * OCCLUSION_TILE_SIZE; ++y) {
+				const float* row = &depth[y * OCCLUSION_BUFFER_WIDTH + tileX * OCCLUSION_TILE_SIZE];
+				for (int x = 0; x < OCCLUSION_TILE_SIZE; x += 4) {
+					farthest = _mm_min_ps(farthest, _mm_loadu_ps(row + x));
+				}
+			}
+			float lanes[4];
+			_mm_storeu_ps(lanes, farthest);
+			tileDepth[tileY * OCCLUSION_TILES_X + tileX] = Min(Min(lanes[0], lanes[1]), Min(lanes[2], lanes[3]));
+		}
+	}
+}
+
+bool OcclusionBuffer::IsOccluded(const AABB& aabb) const {
+	if (triangles.empty()) return false;
+
+	// Screen bounds and closest depth of the box
+	float3 corners[8];
+	aabb.GetCornerPoints(corners);
+	float minX = FLOAT_INF, minY = FLOAT_INF, maxX = -FLOAT_INF, maxY = -FLOAT_INF;
+	float closestDepth = 0.0f;
+	for (const float3& corner : corners) {
+		float4 clipCorner = viewProjection * float4(corner, 1.0f);
+		if (clipCorner.w < nearPlaneDistance) return false;
+
+		float invW = 1.0f / clipCorner.w;
+		float x = (clipCorner.x * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH;
+		float y = (clipCorner.y * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_HEIGHT;
+		minX = Min(minX, x);
+		minY = Min(minY, y);
+		maxX = Max(maxX, x);
+		maxY = Max(maxY, y);
+		closestDepth = Max(closestDepth, invW);
+	}
+
+	// Every pixel that the box touches has to be covered by something closer
+	int pixelMinX = Max((int) floorf(minX), 0);
+	int pixelMinY = Max((int) floorf(minY), 0);
+	int pixelMaxX = Min((int) ceilf(maxX), OCCLUSION_BUFFER_WIDTH);
+	int pixelMaxY = Min((int) ceilf(maxY), OCCLUSION_BUFFER_HEIGHT);
+	if (pixelMinX >= pixelMaxX || pixelMinY >= pixelMaxY) return false; // Outside of the screen: left to frustum culling
+
+	for (int tileY = pixelMinY / OCCLUSION_TILE_SIZE; tileY <= (pixelMaxY - 1) / OCCLUSION_TILE_SIZE; ++tileY) {
+		int tileMinY = Max(tileY * OCCLUSION_TILE_SIZE, pixelMinY);
+		int tileMaxY = Min((tileY + 1) * OCCLUSION_TILE_SIZE, pixelMaxY);
+		for (int tileX = pixelMinX / OCCLUSION_TILE_SIZE; tileX <= (pixelMaxX - 1) / OCCLUSION_TILE_SIZE; ++tileX) {
+			if (tileDepth[tileY * OCCLUSION_TILES_X + tileX] > closestDepth) continue;
+
+			// Tiles that are only partially in front need a closer look, unless the whole tile is covered by the box
+			int tileMinX = Max(tileX * OCCLUSION_TILE_SIZE, pixelMinX);
+			int tileMaxX = Min((tileX + 1) * OCCLUSION_TILE_SIZE, pixelMaxX);
+			if (tileMaxX - tileMinX == OCCLUSION_TILE_SIZE && tileMaxY - tileMinY == OCCLUSION_TILE_SIZE) return false;
+
+			for (int y = tileMinY; y < tileMaxY; ++y) {
+				const float* row = &depth[y * OCCLUSION_BUFFER_WIDTH];
+				for (int x = tileMinX; x < tileMaxX; ++x) {
+					if (row[x] <= closestDepth) return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+unsigned OcclusionBuffer::GetNumTriangles() const {
+	return (unsigned) triangles.size();
+}
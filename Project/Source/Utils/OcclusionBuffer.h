@@ -0,0 +1,50 @@
+#pragma once
+
+#include "MathGeoLibFwd.h"
+#include "Math/float3.h"
+#include "Math/float4x4.h"
+
+#include <vector>
+
+#define OCCLUSION_BUFFER_WIDTH 256 // Multiple of OCCLUSION_TILE_SIZE
+#define OCCLUSION_BUFFER_HEIGHT 128 // Multiple of OCCLUSION_TILE_SIZE * OCCLUSION_BUFFER_BANDS
+#define OCCLUSION_TILE_SIZE 8
+#define OCCLUSION_BUFFER_BANDS 8
+
+/* Small software depth buffer for occlusion culling.
+*  Occluders are transformed and clipped against the near plane, then rasterized with SSE2, 4 pixels at a time.
+*  Triangles are binned into bands of rows as they are added, and each band only rasterizes its own triangles.
+*  Bands are rasterized on worker threads with ParallelFor, unless there are too few triangles to pay for the threads.
+*  The farthest depth of every tile is kept as a second level, so most tests don't need to read single pixels.
+*  Depth is stored as 1/w: larger is closer, and 0 means that nothing was rasterized.
+*/
+
+class OcclusionBuffer {
+public:
+	void Begin(const float4x4& viewProjection, float nearPlaneDistance);
+	void AddOccluder(const float3* vertices, const unsigned* indices, unsigned numIndices, const float4x4& modelMatrix);
+	void Rasterize();
+
+	// True if the box is completely behind the occluders. Boxes that cross the near plane are never occluded.
+	bool IsOccluded(const AABB& aabb) const;
+
+	unsigned GetNumTriangles() const;
+
+private:
+	struct ScreenTriangle {
+		float x[3];
+		float y[3];
+		float depth[3];
+	};
+
+	void AddClippedTriangle(const float4* clipVertices);
+	void RasterizeBand(unsigned band);
+
+private:
+	float4x4 viewProjection = float4x4::identity;
+	float nearPlaneDistance = 0.0f;
+	std::vector<ScreenTriangle> triangles;
+	std::vector<unsigned> bandTriangles[OCCLUSION_BUFFER_BANDS]; // Indices of the triangles that overlap each band
+	std::vector<float> depth;
+	std::vector<float> tileDepth; // Farthest depth of each tile
+};
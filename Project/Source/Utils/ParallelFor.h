@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Utils/Profiling.h"
+
+#include "Math/MathFunc.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+
+// Calls function(index) for every index in [0, count) using all the hardware threads. The calling thread also does work.
+// Threads are created on every call, so each index should represent a meaningful amount of work (a row of blocks, an image, etc.).
+template<typename F>
+inline void ParallelFor(unsigned count, const F& function) {
+	unsigned numThreads = Min(Max(std::thread::hardware_concurrency(), 1u), count);
+	if (numThreads <= 1) {
+		for (unsigned i = 0; i < count; ++i) {
+			function(i);
+		}
+		return;
+	}
+
+	std::atomic<unsigned> nextIndex(0);
+	auto worker = [&]() {
+		PROFILE_ZONE("ParallelFor", ProfilerColor::SkyBlue)
+
+		for (unsigned i = nextIndex++; i < count; i = nextIndex++) {
+			function(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(numThreads - 1);
+	for (unsigned i = 1; i < numThreads; ++i) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
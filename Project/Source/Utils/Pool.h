@@ -1,83 +1,200 @@
 #pragma once
 
 #include "Globals.h"
+#include "Utils/Bits.h"
+#include "Utils/PoolHandle.h"
 
 #include "Math/myassert.h"
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <string.h>
+
+/* Object pool with stable addresses.
+*  - Allocate(capacity): a single page of 'capacity' objects. Obtaining more objects than that is an error.
+*  - AllocatePaged(pageSize, maxCapacity, decommitEmptyPages): grows by adding pages of 'pageSize' objects up to 'maxCapacity'.
+*    Pages are never moved, so pointers stay valid. Pages that become empty can optionally be freed.
+*  Objects are constructed when their page is created and reused afterwards, so released objects keep their state.
+*  Iteration goes through live objects in slot order, scanning an occupancy bitset 64 slots at a time.
+*  GetHandle/Get convert objects to PoolHandles and back. Get returns nullptr if the object has been released since.
+*  Release and GetHandle find the page of an object with a binary search over the committed pages sorted by address.
+*/
 
 template<typename T>
 class Pool {
+private:
+	static const unsigned FREE_LIST_END = (unsigned) -1;
+
+	struct Page {
+		T* data = nullptr; // Data storage. Null if the page isn't committed.
+		unsigned* nextFree = nullptr; // Linked list of free slots.
+		unsigned long long* occupancy = nullptr; // One bit per slot. Set if the object isn't free.
+		unsigned short* generations = nullptr; // Generation of each slot for handles. Kept when the page is decommitted.
+		unsigned firstFree = FREE_LIST_END; // First free slot in the linked list.
+		unsigned count = 0; // Current number of objects in the page.
+	};
+
+	struct CommittedPage {
+		const T* data = nullptr;
+		unsigned pageIndex = 0;
+	};
+
 public:
 	~Pool() {
 		Clear();
 	}
 
-	void Allocate(unsigned amount) {
+	void Allocate(unsigned capacity) {
 		Clear();
 
-		// Allocate
-		size = amount;
-		count = 0;
-		data = new T[amount];
-		nextFree = new T*[amount];
-		firstFree = data;
+		pageSize = capacity;
+		maxPages = 1;
+		decommitEmptyPages = false;
+		if (capacity > 0) AddPage();
+	}
 
-		// Initialize free list
-		for (size_t i = 0; i < amount; ++i) {
-			nextFree[i] = data + (i + 1);
-		}
+	void AllocatePaged(unsigned pageSize_, unsigned maxCapacity = (unsigned) -1, bool decommitEmptyPages_ = false) {
+		assert(pageSize_ > 0);
+
+		Clear();
+
+		pageSize = pageSize_;
+		maxPages = (unsigned) (((unsigned long long) maxCapacity + pageSize - 1) / pageSize);
+		decommitEmptyPages = decommitEmptyPages_;
+		AddPage();
 	}
 
 	void Clear() {
-		size = 0;
+		for (unsigned i = 0; i < pages.size(); ++i) {
+			DecommitPage(i);
+			RELEASE_ARRAY(pages[i].generations);
+		}
+		pages.clear();
+		freePages.clear();
 		count = 0;
-		RELEASE_ARRAY(data);
-		RELEASE_ARRAY(nextFree);
-		firstFree = nullptr;
+		highWater = 0;
 	}
 
 	T* Obtain() {
-		assert(firstFree != nullptr); // The pool hasn't been initialized
+		assert(pageSize > 0); // The pool hasn't been initialized
+
+		if (freePages.empty() && !AddPage()) {
+			assert(false); // Pool overflow
+			return nullptr;
+		}
 
-		assert(firstFree != data + size); // Pool overflow
+		unsigned pageIndex = freePages.back();
+		if (pages[pageIndex].data == nullptr) CommitPage(pageIndex);
+		Page& page = pages[pageIndex];
 
 		// Obtain a new object
-		T* object = firstFree;
-		size_t index = object - data;
-		firstFree = nextFree[index];
-		nextFree[index] = nullptr;
+		unsigned slot = page.firstFree;
+		page.firstFree = page.nextFree[slot];
+		page.occupancy[slot / 64] |= 1ull << (slot % 64);
+		page.count += 1;
+		if (page.firstFree == FREE_LIST_END) freePages.pop_back();
+
 		count += 1;
+		if (count > highWater) highWater = count;
 
-		return object;
+		return &page.data[slot];
 	}
 
 	void Release(T* object) {
-		assert(object >= data && object < data + size); // The object is not in the data array
+		unsigned pageIndex = FindPage(object);
+		assert(pageIndex < pages.size()); // The object is not in the pool
 
-		size_t index = object - data;
+		Page& page = pages[pageIndex];
+		unsigned slot = (unsigned) (object - page.data);
 
-		assert(nextFree[index] == nullptr); // The object is already free
+		assert(IsUsed(page, slot)); // The object is already free
 
 		// Release the object
-		nextFree[index] = firstFree;
-		firstFree = object;
+		if (page.firstFree == FREE_LIST_END) freePages.push_back(pageIndex);
+		page.occupancy[slot / 64] &= ~(1ull << (slot % 64));
+		page.generations[slot] = NextGeneration(page.generations[slot]);
+		page.nextFree[slot] = page.firstFree;
+		page.firstFree = slot;
+		page.count -= 1;
 		count -= 1;
+
+		if (page.count == 0 && decommitEmptyPages && pageIndex > 0) {
+			DecommitPage(pageIndex);
+		}
 	}
 
 	void ReleaseAll() {
-		// Reset count and free list
+		// Reset count and free lists. Pages are reused in order, first page first.
+		freePages.clear();
+		for (unsigned i = (unsigned) pages.size(); i > 0; --i) {
+			Page& page = pages[i - 1];
+			if (page.data != nullptr) InvalidateHandles(page);
+			if (decommitEmptyPages && i > 1) {
+				DecommitPage(i - 1);
+			} else if (page.data != nullptr) {
+				ResetFreeList(page);
+			}
+			freePages.push_back(i - 1);
+		}
 		count = 0;
-		firstFree = data;
+	}
 
-		// Initialize free list
-		for (size_t i = 0; i < size; ++i) {
-			nextFree[i] = data + (i + 1);
-		}
+	// Handles
+
+	PoolHandle<T> GetHandle(const T* object) const {
+		if (object == nullptr) return PoolHandle<T>();
+
+		unsigned pageIndex = FindPage(object);
+		assert(pageIndex < pages.size()); // The object is not in the pool
+
+		const Page& page = pages[pageIndex];
+		unsigned slot = (unsigned) (object - page.data);
+		assert(IsUsed(page, slot)); // The object is free
+		size_t index = (size_t) pageIndex * pageSize + slot;
+		assert(index <= POOL_HANDLE_MAX_INDEX); // The pool is too big to be referenced by handles
+
+		return PoolHandle<T>((unsigned) index, page.generations[slot]);
+	}
+
+	T* Get(PoolHandle<T> handle) const {
+		if (handle.IsNull() || pages.empty()) return nullptr;
+
+		unsigned pageIndex = handle.Index() / pageSize;
+		if (pageIndex >= pages.size()) return nullptr;
+
+		const Page& page = pages[pageIndex];
+		unsigned slot = handle.Index() % pageSize;
+		if (page.data == nullptr || page.generations[slot] != handle.Generation()) return nullptr;
+
+		return &page.data[slot];
 	}
 
-	size_t Count() {
+	// Stats
+
+	size_t Count() const {
 		return count;
 	}
 
+	size_t HighWater() const {
+		return highWater;
+	}
+
+	size_t Capacity() const {
+		return (size_t) pageSize * maxPages;
+	}
+
+	size_t CommittedCapacity() const {
+		size_t committedCapacity = 0;
+		for (const Page& page : pages) {
+			if (page.data != nullptr) committedCapacity += pageSize;
+		}
+		return committedCapacity;
+	}
+
+	unsigned NumPages() const {
+		return (unsigned) pages.size();
+	}
+
 	// Iteration
 
 	class Iterator {
@@ -87,10 +204,7 @@ public:
 			, index(index__) {}
 
 		const Iterator& operator++() {
-			index += 1;
-			while (index < pool->size && pool->nextFree[index] != nullptr) {
-				index += 1;
-			}
+			index = pool->NextUsedIndex(index + 1);
 			return *this;
 		}
 
@@ -99,7 +213,7 @@ public:
 		}
 
 		T& operator*() const {
-			return pool->data[index];
+			return pool->pages[index / pool->pageSize].data[index % pool->pageSize];
 		}
 
 	private:
@@ -108,33 +222,149 @@ public:
 	};
 
 	typename Pool<T>::Iterator begin() {
-		size_t index = 0;
-		while (index < size && nextFree[index] != nullptr) {
-			index += 1;
-		}
-		return Pool<T>::Iterator(*this, index);
+		return Pool<T>::Iterator(*this, NextUsedIndex(0));
 	}
 
 	typename Pool<const T>::Iterator begin() const {
-		size_t index = 0;
-		while (index < size && nextFree[index] != nullptr) {
-			index += 1;
-		}
-		return Pool<const T>::Iterator((Pool<const T>&) *this, index);
+		return Pool<const T>::Iterator((Pool<const T>&) *this, NextUsedIndex(0));
 	}
 
 	typename Pool<T>::Iterator end() {
-		return Pool<T>::Iterator(*this, size);
+		return Pool<T>::Iterator(*this, EndIndex());
 	}
 
 	typename Pool<const T>::Iterator end() const {
-		return Pool<const T>::Iterator((Pool<const T>&) *this, size);
+		return Pool<const T>::Iterator((Pool<const T>&) *this, EndIndex());
 	}
 
 private:
-	size_t size = 0; // Max number of objects in the pool.
+	bool AddPage() {
+		if (pages.size() >= maxPages) return false;
+
+		pages.emplace_back();
+		Page& page = pages.back();
+		page.generations = new unsigned short[pageSize];
+		for (unsigned i = 0; i < pageSize; ++i) {
+			page.generations[i] = 1;
+		}
+		unsigned pageIndex = (unsigned) pages.size() - 1;
+		CommitPage(pageIndex);
+		freePages.push_back(pageIndex);
+		return true;
+	}
+
+	void CommitPage(unsigned pageIndex) {
+		Page& page = pages[pageIndex];
+		page.data = new T[pageSize];
+		page.nextFree = new unsigned[pageSize];
+		page.occupancy = new unsigned long long[NumOccupancyWords()];
+		ResetFreeList(page);
+
+		CommittedPage committedPage;
+		committedPage.data = page.data;
+		committedPage.pageIndex = pageIndex;
+		committedPages.insert(FindCommittedPage(page.data), committedPage);
+	}
+
+	void DecommitPage(unsigned pageIndex) {
+		Page& page = pages[pageIndex];
+		if (page.data != nullptr) committedPages.erase(FindCommittedPage(page.data) - 1); // The entry before the first one that starts after the page
+
+		RELEASE_ARRAY(page.data);
+		RELEASE_ARRAY(page.nextFree);
+		RELEASE_ARRAY(page.occupancy);
+		page.firstFree = 0; // Decommitted pages are empty, they are committed again when obtaining from them
+		page.count = 0;
+	}
+
+	void ResetFreeList(Page& page) {
+		for (unsigned i = 0; i < pageSize; ++i) {
+			page.nextFree[i] = i + 1;
+		}
+		page.nextFree[pageSize - 1] = FREE_LIST_END;
+		memset(page.occupancy, 0, NumOccupancyWords() * sizeof(unsigned long long));
+		page.firstFree = 0;
+		page.count = 0;
+	}
+
+	bool IsUsed(const Page& page, unsigned slot) const {
+		return (page.occupancy[slot / 64] & (1ull << (slot % 64))) != 0;
+	}
+
+	static unsigned short NextGeneration(unsigned short generation) {
+		// Generation 0 is skipped so that null handles never resolve
+		return generation == POOL_HANDLE_MAX_GENERATION ? 1 : generation + 1;
+	}
+
+	void InvalidateHandles(Page& page) {
+		for (unsigned word = 0; word < NumOccupancyWords(); ++word) {
+			unsigned long long bits = page.occupancy[word];
+			while (bits != 0) {
+				unsigned slot = word * 64 + CountTrailingZeros64(bits);
+				page.generations[slot] = NextGeneration(page.generations[slot]);
+				bits &= bits - 1;
+			}
+		}
+	}
+
+	// First committed page that starts after the object
+	typename std::vector<CommittedPage>::const_iterator FindCommittedPage(const T* object) const {
+		return std::upper_bound(committedPages.begin(), committedPages.end(), object, [](const T* object, const CommittedPage& committedPage) {
+			return std::less<const T*>()(object, committedPage.data);
+		});
+	}
+
+	unsigned FindPage(const T* object) const {
+		typename std::vector<CommittedPage>::const_iterator it = FindCommittedPage(object);
+		if (it == committedPages.begin()) return (unsigned) pages.size();
+
+		--it;
+		if (!std::less<const T*>()(object, it->data + pageSize)) return (unsigned) pages.size();
+		return it->pageIndex;
+	}
+
+	size_t EndIndex() const {
+		return (size_t) pageSize * pages.size();
+	}
+
+	unsigned NumOccupancyWords() const {
+		return (pageSize + 63) / 64;
+	}
+
+	size_t NextUsedIndex(size_t index) const {
+		size_t endIndex = EndIndex();
+		while (index < endIndex) {
+			size_t pageIndex = index / pageSize;
+			const Page& page = pages[pageIndex];
+			if (page.count > 0) {
+				// Find the next set bit in the occupancy words of this page
+				unsigned slot = (unsigned) (index % pageSize);
+				unsigned word = slot / 64;
+				unsigned long long bits = page.occupancy[word] & (~0ull << (slot % 64));
+				unsigned numWords = NumOccupancyWords();
+				while (bits == 0 && ++word < numWords) {
+					bits = page.occupancy[word];
+				}
+				if (bits != 0) {
+					return pageIndex * pageSize + word * 64 + CountTrailingZeros64(bits);
+				}
+			}
+
+			// Skip to the next page
+			index = (pageIndex + 1) * pageSize;
+		}
+		return endIndex;
+	}
+
+private:
+	unsigned pageSize = 0; // Number of objects per page.
+	unsigned maxPages = 0; // Max number of pages. Fixed pools have 1.
+	bool decommitEmptyPages = false; // Free the memory of pages that become empty. The first page is always kept.
+
 	size_t count = 0; // Current number of objects in the pool.
-	T* data = nullptr; // Data storage.
-	T** nextFree = nullptr; // Linked list of free objects. Null pointers mean that the object isn't free. Last item points to the end of the data.
-	T* firstFree = nullptr; // First free object in the linked list.
+	size_t highWater = 0; // Max number of objects that have been in the pool at the same time.
+
+	std::vector<Page> pages;
+	std::vector<unsigned> freePages; // Pages with free slots. Objects are obtained from the last one.
+	std::vector<CommittedPage> committedPages; // Sorted by address
 };
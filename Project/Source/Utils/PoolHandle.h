@@ -0,0 +1,43 @@
+#pragma once
+
+#define POOL_HANDLE_INDEX_BITS 20
+#define POOL_HANDLE_GENERATION_BITS 12
+#define POOL_HANDLE_MAX_INDEX ((1u << POOL_HANDLE_INDEX_BITS) - 1)
+#define POOL_HANDLE_MAX_GENERATION ((1u << POOL_HANDLE_GENERATION_BITS) - 1)
+
+/* 32-bit reference to an object in a Pool<T>: slot index + generation of the slot.
+*  The generation changes every time the slot is released, so handles to released objects are detected when resolved.
+*  Generations start at 1, so a handle with value 0 is always null.
+*/
+
+template<typename T>
+class PoolHandle {
+public:
+	PoolHandle() {}
+
+	PoolHandle(unsigned index, unsigned generation)
+		: value((generation << POOL_HANDLE_INDEX_BITS) | index) {}
+
+	unsigned Index() const {
+		return value & POOL_HANDLE_MAX_INDEX;
+	}
+
+	unsigned Generation() const {
+		return value >> POOL_HANDLE_INDEX_BITS;
+	}
+
+	bool IsNull() const {
+		return value == 0;
+	}
+
+	bool operator==(const PoolHandle<T>& other) const {
+		return value == other.value;
+	}
+
+	bool operator!=(const PoolHandle<T>& other) const {
+		return value != other.value;
+	}
+
+public:
+	unsigned value = 0;
+};
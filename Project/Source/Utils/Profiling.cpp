@@ -0,0 +1,256 @@
+#include "Profiling.h"
+
+#include "FileSystem/JsonWriter.h"
+
+#include "SDL_timer.h"
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <stdio.h>
+
+#include "Utils/Leaks.h"
+
+#define PROFILER_EVENTS_MASK (PROFILER_EVENTS_PER_THREAD - 1)
+#define PROFILER_FRAMES_MASK (PROFILER_MAX_FRAMES - 1)
+
+// The oldest zones of a buffer can be overwritten while they are read, so readers leave this many zones out
+#define PROFILER_READ_MARGIN (PROFILER_EVENTS_PER_THREAD / 8)
+
+struct ProfilerThread {
+	ProfilerZone zones[PROFILER_EVENTS_PER_THREAD];
+	std::atomic<unsigned long long> numZones {0}; // Total number of zones recorded. Only written by the thread that owns the buffer.
+	unsigned depth = 0;
+	unsigned id = 0;
+	char name[32] = {'\0'};
+	bool inUse = false;
+};
+
+struct ProfilerState {
+	std::mutex mutex; // Guards the list of threads, not the zones
+	std::vector<ProfilerThread*> threads;
+	bool shutDown = false;
+
+	unsigned long long frameStartNs[PROFILER_MAX_FRAMES] = {0};
+	std::atomic<unsigned long long> numFrames {0};
+};
+
+static ProfilerState& GetProfilerState() {
+	static ProfilerState state;
+	return state;
+}
+
+// Buffers are returned when their thread ends, so that short-lived worker threads reuse them
+struct ProfilerThreadSlot {
+	~ProfilerThreadSlot() {
+		if (thread == nullptr) return;
+
+		ProfilerState& state = GetProfilerState();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		if (!state.shutDown) thread->inUse = false;
+	}
+
+	ProfilerThread* thread = nullptr;
+	bool acquired = false;
+};
+
+static thread_local ProfilerThreadSlot threadSlot;
+
+static ProfilerThread* GetProfilerThread() {
+	if (threadSlot.acquired) return threadSlot.thread;
+	threadSlot.acquired = true;
+
+	ProfilerState& state = GetProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	if (state.shutDown) return nullptr;
+
+	ProfilerThread* thread = nullptr;
+	for (ProfilerThread* freeThread : state.threads) {
+		if (!freeThread->inUse) {
+			thread = freeThread;
+			break;
+		}
+	}
+	if (thread == nullptr) {
+		thread = new ProfilerThread();
+		thread->id = (unsigned) state.threads.size();
+		state.threads.push_back(thread);
+	}
+	thread->inUse = true;
+	thread->depth = 0;
+	sprintf_s(thread->name, "Thread %u", thread->id);
+
+	threadSlot.thread = thread;
+	return thread;
+}
+
+// Only includes the zones that are safe to read. Returns the index of the first one.
+static unsigned long long FirstReadableZone(unsigned long long numZones) {
+	const unsigned long long numReadable = PROFILER_EVENTS_PER_THREAD - PROFILER_READ_MARGIN;
+	return numZones > numReadable ? numZones - numReadable : 0;
+}
+
+ProfileScope::ProfileScope(const char* name_, unsigned color_) {
+	thread = GetProfilerThread();
+	if (thread == nullptr) return;
+
+	name = name_;
+	color = color_;
+	depth = thread->depth;
+	thread->depth += 1;
+	startNs = ProfilerNowNs();
+}
+
+ProfileScope::~ProfileScope() {
+	if (thread == nullptr) return;
+
+	unsigned long long endNs = ProfilerNowNs();
+	thread->depth -= 1;
+
+	unsigned long long numZones = thread->numZones.load(std::memory_order_relaxed);
+	ProfilerZone& zone = thread->zones[numZones & PROFILER_EVENTS_MASK];
+	zone.name = name;
+	zone.startNs = startNs;
+	zone.endNs = endNs;
+	zone.color = color;
+	zone.depth = depth;
+	thread->numZones.store(numZones + 1, std::memory_order_release);
+}
+
+unsigned long long ProfilerNowNs() {
+	static const unsigned long long frequency = SDL_GetPerformanceFrequency();
+	static const unsigned long long startCount = SDL_GetPerformanceCounter();
+
+	// Split in seconds and remainder, so that the conversion doesn't overflow
+	unsigned long long count = SDL_GetPerformanceCounter() - startCount;
+	return count / frequency * 1000000000ull + count % frequency * 1000000000ull / frequency;
+}
+
+void ProfilerMarkFrame() {
+	ProfilerState& state = GetProfilerState();
+	unsigned long long numFrames = state.numFrames.load(std::memory_order_relaxed);
+	state.frameStartNs[numFrames & PROFILER_FRAMES_MASK] = ProfilerNowNs();
+	state.numFrames.store(numFrames + 1, std::memory_order_release);
+}
+
+void SetProfilerThreadName(const char* name) {
+	ProfilerThread* thread = GetProfilerThread();
+	if (thread == nullptr) return;
+
+	std::lock_guard<std::mutex> lock(GetProfilerState().mutex);
+	sprintf_s(thread->name, "%s", name);
+}
+
+bool CaptureProfilerFrame(ProfilerFrameCapture& capture) {
+	ProfilerState& state = GetProfilerState();
+	unsigned long long numFrames = state.numFrames.load(std::memory_order_acquire);
+	if (numFrames < 2) return false;
+
+	// The last completed frame goes from the second to last frame mark to the last one
+	unsigned long long frame = numFrames - 2;
+	capture.frame = frame;
+	capture.startNs = state.frameStartNs[frame & PROFILER_FRAMES_MASK];
+	capture.endNs = state.frameStartNs[(frame + 1) & PROFILER_FRAMES_MASK];
+
+	std::lock_guard<std::mutex> lock(state.mutex);
+	unsigned numThreadCaptures = 0;
+	for (ProfilerThread* thread : state.threads) {
+		// Containers are reused between captures to avoid allocations
+		if (numThreadCaptures == capture.threads.size()) capture.threads.emplace_back();
+		ProfilerThreadCapture& threadCapture = capture.threads[numThreadCaptures];
+		threadCapture.zones.clear();
+
+		// Zones are stored in end time order, so search backwards until the frame start
+		unsigned long long numZones = thread->numZones.load(std::memory_order_acquire);
+		unsigned long long firstZone = FirstReadableZone(numZones);
+		for (unsigned long long i = numZones; i > firstZone; --i) {
+			const ProfilerZone& zone = thread->zones[(i - 1) & PROFILER_EVENTS_MASK];
+			if (zone.endNs < capture.startNs) break;
+			if (zone.startNs >= capture.startNs && zone.endNs <= capture.endNs) {
+				threadCapture.zones.push_back(zone);
+			}
+		}
+		if (threadCapture.zones.empty()) continue;
+
+		std::reverse(threadCapture.zones.begin(), threadCapture.zones.end());
+		threadCapture.threadId = thread->id;
+		threadCapture.threadName = thread->name;
+		numThreadCaptures += 1;
+	}
+	capture.threads.resize(numThreadCaptures);
+
+	return true;
+}
+
+bool ExportProfilerTrace(const char* filePath) {
+	JsonWriter writer(filePath);
+	if (!writer.IsOpen()) return false;
+
+	ProfilerState& state = GetProfilerState();
+
+	writer.StartObject();
+	writer.Key("traceEvents");
+	writer.StartArray();
+	{
+		std::lock_guard<std::mutex> lock(state.mutex);
+		for (ProfilerThread* thread : state.threads) {
+			// Thread name
+			writer.StartObject();
+			writer.Member("name", "thread_name");
+			writer.Member("ph", "M");
+			writer.Member("pid", 0u);
+			writer.Member("tid", thread->id);
+			writer.Key("args");
+			writer.StartObject();
+			writer.Member("name", (const char*) thread->name);
+			writer.EndObject();
+			writer.EndObject();
+
+			// Zones as complete events. Times are in microseconds.
+			unsigned long long numZones = thread->numZones.load(std::memory_order_acquire);
+			for (unsigned long long i = FirstReadableZone(numZones); i < numZones; ++i) {
+				const ProfilerZone& zone = thread->zones[i & PROFILER_EVENTS_MASK];
+				writer.StartObject();
+				writer.Member("name", zone.name);
+				writer.Member("ph", "X");
+				writer.Member("ts", zone.startNs / 1000.0);
+				writer.Member("dur", (zone.endNs - zone.startNs) / 1000.0);
+				writer.Member("pid", 0u);
+				writer.Member("tid", thread->id);
+				writer.EndObject();
+			}
+		}
+	}
+
+	// Frame marks as global instant events
+	unsigned long long numFrames = state.numFrames.load(std::memory_order_acquire);
+	unsigned long long firstFrame = numFrames > PROFILER_MAX_FRAMES ? numFrames - PROFILER_MAX_FRAMES : 0;
+	for (unsigned long long i = firstFrame; i < numFrames; ++i) {
+		writer.StartObject();
+		writer.Member("name", "Frame");
+		writer.Member("ph", "i");
+		writer.Member("s", "g");
+		writer.Member("ts", state.frameStartNs[i & PROFILER_FRAMES_MASK] / 1000.0);
+		writer.Member("pid", 0u);
+		writer.Member("tid", 0u);
+		writer.EndObject();
+	}
+
+	writer.EndArray();
+	writer.Member("displayTimeUnit", "ns");
+	writer.EndObject();
+
+	return writer.Close();
+}
+
+void ShutdownProfiler() {
+	ProfilerState& state = GetProfilerState();
+	std::lock_guard<std::mutex> lock(state.mutex);
+	state.shutDown = true;
+	for (ProfilerThread* thread : state.threads) {
+		delete thread;
+	}
+	std::vector<ProfilerThread*>().swap(state.threads);
+
+	threadSlot.thread = nullptr;
+	threadSlot.acquired = true;
+}
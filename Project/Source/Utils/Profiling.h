@@ -0,0 +1,104 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/* Built-in hierarchical CPU profiler.
+*  PROFILE_ZONE records a named zone from that line until the end of the scope. Every thread writes its zones to its own
+*  ring buffer of PROFILER_EVENTS_PER_THREAD events, so recording doesn't take locks. Old events are overwritten.
+*  Frames are marked with PROFILE_FRAME at the start of Application::Update.
+*  The last frame can be captured for the editor and the buffers can be exported as a Chrome trace (chrome://tracing, Perfetto).
+*  On Windows, zones are also forwarded to Brofiler unless PROFILER_NO_BROFILER is defined.
+*/
+
+#define PROFILER_EVENTS_PER_THREAD 65536 // Must be a power of 2
+#define PROFILER_MAX_FRAMES 256 // Must be a power of 2
+#define PROFILER_TRACE_FILE_PATH "Trace.json"
+
+#if defined(_WIN32) && !defined(PROFILER_NO_BROFILER)
+#include "Brofiler.h"
+#define PROFILER_BROFILER_CATEGORY(name, color) BROFILER_CATEGORY(name, color)
+#define PROFILER_BROFILER_FRAME(name) BROFILER_FRAME(name)
+#else
+#define PROFILER_BROFILER_CATEGORY(name, color)
+#define PROFILER_BROFILER_FRAME(name)
+#endif
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+
+#define PROFILE_ZONE(name, color) \
+	ProfileScope PROFILER_CONCAT(profileScope, __LINE__)(name, (unsigned) color); \
+	PROFILER_BROFILER_CATEGORY(name, color)
+
+#define PROFILE_FRAME(name) \
+	ProfilerMarkFrame(); \
+	ProfileScope PROFILER_CONCAT(profileScope, __LINE__)(name, (unsigned) ProfilerColor::White); \
+	PROFILER_BROFILER_FRAME(name)
+
+// ARGB colors of the zones. Same values as the Brofiler colors with the same name.
+namespace ProfilerColor {
+	enum : unsigned {
+		AntiqueWhite = 0xFFFAEBD7,
+		Azure = 0xFFF0FFFF,
+		Black = 0xFF000000,
+		Blue = 0xFF0000FF,
+		Green = 0xFF008000,
+		Orange = 0xFFFFA500,
+		Purple = 0xFF800080,
+		Red = 0xFFFF0000,
+		SkyBlue = 0xFF87CEEB,
+		White = 0xFFFFFFFF,
+		Yellow = 0xFFFFFF00
+	};
+} // namespace ProfilerColor
+
+struct ProfilerZone {
+	const char* name = nullptr; // Must be a string literal, or at least outlive the profiler.
+	unsigned long long startNs = 0;
+	unsigned long long endNs = 0;
+	unsigned color = 0;
+	unsigned depth = 0; // Number of zones that contain this one in the same thread.
+};
+
+struct ProfilerThreadCapture {
+	unsigned threadId = 0;
+	std::string threadName = "";
+	std::vector<ProfilerZone> zones; // Sorted by end time
+};
+
+struct ProfilerFrameCapture {
+	unsigned long long frame = 0;
+	unsigned long long startNs = 0;
+	unsigned long long endNs = 0;
+	std::vector<ProfilerThreadCapture> threads;
+};
+
+class ProfileScope {
+public:
+	ProfileScope(const char* name, unsigned color);
+	~ProfileScope();
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	struct ProfilerThread* thread = nullptr;
+	const char* name = nullptr;
+	unsigned color = 0;
+	unsigned depth = 0;
+	unsigned long long startNs = 0;
+};
+
+unsigned long long ProfilerNowNs();
+void ProfilerMarkFrame();
+void SetProfilerThreadName(const char* name); // Shown in the editor and in traces
+
+// Zones of the last completed frame. Returns false if there isn't one yet.
+bool CaptureProfilerFrame(ProfilerFrameCapture& capture);
+
+// Writes every buffered zone in Chrome trace event format.
+bool ExportProfilerTrace(const char* filePath);
+
+// Frees the thread buffers. Zones recorded afterwards are ignored.
+void ShutdownProfiler();
@@ -14,7 +14,7 @@ public:
 	// The elements in a node are linked
 	class Element {
 	public:
-		T* object = nullptr;
+		T object = T();
 		AABB2D aabb = {{0, 0}, {0, 0}};
 		Element* next = nullptr;
 	};
@@ -23,7 +23,7 @@ public:
 	class QuadNode;
 	class Node {
 	public:
-		void Add(Quadtree& tree, T* object, const AABB2D& objectAABB, unsigned depth, const AABB2D& nodeAABB, bool optimizing) {
+		void Add(Quadtree& tree, T object, const AABB2D& objectAABB, unsigned depth, const AABB2D& nodeAABB, bool optimizing) {
 			if (IsBranch()) {
 				// Branch
 				childNodes->Add(tree, object, objectAABB, depth + 1, nodeAABB, optimizing);
@@ -51,21 +51,21 @@ public:
 			}
 		}
 
-		void Remove(Quadtree& tree, T* object) {
+		void Remove(Quadtree& tree, T object) {
 			if (IsBranch()) {
 				childNodes->Remove(tree, object);
 			} else {
-				Element* element = firstElement;
+				// Unlink through the pointer that points to the element, so that any element can be removed
 				Element** elementPtr = &firstElement;
-				while (element != nullptr) {
+				while (*elementPtr != nullptr) {
+					Element* element = *elementPtr;
 					if (element->object == object) {
 						*elementPtr = element->next;
 						tree.elements.Release(element);
 						elementCount -= 1;
+					} else {
+						elementPtr = &element->next;
 					}
-
-					element = element->next;
-					elementPtr = &element->next;
 				}
 			}
 		}
@@ -82,7 +82,7 @@ public:
 
 				// Remove all elements and reinsert them
 				while (element != nullptr) {
-					T* object = element->object;
+					T object = element->object;
 					AABB2D objectAABB = element->aabb;
 					Element* nextElement = element->next;
 					tree.elements.Release(element);
@@ -103,7 +103,7 @@ public:
 
 				// Remove all elements and reinsert them
 				for (Element& tempElement : *tempElements) {
-					T* object = tempElement.object;
+					T object = tempElement.object;
 					AABB2D objectAABB = tempElement.aabb;
 					tree.numAddedElements -= 1;
 
@@ -156,7 +156,7 @@ public:
 			}
 		}
 
-		void Add(Quadtree& tree, T* object, const AABB2D& objectAABB, unsigned depth, const AABB2D& nodeAABB, bool optimizing) {
+		void Add(Quadtree& tree, T object, const AABB2D& objectAABB, unsigned depth, const AABB2D& nodeAABB, bool optimizing) {
 			vec2d center = nodeAABB.minPoint + (nodeAABB.maxPoint - nodeAABB.minPoint) * 0.5f;
 
 			AABB2D topLeftAABB = {{nodeAABB.minPoint.x, center.y}, {center.x, nodeAABB.maxPoint.y}};
@@ -180,7 +180,7 @@ public:
 			}
 		}
 
-		void Remove(Quadtree& tree, T* object) {
+		void Remove(Quadtree& tree, T object) {
 			for (Node& node : nodes) {
 				node.Remove(tree, object);
 			}
@@ -203,14 +203,14 @@ public:
 		auxRoot.tempElementList = new std::list<Element>();
 	}
 
-	void Add(T* object, const AABB2D& objectAABB) {
+	void Add(T object, const AABB2D& objectAABB) {
 		assert(!operative); // Tried to add an object to a locked quadtree
 
 		auxRoot.Add(*this, object, objectAABB, 1, bounds, false);
-		addedObjects.emplace_back(std::pair<T*, AABB2D>(object, objectAABB));
+		addedObjects.emplace_back(std::pair<T, AABB2D>(object, objectAABB));
 	}
 
-	void Remove(T* object) {
+	void Remove(T object) {
 		assert(operative); // Tried to remove an object from an unlocked quadtree
 
 		root.Remove(*this, object);
@@ -220,7 +220,7 @@ public:
 		quadNodes.Allocate(auxQuadNodes.size());
 		elements.Allocate(numAddedElements);
 
-		for (std::pair<T*, AABB2D> pair : addedObjects) {
+		for (std::pair<T, AABB2D> pair : addedObjects) {
 			AddToPools(pair.first, pair.second);
 		}
 
@@ -285,7 +285,7 @@ public:
 	Pool<Element> elements;
 
 protected:
-	void AddToPools(T* object, const AABB2D& objectAABB) {
+	void AddToPools(T object, const AABB2D& objectAABB) {
 		root.Add(*this, object, objectAABB, 1, bounds, true);
 	}
 
@@ -295,5 +295,5 @@ private:
 	Node auxRoot;
 	unsigned numAddedElements = 0;
 	std::list<QuadNode> auxQuadNodes;
-	std::list<std::pair<T*, AABB2D>> addedObjects;
+	std::list<std::pair<T, AABB2D>> addedObjects;
 };